@@ -24,6 +24,7 @@ Revision History:
 #include "cmd_context/cmd_context.h"
 #include "smt/smt_solver.h"
 #include "parsers/smt2/smt2parser.h"
+#include "ast/ast_binary.h"
 #include "solver/solver_na2as.h"
 
 
@@ -142,6 +143,50 @@ extern "C" {
         Z3_CATCH_RETURN(nullptr);
     }
 
+    void Z3_API Z3_write_binary_file(Z3_context c, Z3_ast_vector v, Z3_string file_name) {
+        Z3_TRY;
+        LOG_Z3_write_binary_file(c, v, file_name);
+        RESET_ERROR_CODE();
+        ptr_vector<expr> fmls;
+        for (ast * a : to_ast_vector_ref(v)) {
+            if (!is_expr(a)) {
+                SET_ERROR_CODE(Z3_INVALID_ARG, "expressions expected");
+                return;
+            }
+            fmls.push_back(to_expr(a));
+        }
+        std::ofstream out(file_name, std::ios::binary);
+        if (!out) {
+            SET_ERROR_CODE(Z3_FILE_ACCESS_ERROR, nullptr);
+            return;
+        }
+        ast_binary_write(mk_c(c)->m(), out, fmls.size(), fmls.c_ptr());
+        if (!out)
+            SET_ERROR_CODE(Z3_FILE_ACCESS_ERROR, nullptr);
+        Z3_CATCH;
+    }
+
+    Z3_ast_vector Z3_API Z3_parse_binary_file(Z3_context c, Z3_string file_name) {
+        Z3_TRY;
+        LOG_Z3_parse_binary_file(c, file_name);
+        RESET_ERROR_CODE();
+        ast_manager & m = mk_c(c)->m();
+        Z3_ast_vector_ref * v = alloc(Z3_ast_vector_ref, *mk_c(c), m);
+        mk_c(c)->save_object(v);
+        expr_ref_vector fmls(m);
+        try {
+            ast_binary_read_file(m, file_name, fmls);
+        }
+        catch (z3_exception & e) {
+            SET_ERROR_CODE(Z3_PARSER_ERROR, e.msg());
+            RETURN_Z3(of_ast_vector(v));
+        }
+        for (expr * e : fmls)
+            v->m_ast_vector.push_back(e);
+        RETURN_Z3(of_ast_vector(v));
+        Z3_CATCH_RETURN(nullptr);
+    }
+
     Z3_string Z3_API Z3_eval_smtlib2_string(Z3_context c, Z3_string str) {
         std::stringstream ous;
         Z3_TRY;
@@ -1514,6 +1514,7 @@ extern "C" {
 
             - proof  (Boolean)           Enable proof generation
             - debug_ref_count (Boolean)  Enable debug support for Z3_ast reference counting
+            - ast_arena (Boolean)        Allocate ASTs in an arena that is released when the context is deleted
             - trace  (Boolean)           Tracing support for VCC
             - trace_file_name (String)   Trace out file for VCC traces
             - timeout (unsigned)         default timeout (in milliseconds) used for solvers
@@ -5547,6 +5548,25 @@ extern "C" {
                                         Z3_symbol const decl_names[],
                                         Z3_func_decl const decls[]);
 
+    /**
+       \brief Write the formulas in \c v to a file in a binary format.
+       Shared subterms are written once. The file can be read with #Z3_parse_binary_file.
+
+       Formulas using datatypes, recursive functions, floating point numerals
+       or algebraic numbers cannot be written.
+
+       def_API('Z3_write_binary_file', VOID, (_in(CONTEXT), _in(AST_VECTOR), _in(STRING)))
+    */
+    void Z3_API Z3_write_binary_file(Z3_context c, Z3_ast_vector v, Z3_string file_name);
+
+    /**
+       \brief Read the formulas written by #Z3_write_binary_file.
+       The uninterpreted sorts and functions used by the formulas are created in \c c.
+
+       def_API('Z3_parse_binary_file', AST_VECTOR, (_in(CONTEXT), _in(STRING)))
+    */
+    Z3_ast_vector Z3_API Z3_parse_binary_file(Z3_context c, Z3_string file_name);
+
 
     /**
        \brief Parse and evaluate and SMT-LIB2 command sequence. The state from a previous call is saved so the next
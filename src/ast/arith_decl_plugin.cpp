@@ -424,6 +424,7 @@ app * arith_decl_plugin::mk_numeral(rational const & val, bool is_int) {
     if (val.is_unsigned()) {
         unsigned u_val = val.get_unsigned();
         if (u_val < MAX_SMALL_NUM_TO_CACHE) {
+            ast_manager::decl_lock lock(*m_manager);
             if (is_int && !m_convert_int_numerals_to_real) {
                 app * r = m_small_ints.get(u_val, 0);
                 if (r == nullptr) {
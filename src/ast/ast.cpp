@@ -29,6 +29,7 @@ Revision History:
 #include "ast/array_decl_plugin.h"
 #include "ast/ast_translation.h"
 #include "util/z3_version.h"
+#include "util/mutex.h"
 
 
 // -----------------------------------
@@ -1380,7 +1381,10 @@ ast_manager::ast_manager(proof_gen_mode m, char const * trace_file, bool is_form
     m_proof_mode(m),
     m_trace_stream(nullptr),
     m_trace_stream_owner(false),
-    m_lambda_def(":lambda-def") {
+    m_lambda_def(":lambda-def"),
+    m_arena(nullptr),
+    m_concurrency(nullptr),
+    m_concurrent(false) {
 
     if (trace_file) {
         m_trace_stream       = alloc(std::fstream, trace_file, std::ios_base::out);
@@ -1403,7 +1407,10 @@ ast_manager::ast_manager(proof_gen_mode m, std::fstream * trace_stream, bool is_
     m_proof_mode(m),
     m_trace_stream(trace_stream),
     m_trace_stream_owner(false),
-    m_lambda_def(":lambda-def") {
+    m_lambda_def(":lambda-def"),
+    m_arena(nullptr),
+    m_concurrency(nullptr),
+    m_concurrent(false) {
 
     if (!is_format_manager)
         m_format_manager = alloc(ast_manager, PGM_DISABLED, trace_stream, true);
@@ -1420,7 +1427,10 @@ ast_manager::ast_manager(ast_manager const & src, bool disable_proofs):
     m_proof_mode(disable_proofs ? PGM_DISABLED : src.m_proof_mode),
     m_trace_stream(src.m_trace_stream),
     m_trace_stream_owner(false),
-    m_lambda_def(":lambda-def") {
+    m_lambda_def(":lambda-def"),
+    m_arena(nullptr),
+    m_concurrency(nullptr),
+    m_concurrent(false) {
     SASSERT(!src.is_format_manager());
     m_format_manager = alloc(ast_manager, PGM_DISABLED, m_trace_stream, true);
     init();
@@ -1480,10 +1490,54 @@ static void mark_array_ref(ast_mark& mark, unsigned sz, parameter const * a) {
     }
 }
 
+struct ast_manager::concurrency_state {
+    struct shard {
+        mutex     m_mutex;
+        ast_table m_table;
+    };
+    shard                m_shards[64];
+    mutex                m_decls_mutex;
+#ifndef SINGLE_THREAD
+    std::recursive_mutex m_plugin_mutex;
+#endif
+    atomic<unsigned>     m_expr_id;
+    atomic<unsigned>     m_decl_id;
+    atomic<unsigned>     m_fresh_id;
+    ptr_vector<ast>      m_pre_nodes; // nodes created before the manager was shared.
+
+    // the low bits of the hash code select the slot inside the shard.
+    shard & get_shard(unsigned h) { return m_shards[h >> 26]; }
+};
 
 ast_manager::~ast_manager() {
     SASSERT(is_format_manager() || !m_family_manager.has_family(symbol("format")));
 
+    for (auto const & kv : m_extensions)
+        dealloc(kv.m_value);
+    m_extensions.reset();
+    if (m_concurrency) {
+        // the manager is no longer shared, move the nodes back to m_ast_table.
+        m_concurrent = false;
+        for (auto & s : m_concurrency->m_shards)
+            for (ast * n : s.m_table)
+                m_ast_table.insert(n);
+    }
+    if (m_arena) {
+        // the nodes are released with the arena, only declaration infos
+        // own memory. They are released while the plugins are alive.
+        for (ast * n : m_arena_decls) {
+            if (is_sort(n)) {
+                sort_info * info = to_sort(n)->get_info();
+                info->del_eh(*this);
+                dealloc(info);
+            }
+            else {
+                func_decl_info * info = to_func_decl(n)->get_info();
+                info->del_eh(*this);
+                dealloc(info);
+            }
+        }
+    }
     dec_ref(m_bool_sort);
     dec_ref(m_proof_sort);
     dec_ref(m_true);
@@ -1498,6 +1552,24 @@ ast_manager::~ast_manager() {
             dealloc(p);
     }
     m_plugins.reset();
+    if (m_arena) {
+        if (m_concurrency) {
+            // nodes created while the manager was shared are allocated individually.
+            ptr_addr_hashtable<ast> pre_nodes;
+            for (ast * n : m_concurrency->m_pre_nodes)
+                pre_nodes.insert(n);
+            for (ast * n : m_ast_table)
+                if (!pre_nodes.contains(n))
+                    memory::deallocate(n);
+            dealloc(m_concurrency);
+            m_concurrency = nullptr;
+        }
+        for (ast * n : m_arena_old_nodes)
+            m_alloc.deallocate(::get_node_size(n), n);
+        m_ast_table.reset();
+        dealloc(m_arena);
+        m_arena = nullptr;
+    }
     while (!m_ast_table.empty()) {
         DEBUG_CODE(IF_VERBOSE(0, verbose_stream() << "ast_manager LEAKED: " << m_ast_table.size() << std::endl););
         ptr_vector<ast> roots;
@@ -1551,7 +1623,7 @@ ast_manager::~ast_manager() {
                 else {
                     std::cout << mk_ll_pp(a, *this, false) << "id: " << a->get_id() << "\n";
                 });
-            a->m_ref_count = 0;
+            a->store_ref_count(0);
             delete_node(a);
         }
     }
@@ -1566,7 +1638,121 @@ ast_manager::~ast_manager() {
     }
 }
 
+void ast_manager::enable_arena() {
+    if (m_arena)
+        return;
+    // nodes that exist already were allocated by m_alloc.
+    for (ast * n : m_ast_table) {
+        m_arena_old_nodes.push_back(n);
+        if ((is_sort(n) && to_sort(n)->get_info()) || (is_func_decl(n) && to_func_decl(n)->get_info()))
+            m_arena_decls.push_back(n);
+    }
+    m_arena = alloc(region);
+}
+
+void * ast_manager::allocate_arena_node(unsigned size) {
+    if (m_concurrent)
+        return memory::allocate(size);
+    unsigned words = (size + sizeof(char*) - 1) / sizeof(char*);
+    if (words < m_arena_free.size() && m_arena_free[words]) {
+        // reuse a node that was released after a hash-consing hit.
+        char * r = m_arena_free[words];
+        m_arena_free[words] = *reinterpret_cast<char**>(r);
+        return r;
+    }
+    return m_arena->allocate(words * sizeof(char*));
+}
+
+void ast_manager::deallocate_arena_node(ast * n, unsigned size) {
+    if (m_concurrent) {
+        memory::deallocate(n);
+        return;
+    }
+    unsigned words = (size + sizeof(char*) - 1) / sizeof(char*);
+    m_arena_free.reserve(words + 1, nullptr);
+    *reinterpret_cast<char**>(n) = m_arena_free[words];
+    m_arena_free[words] = reinterpret_cast<char*>(n);
+}
+
+void ast_manager::enable_concurrency() {
+    if (m_concurrent)
+        return;
+    enable_arena();
+    m_concurrency = alloc(concurrency_state);
+    for (ast * n : m_ast_table) {
+        m_concurrency->m_pre_nodes.push_back(n);
+        m_concurrency->get_shard(n->hash()).m_table.insert(n);
+    }
+    m_ast_table.reset();
+    m_concurrency->m_expr_id = m_expr_id_gen.get_id_range();
+    m_concurrency->m_decl_id = m_decl_id_gen.get_id_range();
+    m_concurrency->m_fresh_id = m_fresh_id;
+    m_concurrent = true;
+}
+
+ast_manager::extension * ast_manager::get_extension(symbol const & name) const {
+    extension * ext = nullptr;
+    m_extensions.find(name, ext);
+    return ext;
+}
+
+void ast_manager::set_extension(symbol const & name, extension * ext) {
+    extension * old = nullptr;
+    if (m_extensions.find(name, old) && old != ext)
+        dealloc(old);
+    m_extensions.insert(name, ext);
+}
+
+void ast_manager::push_arena_decl(ast * n) {
+    if (m_concurrent) {
+        lock_guard lock(m_concurrency->m_decls_mutex);
+        m_arena_decls.push_back(n);
+    }
+    else {
+        m_arena_decls.push_back(n);
+    }
+}
+
+void ast_manager::lock_decls() {
+#ifndef SINGLE_THREAD
+    m_concurrency->m_plugin_mutex.lock();
+#endif
+}
+
+void ast_manager::unlock_decls() {
+#ifndef SINGLE_THREAD
+    m_concurrency->m_plugin_mutex.unlock();
+#endif
+}
+
+unsigned ast_manager::mk_shared_fresh_id() {
+    return ++m_concurrency->m_fresh_id;
+}
+
+bool ast_manager::contains(ast * a) const {
+    if (m_concurrent) {
+        concurrency_state::shard & s = m_concurrency->get_shard(a->hash());
+        lock_guard lock(s.m_mutex);
+        return s.m_table.contains(a);
+    }
+    return m_ast_table.contains(a);
+}
+
+unsigned ast_manager::get_num_asts() const {
+    if (m_concurrent) {
+        unsigned sz = 0;
+        for (auto & s : m_concurrency->m_shards) {
+            lock_guard lock(s.m_mutex);
+            sz += s.m_table.size();
+        }
+        return sz;
+    }
+    return m_ast_table.size();
+}
+
 void ast_manager::compact_memory() {
+    if (m_concurrent)
+        return;
     m_alloc.consolidate();
     unsigned capacity = m_ast_table.capacity();
     if (capacity > 4*m_ast_table.size()) {
@@ -1583,6 +1769,8 @@ void ast_manager::compact_memory() {
 }
 
 void ast_manager::compress_ids() {
+    if (m_concurrent)
+        return;
     ptr_vector<ast> asts;
     m_expr_id_gen.cleanup();
     m_decl_id_gen.cleanup(c_first_decl_id);
@@ -1795,7 +1983,18 @@ static void track_id(ast_manager& m, ast* n, unsigned id) {
 }
 #endif
 
+static void check_recycled_decl(ast * r, ast * n) {
+    if (is_func_decl(r) && to_func_decl(r)->get_range() != to_func_decl(n)->get_range()) {
+        std::ostringstream buffer;
+        buffer << "Recycling of declaration for the same name '" << to_func_decl(r)->get_name().str()
+               << "' and domain, but different range type is not permitted";
+        throw ast_exception(buffer.str());
+    }
+}
+
 ast * ast_manager::register_node_core(ast * n) {
+    if (m_concurrent)
+        return register_shared_node(n);
     unsigned h = get_node_hash(n);
     n->m_hash = h;
 #ifdef Z3DEBUG
@@ -1809,12 +2008,7 @@ ast * ast_manager::register_node_core(ast * n) {
     if (r != n) {
         SASSERT(contains);
         SASSERT(m_ast_table.contains(n));
-        if (is_func_decl(r) && to_func_decl(r)->get_range() != to_func_decl(n)->get_range()) {
-            std::ostringstream buffer;
-            buffer << "Recycling of declaration for the same name '" << to_func_decl(r)->get_name().str()
-                   << "' and domain, but different range type is not permitted";
-            throw ast_exception(buffer.str());
-        }
+        check_recycled_decl(r, n);
         deallocate_node(n, ::get_node_size(n));
         return r;
     }
@@ -1829,18 +2023,48 @@ ast * ast_manager::register_node_core(ast * n) {
 
     TRACE("ast", tout << "Object " << n->m_id << " was created.\n";);
     TRACE("mk_var_bug", tout << "mk_ast: " << n->m_id << "\n";);
+    init_registered_node(n);
+    return n;
+}
+
+/**
+   \brief Register a node when the manager is shared by threads.
+   The node is initialized while the lock of its shard is held, so other
+   threads only find fully initialized nodes.
+*/
+ast * ast_manager::register_shared_node(ast * n) {
+    unsigned h = get_node_hash(n);
+    n->m_hash = h;
+    concurrency_state::shard & s = m_concurrency->get_shard(h);
+    lock_guard lock(s.m_mutex);
+    ast * r = s.m_table.insert_if_not_there(n);
+    if (r != n) {
+        check_recycled_decl(r, n);
+        deallocate_node(n, ::get_node_size(n));
+        return r;
+    }
+    n->m_id = is_decl(n) ? m_concurrency->m_decl_id++ : m_concurrency->m_expr_id++;
+    init_registered_node(n);
+    return n;
+}
+
+void ast_manager::init_registered_node(ast * n) {
     // increment reference counters
     switch (n->get_kind()) {
     case AST_SORT:
         if (to_sort(n)->m_info != nullptr) {
             to_sort(n)->m_info = alloc(sort_info, *(to_sort(n)->get_info()));
             to_sort(n)->m_info->init_eh(*this);
+            if (m_arena)
+                push_arena_decl(n);
         }
         break;
     case AST_FUNC_DECL:
         if (to_func_decl(n)->m_info != nullptr) {
             to_func_decl(n)->m_info = alloc(func_decl_info, *(to_func_decl(n)->get_info()));
             to_func_decl(n)->m_info->init_eh(*this);
+            if (m_arena)
+                push_arena_decl(n);
         }
         inc_array_ref(to_func_decl(n)->get_arity(), to_func_decl(n)->get_domain());
         inc_ref(to_func_decl(n)->get_range());
@@ -1910,8 +2134,6 @@ ast * ast_manager::register_node_core(ast * n) {
     default:
         break;
     }
-
-    return n;
 }
 
 void ast_manager::delete_node(ast * n) {
@@ -1923,7 +2145,7 @@ void ast_manager::delete_node(ast * n) {
     while ((n = m_ast_table.pop_erase())) {
 
         CTRACE("del_quantifier", is_quantifier(n), tout << "deleting quantifier " << n->m_id << " " << n << "\n";);
-        TRACE("mk_var_bug", tout << "del_ast: " << " " << n->m_ref_count << "\n";);
+        TRACE("mk_var_bug", tout << "del_ast: " << " " << n->get_ref_count() << "\n";);
         TRACE("ast_delete_node", tout << mk_bounded_pp(n, *this) << "\n";);
 
         SASSERT(!m_debug_ref_count || !m_debug_free_indices.contains(n->m_id));
@@ -1989,6 +2211,7 @@ void ast_manager::delete_node(ast * n) {
 
 
 sort * ast_manager::mk_sort(family_id fid, decl_kind k, unsigned num_parameters, parameter const * parameters) {
+    decl_lock lock(*this);
     decl_plugin * p = get_plugin(fid);
     if (p)
         return p->mk_sort(k, num_parameters, parameters);
@@ -1997,6 +2220,7 @@ sort * ast_manager::mk_sort(family_id fid, decl_kind k, unsigned num_parameters,
 
 func_decl * ast_manager::mk_func_decl(family_id fid, decl_kind k, unsigned num_parameters, parameter const * parameters,
                                       unsigned arity, sort * const * domain, sort * range) {
+    decl_lock lock(*this);
     decl_plugin * p = get_plugin(fid);
     if (p)
         return p->mk_func_decl(k, num_parameters, parameters, arity, domain, range);
@@ -2005,6 +2229,7 @@ func_decl * ast_manager::mk_func_decl(family_id fid, decl_kind k, unsigned num_p
 
 func_decl * ast_manager::mk_func_decl(family_id fid, decl_kind k, unsigned num_parameters, parameter const * parameters,
                                       unsigned num_args, expr * const * args, sort * range) {
+    decl_lock lock(*this);
     decl_plugin * p = get_plugin(fid);
     if (p)
         return p->mk_func_decl(k, num_parameters, parameters, num_args, args, range);
@@ -2073,6 +2298,7 @@ sort * ast_manager::substitute(sort* s, unsigned n, sort * const * src, sort * c
 
 
 sort * ast_manager::mk_uninterpreted_sort(symbol const & name, unsigned num_parameters, parameter const * parameters) {
+    decl_lock lock(*this);
     user_sort_plugin * plugin = get_user_sort_plugin();
     decl_kind kind = plugin->register_name(name);
     return plugin->mk_sort(kind, num_parameters, parameters);
@@ -2744,6 +2970,7 @@ expr * ast_manager::get_some_value(sort * s) {
     if (fid != null_family_id) {
         decl_plugin * p = get_plugin(fid);
         if (p != nullptr) {
+            decl_lock lock(*this);
             v = p->get_some_value(s);
             if (v != nullptr)
                 return v;
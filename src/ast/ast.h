@@ -47,6 +47,10 @@ Revision History:
 #include "util/z3_exception.h"
 #include "util/dependency.h"
 #include "util/rlimit.h"
+#include "util/region.h"
+#ifndef SINGLE_THREAD
+#include <atomic>
+#endif
 
 #define RECYCLE_FREE_AST_INDICES
 
@@ -475,7 +479,12 @@ protected:
     void mark_so(bool flag) { m_mark_shared_occs = flag; }
     void reset_mark_so() { m_mark_shared_occs = false; }
     bool is_marked_so() const { return m_mark_shared_occs; }
+#ifdef SINGLE_THREAD
     unsigned m_ref_count;
+#else
+    // Reference counts are only updated atomically when the manager is shared by threads.
+    std::atomic<unsigned> m_ref_count;
+#endif
     unsigned m_hash;
 #ifdef Z3DEBUG
     // In debug mode, we store who is the owner of the mark.
@@ -483,14 +492,26 @@ protected:
     void *   m_mark2_owner;
 #endif
 
+#ifdef SINGLE_THREAD
+    unsigned load_ref_count() const { return m_ref_count; }
+    void store_ref_count(unsigned c) { m_ref_count = c; }
+    void inc_ref_shared() { ++m_ref_count; }
+    void dec_ref_shared() { --m_ref_count; }
+#else
+    unsigned load_ref_count() const { return m_ref_count.load(std::memory_order_relaxed); }
+    void store_ref_count(unsigned c) { m_ref_count.store(c, std::memory_order_relaxed); }
+    void inc_ref_shared() { m_ref_count.fetch_add(1, std::memory_order_relaxed); }
+    void dec_ref_shared() { m_ref_count.fetch_sub(1, std::memory_order_relaxed); }
+#endif
+
     void inc_ref() {
-        SASSERT(m_ref_count < UINT_MAX);
-        m_ref_count ++;
+        SASSERT(load_ref_count() < UINT_MAX);
+        store_ref_count(load_ref_count() + 1);
     }
 
     void dec_ref() {
-        SASSERT(m_ref_count > 0);
-        --m_ref_count;
+        SASSERT(load_ref_count() > 0);
+        store_ref_count(load_ref_count() - 1);
     }
 
     ast(ast_kind k):m_id(UINT_MAX), m_kind(k), m_mark1(false), m_mark2(false), m_mark_shared_occs(false), m_ref_count(0) {
@@ -501,7 +522,7 @@ protected:
     }
 public:
     unsigned get_id() const { return m_id; }
-    unsigned get_ref_count() const { return m_ref_count; }
+    unsigned get_ref_count() const { return load_ref_count(); }
     ast_kind get_kind() const { return static_cast<ast_kind>(m_kind); }
     unsigned hash() const { return m_hash; }
 
@@ -1518,7 +1539,7 @@ public:
 
     void update_fresh_id(ast_manager const& other);
 
-    unsigned mk_fresh_id() { return ++m_fresh_id; }
+    unsigned mk_fresh_id() { return m_concurrent ? mk_shared_fresh_id() : ++m_fresh_id; }
 
 protected:
     reslimit                  m_limit;
@@ -1555,6 +1576,37 @@ protected:
 #endif
     ast_manager *             m_format_manager; // hack for isolating format objects in a different manager.
     symbol                    m_lambda_def;
+    region *                  m_arena;          // nodes are allocated in m_arena when the arena mode is enabled.
+    ptr_vector<char>          m_arena_free;     // free blocks of the arena indexed by size in words.
+    ptr_vector<ast>           m_arena_decls;    // sorts and declarations that own a declaration info.
+    ptr_vector<ast>           m_arena_old_nodes; // nodes created before the arena mode was enabled.
+    struct concurrency_state;
+    concurrency_state *       m_concurrency;    // lock-striped hash-consing table, set when the manager is shared by threads.
+    bool                      m_concurrent;
+public:
+    /**
+       \brief Objects owned by the manager on behalf of other modules,
+       such as caches shared by all rewriters of the manager.
+       They are deleted before the manager releases its nodes.
+    */
+    class extension {
+    public:
+        virtual ~extension() {}
+    };
+private:
+    dictionary<extension*>    m_extensions;
+
+    ast * register_shared_node(ast * n);
+
+    void init_registered_node(ast * n);
+
+    void push_arena_decl(ast * n);
+
+    void lock_decls();
+
+    void unlock_decls();
+
+    unsigned mk_shared_fresh_id();
 
     void init();
 
@@ -1664,7 +1716,7 @@ public:
 
     bool are_distinct(expr * a, expr * b) const;
 
-    bool contains(ast * a) const { return m_ast_table.contains(a); }
+    bool contains(ast * a) const;
     
     bool is_lambda_def(quantifier* q) const { return q->get_qid() == m_lambda_def; }
     void add_lambda_def(func_decl* f, quantifier* q);
@@ -1673,20 +1725,77 @@ public:
 
     symbol const& lambda_def_qid() const { return m_lambda_def; }
 
-    unsigned get_num_asts() const { return m_ast_table.size(); }
+    unsigned get_num_asts() const;
 
     void debug_ref_count() { m_debug_ref_count = true; }
 
+    /**
+       \brief Allocate new nodes in an arena that is released at once when
+       the manager is destroyed. Reference counts are still maintained, but
+       nodes are not deleted when their count drops to zero. This avoids
+       the cost of deleting nodes one by one for managers that are used for
+       a single query.
+    */
+    void enable_arena();
+
+    bool arena_enabled() const { return m_arena != nullptr; }
+
+    /**
+       \brief Allow threads to create and share terms of this manager.
+
+       The hash-consing table is split into shards that are protected by
+       separate locks, reference counts are updated atomically, and calls
+       into declaration plugins through the manager are serialized. Nodes
+       are kept until the manager is destroyed, as in the arena mode, so a
+       node found by one thread cannot be deleted by another.
+
+       Creating sorts, declarations and applications is thread-safe.
+       Marks, compact_memory, the expression dependency and array managers,
+       and the format manager used by pretty printers are not.
+    */
+    void enable_concurrency();
+
+    bool concurrency_enabled() const { return m_concurrent; }
+
+    /**
+       \brief Return the extension registered under \c name, or nullptr.
+    */
+    extension * get_extension(symbol const & name) const;
+
+    /**
+       \brief Register \c ext under \c name. The manager takes ownership
+       of \c ext and deletes the extension previously registered under \c name.
+    */
+    void set_extension(symbol const & name, extension * ext);
+
+    /**
+       \brief Lock used by declaration plugins that cache declarations or
+       terms outside of ast_manager::mk_func_decl. It is recursive and only
+       taken when concurrency is enabled.
+    */
+    class decl_lock {
+        ast_manager & m;
+    public:
+        decl_lock(ast_manager & m): m(m) { if (m.m_concurrent) m.lock_decls(); }
+        ~decl_lock() { if (m.m_concurrent) m.unlock_decls(); }
+    };
+
     void inc_ref(ast* n) {
         if (n) {
-            n->inc_ref();
+            if (m_concurrent)
+                n->inc_ref_shared();
+            else
+                n->inc_ref();
         }
     }
     
     void dec_ref(ast* n) {
         if (n) {
-            n->dec_ref();
-            if (n->get_ref_count() == 0)
+            if (m_concurrent)
+                n->dec_ref_shared();
+            else
+                n->dec_ref();
+            if (n->get_ref_count() == 0 && !m_arena)
                 delete_node(n);
         }
     }
@@ -1723,12 +1832,19 @@ protected:
 
     void delete_node(ast * n);
 
+    void * allocate_arena_node(unsigned size);
+
+    void deallocate_arena_node(ast * n, unsigned size);
+
     void * allocate_node(unsigned size) {
-        return m_alloc.allocate(size);
+        return m_arena ? allocate_arena_node(size) : m_alloc.allocate(size);
     }
 
     void deallocate_node(ast * n, unsigned sz) {
-        m_alloc.deallocate(sz, n);
+        if (m_arena)
+            deallocate_arena_node(n, sz);
+        else
+            m_alloc.deallocate(sz, n);
     }
 
 public:
@@ -0,0 +1,601 @@
+/*++
+Copyright (c) 2020 Microsoft Corporation
+
+Module Name:
+
+    ast_binary.cpp
+
+Abstract:
+
+    Binary format for expressions.
+
+    The data is a sequence of 32-bit words in the byte order of the writer:
+
+    header:   'Z3ASTBIN' version byte-order #symbols #nodes #roots
+    symbol:   0                              null symbol
+              1 n                            numerical symbol
+              2 len bytes                    string symbol, padded to a word
+    node:     SORT  name family kind params
+              DECL  name family kind flags params arity domain* range
+              APP   decl n arg*
+              VAR   idx sort
+              QUANT kind weight qid skid n (name sort)* body n pattern* n no-pattern*
+    params:   n (kind value)*
+    roots:    node*
+
+    Nodes refer to symbols and to nodes that precede them by index.
+
+--*/
+#include "ast/ast_binary.h"
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#ifndef _WINDOWS
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+    char const     g_magic[8]   = { 'Z', '3', 'A', 'S', 'T', 'B', 'I', 'N' };
+    unsigned const g_version    = 1;
+    unsigned const g_byte_order = 0x01020304;
+
+    enum node_kind {
+        NK_SORT,
+        NK_DECL,
+        NK_APP,
+        NK_VAR,
+        NK_QUANTIFIER
+    };
+
+    enum symbol_kind {
+        SK_NULL,
+        SK_NUMERICAL,
+        SK_STRING
+    };
+
+    class writer {
+        ast_manager &          m;
+        std::ostream &         m_out;
+        obj_map<ast, unsigned> m_node2idx;
+        ptr_vector<ast>        m_nodes;
+        dictionary<unsigned>   m_sym2idx;
+        vector<symbol>         m_symbols;
+        ptr_vector<ast>        m_todo;
+        svector<unsigned>      m_words;
+
+        void flush() {
+            m_out.write(reinterpret_cast<char const *>(m_words.c_ptr()), m_words.size() * sizeof(unsigned));
+            m_words.reset();
+        }
+
+        void push(unsigned w) {
+            m_words.push_back(w);
+            if (m_words.size() >= (1u << 16))
+                flush();
+        }
+
+        void push(std::string const & s) {
+            push(static_cast<unsigned>(s.size()));
+            for (size_t i = 0; i < s.size(); i += sizeof(unsigned)) {
+                unsigned w = 0;
+                memcpy(&w, s.c_str() + i, std::min(sizeof(unsigned), s.size() - i));
+                push(w);
+            }
+        }
+
+        void collect(symbol const & s) {
+            if (!m_sym2idx.contains(s)) {
+                m_sym2idx.insert(s, m_symbols.size());
+                m_symbols.push_back(s);
+            }
+        }
+
+        void check_family(decl * d) {
+            symbol const & name = m.get_family_name(d->get_family_id());
+            if (name == "datatype" || name == "recfun")
+                throw default_exception("binary AST format does not support " + name.str() + " declarations");
+        }
+
+        void get_children(ast * n, ptr_buffer<ast> & children) {
+            if (is_sort(n) || is_func_decl(n)) {
+                decl * d = static_cast<decl *>(n);
+                for (unsigned i = 0; i < d->get_num_parameters(); ++i)
+                    if (d->get_parameter(i).is_ast())
+                        children.push_back(d->get_parameter(i).get_ast());
+                if (is_func_decl(n)) {
+                    for (sort * s : *to_func_decl(n))
+                        children.push_back(s);
+                    children.push_back(to_func_decl(n)->get_range());
+                }
+            }
+            else if (is_app(n)) {
+                children.push_back(to_app(n)->get_decl());
+                for (expr * arg : *to_app(n))
+                    children.push_back(arg);
+            }
+            else if (is_var(n)) {
+                children.push_back(to_var(n)->get_sort());
+            }
+            else {
+                quantifier * q = to_quantifier(n);
+                for (unsigned i = 0; i < q->get_num_decls(); ++i)
+                    children.push_back(q->get_decl_sort(i));
+                for (unsigned i = 0; i < q->get_num_children(); ++i)
+                    children.push_back(q->get_child(i));
+            }
+        }
+
+        void collect_symbols(ast * n) {
+            if (is_sort(n) || is_func_decl(n)) {
+                decl * d = static_cast<decl *>(n);
+                check_family(d);
+                collect(d->get_name());
+                collect(m.get_family_name(d->get_family_id()));
+                for (unsigned i = 0; i < d->get_num_parameters(); ++i) {
+                    parameter const & p = d->get_parameter(i);
+                    if (p.is_symbol())
+                        collect(p.get_symbol());
+                    else if (p.is_external())
+                        throw default_exception("binary AST format does not support theory specific parameters");
+                }
+                if (is_func_decl(n) && to_func_decl(n)->is_lambda())
+                    throw default_exception("binary AST format does not support lambda declarations");
+            }
+            else if (is_quantifier(n)) {
+                quantifier * q = to_quantifier(n);
+                for (unsigned i = 0; i < q->get_num_decls(); ++i)
+                    collect(q->get_decl_name(i));
+                collect(q->get_qid());
+                collect(q->get_skid());
+            }
+        }
+
+        void collect(ast * root) {
+            ptr_buffer<ast> children;
+            m_todo.push_back(root);
+            while (!m_todo.empty()) {
+                ast * n = m_todo.back();
+                if (m_node2idx.contains(n)) {
+                    m_todo.pop_back();
+                    continue;
+                }
+                children.reset();
+                get_children(n, children);
+                bool visited = true;
+                for (ast * c : children) {
+                    if (!m_node2idx.contains(c)) {
+                        m_todo.push_back(c);
+                        visited = false;
+                    }
+                }
+                if (visited) {
+                    m_todo.pop_back();
+                    collect_symbols(n);
+                    m_node2idx.insert(n, m_nodes.size());
+                    m_nodes.push_back(n);
+                }
+            }
+        }
+
+        void write_symbol(symbol const & s) {
+            if (s.is_null())
+                push(SK_NULL);
+            else if (s.is_numerical()) {
+                push(SK_NUMERICAL);
+                push(s.get_num());
+            }
+            else {
+                push(SK_STRING);
+                push(s.str());
+            }
+        }
+
+        void push(symbol const & s) { push(m_sym2idx[s]); }
+
+        void push(ast * n) { push(m_node2idx[n]); }
+
+        void write_header(decl * d) {
+            push(d->get_name());
+            push(m.get_family_name(d->get_family_id()));
+            push(static_cast<unsigned>(d->get_decl_kind()));
+        }
+
+        void write_parameters(decl * d) {
+            push(d->get_num_parameters());
+            for (unsigned i = 0; i < d->get_num_parameters(); ++i) {
+                parameter const & p = d->get_parameter(i);
+                push(p.get_kind());
+                switch (p.get_kind()) {
+                case parameter::PARAM_INT:
+                    push(static_cast<unsigned>(p.get_int()));
+                    break;
+                case parameter::PARAM_AST:
+                    push(p.get_ast());
+                    break;
+                case parameter::PARAM_SYMBOL:
+                    push(p.get_symbol());
+                    break;
+                case parameter::PARAM_RATIONAL:
+                    push(numerator(p.get_rational()).to_string());
+                    push(denominator(p.get_rational()).to_string());
+                    break;
+                case parameter::PARAM_DOUBLE: {
+                    double d = p.get_double();
+                    unsigned ws[2];
+                    memcpy(ws, &d, sizeof(d));
+                    push(ws[0]);
+                    push(ws[1]);
+                    break;
+                }
+                default:
+                    UNREACHABLE();
+                }
+            }
+        }
+
+        void write_node(ast * n) {
+            switch (n->get_kind()) {
+            case AST_SORT:
+                push(NK_SORT);
+                write_header(to_sort(n));
+                write_parameters(to_sort(n));
+                break;
+            case AST_FUNC_DECL: {
+                func_decl * f = to_func_decl(n);
+                push(NK_DECL);
+                write_header(f);
+                push(f->is_skolem() ? 1u : 0u);
+                write_parameters(f);
+                push(f->get_arity());
+                for (sort * s : *f)
+                    push(s);
+                push(f->get_range());
+                break;
+            }
+            case AST_APP:
+                push(NK_APP);
+                push(to_app(n)->get_decl());
+                push(to_app(n)->get_num_args());
+                for (expr * arg : *to_app(n))
+                    push(arg);
+                break;
+            case AST_VAR:
+                push(NK_VAR);
+                push(to_var(n)->get_idx());
+                push(to_var(n)->get_sort());
+                break;
+            case AST_QUANTIFIER: {
+                quantifier * q = to_quantifier(n);
+                push(NK_QUANTIFIER);
+                push(q->get_kind());
+                push(static_cast<unsigned>(q->get_weight()));
+                push(q->get_qid());
+                push(q->get_skid());
+                push(q->get_num_decls());
+                for (unsigned i = 0; i < q->get_num_decls(); ++i) {
+                    push(q->get_decl_name(i));
+                    push(q->get_decl_sort(i));
+                }
+                push(q->get_expr());
+                push(q->get_num_patterns());
+                for (unsigned i = 0; i < q->get_num_patterns(); ++i)
+                    push(q->get_pattern(i));
+                push(q->get_num_no_patterns());
+                for (unsigned i = 0; i < q->get_num_no_patterns(); ++i)
+                    push(q->get_no_pattern(i));
+                break;
+            }
+            default:
+                UNREACHABLE();
+            }
+        }
+
+    public:
+        writer(ast_manager & m, std::ostream & out): m(m), m_out(out) {}
+
+        void operator()(unsigned n, expr * const * es) {
+            for (unsigned i = 0; i < n; ++i)
+                collect(es[i]);
+            unsigned magic[2];
+            memcpy(magic, g_magic, sizeof(g_magic));
+            push(magic[0]);
+            push(magic[1]);
+            push(g_version);
+            push(g_byte_order);
+            push(m_symbols.size());
+            push(m_nodes.size());
+            push(n);
+            for (symbol const & s : m_symbols)
+                write_symbol(s);
+            for (ast * a : m_nodes)
+                write_node(a);
+            for (unsigned i = 0; i < n; ++i)
+                push(es[i]);
+            flush();
+        }
+    };
+
+    class reader {
+        ast_manager &  m;
+        char const *   m_data;
+        size_t         m_size; // in words
+        size_t         m_pos;
+        vector<symbol> m_symbols;
+        ast_ref_vector m_nodes;
+
+        [[noreturn]] void fail(char const * msg) {
+            throw default_exception(std::string("invalid binary AST data: ") + msg);
+        }
+
+        unsigned word() {
+            if (m_pos >= m_size)
+                fail("unexpected end of data");
+            unsigned w;
+            memcpy(&w, m_data + m_pos * sizeof(unsigned), sizeof(unsigned));
+            ++m_pos;
+            return w;
+        }
+
+        std::string read_string() {
+            unsigned len = word();
+            size_t num_words = (static_cast<size_t>(len) + sizeof(unsigned) - 1) / sizeof(unsigned);
+            if (num_words > m_size - m_pos)
+                fail("unexpected end of data");
+            std::string s(m_data + m_pos * sizeof(unsigned), len);
+            m_pos += num_words;
+            return s;
+        }
+
+        symbol read_symbol() {
+            unsigned idx = word();
+            if (idx >= m_symbols.size())
+                fail("symbol index out of range");
+            return m_symbols[idx];
+        }
+
+        ast * read_node() {
+            unsigned idx = word();
+            if (idx >= m_nodes.size())
+                fail("node index out of range");
+            return m_nodes.get(idx);
+        }
+
+        sort * read_sort() {
+            ast * n = read_node();
+            if (!is_sort(n))
+                fail("sort expected");
+            return to_sort(n);
+        }
+
+        expr * read_expr() {
+            ast * n = read_node();
+            if (!is_expr(n))
+                fail("expression expected");
+            return to_expr(n);
+        }
+
+        void read_symbols(unsigned n) {
+            for (unsigned i = 0; i < n; ++i) {
+                switch (word()) {
+                case SK_NULL:
+                    m_symbols.push_back(symbol::null);
+                    break;
+                case SK_NUMERICAL:
+                    m_symbols.push_back(symbol(word()));
+                    break;
+                case SK_STRING:
+                    m_symbols.push_back(symbol(read_string().c_str()));
+                    break;
+                default:
+                    fail("unknown symbol kind");
+                }
+            }
+        }
+
+        family_id read_family() {
+            symbol name = read_symbol();
+            if (name.is_null())
+                return null_family_id;
+            family_id fid = m.get_family_id(name);
+            if (fid == null_family_id || !m.has_plugin(fid))
+                throw default_exception("binary AST data uses unknown theory " + name.str());
+            return fid;
+        }
+
+        void read_parameters(vector<parameter> & params) {
+            unsigned n = word();
+            for (unsigned i = 0; i < n; ++i) {
+                switch (word()) {
+                case parameter::PARAM_INT:
+                    params.push_back(parameter(static_cast<int>(word())));
+                    break;
+                case parameter::PARAM_AST:
+                    params.push_back(parameter(read_node()));
+                    break;
+                case parameter::PARAM_SYMBOL:
+                    params.push_back(parameter(read_symbol()));
+                    break;
+                case parameter::PARAM_RATIONAL: {
+                    rational num(read_string().c_str());
+                    rational den(read_string().c_str());
+                    if (den.is_zero())
+                        fail("zero denominator");
+                    params.push_back(parameter(num / den));
+                    break;
+                }
+                case parameter::PARAM_DOUBLE: {
+                    unsigned ws[2] = { word(), word() };
+                    double d;
+                    memcpy(&d, ws, sizeof(d));
+                    params.push_back(parameter(d));
+                    break;
+                }
+                default:
+                    fail("unsupported parameter kind");
+                }
+            }
+        }
+
+        ast * read_sort_node() {
+            symbol name = read_symbol();
+            family_id fid = read_family();
+            decl_kind k = static_cast<decl_kind>(word());
+            vector<parameter> params;
+            read_parameters(params);
+            if (fid == null_family_id)
+                return m.mk_uninterpreted_sort(name, params.size(), params.c_ptr());
+            return m.mk_sort(fid, k, params.size(), params.c_ptr());
+        }
+
+        ast * read_decl_node() {
+            symbol name = read_symbol();
+            family_id fid = read_family();
+            decl_kind k = static_cast<decl_kind>(word());
+            bool skolem = word() != 0;
+            vector<parameter> params;
+            read_parameters(params);
+            unsigned arity = word();
+            ptr_buffer<sort> domain;
+            for (unsigned i = 0; i < arity; ++i)
+                domain.push_back(read_sort());
+            sort * range = read_sort();
+            if (fid != null_family_id)
+                return m.mk_func_decl(fid, k, params.size(), params.c_ptr(), arity, domain.c_ptr(), range);
+            func_decl_info info;
+            info.set_skolem(skolem);
+            return m.mk_func_decl(name, arity, domain.c_ptr(), range, info);
+        }
+
+        ast * read_app_node() {
+            ast * f = read_node();
+            if (!is_func_decl(f))
+                fail("declaration expected");
+            unsigned n = word();
+            ptr_buffer<expr> args;
+            for (unsigned i = 0; i < n; ++i)
+                args.push_back(read_expr());
+            return m.mk_app(to_func_decl(f), n, args.c_ptr());
+        }
+
+        ast * read_quantifier_node() {
+            unsigned k = word();
+            if (k > lambda_k)
+                fail("unknown quantifier kind");
+            int weight = static_cast<int>(word());
+            symbol qid = read_symbol();
+            symbol skid = read_symbol();
+            unsigned n = word();
+            buffer<symbol> names;
+            ptr_buffer<sort> sorts;
+            for (unsigned i = 0; i < n; ++i) {
+                names.push_back(read_symbol());
+                sorts.push_back(read_sort());
+            }
+            expr * body = read_expr();
+            ptr_buffer<expr> patterns, no_patterns;
+            unsigned num_patterns = word();
+            for (unsigned i = 0; i < num_patterns; ++i)
+                patterns.push_back(read_expr());
+            unsigned num_no_patterns = word();
+            for (unsigned i = 0; i < num_no_patterns; ++i)
+                no_patterns.push_back(read_expr());
+            if (k == lambda_k)
+                return m.mk_lambda(n, sorts.c_ptr(), names.c_ptr(), body);
+            return m.mk_quantifier(static_cast<quantifier_kind>(k), n, sorts.c_ptr(), names.c_ptr(), body, weight, qid, skid,
+                                   num_patterns, patterns.c_ptr(), num_no_patterns, no_patterns.c_ptr());
+        }
+
+        ast * read_var_node() {
+            unsigned idx = word();
+            return m.mk_var(idx, read_sort());
+        }
+
+    public:
+        reader(ast_manager & m, char const * data, size_t size):
+            m(m),
+            m_data(data),
+            m_size(size / sizeof(unsigned)),
+            m_pos(0),
+            m_nodes(m) {
+            if (size % sizeof(unsigned) != 0)
+                fail("size is not a multiple of the word size");
+        }
+
+        void operator()(expr_ref_vector & result) {
+            unsigned magic[2] = { word(), word() };
+            if (memcmp(magic, g_magic, sizeof(g_magic)) != 0)
+                fail("wrong magic number");
+            if (word() != g_version)
+                fail("unsupported version");
+            if (word() != g_byte_order)
+                fail("unsupported byte order");
+            unsigned num_symbols = word();
+            unsigned num_nodes = word();
+            unsigned num_roots = word();
+            read_symbols(num_symbols);
+            for (unsigned i = 0; i < num_nodes; ++i) {
+                ast * n = nullptr;
+                switch (word()) {
+                case NK_SORT:       n = read_sort_node(); break;
+                case NK_DECL:       n = read_decl_node(); break;
+                case NK_APP:        n = read_app_node(); break;
+                case NK_VAR:        n = read_var_node(); break;
+                case NK_QUANTIFIER: n = read_quantifier_node(); break;
+                default:            fail("unknown node kind");
+                }
+                if (!n)
+                    fail("the node could not be created");
+                m_nodes.push_back(n);
+            }
+            for (unsigned i = 0; i < num_roots; ++i)
+                result.push_back(read_expr());
+        }
+    };
+}
+
+void ast_binary_write(ast_manager & m, std::ostream & out, unsigned n, expr * const * es) {
+    writer w(m, out);
+    w(n, es);
+}
+
+void ast_binary_read(ast_manager & m, char const * data, size_t size, expr_ref_vector & result) {
+    reader r(m, data, size);
+    r(result);
+}
+
+void ast_binary_read_file(ast_manager & m, char const * file_name, expr_ref_vector & result) {
+#ifndef _WINDOWS
+    int fd = open(file_name, O_RDONLY);
+    if (fd >= 0) {
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            size_t size = static_cast<size_t>(st.st_size);
+            void * data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            close(fd);
+            if (data != MAP_FAILED) {
+                try {
+                    ast_binary_read(m, static_cast<char const *>(data), size, result);
+                }
+                catch (...) {
+                    munmap(data, size);
+                    throw;
+                }
+                munmap(data, size);
+                return;
+            }
+        }
+        else {
+            close(fd);
+        }
+    }
+#endif
+    std::ifstream in(file_name, std::ios::binary);
+    if (!in)
+        throw default_exception(std::string("could not open file ") + file_name);
+    std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    ast_binary_read(m, data.c_str(), data.size(), result);
+}
@@ -0,0 +1,42 @@
+/*++
+Copyright (c) 2020 Microsoft Corporation
+
+Module Name:
+
+    ast_binary.h
+
+Abstract:
+
+    Binary format for expressions.
+
+    A file stores a symbol table, a table of sorts, declarations and
+    expressions in topological order, and the indices of the stored
+    expressions. Shared nodes are stored once. Loading rebuilds each
+    node once through the manager, so the input does not need to be
+    parsed and type checked.
+
+    Datatypes, recursive functions and theory specific parameters
+    (floating point and algebraic numerals) are not supported.
+
+--*/
+#pragma once
+
+#include "ast/ast.h"
+#include <ostream>
+
+/**
+   \brief Write \c es and the sorts, declarations and symbols they use to \c out.
+*/
+void ast_binary_write(ast_manager & m, std::ostream & out, unsigned n, expr * const * es);
+
+/**
+   \brief Rebuild the expressions stored in the \c size bytes at \c data.
+   Throw default_exception if \c data is not in the binary format.
+*/
+void ast_binary_read(ast_manager & m, char const * data, size_t size, expr_ref_vector & result);
+
+/**
+   \brief Rebuild the expressions stored in \c file_name.
+   The file is mapped into memory when the platform supports it.
+*/
+void ast_binary_read_file(ast_manager & m, char const * file_name, expr_ref_vector & result);
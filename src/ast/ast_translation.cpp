@@ -25,6 +25,47 @@ Revision History:
 #include "ast/ast_ll_pp.h"
 #include "ast/ast_pp.h"
 
+void ast_translation_cache::insert(obj_map<ast, ast*> & map, ast_manager & from, ast_manager & to, ast * s, ast * t) {
+    if (map.contains(s))
+        return;
+    from.inc_ref(s);
+    to.inc_ref(t);
+    map.insert(s, t);
+}
+
+void ast_translation_cache::insert(ast_manager & from, ast * s, ast * t) {
+    ast_manager & to = &from == &m1 ? m2 : m1;
+    insert(get_map(from), from, to, s, t);
+    insert(get_map(to), to, from, t, s);
+}
+
+void ast_translation_cache::reset() {
+    for (auto & kv : m_1to2) {
+        m1.dec_ref(kv.m_key);
+        m2.dec_ref(kv.m_value);
+    }
+    for (auto & kv : m_2to1) {
+        m2.dec_ref(kv.m_key);
+        m1.dec_ref(kv.m_value);
+    }
+    m_1to2.reset();
+    m_2to1.reset();
+}
+
+void ast_translation::init(bool copy_plugins) {
+    m_pin_source = true;
+    m_loop_count = 0;
+    m_hit_count = 0;
+    m_miss_count = 0;
+    m_insert_count = 0;
+    m_num_process = 0;
+    if (&m_from_manager != &m_to_manager) {
+        if (copy_plugins)
+            m_to_manager.copy_families_plugins(m_from_manager);
+        m_to_manager.update_fresh_id(m_from_manager);
+    }
+}
+
 ast_translation::~ast_translation() {
     reset_cache();
 }
@@ -39,22 +80,35 @@ void ast_translation::cleanup() {
 
 void ast_translation::reset_cache() {
     for (auto & kv : m_cache) {
-        m_from_manager.dec_ref(kv.m_key);
+        if (m_pin_source)
+            m_from_manager.dec_ref(kv.m_key);
         m_to_manager.dec_ref(kv.m_value);
     }
     m_cache.reset();
 }
 
 void ast_translation::cache(ast * s, ast * t) {
-    SASSERT(!m_cache.contains(s));
     if (s->get_ref_count() > 1) {
-        m_from_manager.inc_ref(s);
-        m_to_manager.inc_ref(t);
-        m_cache.insert(s, t);
+        if (m_shared_cache) {
+            m_shared_cache->insert(m_from_manager, s, t);
+        }
+        else {
+            SASSERT(!m_cache.contains(s));
+            if (m_pin_source)
+                m_from_manager.inc_ref(s);
+            m_to_manager.inc_ref(t);
+            m_cache.insert(s, t);
+        }
         ++m_insert_count;
     }
 }
 
+bool ast_translation::find_cached(ast * n, ast * & r) {
+    if (m_shared_cache)
+        return m_shared_cache->get_map(m_from_manager).find(n, r);
+    return m_cache.find(n, r);
+}
+
 void ast_translation::collect_decl_extra_children(decl * d) {
     unsigned num_params = d->get_num_parameters();
     for (unsigned i = 0; i < num_params; i++) {
@@ -79,7 +133,7 @@ void ast_translation::push_frame(ast * n) {
 bool ast_translation::visit(ast * n) {        
     if (n->get_ref_count() > 1) {
         ast * r;
-        if (m_cache.find(n, r)) {
+        if (find_cached(n, r)) {
             m_result_stack.push_back(r);
             ++m_hit_count;
             return true;
@@ -200,6 +254,8 @@ ast * ast_translation::process(ast const * _n) {
         reset_cache();
         m_num_process = 0;
     }
+    if (m_shared_cache && m_shared_cache->size() > m_shared_cache->m_max_size)
+        m_shared_cache->reset();
     if (!visit(const_cast<ast*>(_n))) {
         while (!m_frame_stack.empty()) {
         loop:
@@ -209,7 +265,7 @@ ast * ast_translation::process(ast const * _n) {
             ast * r;         
             TRACE("ast_translation", tout << mk_ll_pp(n, m_from_manager, false) << "\n";);
             if (fr.m_idx == 0 && n->get_ref_count() > 1) {
-                if (m_cache.find(n, r)) {
+                if (find_cached(n, r)) {
                     SASSERT(m_result_stack.size() == fr.m_rpos);
                     m_result_stack.push_back(r);
                     m_extra_children_stack.shrink(fr.m_cpos);
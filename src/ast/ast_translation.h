@@ -23,6 +23,31 @@ Revision History:
 
 #include "ast/ast.h"
 
+/**
+   \brief Cache of translations between two managers that persists across
+   translations in both directions. A pair (s, t) recorded by a
+   translation from s's manager is also used to translate t back to s.
+*/
+class ast_translation_cache {
+    friend class ast_translation;
+    ast_manager &      m1;
+    ast_manager &      m2;
+    obj_map<ast, ast*> m_1to2;
+    obj_map<ast, ast*> m_2to1;
+    unsigned           m_max_size;
+
+    obj_map<ast, ast*> & get_map(ast_manager & from) { return &from == &m1 ? m_1to2 : m_2to1; }
+    void insert(obj_map<ast, ast*> & map, ast_manager & from, ast_manager & to, ast * s, ast * t);
+    void insert(ast_manager & from, ast * s, ast * t);
+
+public:
+    ast_translation_cache(ast_manager & m1, ast_manager & m2, unsigned max_size = (1 << 20)):
+        m1(m1), m2(m2), m_max_size(max_size) {}
+    ~ast_translation_cache() { reset(); }
+    void reset();
+    unsigned size() const { return m_1to2.size() + m_2to1.size(); }
+};
+
 class ast_translation {
     struct frame {
         ast *    m_n;
@@ -37,6 +62,8 @@ class ast_translation {
     ptr_vector<ast>     m_extra_children_stack; // for sort and func_decl, since they have nested AST in their parameters
     ptr_vector<ast>     m_result_stack; 
     obj_map<ast, ast*>  m_cache;
+    ast_translation_cache * m_shared_cache;
+    bool                m_pin_source;
     unsigned            m_loop_count;
     unsigned            m_hit_count;
     unsigned            m_miss_count;
@@ -44,6 +71,8 @@ class ast_translation {
     unsigned            m_num_process;
 
     void cache(ast * s, ast * t);
+    bool find_cached(ast * n, ast * & r);
+    void init(bool copy_plugins);
     void collect_decl_extra_children(decl * d);
     void push_frame(ast * n);
     bool visit(ast * n);
@@ -54,21 +83,34 @@ class ast_translation {
     ast * process(ast const * n);
 
 public:
-    ast_translation(ast_manager & from, ast_manager & to, bool copy_plugins = true) : m_from_manager(from), m_to_manager(to) {
-        m_loop_count = 0;
-        m_hit_count = 0;
-        m_miss_count = 0;
-        m_insert_count = 0;
-        m_num_process = 0;
-        if (&from != &to) {
-            if (copy_plugins)
-                m_to_manager.copy_families_plugins(m_from_manager);
-            m_to_manager.update_fresh_id(m_from_manager);
-        }
+    ast_translation(ast_manager & from, ast_manager & to, bool copy_plugins = true) :
+        m_from_manager(from), m_to_manager(to), m_shared_cache(nullptr) {
+        init(copy_plugins);
+    }
+
+    /**
+       \brief Translation that records its results in a cache that is
+       kept between translations of the same pair of managers.
+    */
+    ast_translation(ast_translation_cache & c, ast_manager & from, ast_manager & to, bool copy_plugins = true) :
+        m_from_manager(from), m_to_manager(to), m_shared_cache(&c) {
+        SASSERT((&from == &c.m1 && &to == &c.m2) || (&from == &c.m2 && &to == &c.m1));
+        init(copy_plugins);
     }
 
     ~ast_translation();
 
+    /**
+       \brief Do not take references to nodes of the source manager. The
+       caller keeps the translated terms alive while the translation object
+       is used. The source manager is then only read, and several
+       translations out of it can run in parallel.
+    */
+    void set_read_only_source() {
+        SASSERT(!m_shared_cache);
+        m_pin_source = false;
+    }
+
     template<typename T>
     T * operator()(T const * n) { 
         return translate(n);
@@ -17,6 +17,7 @@ Notes:
 
 --*/
 #include<math.h>
+#include<algorithm>
 
 #include "ast/ast_smt2_pp.h"
 #include "ast/well_sorted.h"
@@ -40,6 +41,8 @@ fpa2bv_converter::fpa2bv_converter(ast_manager & m) :
     m_mpf_manager(m_util.fm()),
     m_mpz_manager(m_mpf_manager.mpz_manager()),
     m_hi_fp_unspecified(true),
+    m_use_templates(true),
+    m_in_template(false),
     m_extra_assertions(m) {
     m_plugin = static_cast<fpa_decl_plugin*>(m.get_plugin(m.mk_family_id("fpa")));
 }
@@ -541,6 +544,8 @@ void fpa2bv_converter::add_core(unsigned sbits, unsigned ebits,
 void fpa2bv_converter::mk_add(func_decl * f, unsigned num, expr * const * args, expr_ref & result) {
     SASSERT(num == 3);
     SASSERT(m_util.is_bv2rm(args[0]));
+    if (mk_from_template(&fpa2bv_converter::mk_add, f, num, args, result))
+        return;
 
     expr_ref rm(m), x(m), y(m);
     rm = to_app(args[0])->get_arg(0);
@@ -711,6 +716,8 @@ void fpa2bv_converter::mk_neg(sort * srt, expr_ref & x, expr_ref & result) {
 void fpa2bv_converter::mk_mul(func_decl * f, unsigned num, expr * const * args, expr_ref & result) {
     SASSERT(num == 3);
     SASSERT(m_util.is_bv2rm(args[0]));
+    if (mk_from_template(&fpa2bv_converter::mk_mul, f, num, args, result))
+        return;
 
     expr_ref rm(m), x(m), y(m);
     rm = to_app(args[0])->get_arg(0);
@@ -861,6 +868,8 @@ void fpa2bv_converter::mk_mul(sort * s, expr_ref & rm, expr_ref & x, expr_ref &
 void fpa2bv_converter::mk_div(func_decl * f, unsigned num, expr * const * args, expr_ref & result) {
     SASSERT(num == 3);
     SASSERT(m_util.is_bv2rm(args[0]));
+    if (mk_from_template(&fpa2bv_converter::mk_div, f, num, args, result))
+        return;
     expr_ref rm(m), x(m), y(m);
     rm = to_app(args[0])->get_arg(0);
     x = args[1];
@@ -1374,6 +1383,8 @@ expr_ref fpa2bv_converter::mk_min_max_unspecified(func_decl * f, expr * x, expr
 void fpa2bv_converter::mk_fma(func_decl * f, unsigned num, expr * const * args, expr_ref & result) {
     SASSERT(num == 4);
     SASSERT(m_util.is_bv2rm(args[0]));
+    if (mk_from_template(&fpa2bv_converter::mk_fma, f, num, args, result))
+        return;
 
     // fusedma means (x * y) + z
     expr_ref rm(m), x(m), y(m), z(m);
@@ -1478,7 +1489,7 @@ void fpa2bv_converter::mk_fma(func_decl * f, unsigned num, expr * const * args,
 
     expr_ref zero_cond(m), rm_is_not_to_neg(m);
     rm_is_not_to_neg = m.mk_not(rm_is_to_neg);
-    m_simp.mk_ite(rm_is_to_neg, nzero, pzero, zero_cond);
+    mk_ite(rm_is_to_neg, nzero, pzero, zero_cond);
     mk_ite(c71, zero_cond, z, v7);
 
     // else comes the fused multiplication.
@@ -1769,6 +1780,8 @@ void fpa2bv_converter::mk_fma(func_decl * f, unsigned num, expr * const * args,
 void fpa2bv_converter::mk_sqrt(func_decl * f, unsigned num, expr * const * args, expr_ref & result) {
     SASSERT(num == 2);
     SASSERT(m_util.is_bv2rm(args[0]));
+    if (mk_from_template(&fpa2bv_converter::mk_sqrt, f, num, args, result))
+        return;
 
     expr_ref rm(m), x(m);
     rm = to_app(args[0])->get_arg(0);
@@ -4207,11 +4220,77 @@ void fpa2bv_converter::reset() {
         m.dec_ref(kv.m_value.first);
         m.dec_ref(kv.m_value.second);
     }
+    for (templates_t & t : m_templates) {
+        dec_ref_map_key_values(m, t);
+        t.reset();
+    }
     m_uf2bvuf.reset();
     m_min_max_ufs.reset();
     m_extra_assertions.reset();
 }
 
+/**
+   \brief Translate f(rm, x, ...) by instantiating a circuit for f over variables.
+
+   The circuit is built once per function declaration (i.e., per operation and format)
+   and rounding mode; symbolic rounding modes share one circuit. Arguments with numeral
+   components are translated directly so that the circuit is simplified.
+*/
+bool fpa2bv_converter::mk_from_template(mk_circuit_t mk, func_decl * f, unsigned num, expr * const * args, expr_ref & result) {
+    if (!m_use_templates || m_in_template)
+        return false;
+    SASSERT(num > 1 && m_util.is_bv2rm(args[0]));
+    expr * rm = to_app(args[0])->get_arg(0);
+    ptr_vector<expr> subst;
+    for (unsigned i = 1; i < num; i++) {
+        if (!m_util.is_fp(args[i]))
+            return false;
+        for (expr * c : *to_app(args[i])) {
+            if (m_bv_util.is_numeral(c))
+                return false;
+            subst.push_back(c);
+        }
+    }
+    rational rm_val;
+    unsigned sz;
+    unsigned idx = BV_RM_TO_ZERO + 1;
+    if (m_bv_util.is_numeral(rm, rm_val, sz) && rm_val.get_unsigned() <= BV_RM_TO_ZERO)
+        idx = rm_val.get_unsigned();
+    else
+        subst.push_back(rm);
+
+    expr * tmpl = nullptr;
+    if (!m_templates[idx].find(f, tmpl)) {
+        ptr_vector<expr> vars;
+        expr_ref_vector pinned(m);
+        unsigned j = 0;
+        for (unsigned i = 1; i < num; i++) {
+            app * x = to_app(args[i]);
+            expr * sgn = m.mk_var(j++, m.get_sort(x->get_arg(0)));
+            expr * exp = m.mk_var(j++, m.get_sort(x->get_arg(1)));
+            expr * sig = m.mk_var(j++, m.get_sort(x->get_arg(2)));
+            vars.push_back(m_util.mk_fp(sgn, exp, sig));
+            pinned.push_back(vars.back());
+        }
+        expr * rm_var = idx <= BV_RM_TO_ZERO ? rm : m.mk_var(j, m.get_sort(rm));
+        vars.push_back(m_util.mk_bv2rm(rm_var));
+        pinned.push_back(vars.back());
+        // the rounding mode is the first argument
+        std::rotate(vars.begin(), vars.end() - 1, vars.end());
+        expr_ref r(m);
+        flet<bool> _in_template(m_in_template, true);
+        (this->*mk)(f, num, vars.c_ptr(), r);
+        tmpl = r;
+        m.inc_ref(f);
+        m.inc_ref(tmpl);
+        m_templates[idx].insert(f, tmpl);
+        TRACE("fpa2bv", tout << "template for " << f->get_name() << " rm " << idx << ":\n" << mk_ismt2_pp(tmpl, m) << "\n";);
+    }
+    var_subst vs(m, false);
+    result = vs(tmpl, subst);
+    return true;
+}
+
 func_decl * fpa2bv_converter::mk_bv_uf(func_decl * f, sort * const * domain, sort * range) {
     func_decl* res;
     if (!m_uf2bvuf.find(f, res)) {
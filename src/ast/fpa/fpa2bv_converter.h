@@ -36,6 +36,7 @@ public:
     typedef obj_map<func_decl, std::pair<app *, app *> > special_t;
     typedef obj_map<func_decl, expr*> const2bv_t;
     typedef obj_map<func_decl, func_decl*> uf2bvuf_t;
+    typedef obj_map<func_decl, expr*> templates_t;
 
 protected:
     ast_manager              & m;
@@ -54,6 +55,10 @@ protected:
     const2bv_t                 m_rm_const2bv;
     uf2bvuf_t                  m_uf2bvuf;
     special_t                  m_min_max_ufs;
+    // circuit templates indexed by rounding mode, the last entry is for symbolic rounding modes
+    templates_t                m_templates[BV_RM_TO_ZERO + 2];
+    bool                       m_use_templates;
+    bool                       m_in_template;
 
     friend class fpa2bv_model_converter;
     friend class bv2fpa_converter;
@@ -88,6 +93,11 @@ public:
     virtual void mk_const(func_decl * f, expr_ref & result);
     virtual void mk_rm_const(func_decl * f, expr_ref & result);
     virtual void mk_uf(func_decl * f, unsigned num, expr * const * args, expr_ref & result);
+    /**
+       \brief Return a translation of e to use instead of translating e and its arguments,
+       or nullptr. Clients use it to abstract expensive operations and own the result.
+    */
+    virtual expr * get_abstraction(expr * e) { return nullptr; }
     void mk_var(unsigned base_inx, sort * srt, expr_ref & result);
 
     void mk_pinf(func_decl * f, expr_ref & result);
@@ -145,6 +155,7 @@ public:
     void mk_to_real_unspecified(func_decl * f, unsigned num, expr * const * args, expr_ref & result);
 
     void set_unspecified_fp_hi(bool v) { m_hi_fp_unspecified = v; }
+    void set_circuit_templates(bool v) { m_use_templates = v; }
 
     void mk_min(func_decl * f, unsigned num, expr * const * args, expr_ref & result);
     void mk_max(func_decl * f, unsigned num, expr * const * args, expr_ref & result);
@@ -197,6 +208,9 @@ protected:
 
     app * mk_fresh_const(char const * prefix, unsigned sz);
 
+    typedef void (fpa2bv_converter::*mk_circuit_t)(func_decl * f, unsigned num, expr * const * args, expr_ref & result);
+    bool mk_from_template(mk_circuit_t mk, func_decl * f, unsigned num, expr * const * args, expr_ref & result);
+
     void mk_to_bv(func_decl * f, unsigned num, expr * const * args, bool is_signed, expr_ref & result);
 
 private:
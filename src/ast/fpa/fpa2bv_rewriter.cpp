@@ -40,6 +40,7 @@ void fpa2bv_rewriter_cfg::updt_local_params(params_ref const & _p) {
     fpa2bv_rewriter_params p(_p);
     bool v = p.hi_fp_unspecified();
     m_conv.set_unspecified_fp_hi(v);
+    m_conv.set_circuit_templates(p.fpa2bv_templates());
 }
 
 void fpa2bv_rewriter_cfg::updt_params(params_ref const & p) {
@@ -169,6 +170,12 @@ br_status fpa2bv_rewriter_cfg::reduce_app(func_decl * f, unsigned num, expr * co
     return BR_FAILED;
 }
 
+bool fpa2bv_rewriter_cfg::get_subst(expr * s, expr * & t, proof * & t_pr) {
+    t = m_conv.get_abstraction(s);
+    t_pr = nullptr;
+    return t != nullptr;
+}
+
 bool fpa2bv_rewriter_cfg::pre_visit(expr * t)
 {
     TRACE("fpa2bv", tout << "pre_visit: " << mk_ismt2_pp(t, m()) << std::endl;);
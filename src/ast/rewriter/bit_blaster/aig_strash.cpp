@@ -0,0 +1,208 @@
+/*++
+Copyright (c) 2020 Microsoft Corporation
+
+Module Name:
+
+    aig_strash.cpp
+
+Abstract:
+
+    Structural hashing of and-inverter gates for the bit-blaster.
+
+--*/
+
+#include "ast/rewriter/bit_blaster/aig_strash.h"
+
+/**
+   \brief strip negations from e and return the literal of e.
+*/
+unsigned aig_strash::to_lit(expr*& e) const {
+    unsigned sign = 0;
+    while (m.is_not(e, e))
+        sign ^= 1;
+    return (e->get_id() << 1) | sign;
+}
+
+/**
+   \brief the negation created for a complemented input is kept alive by the gate using it.
+*/
+expr* aig_strash::from_lit(expr* e, unsigned lit) {
+    return (lit & 1) ? m.mk_not(e) : e;
+}
+
+void aig_strash::insert(bool is_iff, uint64_t k, expr* g) {
+    m_pinned.push_back(g);
+    (is_iff ? m_iff : m_and).insert(k, g);
+    m_trail.push_back(std::make_pair(is_iff, k));
+}
+
+void aig_strash::mk_not(expr* a, expr_ref& r) {
+    expr* e = nullptr;
+    if (m.is_true(a))
+        r = m.mk_false();
+    else if (m.is_false(a))
+        r = m.mk_true();
+    else if (m.is_not(a, e))
+        r = e;
+    else
+        r = m.mk_not(a);
+}
+
+void aig_strash::mk_and(expr* a, expr* b, expr_ref& r) {
+    if (m.is_false(a) || m.is_false(b)) {
+        r = m.mk_false();
+        return;
+    }
+    if (m.is_true(a)) {
+        r = b;
+        return;
+    }
+    if (m.is_true(b)) {
+        r = a;
+        return;
+    }
+    expr* e1 = a, *e2 = b;
+    unsigned l1 = to_lit(e1), l2 = to_lit(e2);
+    if (l1 == l2) {
+        r = a;
+        return;
+    }
+    if ((l1 ^ 1) == l2) {
+        r = m.mk_false();
+        return;
+    }
+    if (l1 > l2) {
+        std::swap(l1, l2);
+        std::swap(e1, e2);
+    }
+    expr* g = nullptr;
+    if (m_and.find(key(l1, l2), g)) {
+        ++m_hits;
+        r = g;
+        return;
+    }
+    ++m_misses;
+    r = m.mk_and(from_lit(e1, l1), from_lit(e2, l2));
+    insert(false, key(l1, l2), r);
+}
+
+void aig_strash::mk_and(unsigned sz, expr* const* args, expr_ref& r) {
+    expr_ref tmp(m.mk_true(), m);
+    for (unsigned i = 0; i < sz; ++i) {
+        mk_and(tmp, args[i], r);
+        tmp = r;
+    }
+    r = tmp;
+}
+
+void aig_strash::mk_or(expr* a, expr* b, expr_ref& r) {
+    expr_ref na(m), nb(m), t(m);
+    mk_not(a, na);
+    mk_not(b, nb);
+    mk_and(na, nb, t);
+    mk_not(t, r);
+}
+
+void aig_strash::mk_or(unsigned sz, expr* const* args, expr_ref& r) {
+    expr_ref tmp(m.mk_false(), m);
+    for (unsigned i = 0; i < sz; ++i) {
+        mk_or(tmp, args[i], r);
+        tmp = r;
+    }
+    r = tmp;
+}
+
+void aig_strash::mk_iff(expr* a, expr* b, expr_ref& r) {
+    if (m.is_true(a)) {
+        r = b;
+        return;
+    }
+    if (m.is_true(b)) {
+        r = a;
+        return;
+    }
+    if (m.is_false(a)) {
+        mk_not(b, r);
+        return;
+    }
+    if (m.is_false(b)) {
+        mk_not(a, r);
+        return;
+    }
+    expr* e1 = a, *e2 = b;
+    unsigned l1 = to_lit(e1), l2 = to_lit(e2);
+    bool sign = ((l1 ^ l2) & 1) != 0;
+    l1 &= ~1u;
+    l2 &= ~1u;
+    if (l1 == l2) {
+        r = sign ? m.mk_false() : m.mk_true();
+        return;
+    }
+    if (l1 > l2) {
+        std::swap(l1, l2);
+        std::swap(e1, e2);
+    }
+    expr* g = nullptr;
+    if (m_iff.find(key(l1, l2), g)) {
+        ++m_hits;
+    }
+    else {
+        ++m_misses;
+        g = m.mk_eq(e1, e2);
+        insert(true, key(l1, l2), g);
+    }
+    if (sign)
+        mk_not(g, r);
+    else
+        r = g;
+}
+
+void aig_strash::mk_xor(expr* a, expr* b, expr_ref& r) {
+    expr_ref t(m);
+    mk_iff(a, b, t);
+    mk_not(t, r);
+}
+
+void aig_strash::mk_nand(expr* a, expr* b, expr_ref& r) {
+    expr_ref t(m);
+    mk_and(a, b, t);
+    mk_not(t, r);
+}
+
+void aig_strash::mk_nor(expr* a, expr* b, expr_ref& r) {
+    expr_ref t(m);
+    mk_or(a, b, t);
+    mk_not(t, r);
+}
+
+void aig_strash::push() {
+    m_trail_lim.push_back(m_trail.size());
+}
+
+/**
+   \brief remove the gates created since the matching push.
+   The pinned gates are in the same order as the trail.
+*/
+void aig_strash::pop(unsigned num_scopes) {
+    SASSERT(num_scopes <= m_trail_lim.size());
+    if (num_scopes == 0)
+        return;
+    unsigned old_sz = m_trail_lim[m_trail_lim.size() - num_scopes];
+    for (unsigned i = m_trail.size(); i-- > old_sz; ) {
+        auto const& t = m_trail[i];
+        (t.first ? m_iff : m_and).erase(t.second);
+    }
+    m_trail.shrink(old_sz);
+    m_pinned.shrink(old_sz);
+    m_trail_lim.shrink(m_trail_lim.size() - num_scopes);
+}
+
+void aig_strash::reset() {
+    m_and.reset();
+    m_iff.reset();
+    m_pinned.reset();
+    m_trail.reset();
+    m_trail_lim.reset();
+    m_hits = 0;
+    m_misses = 0;
+}
@@ -0,0 +1,73 @@
+/*++
+Copyright (c) 2020 Microsoft Corporation
+
+Module Name:
+
+    aig_strash.h
+
+Abstract:
+
+    Structural hashing of and-inverter gates for the bit-blaster.
+
+    Gates are normalized to two-input and-gates and two-input iff-gates
+    over literals. A literal is an expression id shifted left by one,
+    the low bit is set for negated expressions (complement edges).
+    Disjunction and exclusive-or are expressed using complement edges.
+
+    The gate table is keyed by the ordered pair of input literals,
+    packed into a single 64-bit word, so that gates are shared
+    modulo commutativity and negation of inputs and outputs, and
+    lookups of existing gates do not allocate new expressions.
+
+Notes:
+
+    The result of a gate is an expression over and, not, =
+    and it is converted to clauses by the consumer (smt or sat internalizer).
+    Gates created in a scope are removed from the table and released when
+    the scope is popped.
+
+--*/
+#pragma once
+
+#include "ast/ast.h"
+#include "util/map.h"
+
+class aig_strash {
+    ast_manager&    m;
+    u64_map<expr*>  m_and;   // (lit1, lit2) -> (and e1 e2)
+    u64_map<expr*>  m_iff;   // (lit1, lit2) -> (= e1 e2)
+    expr_ref_vector m_pinned;
+    svector<std::pair<bool, uint64_t>> m_trail;  // (is iff gate, key) of gates in insertion order
+    unsigned_vector m_trail_lim;
+    unsigned        m_hits;
+    unsigned        m_misses;
+
+    unsigned to_lit(expr*& e) const;
+    expr* from_lit(expr* e, unsigned lit);
+    void insert(bool is_iff, uint64_t k, expr* g);
+    static uint64_t key(unsigned l1, unsigned l2) { return (static_cast<uint64_t>(l1) << 32ull) | l2; }
+
+public:
+    aig_strash(ast_manager& m): m(m), m_pinned(m), m_hits(0), m_misses(0) {}
+
+    void mk_not(expr* a, expr_ref& r);
+    void mk_and(expr* a, expr* b, expr_ref& r);
+    void mk_and(unsigned sz, expr* const* args, expr_ref& r);
+    void mk_or(expr* a, expr* b, expr_ref& r);
+    void mk_or(unsigned sz, expr* const* args, expr_ref& r);
+    void mk_iff(expr* a, expr* b, expr_ref& r);
+    void mk_xor(expr* a, expr* b, expr_ref& r);
+    void mk_nand(expr* a, expr* b, expr_ref& r);
+    void mk_nor(expr* a, expr* b, expr_ref& r);
+
+    unsigned num_gates() const { return m_and.size() + m_iff.size(); }
+    unsigned num_hits() const { return m_hits; }
+    unsigned num_misses() const { return m_misses; }
+
+    void push();
+    void pop(unsigned num_scopes);
+    unsigned num_scopes() const { return m_trail_lim.size(); }
+
+    void reset();
+};
+
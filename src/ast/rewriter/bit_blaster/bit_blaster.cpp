@@ -22,10 +22,46 @@ Revision History:
 #include "ast/bv_decl_plugin.h"
 
 
-bit_blaster_cfg::bit_blaster_cfg(bv_util & u, bit_blaster_params const & p, bool_rewriter& rw):
+bit_blaster_cfg::bit_blaster_cfg(bv_util & u, bit_blaster_params const & p, bool_rewriter& rw, aig_strash& strash):
     m_util(u),
     m_params(p),
-    m_rw(rw) {
+    m_rw(rw),
+    m_strash(strash) {
+}
+
+void bit_blaster_cfg::mk_and(expr * a, expr * b, expr * c, expr_ref & r) {
+    if (aig()) {
+        expr_ref t(m());
+        m_strash.mk_and(a, b, t);
+        m_strash.mk_and(t, c, r);
+    }
+    else {
+        m_rw.mk_and(a, b, c, r);
+    }
+}
+
+void bit_blaster_cfg::mk_or(expr * a, expr * b, expr * c, expr_ref & r) {
+    if (aig()) {
+        expr_ref t(m());
+        m_strash.mk_or(a, b, t);
+        m_strash.mk_or(t, c, r);
+    }
+    else {
+        m_rw.mk_or(a, b, c, r);
+    }
+}
+
+void bit_blaster_cfg::mk_ge2(expr * a, expr * b, expr * c, expr_ref & r) {
+    if (aig()) {
+        expr_ref t1(m()), t2(m()), t3(m());
+        m_strash.mk_and(a, b, t1);
+        m_strash.mk_and(a, c, t2);
+        m_strash.mk_and(b, c, t3);
+        mk_or(t1, t2, t3, r);
+    }
+    else {
+        m_rw.mk_ge2(a, b, c, r);
+    }
 }
 
 static void sort_args(expr * & l1, expr * & l2, expr * & l3) {
@@ -71,8 +107,8 @@ void bit_blaster_cfg::mk_xor3(expr * l1, expr * l2, expr * l3, expr_ref & r) {
     }
     else {
         expr_ref t(m());
-        m_rw.mk_xor(l1, l2, t);
-        m_rw.mk_xor(t, l3, r);
+        mk_xor(l1, l2, t);
+        mk_xor(t, l3, r);
     }
 }
 
@@ -114,17 +150,18 @@ void bit_blaster_cfg::mk_carry(expr * l1, expr * l2, expr * l3, expr_ref & r) {
     }
     else {
         expr_ref t1(m()), t2(m()), t3(m());
-        m_rw.mk_and(l1, l2, t1);
-        m_rw.mk_and(l1, l3, t2);
-        m_rw.mk_and(l2, l3, t3);
-        m_rw.mk_or(t1, t2, t3, r);
+        mk_and(l1, l2, t1);
+        mk_and(l1, l3, t2);
+        mk_and(l2, l3, t3);
+        mk_or(t1, t2, t3, r);
     }
 }
 
 template class bit_blaster_tpl<bit_blaster_cfg>;
 
 bit_blaster::bit_blaster(ast_manager & m, bit_blaster_params const & params):
-    bit_blaster_tpl<bit_blaster_cfg>(bit_blaster_cfg(m_util, params, m_rw)),
+    bit_blaster_tpl<bit_blaster_cfg>(bit_blaster_cfg(m_util, params, m_rw, m_strash)),
     m_util(m),
-    m_rw(m) {
+    m_rw(m),
+    m_strash(m) {
 }
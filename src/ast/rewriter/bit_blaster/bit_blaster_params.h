@@ -22,9 +22,11 @@ Revision History:
 struct bit_blaster_params {
     bool  m_bb_ext_gates;
     bool  m_bb_quantifiers;
+    bool  m_bb_aig;
     bit_blaster_params() :
         m_bb_ext_gates(false),
-        m_bb_quantifiers(false) {
+        m_bb_quantifiers(false),
+        m_bb_aig(false) {
     }
 #if 0
     void register_params(ini_params & p) {
@@ -36,6 +38,7 @@ struct bit_blaster_params {
     void display(std::ostream & out) const {
         out << "m_bb_ext_gates=" << m_bb_ext_gates << std::endl;
         out << "m_bb_quantifiers=" << m_bb_quantifiers << std::endl;
+        out << "m_bb_aig=" << m_bb_aig << std::endl;
     }
 };
 
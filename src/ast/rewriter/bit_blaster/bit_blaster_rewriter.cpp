@@ -21,6 +21,7 @@ Notes:
 #include "ast/rewriter/bit_blaster/bit_blaster_tpl_def.h"
 #include "ast/rewriter/rewriter_def.h"
 #include "ast/rewriter/bool_rewriter.h"
+#include "ast/rewriter/bit_blaster/aig_strash.h"
 #include "util/ref_util.h"
 #include "ast/ast_smt2_pp.h"
 
@@ -29,23 +30,29 @@ struct blaster_cfg {
 
     bool_rewriter & m_rewriter;
     bv_util &       m_util;
-    blaster_cfg(bool_rewriter & r, bv_util & u):m_rewriter(r), m_util(u) {}
+    aig_strash &    m_strash;
+    bool            m_aig;
+    blaster_cfg(bool_rewriter & r, bv_util & u, aig_strash & s):m_rewriter(r), m_util(u), m_strash(s), m_aig(false) {}
 
     ast_manager & m() const { return m_util.get_manager(); }
     numeral power(unsigned n) const { return rational::power_of_two(n); }
-    void mk_xor(expr * a, expr * b, expr_ref & r) { m_rewriter.mk_xor(a, b, r); }
+    void mk_xor(expr * a, expr * b, expr_ref & r) { if (m_aig) m_strash.mk_xor(a, b, r); else m_rewriter.mk_xor(a, b, r); }
     void mk_xor3(expr * a, expr * b, expr * c, expr_ref & r) {
         expr_ref tmp(m());
         mk_xor(b, c, tmp);
         mk_xor(a, tmp, r);
     }
-    void mk_iff(expr * a, expr * b, expr_ref & r) { m_rewriter.mk_iff(a, b, r); }
-    void mk_and(expr * a, expr * b, expr_ref & r) { m_rewriter.mk_and(a, b, r); }
-    void mk_and(expr * a, expr * b, expr * c, expr_ref & r) { m_rewriter.mk_and(a, b, c, r); }
-    void mk_and(unsigned sz, expr * const * args, expr_ref & r) { m_rewriter.mk_and(sz, args, r); }
-    void mk_or(expr * a, expr * b, expr_ref & r) { m_rewriter.mk_or(a, b, r); }
-    void mk_or(expr * a, expr * b, expr * c, expr_ref & r) { m_rewriter.mk_or(a, b, c, r); }
-    void mk_or(unsigned sz, expr * const * args, expr_ref & r) { m_rewriter.mk_or(sz, args, r); }
+    void mk_iff(expr * a, expr * b, expr_ref & r) { if (m_aig) m_strash.mk_iff(a, b, r); else m_rewriter.mk_iff(a, b, r); }
+    void mk_and(expr * a, expr * b, expr_ref & r) { if (m_aig) m_strash.mk_and(a, b, r); else m_rewriter.mk_and(a, b, r); }
+    void mk_and(expr * a, expr * b, expr * c, expr_ref & r) { 
+        if (m_aig) { expr* args[3] = { a, b, c }; m_strash.mk_and(3, args, r); } else m_rewriter.mk_and(a, b, c, r); 
+    }
+    void mk_and(unsigned sz, expr * const * args, expr_ref & r) { if (m_aig) m_strash.mk_and(sz, args, r); else m_rewriter.mk_and(sz, args, r); }
+    void mk_or(expr * a, expr * b, expr_ref & r) { if (m_aig) m_strash.mk_or(a, b, r); else m_rewriter.mk_or(a, b, r); }
+    void mk_or(expr * a, expr * b, expr * c, expr_ref & r) { 
+        if (m_aig) { expr* args[3] = { a, b, c }; m_strash.mk_or(3, args, r); } else m_rewriter.mk_or(a, b, c, r); 
+    }
+    void mk_or(unsigned sz, expr * const * args, expr_ref & r) { if (m_aig) m_strash.mk_or(sz, args, r); else m_rewriter.mk_or(sz, args, r); }
     void mk_not(expr * a, expr_ref & r) { m_rewriter.mk_not(a, r); }
     void mk_carry(expr * a, expr * b, expr * c, expr_ref & r) {
         expr_ref t1(m()), t2(m()), t3(m());
@@ -62,24 +69,30 @@ struct blaster_cfg {
 #endif
     }
     void mk_ite(expr * c, expr * t, expr * e, expr_ref & r) { m_rewriter.mk_ite(c, t, e, r); }
-    void mk_nand(expr * a, expr * b, expr_ref & r) { m_rewriter.mk_nand(a, b, r); }
-    void mk_nor(expr * a, expr * b, expr_ref & r) { m_rewriter.mk_nor(a, b, r); }
-    void mk_ge2(expr * a, expr * b, expr * c, expr_ref& r) { m_rewriter.mk_ge2(a, b, c, r); }
+    void mk_nand(expr * a, expr * b, expr_ref & r) { if (m_aig) m_strash.mk_nand(a, b, r); else m_rewriter.mk_nand(a, b, r); }
+    void mk_nor(expr * a, expr * b, expr_ref & r) { if (m_aig) m_strash.mk_nor(a, b, r); else m_rewriter.mk_nor(a, b, r); }
+    void mk_ge2(expr * a, expr * b, expr * c, expr_ref& r) { if (m_aig) mk_carry(a, b, c, r); else m_rewriter.mk_ge2(a, b, c, r); }
 };
 
 class blaster : public bit_blaster_tpl<blaster_cfg> {
     bool_rewriter           m_rewriter;
     bv_util                 m_util;
+    aig_strash              m_strash;
 public:
     blaster(ast_manager & m):
-        bit_blaster_tpl<blaster_cfg>(blaster_cfg(m_rewriter, m_util)),
+        bit_blaster_tpl<blaster_cfg>(blaster_cfg(m_rewriter, m_util, m_strash)),
         m_rewriter(m),
-        m_util(m) {
+        m_util(m),
+        m_strash(m) {
         m_rewriter.set_flat(false);
         m_rewriter.set_elim_and(true);
     }
 
     bv_util & butil() { return m_util; }
+
+    void set_aig(bool f) { m_aig = f; }
+    void push() { m_strash.push(); }
+    void pop(unsigned num_scopes) { m_strash.pop(num_scopes); }
 };
 
 struct blaster_rewriter_cfg : public default_rewriter_cfg {
@@ -138,6 +151,7 @@ struct blaster_rewriter_cfg : public default_rewriter_cfg {
         m_blast_full     = p.get_bool("blast_full", false);
         m_blast_quant    = p.get_bool("blast_quant", false);
         m_blaster.set_max_memory(m_max_memory);
+        m_blaster.set_aig(p.get_bool("blast_aig", false));
     }
 
     bool rewrite_patterns() const { return true; }
@@ -165,6 +179,7 @@ struct blaster_rewriter_cfg : public default_rewriter_cfg {
     void push() {
         m_keyval_lim.push_back(m_keys.size());
         m_newbits_lim.push_back(m_newbits.size());
+        m_blaster.push();
     }
 
     unsigned get_num_scopes() const {
@@ -187,6 +202,7 @@ struct blaster_rewriter_cfg : public default_rewriter_cfg {
             lim = m_newbits_lim[new_sz];
             m_newbits.shrink(lim);
             m_newbits_lim.shrink(new_sz);
+            m_blaster.pop(num_scopes);
         }
     }
 
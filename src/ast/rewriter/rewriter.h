@@ -22,6 +22,7 @@ Notes:
 #include "ast/ast.h"
 #include "ast/rewriter/rewriter_types.h"
 #include "ast/act_cache.h"
+#include "ast/rewriter/rewriter_memo.h"
 
 /**
    \brief Common infrastructure for AST rewriters.
@@ -70,6 +71,9 @@ protected:
     };
     svector<scope>             m_scopes;
 
+    rewriter_memo *            m_memo;        // results shared with other rewriters, consulted when m_cache misses.
+    unsigned                   m_memo_config;
+
     // Return true if the rewriting result of the given expression must be cached.
     bool must_cache(expr * t) const {
         return 
@@ -120,6 +124,16 @@ public:
     void reset();
     void cleanup();
     void set_cancel_check(bool f) { m_cancel_check = f; }
+    /**
+       \brief Share the results of rewriting with the rewriters using \c memo
+       with the same configuration. The results must not depend on anything
+       but the rewritten expression and the configuration.
+    */
+    void set_memo(rewriter_memo * memo, unsigned config) {
+        SASSERT(!memo || !m_proof_gen);
+        m_memo = memo;
+        m_memo_config = config;
+    }
 #ifdef _TRACE
     void display_stack(std::ostream & out, unsigned pp_depth);
 #endif
@@ -250,6 +264,8 @@ protected:
     bool flat_assoc(func_decl * f) const { return m_cfg.flat_assoc(f); }
     // rewrite patterns
     bool rewrite_patterns() const { return m_cfg.rewrite_patterns(); }
+    // results only depend on the configuration when there are no bindings.
+    bool memo_enabled() const { return this->m_memo && m_bindings.empty(); }
    
     // check maximum number of scopes
     void check_max_scopes() const { 
@@ -276,6 +292,8 @@ protected:
 
     // Return true if the rewriting result of the given expression must be cached.
     bool must_cache(expr * t) const {
+        if (memo_enabled())
+            return (is_app(t) && to_app(t)->get_num_args() > 0) || is_quantifier(t);
         if (cache_all_results())
             return t != this->m_root && ((is_app(t) && to_app(t)->get_num_args() > 0) || is_quantifier(t));
         if (cache_results())
@@ -308,10 +326,14 @@ protected:
     bool visit(expr * t, unsigned max_depth);
 
     template<bool ProofGen>
-    void cache_result(expr * t, expr * new_t, proof * pr, bool c) {
-        if (c) {
-            if (!ProofGen)
+    void cache_result(expr * t, expr * new_t, proof * pr, frame const & fr) {
+        if (fr.m_cache_result) {
+            if (!ProofGen) {
                 rewriter_core::cache_result(t, new_t);
+                // results of bounded rewrites are not shared.
+                if (memo_enabled() && fr.m_max_depth == RW_UNBOUNDED_DEPTH)
+                    this->m_memo->insert(t, this->m_memo_config, new_t);
+            }
             else
                 rewriter_core::cache_result(t, new_t, pr);
         }
@@ -170,6 +170,11 @@ bool rewriter_tpl<Config>::visit(expr * t, unsigned max_depth) {
             std::cerr << "[rewriter] num-cache-checks: " << checked_cache << std::endl;
 #endif
         expr * r = get_cached(t);
+        if (!r && !ProofGen && memo_enabled()) {
+            r = m_memo->find(t, m_memo_config);
+            if (r)
+                rewriter_core::cache_result(t, r);
+        }
         if (r) {
             SASSERT(m().get_sort(r) == m().get_sort(t));
             result_stack().push_back(r);
@@ -236,7 +241,7 @@ bool rewriter_tpl<Config>::constant_fold(app * t, frame & fr) {
                 result_stack().pop_back();
                 result_stack().pop_back();
                 result_stack().push_back(m_r);
-                cache_result<false>(t, m_r, m_pr, fr.m_cache_result);
+                cache_result<false>(t, m_r, m_pr, fr);
                 TRACE("rewriter_step", tout << "step 1\n" << mk_ismt2_pp(m_r, m()) << "\n";);
                 frame_stack().pop_back();
                 set_new_child_flag(t);
@@ -329,7 +334,7 @@ void rewriter_tpl<Config>::process_app(app * t, frame & fr) {
                 m_pr2 = nullptr;
             }
             if (st == BR_DONE) {
-                cache_result<ProofGen>(t, m_r, m_pr, fr.m_cache_result);
+                cache_result<ProofGen>(t, m_r, m_pr, fr);
                 frame_stack().pop_back();
                 set_new_child_flag(t);
                 m_r = nullptr;
@@ -364,7 +369,7 @@ void rewriter_tpl<Config>::process_app(app * t, frame & fr) {
                     result_stack().pop_back();
                     result_stack().pop_back();
                     result_stack().push_back(m_r);
-                    cache_result<ProofGen>(t, m_r, m_pr, fr.m_cache_result);
+                    cache_result<ProofGen>(t, m_r, m_pr, fr);
                     frame_stack().pop_back();
                     set_new_child_flag(t);
                     m_r = nullptr;
@@ -446,7 +451,7 @@ void rewriter_tpl<Config>::process_app(app * t, frame & fr) {
         }
         result_stack().shrink(fr.m_spos);
         result_stack().push_back(m_r);
-        cache_result<ProofGen>(t, m_r, m_pr, fr.m_cache_result);
+        cache_result<ProofGen>(t, m_r, m_pr, fr);
         if (ProofGen) {
             result_pr_stack().shrink(fr.m_spos);
             result_pr_stack().push_back(m_pr);
@@ -472,7 +477,7 @@ void rewriter_tpl<Config>::process_app(app * t, frame & fr) {
         result_stack().pop_back();
         result_stack().pop_back();
         result_stack().push_back(m_r);
-        cache_result<ProofGen>(t, m_r, m_pr, fr.m_cache_result);
+        cache_result<ProofGen>(t, m_r, m_pr, fr);
         frame_stack().pop_back();
         set_new_child_flag(t);
         return;
@@ -493,7 +498,7 @@ void rewriter_tpl<Config>::process_app(app * t, frame & fr) {
             }
             result_stack().shrink(fr.m_spos);
             result_stack().push_back(m_r);
-            cache_result<ProofGen>(t, m_r, m_pr, fr.m_cache_result);
+            cache_result<ProofGen>(t, m_r, m_pr, fr);
             frame_stack().pop_back();
             set_new_child_flag(t);
         }
@@ -602,7 +607,7 @@ void rewriter_tpl<Config>::process_quantifier(quantifier * q, frame & fr) {
     m_bindings.shrink(m_bindings.size() - num_decls);
     m_shifts.shrink(m_shifts.size() - num_decls);
     end_scope();
-    cache_result<ProofGen>(q, m_r, m_pr, fr.m_cache_result);
+    cache_result<ProofGen>(q, m_r, m_pr, fr);
     m_r = nullptr;
     m_pr = nullptr;
     frame_stack().pop_back();
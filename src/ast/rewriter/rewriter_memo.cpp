@@ -0,0 +1,125 @@
+/*++
+Copyright (c) 2020 Microsoft Corporation
+
+Module Name:
+
+    rewriter_memo.cpp
+
+Abstract:
+
+    Bounded cache of rewriting results shared by the rewriters of an
+    ast_manager.
+
+--*/
+#include "ast/rewriter/rewriter_memo.h"
+
+namespace {
+    // the memo is only accessed by several threads when the manager is shared.
+    class memo_lock {
+        mutex & m_mux;
+        bool    m_locked;
+    public:
+        memo_lock(ast_manager & m, mutex & mux): m_mux(mux), m_locked(m.concurrency_enabled()) {
+            if (m_locked) m_mux.lock();
+        }
+        ~memo_lock() { if (m_locked) m_mux.unlock(); }
+    };
+}
+
+static symbol const & memo_name() {
+    static symbol s("rewriter_memo");
+    return s;
+}
+
+rewriter_memo::rewriter_memo(ast_manager & m):
+    m(m),
+    m_gen1(m),
+    m_gen2(m),
+    m_young(&m_gen1),
+    m_old(&m_gen2),
+    m_capacity(1 << 20) {
+}
+
+rewriter_memo::~rewriter_memo() {
+    reset();
+}
+
+rewriter_memo & rewriter_memo::get(ast_manager & m) {
+    ast_manager::decl_lock lock(m);
+    rewriter_memo * r = find(m);
+    if (!r) {
+        r = alloc(rewriter_memo, m);
+        m.set_extension(memo_name(), r);
+    }
+    return *r;
+}
+
+rewriter_memo * rewriter_memo::find(ast_manager & m) {
+    return static_cast<rewriter_memo*>(m.get_extension(memo_name()));
+}
+
+unsigned rewriter_memo::get_config(std::string const & fingerprint) {
+    memo_lock lock(m, m_mux);
+    for (unsigned i = 0; i < m_configs.size(); ++i)
+        if (m_configs[i] == fingerprint)
+            return i;
+    m_configs.push_back(fingerprint);
+    return m_configs.size() - 1;
+}
+
+void rewriter_memo::set_capacity(unsigned c) {
+    memo_lock lock(m, m_mux);
+    m_capacity = std::max(c, 1u);
+}
+
+void rewriter_memo::insert_young(uint64_t key, expr * t, expr * r) {
+    if (m_young->m_table.size() >= m_capacity) {
+        m_stats.m_evictions += m_old->m_table.size();
+        m_old->reset();
+        std::swap(m_young, m_old);
+    }
+    m_young->m_table.insert(key, r);
+    m_young->m_pinned.push_back(t);
+    m_young->m_pinned.push_back(r);
+}
+
+expr * rewriter_memo::find(expr * t, unsigned config) {
+    memo_lock lock(m, m_mux);
+    uint64_t key = mk_key(t, config);
+    expr * r = nullptr;
+    if (m_young->m_table.find(key, r)) {
+        m_stats.m_hits++;
+        return r;
+    }
+    if (m_old->m_table.find(key, r)) {
+        m_stats.m_hits++;
+        // promote the entry, it survives the next eviction.
+        expr_ref pin(r, m);
+        m_old->m_table.erase(key);
+        insert_young(key, t, r);
+        return r;
+    }
+    m_stats.m_misses++;
+    return nullptr;
+}
+
+void rewriter_memo::insert(expr * t, unsigned config, expr * r) {
+    memo_lock lock(m, m_mux);
+    uint64_t key = mk_key(t, config);
+    if (m_young->m_table.contains(key))
+        return;
+    insert_young(key, t, r);
+}
+
+void rewriter_memo::reset() {
+    memo_lock lock(m, m_mux);
+    m_young->reset();
+    m_old->reset();
+}
+
+void rewriter_memo::collect_statistics(statistics & st) const {
+    st.update("rewriter memo hits", m_stats.m_hits);
+    st.update("rewriter memo misses", m_stats.m_misses);
+    st.update("rewriter memo evictions", m_stats.m_evictions);
+    st.update("rewriter memo entries", size());
+}
@@ -0,0 +1,101 @@
+/*++
+Copyright (c) 2020 Microsoft Corporation
+
+Module Name:
+
+    rewriter_memo.h
+
+Abstract:
+
+    Bounded cache of rewriting results shared by the rewriters of an
+    ast_manager.
+
+    Entries are keyed by the expression id and by a configuration
+    identifier that distinguishes rewriters using different parameters.
+    Keys and values are pinned, so an id cannot be recycled while its
+    entry is alive.
+
+    The memo has two generations. New results and hits found in the old
+    generation are stored in the young generation. When the young
+    generation is full, the old generation is dropped and the young
+    generation becomes the old one.
+
+--*/
+#pragma once
+
+#include "ast/ast.h"
+#include "util/map.h"
+#include "util/mutex.h"
+#include "util/statistics.h"
+#include <string>
+
+class rewriter_memo : public ast_manager::extension {
+    struct stats {
+        unsigned m_hits;
+        unsigned m_misses;
+        unsigned m_evictions;
+        stats() { reset(); }
+        void reset() { memset(this, 0, sizeof(*this)); }
+    };
+    typedef u64_map<expr*> table;
+    struct generation {
+        table           m_table;
+        expr_ref_vector m_pinned; // keys and values of m_table.
+        generation(ast_manager & m): m_pinned(m) {}
+        void reset() { m_table.reset(); m_pinned.reset(); }
+    };
+    ast_manager &       m;
+    generation          m_gen1, m_gen2;
+    generation *        m_young;
+    generation *        m_old;
+    unsigned            m_capacity;
+    vector<std::string> m_configs;
+    stats               m_stats;
+    mutex               m_mux;
+
+    static uint64_t mk_key(expr * t, unsigned config) {
+        return (static_cast<uint64_t>(config) << 32) | t->get_id();
+    }
+
+    void insert_young(uint64_t key, expr * t, expr * r);
+
+    rewriter_memo(ast_manager & m);
+public:
+    ~rewriter_memo() override;
+
+    /**
+       \brief Return the memo of the given manager, create it if needed.
+    */
+    static rewriter_memo & get(ast_manager & m);
+
+    /**
+       \brief Return the memo of the given manager, or nullptr if none was created.
+    */
+    static rewriter_memo * find(ast_manager & m);
+
+    /**
+       \brief Return an identifier for rewriters whose behavior is described by \c fingerprint.
+       Rewriters with equal fingerprints share the cached results.
+    */
+    unsigned get_config(std::string const & fingerprint);
+
+    /**
+       \brief Set the maximal number of entries in a generation.
+    */
+    void set_capacity(unsigned c);
+    unsigned capacity() const { return m_capacity; }
+
+    expr * find(expr * t, unsigned config);
+    void insert(expr * t, unsigned config, expr * r);
+
+    /**
+       \brief Number of entries in both generations.
+    */
+    unsigned size() const { return m_young->m_table.size() + m_old->m_table.size(); }
+    unsigned hits() const { return m_stats.m_hits; }
+    unsigned misses() const { return m_stats.m_misses; }
+    unsigned evictions() const { return m_stats.m_evictions; }
+
+    void reset();
+    void collect_statistics(statistics & st) const;
+};
@@ -60,6 +60,21 @@ expr_ref sym_expr::accept(expr* e) {
             result = m.mk_and(u.mk_le(m_t, e), u.mk_le(e, m_s));
         }
         break;
+    case t_set:
+        if (u.is_const_char(e, r2)) {
+            result = m.mk_bool_val(m_set.contains(r2));
+        }
+        else {
+            expr_ref_vector ors(m);
+            for (auto const& r : m_set) {
+                if (r.m_lo == r.m_hi)
+                    ors.push_back(m.mk_eq(e, u.mk_char(r.m_lo)));
+                else
+                    ors.push_back(m.mk_and(u.mk_le(u.mk_char(r.m_lo), e), u.mk_le(e, u.mk_char(r.m_hi))));
+            }
+            result = mk_or(ors);
+        }
+        break;
     }
     
     return result;
@@ -71,6 +86,7 @@ std::ostream& sym_expr::display(std::ostream& out) const {
     case t_range: return out << m_t << ":" << m_s;
     case t_pred: return out << m_t;
     case t_not: return m_expr->display(out << "not ");
+    case t_set: return out << m_set;
     }
     return out << "expression type not recognized";
 }
@@ -100,6 +116,47 @@ public:
         expr_ref fml(m.mk_true(), m);
         return sym_expr::mk_pred(fml, m.mk_bool_sort());
     }
+    /**
+       \brief convert predicates over constant characters to character sets.
+       Intersection, union, complement and emptiness of such predicates
+       are then computed without building formulas.
+    */
+    bool to_char_set(T x, char_set& result) {
+        seq_util u(m);
+        unsigned lo, hi;
+        if (x->is_set()) {
+            result = x->get_set();
+            return true;
+        }
+        if (x->is_char() && u.is_const_char(x->get_char(), lo)) {
+            result = char_set(lo, lo);
+            return true;
+        }
+        if (x->is_range() && u.is_const_char(x->get_lo(), lo) && u.is_const_char(x->get_hi(), hi)) {
+            result = char_set(lo, hi);
+            return true;
+        }
+        if (x->is_not() && to_char_set(x->get_arg(), result)) {
+            result = result.complement(zstring::max_char());
+            return true;
+        }
+        if (x->is_pred() && !x->is_not() && !x->is_range() && (m.is_true(x->get_pred()) || m.is_false(x->get_pred()))) {
+            result = m.is_true(x->get_pred()) ? char_set::full(zstring::max_char()) : char_set();
+            return true;
+        }
+        return false;
+    }
+
+    T mk_set(T x, T y, char_set const& cs) {
+        sort* s = x->get_sort();
+        if (m.is_bool(s)) s = y->get_sort();
+        if (cs.empty()) 
+            return mk_false();
+        if (m.is_bool(s))
+            return mk_true();
+        return sym_expr::mk_set(m, cs, s);
+    }
+
     T mk_and(T x, T y) override {
         seq_util u(m);
         if (x->is_char() && y->is_char()) {
@@ -111,19 +168,10 @@ public:
                 return sym_expr::mk_pred(fml, x->get_sort());
             }
         }
-        unsigned lo1, hi1, lo2, hi2;
-        if (x->is_range() && y->is_range() &&
-            u.is_const_char(x->get_lo(), lo1) && u.is_const_char(x->get_hi(), hi1) &&
-            u.is_const_char(y->get_lo(), lo2) && u.is_const_char(y->get_hi(), hi2)) {
-            lo1 = std::max(lo1, lo2);
-            hi1 = std::min(hi1, hi2);
-            if (lo1 > hi1) {
-                expr_ref fml(m.mk_false(), m);
-                return sym_expr::mk_pred(fml, x->get_sort());
-            }
-            expr_ref _start(u.mk_char(lo1), m);
-            expr_ref _stop(u.mk_char(hi1), m);
-            return sym_expr::mk_range(_start, _stop);
+        char_set s1, s2;
+        if (to_char_set(x, s1) && to_char_set(y, s2)) {
+            s1 &= s2;
+            return mk_set(x, y, s1);
         }
 
         sort* s = x->get_sort();
@@ -163,6 +211,11 @@ public:
             return x;
         }
         if (x == y) return x;
+        char_set s1, s2;
+        if (to_char_set(x, s1) && to_char_set(y, s2)) {
+            s1 |= s2;
+            return mk_set(x, y, s1);
+        }
         var_ref v(m.mk_var(0, x->get_sort()), m);
         expr_ref fml1 = x->accept(v);
         expr_ref fml2 = y->accept(v);        
@@ -215,6 +268,10 @@ public:
         if (x->is_not() && x->get_arg()->is_range() && u.is_const_char(x->get_arg()->get_lo(), lo) && 0 < lo) {
             return l_true;
         }            
+        char_set cs;
+        if (to_char_set(x, cs)) {
+            return cs.empty() ? l_false : l_true;
+        }
         if (!m_var || m.get_sort(m_var) != x->get_sort()) {
             m_var = m.mk_fresh_const("x", x->get_sort()); 
         }
@@ -3391,19 +3448,6 @@ br_status seq_rewriter::mk_re_opt(expr* a, expr_ref& result) {
     return BR_REWRITE1;
 }
 
-void seq_rewriter::intersect(unsigned lo, unsigned hi, svector<std::pair<unsigned, unsigned>>& ranges) {
-    unsigned j = 0;
-    for (unsigned i = 0; i < ranges.size(); ++i) {
-        unsigned lo1 = ranges[i].first;
-        unsigned hi1 = ranges[i].second;        
-        if (hi < lo1) 
-            break;
-        if (hi1 >= lo) 
-            ranges[j++] = std::make_pair(std::max(lo1, lo), std::min(hi1, hi));
-    }
-    ranges.shrink(j);
-}
-
 /**
  * Simplify cond using special case rewriting for character equations
  * When elem is uninterpreted compute the simplification of Exists elem . cond
@@ -3415,56 +3459,40 @@ void seq_rewriter::elim_condition(expr* elem, expr_ref& cond) {
     expr* lhs = nullptr, *rhs = nullptr, *e1 = nullptr; 
     if (u().is_char(elem)) {
         unsigned ch = 0;
-        svector<std::pair<unsigned, unsigned>> ranges, ranges1;
-        ranges.push_back(std::make_pair(0, zstring::max_char()));
-        auto exclude_char = [&](unsigned ch) {
-            if (ch == 0) {
-                intersect(1, zstring::max_char(), ranges);
-            }
-            else if (ch == zstring::max_char()) {
-                intersect(0, ch-1, ranges);
-            }
-            else {
-                ranges1.reset();
-                ranges1.append(ranges);
-                intersect(0, ch - 1, ranges);
-                intersect(ch + 1, zstring::max_char(), ranges1);
-                ranges.append(ranges1);
-            }
-        };
+        char_set ranges = char_set::full(zstring::max_char());
         bool all_ranges = true;
         for (expr* e : conds) {
             if (m().is_eq(e, lhs, rhs) && elem == lhs && u().is_const_char(rhs, ch)) {
-                intersect(ch, ch, ranges);                
+                ranges.intersect(ch, ch);
             }
             else if (m().is_eq(e, lhs, rhs) && elem == rhs && u().is_const_char(lhs, ch)) {
-                intersect(ch, ch, ranges);
+                ranges.intersect(ch, ch);
             }
             else if (u().is_char_le(e, lhs, rhs) && elem == lhs && u().is_const_char(rhs, ch)) {
-                intersect(0, ch, ranges);
+                ranges.intersect(0, ch);
             }
             else if (u().is_char_le(e, lhs, rhs) && elem == rhs && u().is_const_char(lhs, ch)) {
-                intersect(ch, zstring::max_char(), ranges);
+                ranges.intersect(ch, zstring::max_char());
             }
             else if (m().is_not(e, e1) && m().is_eq(e1, lhs, rhs) && elem == lhs && u().is_const_char(rhs, ch)) {
-                exclude_char(ch);
+                ranges.remove(ch);
             }
             else if (m().is_not(e, e1) && m().is_eq(e1, lhs, rhs) && elem == rhs && u().is_const_char(lhs, ch)) {
-                exclude_char(ch);
+                ranges.remove(ch);
             }
             else if (m().is_not(e, e1) && u().is_char_le(e1, lhs, rhs) && elem == lhs && u().is_const_char(rhs, ch)) {
                 // not (e <= ch)
                 if (ch == zstring::max_char()) 
                     ranges.reset();
                 else 
-                    intersect(ch+1, zstring::max_char(), ranges);
+                    ranges.intersect(ch+1, zstring::max_char());
             }
             else if (m().is_not(e, e1) && u().is_char_le(e1, lhs, rhs) && elem == rhs && u().is_const_char(lhs, ch)) {
                 // not (ch <= e)
                 if (ch == 0) 
                     ranges.reset();
                 else                 
-                    intersect(0, ch-1, ranges);
+                    ranges.intersect(0, ch-1);
             }
             else {
                 all_ranges = false;
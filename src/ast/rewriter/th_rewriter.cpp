@@ -35,6 +35,14 @@ Notes:
 #include "ast/ast_pp.h"
 #include "ast/ast_util.h"
 #include "ast/well_sorted.h"
+#include "ast/ast_translation.h"
+#include "util/gparams.h"
+#include "util/scoped_ptr_vector.h"
+#include <sstream>
+#ifndef SINGLE_THREAD
+#include <thread>
+#include <mutex>
+#endif
 
 namespace {
 struct th_rewriter_cfg : public default_rewriter_cfg {
@@ -791,11 +799,208 @@ struct th_rewriter_cfg : public default_rewriter_cfg {
 
 template class rewriter_tpl<th_rewriter_cfg>;
 
+#ifndef SINGLE_THREAD
+namespace {
+/**
+   \brief Rewrite the large independent subterms of an expression in parallel.
+
+   The expression is split into chunks: maximal subterms whose tree size is
+   below a fraction of the size of the expression. Contiguous ranges of chunks
+   are assigned to workers. A worker translates its chunks into its own
+   manager, reading the main manager without updating it, and rewrites them
+   with a th_rewriter using the same parameters. The results are translated
+   back by the main thread.
+
+   The nodes of the chunks are translated in the order of their ids, so the
+   rewriters compare input nodes in the same order as the main rewriter.
+   Rewrite rules that order arguments by id may still order the nodes created
+   by rewriting differently than a sequential rewrite does.
+*/
+class parallel_rewriter {
+    ast_manager &    m;
+    params_ref       m_params;
+    unsigned         m_threads;
+    ptr_vector<expr> m_chunks;
+    unsigned_vector  m_weights;
+
+    static unsigned add_size(unsigned a, unsigned b) {
+        return a + b < a || a + b > (1u << 30) ? (1u << 30) : a + b;
+    }
+
+    void collect_nodes(unsigned begin, unsigned end, ptr_vector<expr> & nodes) {
+        expr_mark visited;
+        ptr_vector<expr> todo;
+        for (unsigned i = begin; i < end; ++i)
+            todo.push_back(m_chunks[i]);
+        while (!todo.empty()) {
+            expr * e = todo.back();
+            todo.pop_back();
+            if (visited.is_marked(e))
+                continue;
+            visited.mark(e);
+            nodes.push_back(e);
+            if (is_app(e))
+                for (expr * arg : *to_app(e))
+                    todo.push_back(arg);
+        }
+        std::sort(nodes.begin(), nodes.end(), ast_lt_proc());
+    }
+
+    void rewrite_range(ast_manager & wm, unsigned begin, unsigned end, expr_ref_vector & result) {
+        ast_translation tr(m, wm, false);
+        tr.set_read_only_source();
+        ptr_vector<expr> nodes;
+        collect_nodes(begin, end, nodes);
+        expr_ref_vector pinned(wm);
+        for (expr * n : nodes)
+            pinned.push_back(tr(n));
+        th_rewriter rw(wm, m_params);
+        expr_ref r(wm);
+        for (unsigned i = begin; i < end; ++i) {
+            rw(tr(m_chunks[i]), r);
+            result.push_back(r);
+        }
+    }
+
+public:
+    parallel_rewriter(ast_manager & m, params_ref const & p, unsigned threads):
+        m(m),
+        m_params(p),
+        m_threads(threads) {
+        m_params.set_uint("threads", 1);
+        m_params.set_bool("memo", false);
+    }
+
+    /**
+       \brief Split \c t into chunks. Return false if \c t has fewer than
+       \c min_size nodes or cannot be split.
+    */
+    bool split(expr * t, unsigned min_size) {
+        obj_map<expr, unsigned> size;
+        ptr_vector<expr> todo;
+        todo.push_back(t);
+        while (!todo.empty()) {
+            expr * e = todo.back();
+            if (size.contains(e)) {
+                todo.pop_back();
+                continue;
+            }
+            unsigned sz = 1;
+            bool visited = true;
+            if (is_app(e)) {
+                for (expr * arg : *to_app(e)) {
+                    unsigned arg_sz = 0;
+                    if (size.find(arg, arg_sz))
+                        sz = add_size(sz, arg_sz);
+                    else {
+                        todo.push_back(arg);
+                        visited = false;
+                    }
+                }
+            }
+            if (visited) {
+                size.insert(e, sz);
+                todo.pop_back();
+            }
+        }
+        if (size.size() < min_size)
+            return false;
+        unsigned target = std::max(1u, size[t] / (8 * m_threads));
+        expr_mark visited;
+        todo.push_back(t);
+        while (!todo.empty()) {
+            expr * e = todo.back();
+            todo.pop_back();
+            if (visited.is_marked(e) || !is_app(e) || to_app(e)->get_num_args() == 0)
+                continue;
+            visited.mark(e);
+            unsigned sz = size[e];
+            if (sz > target) {
+                for (expr * arg : *to_app(e))
+                    todo.push_back(arg);
+            }
+            else {
+                m_chunks.push_back(e);
+                m_weights.push_back(sz);
+            }
+        }
+        return m_chunks.size() > 1;
+    }
+
+    /**
+       \brief Rewrite the chunks and store their results in \c sub.
+    */
+    void operator()(expr_substitution & sub) {
+        unsigned num_threads = std::min(m_threads, m_chunks.size());
+        uint64_t total = 0;
+        for (unsigned w : m_weights)
+            total += w;
+        // worker i rewrites the chunks in [bounds[i], bounds[i+1]).
+        unsigned_vector bounds;
+        bounds.push_back(0);
+        uint64_t acc = 0;
+        for (unsigned i = 0; i < m_chunks.size() && bounds.size() < num_threads; ++i) {
+            acc += m_weights[i];
+            if (acc * num_threads >= bounds.size() * total)
+                bounds.push_back(i + 1);
+        }
+        bounds.push_back(m_chunks.size());
+        num_threads = bounds.size() - 1;
+
+        scoped_ptr_vector<ast_manager> managers;
+        vector<expr_ref_vector> results;
+        scoped_limits sl(m.limit());
+        for (unsigned i = 0; i < num_threads; ++i) {
+            ast_manager * wm = alloc(ast_manager, m, true);
+            managers.push_back(wm);
+            results.push_back(expr_ref_vector(*wm));
+            sl.push_child(&(wm->limit()));
+        }
+        std::mutex mux;
+        std::string ex_msg;
+        bool failed = false;
+        vector<std::thread> threads(num_threads);
+        for (unsigned i = 0; i < num_threads; ++i) {
+            threads[i] = std::thread([&, i]() {
+                try {
+                    rewrite_range(*managers[i], bounds[i], bounds[i + 1], results[i]);
+                }
+                catch (z3_exception & ex) {
+                    std::lock_guard<std::mutex> lock(mux);
+                    ex_msg = ex.msg();
+                    failed = true;
+                }
+            });
+        }
+        for (auto & th : threads)
+            th.join();
+        if (failed)
+            throw rewriter_exception(std::move(ex_msg));
+        for (unsigned i = 0; i < num_threads; ++i) {
+            ast_translation tr(*managers[i], m, false);
+            for (unsigned j = bounds[i]; j < bounds[i + 1]; ++j)
+                sub.insert(m_chunks[j], tr(results[i].get(j - bounds[i])));
+        }
+    }
+};
+}
+#endif
+
 struct th_rewriter::imp : public rewriter_tpl<th_rewriter_cfg> {
     th_rewriter_cfg m_cfg;
+    rewriter_memo * m_shared_memo;
+    unsigned        m_shared_config;
+    bool            m_has_solver;
+    unsigned        m_threads;
+    unsigned        m_threads_min_size;
     imp(ast_manager & m, params_ref const & p):
         rewriter_tpl<th_rewriter_cfg>(m, m.proofs_enabled(), m_cfg),
-        m_cfg(m, p) {
+        m_cfg(m, p),
+        m_shared_memo(nullptr),
+        m_shared_config(0),
+        m_has_solver(false) {
+        updt_memo(p);
+        updt_parallel(p);
     }
     expr_ref mk_app(func_decl* f, unsigned sz, expr* const* args) {
         return m_cfg.mk_app(f, sz, args);
@@ -803,6 +1008,76 @@ struct th_rewriter::imp : public rewriter_tpl<th_rewriter_cfg> {
 
     void set_solver(expr_solver* solver) {
         m_cfg.m_seq_rw.set_solver(solver);
+        m_has_solver = solver != nullptr;
+        sync_memo();
+    }
+
+    /**
+       \brief Rewriters with the same parameters share the memo of the manager.
+       The parameters of the rewriter module are part of the fingerprint,
+       since they provide the defaults of the parameters in \c p.
+    */
+    void updt_memo(params_ref const & p) {
+        rewriter_params rp(p);
+        m_shared_memo = nullptr;
+        if (rp.memo() && !m().proofs_enabled()) {
+            std::ostringstream strm;
+            p.display(strm);
+            strm << "|";
+            gparams::get_module("rewriter").display(strm);
+            m_shared_memo = &rewriter_memo::get(m());
+            m_shared_memo->set_capacity(rp.memo_size());
+            m_shared_config = m_shared_memo->get_config(strm.str());
+        }
+        sync_memo();
+    }
+
+    // results depend on the substitution and the solver, they are not shared.
+    void sync_memo() {
+        bool enabled = m_shared_memo && !m_cfg.m_subst && !m_has_solver;
+        set_memo(enabled ? m_shared_memo : nullptr, m_shared_config);
+    }
+
+    void updt_parallel(params_ref const & p) {
+        rewriter_params rp(p);
+        m_threads = rp.threads();
+        m_threads_min_size = rp.threads_min_size();
+    }
+
+    /**
+       \brief Rewrite \c t using worker threads for its large subterms.
+       Return false if \c t is rewritten sequentially.
+    */
+    bool rewrite_parallel(expr * t, params_ref const & p, expr_ref & result) {
+#ifdef SINGLE_THREAD
+        return false;
+#else
+        if (m_threads <= 1 || m_cfg.m_subst || m_has_solver || m().proofs_enabled() ||
+            m().has_trace_stream() || !m_bindings.empty())
+            return false;
+        parallel_rewriter prw(m(), p, m_threads);
+        if (!prw.split(t, m_threads_min_size))
+            return false;
+        expr_substitution sub(m());
+        prw(sub);
+        // the results of the workers are used for the chunks, the main
+        // rewriter only simplifies the terms above them.
+        m_cfg.set_substitution(&sub);
+        sync_memo();
+        try {
+            operator()(t, result);
+        }
+        catch (...) {
+            m_cfg.reset();
+            rewriter_tpl<th_rewriter_cfg>::reset();
+            sync_memo();
+            throw;
+        }
+        m_cfg.reset();
+        rewriter_tpl<th_rewriter_cfg>::reset();
+        sync_memo();
+        return true;
+#endif
     }
 };
 
@@ -818,6 +1093,8 @@ ast_manager & th_rewriter::m() const {
 void th_rewriter::updt_params(params_ref const & p) {
     m_params = p;
     m_imp->cfg().updt_params(p);
+    m_imp->updt_memo(p);
+    m_imp->updt_parallel(p);
 }
 
 void th_rewriter::get_param_descrs(param_descrs & r) {
@@ -850,16 +1127,18 @@ void th_rewriter::cleanup() {
 void th_rewriter::reset() {
     m_imp->reset();
     m_imp->cfg().reset();
+    m_imp->sync_memo();
 }
 
 void th_rewriter::operator()(expr_ref & term) {
     expr_ref result(term.get_manager());
-    m_imp->operator()(term, result);
+    operator()(term, result);
     term = std::move(result);
 }
 
 void th_rewriter::operator()(expr * t, expr_ref & result) {
-    m_imp->operator()(t, result);
+    if (!m_imp->rewrite_parallel(t, m_params, result))
+        m_imp->operator()(t, result);
 }
 
 void th_rewriter::operator()(expr * t, expr_ref & result, proof_ref & result_pr) {
@@ -873,6 +1152,7 @@ expr_ref th_rewriter::operator()(expr * n, unsigned num_bindings, expr * const *
 void th_rewriter::set_substitution(expr_substitution * s) {
     m_imp->reset(); // reset the cache
     m_imp->cfg().set_substitution(s);
+    m_imp->sync_memo();
 }
 
 expr_dependency * th_rewriter::get_used_dependencies() {
@@ -894,6 +1174,12 @@ void th_rewriter::set_solver(expr_solver* solver) {
     m_imp->set_solver(solver);
 }
 
+void th_rewriter::collect_statistics(statistics & st) const {
+    rewriter_memo * memo = rewriter_memo::find(m());
+    if (memo)
+        memo->collect_statistics(st);
+}
+
 
 bool th_rewriter::reduce_quantifier(quantifier * old_q, 
                                     expr * new_body, 
@@ -22,6 +22,7 @@ Notes:
 #include "ast/ast.h"
 #include "ast/rewriter/rewriter_types.h"
 #include "util/params.h"
+#include "util/statistics.h"
 
 class expr_substitution;
 
@@ -70,6 +71,11 @@ public:
 
     void set_solver(expr_solver* solver);
 
+    /**
+       \brief Statistics of the memo shared by the rewriters of the manager (see rewriter.memo).
+    */
+    void collect_statistics(statistics & st) const;
+
 };
 
 #endif
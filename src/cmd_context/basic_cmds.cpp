@@ -22,6 +22,8 @@ Notes:
 #include "ast/ast_smt2_pp.h"
 #include "ast/ast_pp_dot.h"
 #include "ast/ast_pp.h"
+#include "ast/ast_binary.h"
+#include "ast/decl_collector.h"
 #include "ast/array_decl_plugin.h"
 #include "ast/pp.h"
 #include "ast/well_sorted.h"
@@ -305,6 +307,34 @@ UNARY_CMD(echo_cmd, "echo", "<string>", "display the given string", CPK_STRING,
     bool smt2c = ctx.params().m_smtlib2_compliant;
     ctx.regular_stream() << (smt2c ? "\"" : "") << arg << (smt2c ? "\"" : "") << std::endl;);
 
+UNARY_CMD(save_binary_cmd, "save-binary", "<string>", "save the assertions to the given file in binary format.", CPK_STRING, char const *, {
+    std::ofstream out(arg, std::ios::binary);
+    if (!out)
+        throw cmd_exception("could not open file ", symbol(arg));
+    ast_binary_write(ctx.m(), out, ctx.assertions().size(), ctx.assertions().c_ptr());
+    if (!out)
+        throw cmd_exception("could not write file ", symbol(arg));
+    ctx.print_success();
+});
+
+UNARY_CMD(load_binary_cmd, "load-binary", "<string>", "assert the formulas saved in the given file by save-binary.", CPK_STRING, char const *, {
+    expr_ref_vector fmls(ctx.m());
+    ast_binary_read_file(ctx.m(), arg, fmls);
+    // declare the uninterpreted sorts and functions that are not declared yet.
+    decl_collector dc(ctx.m());
+    for (expr * e : fmls)
+        dc.visit(e);
+    for (sort * s : dc.get_sorts())
+        if (s->get_family_id() == null_family_id && !ctx.find_psort_decl(s->get_name()))
+            ctx.insert(ctx.pm().mk_psort_user_decl(0, s->get_name(), ctx.pm().mk_psort_cnst(s)));
+    for (func_decl * f : dc.get_func_decls())
+        if (!ctx.is_func_decl(f->get_name()))
+            ctx.insert(f);
+    for (expr * e : fmls)
+        ctx.assert_expr(e);
+    ctx.print_success();
+});
+
 
 class set_get_option_cmd : public cmd {
 protected:
@@ -897,6 +927,8 @@ void install_ext_basic_cmds(cmd_context & ctx) {
     ctx.insert(alloc(pp_cmd));
     ctx.insert(alloc(get_model_cmd));
     ctx.insert(alloc(echo_cmd));
+    ctx.insert(alloc(save_binary_cmd));
+    ctx.insert(alloc(load_binary_cmd));
     ctx.insert(alloc(labels_cmd));
     ctx.insert(alloc(declare_map_cmd));
     ctx.insert(alloc(builtin_cmd, "reset", nullptr, "reset the shell (all declarations and assertions will be erased)"));
@@ -35,6 +35,7 @@ public:
     std::string m_dot_proof_file;
     bool        m_interpolants;
     bool        m_debug_ref_count;
+    bool        m_ast_arena;
     bool        m_trace;
     std::string m_trace_file_name;
     bool        m_well_sorted_check;
@@ -26,6 +26,9 @@ namespace dd {
     pdd_manager::pdd_manager(unsigned num_vars, semantics s) {
         m_spare_entry = nullptr;
         m_max_num_nodes = 1 << 24; // up to 16M nodes
+        m_op_cache_limit = 1 << 16;
+        m_op_cache_hits = 0;
+        m_op_cache_misses = 0;
         m_mark_level = 0;
         m_dmark_level = 0;
         m_disable_gc = false;
@@ -91,6 +94,29 @@ namespace dd {
             m_alloc.deallocate(sizeof(*e), e);
         }
         m_op_cache.reset();
+        m_op_cache_hits = 0;
+        m_op_cache_misses = 0;
+    }
+
+    /**
+       \brief bound the size of the operation cache.
+       The cache is only resized between top-level operations, when it contains no pending entries.
+       If the cache pays off (more than a quarter of the lookups hit) its limit is doubled,
+       otherwise it is flushed and refilled with entries of the current working set.
+    */
+    void pdd_manager::resize_op_cache() {
+        if (m_op_cache.size() <= m_op_cache_limit) 
+            return;
+        if (m_op_cache_hits > m_op_cache_misses / 3 && m_op_cache_limit < m_max_num_nodes) {
+            m_op_cache_limit *= 2;
+            m_stats.m_op_cache_grows++;
+            m_op_cache_hits = 0;
+            m_op_cache_misses = 0;
+        }
+        else {
+            reset_op_cache();
+            m_stats.m_op_cache_resets++;
+        }
     }
 
     pdd pdd_manager::add(pdd const& a, pdd const& b) { return pdd(apply(a.root, b.root, pdd_add_op), this); }
@@ -125,6 +151,7 @@ namespace dd {
     pdd_manager::PDD pdd_manager::apply(PDD arg1, PDD arg2, pdd_op op) {
         bool first = true;
         SASSERT(well_formed());
+        resize_op_cache();
         scoped_push _sp(*this);
         while (true) {
             try {
@@ -145,9 +172,13 @@ namespace dd {
             SASSERT(e2->m_result != null_pdd);
             push_entry(e1);
             e1 = nullptr;
+            m_op_cache_hits++;
+            m_stats.m_op_cache_hits++;
             return true;            
         }
         else {
+            m_op_cache_misses++;
+            m_stats.m_op_cache_misses++;
             e1->m_pdd1 = a;
             e1->m_pdd2 = b;
             e1->m_op = c;
@@ -358,6 +389,7 @@ namespace dd {
         }
         bool first = true;
         SASSERT(well_formed());
+        resize_op_cache();
         scoped_push _sp(*this);
         while (true) {
             try {
@@ -783,7 +815,10 @@ namespace dd {
             e = m_node_table.insert_if_not_there2(n);
             e->get_data().m_refcount = 0;      
         }
-        if (do_gc) {
+        // grow the node table only if garbage collection reclaimed less than a quarter of it.
+        // Otherwise keep allocating from the freed nodes, lowest index first, so that
+        // the live nodes stay clustered at the front of m_nodes.
+        if (do_gc && m_free_nodes.size() < m_nodes.size() / 4) {
             if (m_nodes.size() > m_max_num_nodes) {
                 throw mem_out();
             }
@@ -799,6 +834,7 @@ namespace dd {
         m_nodes[result] = e->get_data();
         SASSERT(well_formed(m_nodes[result]));
         m_is_new_node = true;        
+        m_stats.m_nodes_allocated++;
         SASSERT(!m_free_nodes.contains(result));
         SASSERT(m_nodes[result].m_index == result); 
         return result;
@@ -994,6 +1030,7 @@ namespace dd {
         m_free_nodes.reset();
         SASSERT(well_formed());
         IF_VERBOSE(13, verbose_stream() << "(pdd :gc " << m_nodes.size() << ")\n";);
+        m_stats.m_num_gc++;
         bool_vector reachable(m_nodes.size(), false);
         compute_reachable(reachable);
         for (unsigned i = m_nodes.size(); i-- > pdd_no_op; ) {
@@ -1040,6 +1077,16 @@ namespace dd {
         SASSERT(well_formed());
     }
 
+    void pdd_manager::collect_statistics(statistics& st) const {
+        st.update("dd.pdd.nodes", m_nodes.size());
+        st.update("dd.pdd.nodes allocated", m_stats.m_nodes_allocated);
+        st.update("dd.pdd.gc", m_stats.m_num_gc);
+        st.update("dd.pdd.op cache hits", m_stats.m_op_cache_hits);
+        st.update("dd.pdd.op cache misses", m_stats.m_op_cache_misses);
+        st.update("dd.pdd.op cache grows", m_stats.m_op_cache_grows);
+        st.update("dd.pdd.op cache resets", m_stats.m_op_cache_resets);
+    }
+
     void pdd_manager::init_mark() {
         m_mark.resize(m_nodes.size());
         ++m_mark_level;
@@ -23,6 +23,9 @@ Abstract:
 
     - try_spoly(a, b, c) returns true if lt(a) and lt(b) have a non-trivial overlap. c is the resolvent (S polynomial).
 
+    A pdd_manager and its pdds are used by a single thread: the node table, the op cache
+    and garbage collection are not synchronized.
+
 Author:
 
     Nikolaj Bjorner (nbjorner) 2019-12-17
@@ -35,6 +38,8 @@ Author:
 #include "util/map.h"
 #include "util/small_object_allocator.h"
 #include "util/rational.h"
+#include "util/statistics.h"
+#include <cstring>
 
 namespace dd {
     class test;
@@ -135,12 +140,23 @@ namespace dd {
 
         struct eq_entry {
             bool operator()(op_entry * a, op_entry * b) const { 
-                return a->m_pdd1 == b->m_pdd2 && a->m_pdd2 == b->m_pdd2 && a->m_op == b->m_op;
+                return a->m_pdd1 == b->m_pdd1 && a->m_pdd2 == b->m_pdd2 && a->m_op == b->m_op;
             }
         };
 
         typedef ptr_hashtable<op_entry, hash_entry, eq_entry> op_table;
 
+        struct stats {
+            unsigned m_op_cache_hits;
+            unsigned m_op_cache_misses;
+            unsigned m_op_cache_resets;
+            unsigned m_op_cache_grows;
+            unsigned m_num_gc;
+            unsigned m_nodes_allocated;
+            stats() { reset(); }
+            void reset() { memset(this, 0, sizeof(*this)); }
+        };
+
         svector<node>          m_nodes;
         vector<rational>           m_values;
         op_table                   m_op_cache;
@@ -160,12 +176,17 @@ namespace dd {
         bool                       m_disable_gc;
         bool                       m_is_new_node;
         unsigned                   m_max_num_nodes;
+        unsigned                   m_op_cache_limit;
+        unsigned                   m_op_cache_hits;   // hits since the last cache sizing decision
+        unsigned                   m_op_cache_misses; // misses since the last cache sizing decision
+        stats                      m_stats;
         semantics                  m_semantics;
         unsigned_vector            m_free_vars;
         unsigned_vector            m_free_values;
         rational                   m_freeze_value;
 
         void reset_op_cache();
+        void resize_op_cache();
         void init_nodes(unsigned_vector const& l2v);
         void init_vars(unsigned_vector const& l2v);
 
@@ -260,6 +281,9 @@ namespace dd {
 
         void reset(unsigned_vector const& level2var);
         void set_max_num_nodes(unsigned n) { m_max_num_nodes = n; }
+        void set_op_cache_limit(unsigned n) { m_op_cache_limit = n; }
+        unsigned num_nodes() const { return m_nodes.size(); }
+        unsigned op_cache_size() const { return m_op_cache.size(); }
         unsigned_vector const& get_level2var() const { return m_level2var; }
 
         pdd mk_var(unsigned i);
@@ -307,6 +331,9 @@ namespace dd {
         std::ostream& display(std::ostream& out, pdd const& b);
 
         void gc();
+
+        void collect_statistics(statistics& st) const;
+        void reset_statistics() { m_stats.reset(); }
     };
 
     class pdd {
@@ -0,0 +1,398 @@
+/*++
+Copyright (c) 2020 Microsoft Corporation
+
+Module Name:
+
+    bv_word_domain.cpp
+
+Abstract:
+
+    Abstract values of bit-vectors for word-level propagation.
+
+--*/
+
+#include "smt/bv_word_domain.h"
+
+bv_word_domain::bv_word_domain(unsigned sz):
+    m_sz(sz),
+    m_lo(0),
+    m_hi(rational::power_of_two(sz) - rational::one()),
+    m_bits(sz, l_undef) {
+}
+
+bv_word_domain bv_word_domain::mk_value(unsigned sz, rational const & v) {
+    bv_word_domain r(sz);
+    r.intersect(v, v);
+    r.reduce();
+    return r;
+}
+
+bool bv_word_domain::is_full() const {
+    if (!m_lo.is_zero() || m_hi != max_value())
+        return false;
+    for (lbool b : m_bits)
+        if (b != l_undef)
+            return false;
+    return true;
+}
+
+void bv_word_domain::to_bits(unsigned sz, rational r, svector<bool> & bits) {
+    rational two(2);
+    bits.reset();
+    for (unsigned i = 0; i < sz; ++i) {
+        bits.push_back(!r.is_even());
+        r = div(r, two);
+    }
+}
+
+rational bv_word_domain::from_bits(svector<bool> const & bits) {
+    rational r(0);
+    for (unsigned i = bits.size(); i-- > 0; ) {
+        r *= rational(2);
+        if (bits[i])
+            r += rational::one();
+    }
+    return r;
+}
+
+void bv_word_domain::set_bit(unsigned i, bool val) {
+    lbool b = val ? l_true : l_false;
+    if (m_bits[i] == l_undef)
+        m_bits[i] = b;
+    else if (m_bits[i] != b)
+        set_empty();
+}
+
+void bv_word_domain::intersect(rational const & lo, rational const & hi) {
+    if (lo > m_lo)
+        m_lo = lo;
+    if (hi < m_hi)
+        m_hi = hi;
+}
+
+void bv_word_domain::intersect(bv_word_domain const & other) {
+    SASSERT(m_sz == other.m_sz);
+    if (other.is_empty()) {
+        set_empty();
+        return;
+    }
+    intersect(other.m_lo, other.m_hi);
+    for (unsigned i = 0; i < m_sz; ++i)
+        if (other.m_bits[i] != l_undef)
+            set_bit(i, other.m_bits[i] == l_true);
+}
+
+/**
+   \brief raise the lower bound to the least value that agrees with the known bits.
+   Return true if the lower bound changed.
+*/
+bool bv_word_domain::tighten_lo() {
+    svector<bool> lo;
+    to_bits(m_sz, m_lo, lo);
+    unsigned i = m_sz;
+    while (i > 0 && (m_bits[i - 1] == l_undef || (m_bits[i - 1] == l_true) == lo[i - 1]))
+        --i;
+    if (i == 0)
+        return false;
+    --i;
+    if (m_bits[i] == l_false) {
+        // the prefix above i must increase at an unknown zero position
+        unsigned j = i + 1;
+        while (j < m_sz && (m_bits[j] != l_undef || lo[j]))
+            ++j;
+        if (j == m_sz) {
+            set_empty();
+            return true;
+        }
+        i = j;
+    }
+    lo[i] = true;
+    for (unsigned k = 0; k < i; ++k)
+        lo[k] = m_bits[k] == l_true;
+    m_lo = from_bits(lo);
+    return true;
+}
+
+/**
+   \brief lower the upper bound to the greatest value that agrees with the known bits.
+   Return true if the upper bound changed.
+*/
+bool bv_word_domain::tighten_hi() {
+    svector<bool> hi;
+    to_bits(m_sz, m_hi, hi);
+    unsigned i = m_sz;
+    while (i > 0 && (m_bits[i - 1] == l_undef || (m_bits[i - 1] == l_true) == hi[i - 1]))
+        --i;
+    if (i == 0)
+        return false;
+    --i;
+    if (m_bits[i] == l_true) {
+        // the prefix above i must decrease at an unknown one position
+        unsigned j = i + 1;
+        while (j < m_sz && (m_bits[j] != l_undef || !hi[j]))
+            ++j;
+        if (j == m_sz) {
+            set_empty();
+            return true;
+        }
+        i = j;
+    }
+    hi[i] = false;
+    for (unsigned k = 0; k < i; ++k)
+        hi[k] = m_bits[k] != l_false;
+    m_hi = from_bits(hi);
+    return true;
+}
+
+/**
+   \brief the bits shared by the prefixes of both bounds are known.
+*/
+bool bv_word_domain::fix_prefix() {
+    svector<bool> lo, hi;
+    to_bits(m_sz, m_lo, lo);
+    to_bits(m_sz, m_hi, hi);
+    bool changed = false;
+    for (unsigned i = m_sz; i-- > 0 && lo[i] == hi[i]; ) {
+        if (m_bits[i] == l_undef) {
+            m_bits[i] = lo[i] ? l_true : l_false;
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+void bv_word_domain::reduce() {
+    while (!is_empty()) {
+        bool changed = tighten_lo();
+        if (is_empty())
+            return;
+        changed |= tighten_hi();
+        if (is_empty())
+            return;
+        changed |= fix_prefix();
+        if (!changed)
+            return;
+    }
+}
+
+unsigned bv_word_domain::trailing_zeros() const {
+    unsigned k = 0;
+    while (k < m_sz && m_bits[k] == l_false)
+        ++k;
+    return k;
+}
+
+unsigned bv_word_domain::known_low() const {
+    unsigned k = 0;
+    while (k < m_sz && m_bits[k] != l_undef)
+        ++k;
+    return k;
+}
+
+rational bv_word_domain::low_value(unsigned k) const {
+    rational r(0), p(1);
+    for (unsigned i = 0; i < k; ++i, p *= rational(2))
+        if (m_bits[i] == l_true)
+            r += p;
+    return r;
+}
+
+bv_word_domain bv_word_domain::mk_add(bv_word_domain const & a, bv_word_domain const & b) {
+    SASSERT(a.m_sz == b.m_sz);
+    bv_word_domain r(a.m_sz);
+    if (a.is_empty() || b.is_empty()) {
+        r.set_empty();
+        return r;
+    }
+    // the sum wraps around for all or for none of the values in the intervals
+    rational n = rational::power_of_two(a.m_sz);
+    rational lo = a.m_lo + b.m_lo, hi = a.m_hi + b.m_hi;
+    if (hi < n)
+        r.intersect(lo, hi);
+    else if (lo >= n)
+        r.intersect(lo - n, hi - n);
+    // ripple the known bits and carries
+    lbool c = l_false;
+    for (unsigned i = 0; i < a.m_sz; ++i) {
+        lbool x = a.m_bits[i], y = b.m_bits[i];
+        if (x != l_undef && y != l_undef && c != l_undef)
+            r.set_bit(i, ((x == l_true) != (y == l_true)) != (c == l_true));
+        unsigned ones  = (x == l_true) + (y == l_true) + (c == l_true);
+        unsigned zeros = (x == l_false) + (y == l_false) + (c == l_false);
+        c = ones >= 2 ? l_true : (zeros >= 2 ? l_false : l_undef);
+    }
+    r.reduce();
+    return r;
+}
+
+bv_word_domain bv_word_domain::mk_and(bv_word_domain const & a, bv_word_domain const & b) {
+    SASSERT(a.m_sz == b.m_sz);
+    bv_word_domain r(a.m_sz);
+    if (a.is_empty() || b.is_empty()) {
+        r.set_empty();
+        return r;
+    }
+    r.intersect(rational::zero(), a.m_hi < b.m_hi ? a.m_hi : b.m_hi);
+    for (unsigned i = 0; i < a.m_sz; ++i) {
+        if (a.m_bits[i] == l_false || b.m_bits[i] == l_false)
+            r.set_bit(i, false);
+        else if (a.m_bits[i] == l_true && b.m_bits[i] == l_true)
+            r.set_bit(i, true);
+    }
+    r.reduce();
+    return r;
+}
+
+bv_word_domain bv_word_domain::mk_mul(bv_word_domain const & a, bv_word_domain const & b) {
+    SASSERT(a.m_sz == b.m_sz);
+    unsigned sz = a.m_sz;
+    bv_word_domain r(sz);
+    if (a.is_empty() || b.is_empty()) {
+        r.set_empty();
+        return r;
+    }
+    if (a.m_hi * b.m_hi < rational::power_of_two(sz))
+        r.intersect(a.m_lo * b.m_lo, a.m_hi * b.m_hi);
+    // the low bits of the product only depend on the low bits of the factors
+    unsigned tz = std::min(sz, a.trailing_zeros() + b.trailing_zeros());
+    for (unsigned i = 0; i < tz; ++i)
+        r.set_bit(i, false);
+    unsigned k = std::min(a.known_low(), b.known_low());
+    rational p = mod(a.low_value(k) * b.low_value(k), rational::power_of_two(k));
+    bv_word_domain low = mk_value(k, p);
+    for (unsigned i = 0; i < k; ++i)
+        r.set_bit(i, low.m_bits[i] == l_true);
+    r.reduce();
+    return r;
+}
+
+/**
+   \brief quotient of bvudiv_i. Division by zero is left unconstrained.
+*/
+bv_word_domain bv_word_domain::mk_udiv(bv_word_domain const & a, bv_word_domain const & b) {
+    SASSERT(a.m_sz == b.m_sz);
+    bv_word_domain r(a.m_sz);
+    if (a.is_empty() || b.is_empty()) {
+        r.set_empty();
+        return r;
+    }
+    if (b.m_lo.is_pos())
+        r.intersect(div(a.m_lo, b.m_hi), div(a.m_hi, b.m_lo));
+    r.reduce();
+    return r;
+}
+
+/**
+   \brief remainder of bvurem_i. Division by zero is left unconstrained.
+*/
+bv_word_domain bv_word_domain::mk_urem(bv_word_domain const & a, bv_word_domain const & b) {
+    SASSERT(a.m_sz == b.m_sz);
+    bv_word_domain r(a.m_sz);
+    if (a.is_empty() || b.is_empty()) {
+        r.set_empty();
+        return r;
+    }
+    if (b.m_lo.is_pos()) {
+        if (a.m_hi < b.m_lo)
+            return a;
+        rational hi = b.m_hi - rational::one();
+        r.intersect(rational::zero(), a.m_hi < hi ? a.m_hi : hi);
+    }
+    r.reduce();
+    return r;
+}
+
+bv_word_domain bv_word_domain::mk_shl(bv_word_domain const & a, bv_word_domain const & s) {
+    SASSERT(a.m_sz == s.m_sz);
+    unsigned sz = a.m_sz;
+    bv_word_domain r(sz);
+    if (a.is_empty() || s.is_empty()) {
+        r.set_empty();
+        return r;
+    }
+    if (s.m_lo >= rational(sz))
+        return mk_value(sz, rational::zero());
+    unsigned lo_k = s.m_lo.get_unsigned();
+    unsigned tz = std::min(sz, a.trailing_zeros() + lo_k);
+    for (unsigned i = 0; i < tz; ++i)
+        r.set_bit(i, false);
+    if (s.m_hi < rational(sz)) {
+        unsigned hi_k = s.m_hi.get_unsigned();
+        if (a.m_hi * rational::power_of_two(hi_k) < rational::power_of_two(sz))
+            r.intersect(a.m_lo * rational::power_of_two(lo_k), a.m_hi * rational::power_of_two(hi_k));
+    }
+    if (s.is_fixed())
+        for (unsigned i = lo_k; i < sz; ++i)
+            if (a.m_bits[i - lo_k] != l_undef)
+                r.set_bit(i, a.m_bits[i - lo_k] == l_true);
+    r.reduce();
+    return r;
+}
+
+bv_word_domain bv_word_domain::mk_lshr(bv_word_domain const & a, bv_word_domain const & s) {
+    SASSERT(a.m_sz == s.m_sz);
+    unsigned sz = a.m_sz;
+    bv_word_domain r(sz);
+    if (a.is_empty() || s.is_empty()) {
+        r.set_empty();
+        return r;
+    }
+    if (s.m_lo >= rational(sz))
+        return mk_value(sz, rational::zero());
+    unsigned lo_k = s.m_lo.get_unsigned();
+    rational lo(0);
+    if (s.m_hi < rational(sz))
+        lo = div(a.m_lo, rational::power_of_two(s.m_hi.get_unsigned()));
+    r.intersect(lo, div(a.m_hi, rational::power_of_two(lo_k)));
+    if (s.is_fixed())
+        for (unsigned i = 0; i + lo_k < sz; ++i)
+            if (a.m_bits[i + lo_k] != l_undef)
+                r.set_bit(i, a.m_bits[i + lo_k] == l_true);
+    r.reduce();
+    return r;
+}
+
+bv_word_domain bv_word_domain::mk_concat(bv_word_domain const & hi, bv_word_domain const & lo) {
+    bv_word_domain r(hi.m_sz + lo.m_sz);
+    if (hi.is_empty() || lo.is_empty()) {
+        r.set_empty();
+        return r;
+    }
+    rational p = rational::power_of_two(lo.m_sz);
+    r.intersect(hi.m_lo * p + lo.m_lo, hi.m_hi * p + lo.m_hi);
+    for (unsigned i = 0; i < r.m_sz; ++i) {
+        lbool b = i < lo.m_sz ? lo.m_bits[i] : hi.m_bits[i - lo.m_sz];
+        if (b != l_undef)
+            r.set_bit(i, b == l_true);
+    }
+    r.reduce();
+    return r;
+}
+
+bv_word_domain bv_word_domain::mk_extract(bv_word_domain const & a, unsigned high, unsigned low) {
+    SASSERT(low <= high && high < a.m_sz);
+    bv_word_domain r(high - low + 1);
+    if (a.is_empty()) {
+        r.set_empty();
+        return r;
+    }
+    // the interval survives when no high bits are cut off
+    if (a.m_hi < rational::power_of_two(high + 1)) {
+        rational p = rational::power_of_two(low);
+        r.intersect(div(a.m_lo, p), div(a.m_hi, p));
+    }
+    for (unsigned i = low; i <= high; ++i)
+        if (a.m_bits[i] != l_undef)
+            r.set_bit(i - low, a.m_bits[i] == l_true);
+    r.reduce();
+    return r;
+}
+
+std::ostream & bv_word_domain::display(std::ostream & out) const {
+    if (is_empty())
+        return out << "empty";
+    out << "[" << m_lo << ", " << m_hi << "] ";
+    for (unsigned i = m_sz; i-- > 0; )
+        out << (m_bits[i] == l_true ? '1' : (m_bits[i] == l_false ? '0' : '?'));
+    return out;
+}
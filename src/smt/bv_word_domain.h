@@ -0,0 +1,79 @@
+/*++
+Copyright (c) 2020 Microsoft Corporation
+
+Module Name:
+
+    bv_word_domain.h
+
+Abstract:
+
+    Abstract values of bit-vectors for word-level propagation.
+
+    A value is the reduced product of known bits and an unsigned
+    interval [lo, hi]: the interval bounds are tightened to the nearest
+    values that agree with the known bits, and the bits shared by both
+    bounds become known. Transfer functions over-approximate the results
+    of bit-vector operations on abstract arguments.
+
+--*/
+#pragma once
+
+#include "util/rational.h"
+#include "util/lbool.h"
+#include "util/vector.h"
+
+class bv_word_domain {
+    unsigned       m_sz;
+    rational       m_lo;
+    rational       m_hi;
+    svector<lbool> m_bits;
+
+    rational max_value() const { return rational::power_of_two(m_sz) - rational::one(); }
+    static void to_bits(unsigned sz, rational r, svector<bool> & bits);
+    static rational from_bits(svector<bool> const & bits);
+    bool tighten_lo();
+    bool tighten_hi();
+    bool fix_prefix();
+    void set_empty() { m_lo = rational::one(); m_hi = rational::zero(); }
+    unsigned trailing_zeros() const;
+    unsigned known_low() const;
+    rational low_value(unsigned k) const;
+
+public:
+    bv_word_domain(unsigned sz);
+
+    static bv_word_domain mk_value(unsigned sz, rational const & v);
+
+    unsigned size() const { return m_sz; }
+    rational const & lo() const { return m_lo; }
+    rational const & hi() const { return m_hi; }
+    lbool bit(unsigned i) const { return m_bits[i]; }
+    bool is_empty() const { return m_lo > m_hi; }
+    bool is_fixed() const { return m_lo == m_hi; }
+    bool is_full() const;
+
+    void set_bit(unsigned i, bool val);
+    void intersect(rational const & lo, rational const & hi);
+    void intersect(bv_word_domain const & other);
+
+    /**
+       \brief tighten the interval and the known bits against each other.
+    */
+    void reduce();
+
+    static bv_word_domain mk_add(bv_word_domain const & a, bv_word_domain const & b);
+    static bv_word_domain mk_and(bv_word_domain const & a, bv_word_domain const & b);
+    static bv_word_domain mk_mul(bv_word_domain const & a, bv_word_domain const & b);
+    static bv_word_domain mk_udiv(bv_word_domain const & a, bv_word_domain const & b);
+    static bv_word_domain mk_urem(bv_word_domain const & a, bv_word_domain const & b);
+    static bv_word_domain mk_shl(bv_word_domain const & a, bv_word_domain const & s);
+    static bv_word_domain mk_lshr(bv_word_domain const & a, bv_word_domain const & s);
+    static bv_word_domain mk_concat(bv_word_domain const & hi, bv_word_domain const & lo);
+    static bv_word_domain mk_extract(bv_word_domain const & a, unsigned high, unsigned low);
+
+    std::ostream & display(std::ostream & out) const;
+};
+
+inline std::ostream & operator<<(std::ostream & out, bv_word_domain const & d) {
+    return d.display(out);
+}
@@ -127,12 +127,16 @@ class dl_graph {
         unsigned m_num_implied_literals;
         unsigned m_num_helpful_implied_literals;
         unsigned m_num_relax;
+        unsigned m_num_batch_passes;
+        unsigned m_num_batch_fallbacks;
         void reset() {
             m_propagation_cost     = 0;
             m_implied_literal_cost = 0;
             m_num_implied_literals = 0;
             m_num_helpful_implied_literals = 0;
             m_num_relax = 0;
+            m_num_batch_passes = 0;
+            m_num_batch_fallbacks = 0;
         }
         stats() { reset(); }
         void collect_statistics(::statistics& st) const {
@@ -141,6 +145,8 @@ class dl_graph {
             st.update("dl impl lits",  m_num_implied_literals);
             st.update("dl impl conf lits", m_num_helpful_implied_literals);
             st.update("dl bound relax", m_num_relax);
+            st.update("dl batch passes", m_num_batch_passes);
+            st.update("dl batch fallbacks", m_num_batch_fallbacks);
         }
     };
     stats m_stats;
@@ -198,6 +204,7 @@ class dl_graph {
     svector<char>           m_mark;     // per var
     edge_id_vector          m_parent;   // per var
     dl_var_vector           m_visited; 
+    dl_var_vector           m_gr_order; // scan order of enable_edges
     typedef heap<dl_var_lt<Ext> > var_heap;
     var_heap                m_heap;
 
@@ -433,6 +440,106 @@ private:
         }
     }
 
+    // Store in m_gr_order the variables reachable from roots through edges with non-positive
+    // normalized weight (the admissible edges), in topological order. Cycles of edges
+    // with zero normalized weight are ignored. Return false if the admissible edges
+    // contain a cycle with a negative edge, which is then a negative cycle of the graph.
+    // The cycle is closed by the edge cycle_edge and m_parent links its other edges.
+    bool gr_topological_sort(dl_var_vector const& roots, edge_id & cycle_edge) {
+        SASSERT(m_visited.empty());
+        m_gr_order.reset();
+        numeral gamma;
+        struct frame {
+            dl_var   m_var;
+            edge_id  m_edge; // the edge entering m_var
+            unsigned m_idx;
+            bool     m_neg;  // m_edge has negative normalized weight
+            frame(dl_var v, edge_id e, bool neg): m_var(v), m_edge(e), m_idx(0), m_neg(neg) {}
+        };
+        svector<frame> stack;
+        for (dl_var r : roots) {
+            if (m_mark[r] != DL_UNMARKED) {
+                continue;
+            }
+            m_mark[r] = DL_FOUND;
+            m_visited.push_back(r);
+            stack.push_back(frame(r, null_edge_id, false));
+            while (!stack.empty()) {
+                ++m_stats.m_propagation_cost;
+                frame & f = stack.back();
+                edge_id_vector const& out = m_out_edges[f.m_var];
+                dl_var w = -1;
+                edge_id w_edge = null_edge_id;
+                bool neg = false;
+                while (f.m_idx < out.size()) {
+                    w_edge = out[f.m_idx++];
+                    edge const& e = m_edges[w_edge];
+                    if (!e.is_enabled() || set_gamma(e, gamma).is_pos()) {
+                        continue;
+                    }
+                    neg = gamma.is_neg();
+                    if (m_mark[e.get_target()] == DL_PROCESSED) {
+                        continue;
+                    }
+                    if (m_mark[e.get_target()] == DL_FOUND) {
+                        // back edge: the cycle is negative if one of its edges is negative.
+                        unsigned i = stack.size();
+                        while (!neg && i-- > 0 && stack[i].m_var != e.get_target()) {
+                            neg = stack[i].m_neg;
+                        }
+                        if (neg) {
+                            for (unsigned j = stack.size(); j-- > 0 && stack[j].m_var != e.get_target(); ) {
+                                m_parent[stack[j].m_var] = stack[j].m_edge;
+                            }
+                            m_parent[e.get_target()] = w_edge;
+                            cycle_edge = w_edge;
+                            reset_marks();
+                            return false;
+                        }
+                        continue;
+                    }
+                    w = e.get_target();
+                    break;
+                }
+                if (w == -1) {
+                    m_mark[f.m_var] = DL_PROCESSED;
+                    m_gr_order.push_back(f.m_var);
+                    stack.pop_back();
+                    continue;
+                }
+                m_mark[w] = DL_FOUND;
+                m_visited.push_back(w);
+                stack.push_back(frame(w, w_edge, neg));
+            }
+        }
+        reset_marks();
+        m_gr_order.reverse();
+        return true;
+    }
+
+    // The negative cycle through cycle_edge is linked by m_parent. Set up the state
+    // used by traverse_neg_cycle: the last enabled edge is an edge of the cycle that is
+    // infeasible in the current assignment, one exists since the weight of the cycle
+    // is negative, and the gamma of its source is the weight of the cycle.
+    void set_neg_cycle(edge_id cycle_edge) {
+        numeral weight, gamma;
+        edge_id last_id = null_edge_id;
+        edge_id e_id = cycle_edge;
+        do {
+            edge const& e = m_edges[e_id];
+            weight += e.get_weight();
+            if (last_id == null_edge_id && set_gamma(e, gamma).is_neg()) {
+                last_id = e_id;
+            }
+            e_id = m_parent[e.get_source()];
+        }
+        while (e_id != cycle_edge);
+        SASSERT(weight.is_neg());
+        SASSERT(last_id != null_edge_id);
+        m_last_enabled_edge = last_id;
+        m_gamma[m_edges[last_id].get_source()] = weight;
+    }
+
     edge const* find_relaxed_edge(edge const* e, numeral & gamma) {
         SASSERT(gamma.is_neg());
         dl_var src = e->get_source();
@@ -531,6 +638,89 @@ public:
     }
 
 
+    // Enable the edges ids[0], ..., ids[n-1] and restore feasibility with a single
+    // Goldberg-Radzik pass: each round scans the labeled variables in topological
+    // order of the edges with negative normalized weight.
+    // When the edges close a negative cycle, it is taken from the topological sort:
+    // the assignment is restored and the cycle can be extracted using traverse_neg_cycle.
+    // num_enabled is the number of edges processed.
+    // The method assumes the graph is feasible before the invocation.
+    bool enable_edges(unsigned n, edge_id const* ids, unsigned & num_enabled) {
+        SASSERT(is_feasible_dbg());
+        SASSERT(m_assignment_stack.empty());
+        unsigned enabled_lim = m_enabled_edges.size();
+        unsigned old_timestamp = m_timestamp;
+        dl_var_vector labeled;
+        uint_set is_labeled;
+        for (unsigned i = 0; i < n; ++i) {
+            edge & e = m_edges[ids[i]];
+            if (e.is_enabled()) {
+                continue;
+            }
+            e.enable(m_timestamp);
+            m_last_enabled_edge = ids[i];
+            m_timestamp++;
+            m_enabled_edges.push_back(ids[i]);
+            dl_var src = e.get_source();
+            if (!is_feasible(e) && !is_labeled.contains(src)) {
+                is_labeled.insert(src);
+                labeled.push_back(src);
+            }
+        }
+        numeral gamma;
+        unsigned num_passes = 0;
+        edge_id cycle_edge = null_edge_id;
+        num_enabled = n;
+        while (!labeled.empty()) {
+            ++m_stats.m_num_batch_passes;
+            if (!gr_topological_sort(labeled, cycle_edge)) {
+                undo_assignments();
+                set_neg_cycle(cycle_edge);
+                return false;
+            }
+            if (++num_passes > m_assignment.size()) {
+                // by the Bellman-Ford bound there is a negative cycle, but the topological sort
+                // did not meet it. Replay the edges incrementally to obtain an explanation.
+                ++m_stats.m_num_batch_fallbacks;
+                undo_assignments();
+                for (unsigned i = m_enabled_edges.size(); i > enabled_lim; ) {
+                    --i;
+                    m_edges[m_enabled_edges[i]].disable();
+                }
+                m_enabled_edges.shrink(enabled_lim);
+                m_timestamp = old_timestamp;
+                for (unsigned i = 0; i < n; ++i) {
+                    if (!enable_edge(ids[i])) {
+                        num_enabled = i + 1;
+                        return false;
+                    }
+                }
+                return true;
+            }
+            labeled.reset();
+            is_labeled.reset();
+            for (dl_var v : m_gr_order) {
+                for (edge_id e_id : m_out_edges[v]) {
+                    edge const& e = m_edges[e_id];
+                    if (!e.is_enabled() || !set_gamma(e, gamma).is_neg()) {
+                        continue;
+                    }
+                    ++m_stats.m_propagation_cost;
+                    dl_var w = e.get_target();
+                    acc_assignment(w, gamma);
+                    if (!is_labeled.contains(w)) {
+                        is_labeled.insert(w);
+                        labeled.push_back(w);
+                    }
+                }
+            }
+        }
+        m_assignment_stack.reset();
+        SASSERT(check_invariant());
+        SASSERT(is_feasible_dbg());
+        return true;
+    }
+
     // This method should only be invoked when add_edge returns false.
     // That is, there is a negative cycle in the graph.
     // It will apply the functor f on every explanation attached to the edges
@@ -1182,6 +1372,7 @@ public:
         m_gamma             .reset();
         m_mark              .reset();
         m_parent            .reset();
+        m_gr_order          .reset();
         m_visited           .reset();
         m_heap              .reset();
         m_enabled_edges     .reset();
@@ -1383,6 +1574,37 @@ public:
         return find_shortest_path_aux(source, target, timestamp, f, false);
     }
 
+    // Find a shortest path from source to target over the enabled edges, regardless of their
+    // weights. The functor f is applied on every explanation attached to the edges in the path.
+    // Return true if the path exists, false otherwise.
+    template<typename Functor>
+    bool find_enabled_path(dl_var source, dl_var target, Functor & f) {
+        svector<bfs_elem> bfs_todo;
+        bool_vector     bfs_mark;
+        bfs_mark.resize(m_assignment.size(), false);
+        bfs_todo.push_back(bfs_elem(source, -1, null_edge_id));
+        bfs_mark[source] = true;
+        for (unsigned head = 0; head < bfs_todo.size(); ++head) {
+            dl_var v = bfs_todo[head].m_var;
+            for (edge_id e_id : m_out_edges[v]) {
+                edge const& e = m_edges[e_id];
+                if (!e.is_enabled() || bfs_mark[e.get_target()]) {
+                    continue;
+                }
+                if (e.get_target() == target) {
+                    f(e.get_explanation());
+                    for (int idx = head; bfs_todo[idx].m_edge_id != null_edge_id; idx = bfs_todo[idx].m_parent_idx) {
+                        f(m_edges[bfs_todo[idx].m_edge_id].get_explanation());
+                    }
+                    return true;
+                }
+                bfs_todo.push_back(bfs_elem(e.get_target(), head, e_id));
+                bfs_mark[e.get_target()] = true;
+            }
+        }
+        return false;
+    }
+
     template<typename Functor>
     bool find_shortest_path_aux(dl_var source, dl_var target, unsigned timestamp, Functor & f, bool zero_edge) {
         svector<bfs_elem> bfs_todo;
@@ -46,6 +46,7 @@ void smt_params::updt_local_params(params_ref const & _p) {
     m_core_validate = p.core_validate();
     m_logic = _p.get_sym("logic", m_logic);
     m_string_solver = p.string_solver();
+    m_fp_lazy = p.fp_lazy();
     if (_p.get_bool("arith.greatest_error_pivot", false))
         m_arith_pivot_strategy = ARITH_PIVOT_GREATEST_ERROR;
     else if (_p.get_bool("arith.least_error_pivot", false))
@@ -66,6 +67,7 @@ void smt_params::updt_params(params_ref const & p) {
     // theory_array_params::updt_params(p);
     theory_datatype_params::updt_params(p);
     theory_str_params::updt_params(p);
+    theory_seq_params::updt_params(p);
     updt_local_params(p);
 }
 
@@ -146,6 +148,7 @@ void smt_params::display(std::ostream & out) const {
     DISPLAY_PARAM(m_smtlib_dump_lemmas);
     DISPLAY_PARAM(m_logic);
     DISPLAY_PARAM(m_string_solver);
+    DISPLAY_PARAM(m_fp_lazy);
 
     DISPLAY_PARAM(m_profile_res_sub);
     DISPLAY_PARAM(m_display_bool_var2expr);
@@ -22,5 +22,8 @@ void theory_seq_params::updt_params(params_ref const & _p) {
     m_split_w_len = p.seq_split_w_len();
     m_seq_validate = p.seq_validate();
     m_seq_use_derivatives = p.seq_use_derivatives();
+    m_seq_regex_cache = p.seq_regex_cache();
     m_seq_use_unicode = p.seq_use_unicode();
+    m_seq_length_abstraction = p.seq_length_abstraction();
+    m_seq_bounded_length = p.seq_bounded_length();
 }
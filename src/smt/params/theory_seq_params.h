@@ -26,14 +26,20 @@ struct theory_seq_params {
     bool m_split_w_len;
     bool m_seq_validate;
     bool m_seq_use_derivatives;
+    bool m_seq_regex_cache;
     bool m_seq_use_unicode;
+    bool m_seq_length_abstraction;
+    unsigned m_seq_bounded_length;
 
 
     theory_seq_params(params_ref const & p = params_ref()):
         m_split_w_len(false),
         m_seq_validate(false),
         m_seq_use_derivatives(false),
-        m_seq_use_unicode(false)
+        m_seq_regex_cache(true),
+        m_seq_use_unicode(false),
+        m_seq_length_abstraction(false),
+        m_seq_bounded_length(4)
     {
         updt_params(p);
     }
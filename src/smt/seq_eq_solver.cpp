@@ -1149,6 +1149,26 @@ bool theory_seq::branch_variable_eq(eq const& e) {
     return found;
 }
 
+/**
+   \brief add the length bounds of e to the bounds lo, hi of a prefix.
+   has_hi is reset if e has no upper bound.
+*/
+void theory_seq::add_length_bounds(expr* e, rational& lo, rational& hi, bool& has_hi) {
+    expr_ref len = mk_len(e);
+    rational lo_e, hi_e;
+    if (m_autil.is_numeral(len, lo_e)) {
+        lo += lo_e;
+        hi += lo_e;
+        return;
+    }
+    if (lower_bound(len, lo_e))
+        lo += lo_e;
+    if (has_hi && upper_bound(len, hi_e))
+        hi += hi_e;
+    else
+        has_hi = false;
+}
+
 void theory_seq::insert_branch_start(unsigned k, unsigned s) {
     m_branch_start.insert(k, s);
     m_trail_stack.push(pop_branch(k));
@@ -1174,9 +1194,23 @@ bool theory_seq::find_branch_candidate(unsigned& start, dependency* dep, expr_re
 
     TRACE("seq", tout << mk_pp(l, m) << ": " << ctx.get_scope_level() << " - start:" << start << "\n";);
 
+    // length bounds of l and of the prefix rs[0..start)
+    bool use_len = get_fparams().m_seq_length_abstraction && has_length(l);
+    rational lo_l, hi_l, lo_p, hi_p;
+    bool has_lo_l = use_len && lower_bound(mk_len(l), lo_l);
+    bool has_hi_l = use_len && upper_bound(mk_len(l), hi_l);
+    bool has_hi_p = true;
+    if (use_len) {
+        for (unsigned j = 0; j < start && j < rs.size(); ++j) 
+            add_length_bounds(rs.get(j), lo_p, hi_p, has_hi_p);
+    }
+
     expr_ref v0(m);
     v0 = m_util.str.mk_empty(m.get_sort(l));
-    if (can_be_equal(ls.size() - 1, ls.c_ptr() + 1, rs.size(), rs.c_ptr())) {
+    if (has_lo_l && lo_l.is_pos()) {
+        ++m_stats.m_length_pruned;
+    }
+    else if (can_be_equal(ls.size() - 1, ls.c_ptr() + 1, rs.size(), rs.c_ptr())) {
         if (l_false != assume_equality(l, v0)) {
             TRACE("seq", tout << mk_pp(l, m) << " " << v0 << "\n";);
             return true;
@@ -1189,6 +1223,13 @@ bool theory_seq::find_branch_candidate(unsigned& start, dependency* dep, expr_re
         if (l == rs.get(j)) {
             return false;
         }
+        if (use_len) {
+            add_length_bounds(rs.get(j), lo_p, hi_p, has_hi_p);
+            if ((has_hi_l && lo_p > hi_l) || (has_lo_l && has_hi_p && hi_p < lo_l)) {
+                ++m_stats.m_length_pruned;
+                continue;
+            }
+        }
         if (!can_be_equal(ls.size() - 1, ls.c_ptr() + 1, rs.size() - j - 1, rs.c_ptr() + j + 1)) {
             continue;
         }
@@ -24,7 +24,10 @@ namespace smt {
     seq_regex::seq_regex(theory_seq& th):
         th(th),
         ctx(th.get_context()),
-        m(th.get_manager())
+        m(th.get_manager()),
+        m_state_trail(m),
+        m_trans_conds(m),
+        m_trans_dsts(m)
     {}
 
     seq_util& seq_regex::u() { return th.m_util; }
@@ -407,11 +410,108 @@ namespace smt {
         with optimizations for if-then-else expressions involving the head.
     */
     expr_ref seq_regex::derivative_wrapper(expr* hd, expr* r) {
-        expr_ref result = expr_ref(re().mk_derivative(hd, r), m);
-        rewrite(result);
+        if (!ctx.get_fparams().m_seq_regex_cache) {
+            expr_ref result(re().mk_derivative(hd, r), m);
+            rewrite(result);
+            return result;
+        }
+        expr_ref result(m_states[mk_state(r)].m_derivative, m);
+        if (is_var(hd) && to_var(hd)->get_idx() == 0)
+            return result;
+        if (!is_ground(result)) {
+            var_subst subst(m);
+            result = subst(result, 1, &hd);
+            rewrite(result);
+        }
         return result;
     }
 
+    /*
+        Return the automaton state for r.
+        The symbolic derivative of r with respect to (:var 0) is computed 
+        when the state is created and reused for every unfolding of r.
+    */
+    unsigned seq_regex::mk_state(expr* r) {
+        unsigned id = 0;
+        if (m_re2state.find(r, id)) {
+            m_stats.m_num_derivative_hits++;
+            return id;
+        }
+        sort* seq_sort = nullptr, *elem_sort = nullptr;
+        VERIFY(u().is_re(r, seq_sort));
+        VERIFY(u().is_seq(seq_sort, elem_sort));
+        expr_ref d(re().mk_derivative(m.mk_var(0, elem_sort), r), m);
+        rewrite(d);
+        m_stats.m_num_derivatives++;
+        id = m_states.size();
+        m_states.push_back(re_state(r, d));
+        m_state_trail.push_back(r);
+        m_state_trail.push_back(d);
+        m_re2state.insert(r, id);
+        return id;
+    }
+
+    /*
+        Cofactors (min-terms) of the derivative of r instantiated for the head hd.
+        The cofactors with respect to (:var 0) are the transitions of the state of r, 
+        they are built on first use and shared across all heads.
+        Conditions are simplified after instantiation and unsatisfiable ones are dropped.
+    */
+    void seq_regex::get_transitions(expr* hd, expr* r, expr_ref_pair_vector& result) {
+        if (!ctx.get_fparams().m_seq_regex_cache) {
+            expr_ref_pair_vector cofactors(m);
+            get_cofactors(derivative_wrapper(hd, r), cofactors);
+            for (auto const& p : cofactors) {
+                expr_ref cond(p.first, m);
+                rewrite(cond);
+                if (!m.is_false(cond))
+                    result.push_back(cond, p.second);
+            }
+            return;
+        }
+        unsigned id = mk_state(r);
+        if (m_states[id].m_has_trans) 
+            m_stats.m_num_transition_hits++;
+        else {
+            expr_ref_pair_vector cofactors(m);
+            get_cofactors(m_states[id].m_derivative, cofactors);
+            re_state& st = m_states[id];
+            st.m_trans_begin = m_trans_conds.size();
+            for (auto const& p : cofactors) {
+                expr_ref cond(p.first, m);
+                rewrite(cond);
+                if (m.is_false(cond))
+                    continue;
+                m_trans_conds.push_back(cond);
+                m_trans_dsts.push_back(p.second);
+            }
+            st.m_trans_end = m_trans_conds.size();
+            st.m_has_trans = true;
+        }
+        re_state const& st = m_states[id];
+        var_subst subst(m);
+        for (unsigned i = st.m_trans_begin; i < st.m_trans_end; ++i) {
+            expr_ref cond(m_trans_conds.get(i), m), dst(m_trans_dsts.get(i), m);
+            if (!is_ground(cond)) {
+                cond = subst(cond, 1, &hd);
+                rewrite(cond);
+                if (m.is_false(cond))
+                    continue;
+            }
+            if (!is_ground(dst)) {
+                dst = subst(dst, 1, &hd);
+                rewrite(dst);
+            }
+            result.push_back(cond, dst);
+        }
+    }
+
+    void seq_regex::collect_statistics(::statistics& st) const {
+        st.update("seq regex derivatives", m_stats.m_num_derivatives);
+        st.update("seq regex derivative hits", m_stats.m_num_derivative_hits);
+        st.update("seq regex transition hits", m_stats.m_num_transition_hits);
+    }
+
     void seq_regex::propagate_eq(expr* r1, expr* r2) {
         sort* seq_sort = nullptr;
         VERIFY(u().is_re(r1, seq_sort));
@@ -458,14 +558,12 @@ namespace smt {
             return;
         literal null_lit = th.mk_literal(is_nullable);
         expr_ref hd = mk_first(r, n);
-        expr_ref d(m);
-        d = derivative_wrapper(hd, r);
         literal_vector lits;
         lits.push_back(~lit);
         if (null_lit != false_literal) 
             lits.push_back(null_lit);
         expr_ref_pair_vector cofactors(m);
-        get_cofactors(d, cofactors);
+        get_transitions(hd, r, cofactors);
         for (auto const& p : cofactors) {
             if (is_member(p.second, u))
                 continue;
@@ -515,11 +613,9 @@ namespace smt {
         }
         th.add_axiom(~lit, ~th.mk_literal(is_nullable));
         expr_ref hd = mk_first(r, n);
-        expr_ref d(m);
-        d = derivative_wrapper(hd, r);
         literal_vector lits;
         expr_ref_pair_vector cofactors(m);
-        get_cofactors(d, cofactors);        
+        get_transitions(hd, r, cofactors);
         for (auto const& p : cofactors) {
             if (is_member(p.second, u))
                 continue;
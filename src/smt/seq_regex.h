@@ -44,12 +44,44 @@ namespace smt {
             propagation_lit(): m_lit(null_literal), m_trigger(null_literal) {}
         };
 
+        /**
+         * A state of the lazily built automaton for derivatives.
+         * m_derivative is the derivative of m_re with respect to (:var 0) in BDD form.
+         * The transitions of the state are the cofactors of the derivative, 
+         * stored in m_trans_conds/m_trans_dsts from m_trans_begin to m_trans_end. 
+         * They are computed on first use.
+         */
+        struct re_state {
+            expr*    m_re;
+            expr*    m_derivative;
+            unsigned m_trans_begin;
+            unsigned m_trans_end;
+            bool     m_has_trans;
+            re_state(expr* r, expr* d): m_re(r), m_derivative(d), m_trans_begin(0), m_trans_end(0), m_has_trans(false) {}
+        };
+
+        struct stats {
+            unsigned m_num_derivatives;
+            unsigned m_num_derivative_hits;
+            unsigned m_num_transition_hits;
+            stats() { reset(); }
+            void reset() { memset(this, 0, sizeof(*this)); }
+        };
+
         theory_seq&      th;
         context&         ctx;
         ast_manager&     m;
         vector<s_in_re> m_s_in_re;
         scoped_vector<propagation_lit> m_to_propagate;
 
+        // derivative cache, shared across scopes and check-sat calls
+        obj_map<expr, unsigned> m_re2state;
+        vector<re_state>        m_states;
+        expr_ref_vector         m_state_trail;
+        expr_ref_vector         m_trans_conds;
+        expr_ref_vector         m_trans_dsts;
+        stats                   m_stats;
+
         seq_util& u();
         class seq_util::re& re();
         class seq_util::str& str();
@@ -81,6 +113,10 @@ namespace smt {
 
         expr_ref derivative_wrapper(expr* hd, expr* r);
 
+        unsigned mk_state(expr* r);
+
+        void get_transitions(expr* hd, expr* r, expr_ref_pair_vector& result);
+
         void get_cofactors(expr* r, expr_ref_vector& conds, expr_ref_pair_vector& result);
 
         void get_cofactors(expr* r, expr_ref_pair_vector& result) {
@@ -113,6 +149,8 @@ namespace smt {
         void propagate_is_non_empty(literal lit);
 
         void propagate_is_empty(literal lit);
+
+        void collect_statistics(::statistics& st) const;
         
     };
 
@@ -141,7 +141,10 @@ namespace smt {
         }
         SASSERT(src_ctx.m_base_lvl == 0 || override_base);
 
+        // The formulas of src_ctx are alive while they are copied. The source
+        // manager is only read, so contexts can be copied from src_ctx in parallel.
         ast_translation tr(src_m, dst_m, false);
+        tr.set_read_only_source();
 
         dst_ctx.set_logic(src_ctx.m_setup.get_logic());
         dst_ctx.copy_plugins(src_ctx, dst_ctx);
@@ -173,10 +176,16 @@ namespace smt {
             if (d.is_theory_atom() && !src_ctx.m_theories.get_plugin(d.get_theory())->is_safe_to_copy(lit.var())) {
                 continue;
             }
-            expr_ref fml0(src_m), fml1(dst_m);
-            src_ctx.literal2expr(lit, fml0);
-            fml1 = tr(fml0.get());
-            dst_ctx.assert_expr(fml1);
+            expr_ref fml(dst_m);
+            if (lit == false_literal) {
+                fml = dst_m.mk_false();
+            }
+            else {
+                fml = tr(src_ctx.bool_var2expr(lit.var()));
+                if (lit.sign())
+                    fml = dst_m.mk_not(fml);
+            }
+            dst_ctx.assert_expr(fml);
         }
 
         dst_ctx.setup_context(dst_ctx.m_fparams.m_auto_config);
@@ -577,6 +577,10 @@ namespace smt {
             return m_fingerprints.insert(data, data_hash, num_args, args, def);
         }
 
+        bool contains_fingerprint(void * data, unsigned data_hash, unsigned num_args, enode * const * args) {
+            return m_fingerprints.contains(data, data_hash, num_args, args);
+        }
+
         theory_id get_var_theory(bool_var v) const {
             return get_bdata(v).get_theory();
         }
@@ -62,6 +62,7 @@ namespace smt {
         vector<smt_params> smt_params;
         scoped_ptr_vector<ast_manager> pms;
         scoped_ptr_vector<context> pctxs;
+        scoped_ptr_vector<ast_translation_cache> caches;
         vector<expr_ref_vector> pasms;
 
         ast_manager& m = ctx.m;
@@ -83,12 +84,47 @@ namespace smt {
             ast_manager* new_m = alloc(ast_manager, m, true);
             pms.push_back(new_m);
             pctxs.push_back(alloc(context, *new_m, smt_params[i], ctx.get_params())); 
-            context& new_ctx = *pctxs.back();
+            caches.push_back(alloc(ast_translation_cache, m, *new_m));
+            pasms.push_back(expr_ref_vector(*new_m));
+            sl.push_child(&(new_m->limit()));
+        }
+
+        std::mutex mux;
+
+        // Copy the assertions into the worker contexts. The main manager is only
+        // read by the copies, which can then run in parallel. Macros are copied
+        // with translations that update the main manager.
+        auto copy_context = [&](unsigned i) {
+            context& new_ctx = *pctxs[i];
             context::copy(ctx, new_ctx, true);
             new_ctx.set_random_seed(i + ctx.get_fparams().m_random_seed);
-            ast_translation tr(m, *new_m);
-            pasms.push_back(tr(asms));
-            sl.push_child(&(new_m->limit()));
+            ast_translation tr(m, *pms[i], false);
+            tr.set_read_only_source();
+            pasms[i] = tr(asms);
+        };
+        ctx.pop_to_base_lvl();
+        if (ctx.m_asserted_formulas.get_macro_manager().get_num_macros() > 0) {
+            for (unsigned i = 0; i < num_threads; ++i)
+                copy_context(i);
+        }
+        else {
+            vector<std::thread> threads(num_threads);
+            for (unsigned i = 0; i < num_threads; ++i) {
+                threads[i] = std::thread([&, i]() {
+                    try {
+                        copy_context(i);
+                    }
+                    catch (z3_exception & ex) {
+                        std::lock_guard<std::mutex> lock(mux);
+                        ex_msg = ex.msg();
+                        done = true;
+                    }
+                });
+            }
+            for (auto & th : threads)
+                th.join();
+            if (done)
+                throw default_exception(std::move(ex_msg));
         }
 
         auto cube = [](context& ctx, expr_ref_vector& lasms, expr_ref& c) {
@@ -106,7 +142,7 @@ namespace smt {
             for (unsigned i = 0; i < num_threads; ++i) {
                 context& pctx = *pctxs[i];
                 pctx.pop_to_base_lvl();
-                ast_translation tr(pctx.m, ctx.m);
+                ast_translation tr(*caches[i], pctx.m, ctx.m, false);
                 unsigned sz = pctx.assigned_literals().size();
                 for (unsigned j = unit_lim[i]; j < sz; ++j) {
                     literal lit = pctx.assigned_literals()[j];
@@ -123,7 +159,7 @@ namespace smt {
             unsigned sz = unit_trail.size();
             for (unsigned i = 0; i < num_threads; ++i) {
                 context& pctx = *pctxs[i];
-                ast_translation tr(ctx.m, pctx.m);
+                ast_translation tr(*caches[i], ctx.m, pctx.m, false);
                 for (unsigned j = unit_lim[i]; j < sz; ++j) {
                     expr_ref src(ctx.m), dst(pctx.m);
                     dst = tr(unit_trail.get(j));
@@ -133,8 +169,6 @@ namespace smt {
             }
         };
 
-        std::mutex mux;
-
         auto worker_thread = [&](int i) {
             try {
                 context& pctx = *pctxs[i];
@@ -227,7 +261,7 @@ namespace smt {
 
         model_ref mdl;        
         context& pctx = *pctxs[finished_id];
-        ast_translation tr(*pms[finished_id], m);
+        ast_translation tr(*caches[finished_id], *pms[finished_id], m, false);
         switch (result) {
         case l_true: 
             pctx.get_model(mdl);
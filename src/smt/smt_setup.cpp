@@ -32,6 +32,7 @@ Revision History:
 #include "smt/theory_dummy.h"
 #include "smt/theory_dl.h"
 #include "smt/theory_seq_empty.h"
+#include "smt/theory_seq_bounded.h"
 #include "smt/theory_seq.h"
 #include "smt/theory_special_relations.h"
 #include "smt/theory_pb.h"
@@ -729,6 +730,9 @@ namespace smt {
         else if (m_params.m_string_solver == "auto") {
             setup_unknown();
         }
+        else if (m_params.m_string_solver == "bounded") {
+            setup_unknown();
+        }
  
         else if (m_params.m_string_solver == "empty") {
             m_context.register_plugin(alloc(smt::theory_seq_empty, m_context));
@@ -737,7 +741,7 @@ namespace smt {
             // don't register any solver.
         }
         else {
-            throw default_exception("invalid parameter for smt.string_solver, valid options are 'z3str3', 'seq', 'auto'");
+            throw default_exception("invalid parameter for smt.string_solver, valid options are 'z3str3', 'seq', 'auto', 'bounded'");
         }
     }
 
@@ -903,6 +907,9 @@ namespace smt {
         else if (m_params.m_string_solver == "empty") {
             m_context.register_plugin(alloc(smt::theory_seq_empty, m_context));
         }
+        else if (m_params.m_string_solver == "bounded") {
+            m_context.register_plugin(alloc(smt::theory_seq_bounded, m_context));
+        }
         else if (m_params.m_string_solver == "none") {
             // don't register any solver.
         }
@@ -915,7 +922,7 @@ namespace smt {
             }
         } 
         else {
-            throw default_exception("invalid parameter for smt.string_solver, valid options are 'z3str3', 'seq', 'auto'");
+            throw default_exception("invalid parameter for smt.string_solver, valid options are 'z3str3', 'seq', 'auto', 'bounded'");
         }
     }
 
@@ -960,7 +967,8 @@ namespace smt {
         setup_dl();
         setup_seq_str(st);
         setup_fpa();
-        if (st.m_has_sr) setup_special_relations();
+        // formulas with special relations may be asserted after the setup in incremental mode.
+        setup_special_relations();
     }
 
     void setup::setup_unknown(static_features & st) {
@@ -82,12 +82,54 @@ namespace smt {
         return r;
     }
     
+    /**
+       \brief Return true if the equivalence class of d already has a parent select
+       with the same index roots as s. 
+       The axioms for s are then congruent to the axioms for the existing select.
+       Otherwise, index s by the root of its first index.
+    */
+    bool theory_array::is_congruent_select(var_data * d, enode * s) {
+        enode * r = s->get_arg(1)->get_root();
+        enode * s2 = nullptr;
+        if (d->m_index2select.find(r, s2)) {
+            unsigned num_args = s->get_num_args();
+            for (unsigned i = 2; i < num_args; ++i) 
+                if (s->get_arg(i)->get_root() != s2->get_arg(i)->get_root())
+                    return false;
+            return true;
+        }
+        d->m_index2select.insert(r, s);
+        m_trail_stack.push(insert_obj_map<theory_array, enode, enode*>(d->m_index2select, r));
+        return false;
+    }
+
     void theory_array::add_parent_select(theory_var v, enode * s) {
+        add_parent_select_core(v, s);
+    }
+
+    /**
+       \brief Register s as a parent select of v and instantiate axiom 2 for the stores of v.
+       Return false if s is skipped because it is congruent to an existing parent select.
+    */
+    bool theory_array::add_parent_select_core(theory_var v, enode * s) {
         if (m_params.m_array_cg && !s->is_cgr())
-            return;
+            return false;
         SASSERT(is_select(s));
         v                = find(v);
         var_data * d     = m_var_data[v];
+        if (is_congruent_select(d, s)) {
+            TRACE("array", tout << "congruent select skipped: #" << s->get_owner_id() << "\n";);
+            m_stats.m_num_select_dups++;
+            // count the axioms that registering s would have instantiated
+            for (enode * n : d->m_stores)
+                if (is_new_store_axiom2(n, s))
+                    m_stats.m_num_axiom2_avoided++;
+            if (!m_params.m_array_delay_exp_axiom && d->m_prop_upward)
+                for (enode * store : d->m_parent_stores)
+                    if ((!m_params.m_array_cg || store->is_cgr()) && is_new_store_axiom2(store, s))
+                        m_stats.m_num_axiom2_avoided++;
+            return false;
+        }
         d->m_parent_selects.push_back(s);
         TRACE("array", tout << v << " " << mk_pp(s->get_owner(), m) << " " << mk_pp(get_enode(v)->get_owner(), m) << "\n";);
         m_trail_stack.push(push_back_trail<theory_array, enode *, false>(d->m_parent_selects));
@@ -102,6 +144,7 @@ namespace smt {
                 }
             }
         }
+        return true;
     }
 
     void theory_array::add_parent_store(theory_var v, enode * s) {
@@ -469,6 +512,8 @@ namespace smt {
         st.update("array exp ax2", m_stats.m_num_axiom2b);
         st.update("array ext ax", m_stats.m_num_extensionality);
         st.update("array splits", m_stats.m_num_eq_splits);
+        st.update("array select dups", m_stats.m_num_select_dups);
+        st.update("array ax2 avoided", m_stats.m_num_axiom2_avoided);
     }
 
 };
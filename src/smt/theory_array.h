@@ -30,6 +30,7 @@ namespace smt {
         unsigned   m_num_map_axiom, m_num_default_map_axiom;
         unsigned   m_num_select_const_axiom, m_num_default_store_axiom, m_num_default_const_axiom, m_num_default_as_array_axiom;
         unsigned   m_num_select_as_array_axiom;
+        unsigned   m_num_select_dups, m_num_axiom2_avoided;
         void reset() { memset(this, 0, sizeof(theory_array_stats)); }
         theory_array_stats() { reset(); }
     };
@@ -43,6 +44,7 @@ namespace smt {
             ptr_vector<enode>  m_stores;
             ptr_vector<enode>  m_parent_selects;
             ptr_vector<enode>  m_parent_stores;
+            obj_map<enode, enode*> m_index2select; // root of first index -> parent select
             bool               m_prop_upward;
             bool               m_is_array;
             bool               m_is_select;
@@ -78,6 +80,8 @@ namespace smt {
         bool is_root(theory_var v) const { return m_find.is_root(v); }
 
         virtual void add_parent_select(theory_var v, enode * s);
+        bool add_parent_select_core(theory_var v, enode * s);
+        bool is_congruent_select(var_data * d, enode * s);
         void add_parent_store(theory_var v, enode * s);
         void add_store(theory_var v, enode * s);
 
@@ -198,6 +198,18 @@ namespace smt {
         }
     }
     
+    /**
+       \brief Return true if assert_store_axiom2(store, select) would instantiate a new axiom.
+    */
+    bool theory_array_base::is_new_store_axiom2(enode * store, enode * select) {
+        unsigned num_args = select->get_num_args();
+        unsigned        i = 1;
+        for (; i < num_args; i++) 
+            if (store->get_arg(i)->get_root() != select->get_arg(i)->get_root())
+                break;
+        return i < num_args && !ctx.contains_fingerprint(store, store->get_owner_id(), num_args - 1, select->get_args() + 1);
+    }
+
     bool theory_array_base::assert_store_axiom2(enode * store, enode * select) { 
         unsigned num_args = select->get_num_args();
         unsigned        i = 1;
@@ -371,7 +371,8 @@ namespace smt {
               tout << v << " select parent: " << mk_pp(s->get_owner(), m) << "\n";
               display_var(tout, v);
               );
-        theory_array::add_parent_select(v,s);
+        if (!add_parent_select_core(v, s))
+            return;
         v = find(v);
         var_data_full* d_full = m_var_data_full[v];
         var_data* d = m_var_data[v];
@@ -34,6 +34,8 @@ namespace smt {
         m_bits.push_back(literal_vector());
         m_wpos.push_back(0);
         m_zero_one_bits.push_back(zero_one_bits());
+        m_word_parents.push_back(vector<app*>());
+        m_word_bounds.push_back(vector<word_bound>());
         ctx.attach_th_var(n, this, r);
         return r;
     }
@@ -830,12 +832,568 @@ namespace smt {
         find_wpos(v);
     }
 
+    /**
+       \brief multipliers, dividers and remainders are not bit-blasted on internalization 
+       when smt.bv.delay is set. They are treated as fresh bit-vectors until final check finds
+       their bits inconsistent with the values of their arguments.
+       Multiplication by a numeral is cheap to blast, and is not delayed.
+    */
+    bool theory_bv::should_delay(app * n) const {
+        if (!params().m_bv_delay)
+            return false;
+        switch (n->get_decl_kind()) {
+        case OP_BMUL:
+            for (expr * arg : *n) 
+                if (m_util.is_numeral(arg))
+                    return false;
+            return true;
+        case OP_BSDIV_I:
+        case OP_BUDIV_I:
+        case OP_BSREM_I:
+        case OP_BUREM_I:
+        case OP_BSMOD_I:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    void theory_bv::internalize_delayed(app * n) {
+        SASSERT(!ctx.e_internalized(n));
+        process_args(n);
+        enode * e = mk_enode(n);
+        for (unsigned i = 0; i < n->get_num_args(); ++i) {
+            theory_var arg = get_arg_var(e, i);
+            m_word_parents[arg].push_back(n);
+            m_trail_stack.push(push_back2_trail<theory_bv, app*>(m_word_parents, arg));
+        }
+        mk_bits(e->get_th_var(get_id()));
+        m_delayed.push_back(n);
+        m_trail_stack.push(push_back_vector<theory_bv, ptr_vector<app>>(m_delayed));
+        m_stats.m_num_delayed++;
+    }
+
+    /**
+       \brief bit-blast delayed terms whose bits disagree with the value of the operation
+       applied to the values of their arguments.
+       The arguments are fixed at this point, so the term is blasted instead of propagating
+       its value: a propagation would only exclude the current values of the arguments.
+       Return false if new constraints were added.
+    */
+    bool theory_bv::check_delayed() {
+        if (m_delayed.empty())
+            return true;
+        bool ok = true;
+        for (unsigned i = 0; i < m_delayed.size() && !ctx.inconsistent(); ++i) {
+            app * n = m_delayed[i];
+            if (m_delayed_blasted.contains(n) || !ctx.is_relevant(n) || is_delayed_consistent(n)) 
+                continue;
+            blast_delayed(n);
+            ok = false;
+        }
+        return ok;
+    }
+
+    th_rewriter& theory_bv::delayed_rw() {
+        if (!m_delayed_rw)
+            m_delayed_rw = alloc(th_rewriter, m);
+        return *m_delayed_rw;
+    }
+
+    /**
+       \brief evaluate n on the fixed values of its arguments.
+    */
+    bool theory_bv::eval_delayed(app * n, numeral & r) {
+        numeral arg_val;
+        unsigned sz;
+        expr_ref_vector args(m);
+        for (expr * arg : *n) {
+            if (!get_fixed_value(to_app(arg), arg_val))
+                return false;
+            args.push_back(m_util.mk_numeral(arg_val, m.get_sort(arg)));
+        }
+        expr_ref e(m.mk_app(n->get_decl(), args.size(), args.c_ptr()), m);
+        delayed_rw()(e);
+        return m_util.is_numeral(e, r, sz);
+    }
+
+    bool theory_bv::is_delayed_consistent(app * n) {
+        numeral val, expected;
+        if (!get_fixed_value(n, val) || !eval_delayed(n, expected))
+            return false;
+        TRACE("bv", tout << mk_pp(n, m) << " := " << val << " expected: " << expected << "\n";);
+        return val == expected;
+    }
+
+    /**
+       \brief return the literal of the assigned bit idx of v that is true in the current assignment.
+    */
+    literal theory_bv::get_assigned_bit(theory_var v, unsigned idx) const {
+        literal l = m_bits[v][idx];
+        SASSERT(ctx.get_assignment(l) != l_undef);
+        return ctx.get_assignment(l) == l_false ? ~l : l;
+    }
+
+    void theory_bv::assign_word_bit(theory_var v, unsigned idx, bool is_true, literal_vector const & antecedents) {
+        literal l = m_bits[v][idx];
+        if (!is_true)
+            l.neg();
+        lbool val = ctx.get_assignment(l);
+        if (val == l_true)
+            return;
+        TRACE("bv", tout << "word propagation v" << v << "[" << idx << "] := " << is_true << "\n";);
+        if (val == l_false)
+            m_stats.m_num_word_conflicts++;
+        else
+            m_stats.m_num_word_props++;
+        ctx.assign(l, ctx.mk_justification(
+                       ext_theory_propagation_justification(
+                           get_id(), ctx.get_region(), antecedents.size(), antecedents.c_ptr(), 0, nullptr, l)));
+    }
+
+    /**
+       \brief word-level propagation for the delayed term n.
+       Bits of n are derived from the assigned bits of its arguments without bit-blasting n:
+       - the low bits of a product from the known low bits of the factors,
+         or from the number of known trailing zeros of the factors,
+       - the high bits of an unsigned quotient or remainder from upper bounds on
+         the dividend and divisor given by their known leading zeros.
+       Nothing is propagated when the arguments are fixed, final check blasts n
+       if its value is inconsistent.
+       Return true if a bit was assigned or a conflict was detected.
+    */
+    bool theory_bv::propagate_delayed(app * n) {
+        if (m_delayed_blasted.contains(n))
+            return false;
+        enode * e          = ctx.get_enode(n);
+        theory_var v       = e->get_th_var(get_id());
+        unsigned sz        = get_bv_size(n);
+        unsigned num_args  = n->get_num_args();
+        unsigned old_props = m_stats.m_num_word_props + m_stats.m_num_word_conflicts;
+        literal_vector antecedents;
+
+        // the number of leading (known zero) and trailing (known low value) bits of arg
+        auto leading_zeros = [&](theory_var arg) {
+            literal_vector const & bits = m_bits[arg];
+            unsigned k = 0;
+            while (k < sz && ctx.get_assignment(bits[sz - k - 1]) == l_false)
+                ++k;
+            return k;
+        };
+        auto known_low = [&](theory_var arg) {
+            literal_vector const & bits = m_bits[arg];
+            unsigned k = 0;
+            while (k < sz && ctx.get_assignment(bits[k]) != l_undef)
+                ++k;
+            return k;
+        };
+        auto trailing_zeros = [&](theory_var arg) {
+            literal_vector const & bits = m_bits[arg];
+            unsigned k = 0;
+            while (k < sz && ctx.get_assignment(bits[k]) == l_false)
+                ++k;
+            return k;
+        };
+        // a literal witnessing that arg is non-zero
+        auto non_zero = [&](theory_var arg) {
+            for (literal b : m_bits[arg]) 
+                if (ctx.get_assignment(b) == l_true)
+                    return b;
+            return null_literal;
+        };
+        auto low_value = [&](theory_var arg, unsigned k) {
+            numeral r(0), p(1);
+            for (unsigned i = 0; i < k; ++i, p *= numeral(2)) 
+                if (ctx.get_assignment(m_bits[arg][i]) == l_true)
+                    r += p;
+            return r;
+        };
+        auto assign_low = [&](numeral r, unsigned k) {
+            numeral two(2);
+            for (unsigned i = 0; i < k && !ctx.inconsistent(); ++i) {
+                assign_word_bit(v, i, !mod(r, two).is_zero(), antecedents);
+                r = div(r, two);
+            }
+        };
+        auto assign_high_zeros = [&](unsigned k) {
+            for (unsigned i = sz - k; i < sz && !ctx.inconsistent(); ++i) 
+                assign_word_bit(v, i, false, antecedents);
+        };
+
+        svector<theory_var> args;
+        bool all_fixed = true;
+        for (unsigned i = 0; i < num_args; ++i) {
+            theory_var arg = e->get_arg(i)->get_th_var(get_id());
+            if (arg == null_theory_var)
+                return false;
+            args.push_back(arg);
+            all_fixed &= known_low(arg) == sz;
+        }
+
+        if (all_fixed)
+            return false;
+
+        switch (n->get_decl_kind()) {
+        case OP_BMUL: {
+            unsigned lo = sz, tz = 0;
+            for (theory_var arg : args) {
+                lo = std::min(lo, known_low(arg));
+                tz += trailing_zeros(arg);
+            }
+            tz = std::min(tz, sz);
+            if (tz > lo) {
+                for (theory_var arg : args) 
+                    for (unsigned i = 0, k = trailing_zeros(arg); i < k; ++i) 
+                        antecedents.push_back(get_assigned_bit(arg, i));
+                assign_low(numeral(0), tz);
+            }
+            else if (lo > 0) {
+                numeral p(1);
+                for (theory_var arg : args) {
+                    p *= low_value(arg, lo);
+                    for (unsigned i = 0; i < lo; ++i) 
+                        antecedents.push_back(get_assigned_bit(arg, i));
+                }
+                assign_low(mod(p, numeral::power_of_two(lo)), lo);
+            }
+            break;
+        }
+        case OP_BUDIV_I: {
+            // x / y <= x if y != 0
+            literal nz = non_zero(args[1]);
+            unsigned lz = leading_zeros(args[0]);
+            if (nz == null_literal || lz == 0)
+                break;
+            antecedents.push_back(nz);
+            for (unsigned i = sz - lz; i < sz; ++i) 
+                antecedents.push_back(get_assigned_bit(args[0], i));
+            assign_high_zeros(lz);
+            break;
+        }
+        case OP_BUREM_I: {
+            // x % y <= x, and x % y < y if y != 0
+            literal nz = non_zero(args[1]);
+            unsigned lz0 = leading_zeros(args[0]);
+            unsigned lz1 = nz == null_literal ? 0 : leading_zeros(args[1]);
+            theory_var arg = args[0];
+            unsigned lz = lz0;
+            if (lz1 > lz0) {
+                antecedents.push_back(nz);
+                arg = args[1];
+                lz = lz1;
+            }
+            if (lz == 0)
+                break;
+            for (unsigned i = sz - lz; i < sz; ++i) 
+                antecedents.push_back(get_assigned_bit(arg, i));
+            assign_high_zeros(lz);
+            break;
+        }
+        default:
+            break;
+        }
+        return old_props != m_stats.m_num_word_props + m_stats.m_num_word_conflicts;
+    }
+
+    /**
+       \brief terms propagated at word level when smt.bv.word_prop is set.
+       The bits of concatenations and extractions are the bits of their arguments,
+       their domains still combine the intervals of the arguments.
+    */
+    bool theory_bv::is_word_term(app * n) const {
+        if (!params().m_bv_word_prop || n->get_family_id() != get_id())
+            return false;
+        switch (n->get_decl_kind()) {
+        case OP_BADD:
+        case OP_BAND:
+        case OP_BSHL:
+        case OP_BLSHR:
+        case OP_CONCAT:
+        case OP_EXTRACT:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    void theory_bv::register_word_term(app * n) {
+        enode * e = ctx.get_enode(n);
+        if (m_word_terms.contains(n))
+            return;
+        for (unsigned i = 0; i < n->get_num_args(); ++i) {
+            theory_var arg = get_arg_var(e, i);
+            m_word_parents[arg].push_back(n);
+            m_trail_stack.push(push_back2_trail<theory_bv, app*>(m_word_parents, arg));
+        }
+        m_word_terms.insert(n);
+        m_trail_stack.push(insert_obj_trail<theory_bv, app>(m_word_terms, n));
+        m_word_queue.push_back(n);
+    }
+
+    /**
+       \brief record the unsigned comparison of a variable with a numeral.
+    */
+    void theory_bv::register_word_bound(app * atom, le_atom * a) {
+        numeral val;
+        unsigned sz;
+        bool upper;
+        expr * x;
+        if (m_util.is_numeral(atom->get_arg(1), val, sz)) {
+            x = atom->get_arg(0);
+            upper = true;
+        }
+        else if (m_util.is_numeral(atom->get_arg(0), val, sz)) {
+            x = atom->get_arg(1);
+            upper = false;
+        }
+        else 
+            return;
+        theory_var v = get_var(ctx.get_enode(x));
+        a->m_bound_var = v;
+        m_word_bounds[v].push_back(word_bound(a->m_var.var(), val, upper));
+        m_trail_stack.push(push_back2_trail<theory_bv, word_bound>(m_word_bounds, v));
+    }
+
+    void theory_bv::enqueue_word(theory_var v) {
+        for (app * p : m_word_parents[v]) 
+            if (m_word_queue.empty() || m_word_queue.back() != p)
+                m_word_queue.push_back(p);
+        app * n = get_enode(v)->get_owner();
+        if (m_word_terms.contains(n) && (m_word_queue.empty() || m_word_queue.back() != n))
+            m_word_queue.push_back(n);
+    }
+
+    void theory_bv::propagate_word(app * n) {
+        if (m_word_terms.contains(n)) {
+            propagate_domain(n);
+            return;
+        }
+        propagate_delayed(n);
+        if (params().m_bv_word_prop && !ctx.inconsistent())
+            propagate_domain(n);
+    }
+
+    /**
+       \brief the domain given by the assigned bits of v and its assigned comparisons
+       with numerals. The assigned literals are added to antecedents.
+    */
+    bv_word_domain theory_bv::get_word_domain(theory_var v, literal_vector & antecedents) const {
+        unsigned sz = get_bv_size(v);
+        bv_word_domain d(sz);
+        for (unsigned i = 0; i < sz; ++i) {
+            lbool val = ctx.get_assignment(m_bits[v][i]);
+            if (val == l_undef)
+                continue;
+            d.set_bit(i, val == l_true);
+            antecedents.push_back(get_assigned_bit(v, i));
+        }
+        numeral max_val = numeral::power_of_two(sz) - numeral::one();
+        for (word_bound const & b : m_word_bounds[v]) {
+            lbool val = ctx.get_assignment(b.m_atom);
+            if (val == l_undef)
+                continue;
+            antecedents.push_back(literal(b.m_atom, val == l_false));
+            if (b.m_upper == (val == l_true)) {
+                // v <= c, or not (c <= v), that is v <= c - 1
+                d.intersect(numeral::zero(), b.m_upper ? b.m_val : b.m_val - numeral::one());
+            }
+            else {
+                // c <= v, or not (v <= c), that is c + 1 <= v
+                d.intersect(b.m_upper ? b.m_val + numeral::one() : b.m_val, max_val);
+            }
+        }
+        d.reduce();
+        return d;
+    }
+
+    /**
+       \brief propagate the domain of n computed from the domains of its arguments:
+       - its known bits are assigned,
+       - its comparisons with numerals are assigned when the interval decides them,
+       - a conflict is detected when the domain is disjoint from the assigned bits and 
+         comparisons of n.
+       The antecedents are the assigned bits and comparisons of the arguments.
+       Delayed terms are not propagated when their arguments are fixed, final check
+       blasts them if their value is inconsistent.
+       Return true if a literal was assigned or a conflict was detected.
+    */
+    bool theory_bv::propagate_domain(app * n) {
+        enode * e   = ctx.get_enode(n);
+        theory_var v = e->get_th_var(get_id());
+        unsigned sz  = get_bv_size(n);
+        if (v == null_theory_var || m_delayed_blasted.contains(n))
+            return false;
+        literal_vector antecedents;
+        vector<bv_word_domain> args;
+        bool all_fixed = true;
+        for (unsigned i = 0; i < n->get_num_args(); ++i) {
+            theory_var arg = e->get_arg(i)->get_th_var(get_id());
+            if (arg == null_theory_var)
+                return false;
+            args.push_back(get_word_domain(arg, antecedents));
+            all_fixed &= args.back().is_fixed();
+        }
+        if (all_fixed && should_delay(n))
+            return false;
+
+        bv_word_domain d(args[0]);
+        switch (n->get_decl_kind()) {
+        case OP_BADD:
+            for (unsigned i = 1; i < args.size(); ++i)
+                d = bv_word_domain::mk_add(d, args[i]);
+            break;
+        case OP_BAND:
+            for (unsigned i = 1; i < args.size(); ++i)
+                d = bv_word_domain::mk_and(d, args[i]);
+            break;
+        case OP_BMUL:
+            for (unsigned i = 1; i < args.size(); ++i)
+                d = bv_word_domain::mk_mul(d, args[i]);
+            break;
+        case OP_BUDIV_I:
+            d = bv_word_domain::mk_udiv(args[0], args[1]);
+            break;
+        case OP_BUREM_I:
+            d = bv_word_domain::mk_urem(args[0], args[1]);
+            break;
+        case OP_BSHL:
+            d = bv_word_domain::mk_shl(args[0], args[1]);
+            break;
+        case OP_BLSHR:
+            d = bv_word_domain::mk_lshr(args[0], args[1]);
+            break;
+        case OP_CONCAT:
+            for (unsigned i = 1; i < args.size(); ++i)
+                d = bv_word_domain::mk_concat(d, args[i]);
+            break;
+        case OP_EXTRACT:
+            d = bv_word_domain::mk_extract(args[0], m_util.get_extract_high(n), m_util.get_extract_low(n));
+            break;
+        default:
+            return false;
+        }
+        SASSERT(d.size() == sz);
+        if (d.is_empty()) {
+            // the assigned bits and comparisons of an argument are inconsistent
+            m_stats.m_num_word_conflicts++;
+            ctx.set_conflict(ctx.mk_justification(
+                                 ext_theory_conflict_justification(
+                                     get_id(), ctx.get_region(), antecedents.size(), antecedents.c_ptr(), 0, nullptr)));
+            return true;
+        }
+        if (d.is_full())
+            return false;
+        TRACE("bv", tout << mk_pp(n, m) << " in " << d << "\n";);
+
+        unsigned old_props = m_stats.m_num_word_props + m_stats.m_num_word_conflicts;
+        for (unsigned i = 0; i < sz && !ctx.inconsistent(); ++i) 
+            if (d.bit(i) != l_undef)
+                assign_word_bit(v, i, d.bit(i) == l_true, antecedents);
+        if (ctx.inconsistent())
+            return true;
+
+        for (word_bound const & b : m_word_bounds[v]) {
+            if (ctx.get_assignment(b.m_atom) != l_undef)
+                continue;
+            lbool val = l_undef;
+            if (b.m_upper)
+                val = d.hi() <= b.m_val ? l_true : (d.lo() > b.m_val ? l_false : l_undef);
+            else
+                val = d.lo() >= b.m_val ? l_true : (d.hi() < b.m_val ? l_false : l_undef);
+            if (val == l_undef)
+                continue;
+            literal l(b.m_atom, val == l_false);
+            m_stats.m_num_word_props++;
+            ctx.assign(l, ctx.mk_justification(
+                           ext_theory_propagation_justification(
+                               get_id(), ctx.get_region(), antecedents.size(), antecedents.c_ptr(), 0, nullptr, l)));
+        }
+
+        literal_vector lits(antecedents);
+        bv_word_domain cur = get_word_domain(v, lits);
+        cur.intersect(d);
+        cur.reduce();
+        if (cur.is_empty()) {
+            TRACE("bv", tout << "word conflict " << mk_pp(n, m) << "\n";);
+            m_stats.m_num_word_conflicts++;
+            ctx.set_conflict(ctx.mk_justification(
+                                 ext_theory_conflict_justification(
+                                     get_id(), ctx.get_region(), lits.size(), lits.c_ptr(), 0, nullptr)));
+        }
+        return old_props != m_stats.m_num_word_props + m_stats.m_num_word_conflicts;
+    }
+
+    void theory_bv::mk_delayed_bits(app * n, expr_ref_vector & bits) {
+        enode * e = ctx.get_enode(n);
+        expr_ref_vector arg1_bits(m), arg2_bits(m);
+        unsigned i = n->get_num_args() - 1;
+        get_arg_bits(e, i, arg2_bits);
+        while (i > 0) {
+            --i;
+            arg1_bits.reset();
+            bits.reset();
+            get_arg_bits(e, i, arg1_bits);
+            SASSERT(arg1_bits.size() == arg2_bits.size());
+            switch (n->get_decl_kind()) {
+            case OP_BMUL:    m_bb.mk_multiplier(arg1_bits.size(), arg1_bits.c_ptr(), arg2_bits.c_ptr(), bits); break;
+            case OP_BSDIV_I: m_bb.mk_sdiv(arg1_bits.size(), arg1_bits.c_ptr(), arg2_bits.c_ptr(), bits); break;
+            case OP_BUDIV_I: m_bb.mk_udiv(arg1_bits.size(), arg1_bits.c_ptr(), arg2_bits.c_ptr(), bits); break;
+            case OP_BSREM_I: m_bb.mk_srem(arg1_bits.size(), arg1_bits.c_ptr(), arg2_bits.c_ptr(), bits); break;
+            case OP_BUREM_I: m_bb.mk_urem(arg1_bits.size(), arg1_bits.c_ptr(), arg2_bits.c_ptr(), bits); break;
+            case OP_BSMOD_I: m_bb.mk_smod(arg1_bits.size(), arg1_bits.c_ptr(), arg2_bits.c_ptr(), bits); break;
+            default: UNREACHABLE(); break;
+            }
+            arg2_bits.swap(bits);
+        }
+        bits.swap(arg2_bits);
+    }
+
+    /**
+       \brief assert that the bits of n are equal to the circuit of its operation.
+       Circuits are cached across scopes: re-asserting the circuit after backtracking
+       only requires re-internalizing it.
+    */
+    void theory_bv::blast_delayed(app * n) {
+        expr_ref_vector bits(m);
+        unsigned sz = get_bv_size(n);
+        unsigned offset = 0;
+        if (m_blast_cache.find(n, offset)) {
+            for (unsigned i = 0; i < sz; ++i) 
+                bits.push_back(m_blast_bits.get(offset + i));
+        }
+        else {
+            mk_delayed_bits(n, bits);
+            m_blast_cache.insert(n, m_blast_bits.size());
+            m_blast_cache_keys.push_back(n);
+            m_blast_bits.append(bits);
+        }
+        TRACE("bv", tout << "blast delayed " << mk_pp(n, m) << "\n";);
+        SASSERT(bits.size() == sz);
+        ctx.internalize(bits.c_ptr(), sz, true);
+        theory_var v = ctx.get_enode(n)->get_th_var(get_id());
+        literal_vector const & n_bits = m_bits[v];
+        for (unsigned i = 0; i < sz; ++i) {
+            literal a = n_bits[i];
+            literal b = ctx.get_literal(bits.get(i));
+            ctx.mark_as_relevant(b);
+            ctx.mk_th_axiom(get_id(), ~a,  b);
+            ctx.mk_th_axiom(get_id(),  a, ~b);
+        }
+        m_delayed_blasted.insert(n);
+        m_trail_stack.push(insert_obj_trail<theory_bv, app>(m_delayed_blasted, n));
+        m_stats.m_num_delayed_blasted++;
+    }
+
     bool theory_bv::internalize_term_core(app * term) {
         SASSERT(term->get_family_id() == get_family_id());
         TRACE("bv", tout << "internalizing term: " << mk_bounded_pp(term, m) << "\n";);
         if (approximate_term(term)) {
             return false;
         }
+        if (should_delay(term)) {
+            internalize_delayed(term);
+            return true;
+        }
         switch (term->get_decl_kind()) {
         case OP_BV_NUM:         internalize_num(term); return true;
         case OP_BADD:           internalize_add(term); return true;
@@ -893,7 +1451,11 @@ namespace smt {
     bool theory_bv::internalize_term(app * term) {
         scoped_suspend_rlimit _suspend_cancel(m.limit());
         try {
-            return internalize_term_core(term);
+            if (!internalize_term_core(term))
+                return false;
+            if (is_word_term(term))
+                register_word_term(term);
+            return true;
         }
         catch (z3_exception& ex) {
             IF_VERBOSE(1, verbose_stream() << "internalize_term: " << ex.msg() << "\n";);
@@ -955,6 +1517,8 @@ namespace smt {
         le_atom * a     = new (get_region()) le_atom(l, def);
         insert_bv2a(l.var(), a);
         m_trail_stack.push(mk_atom_trail(l.var()));
+        if (!Signed && params().m_bv_word_prop)
+            register_word_bound(n, a);
         if (!ctx.relevancy() || !params().m_bv_lazy_le) {
             ctx.mk_th_axiom(get_id(),  l, ~def);
             ctx.mk_th_axiom(get_id(), ~l,  def);
@@ -1187,6 +1751,7 @@ namespace smt {
             var_pos_occ * curr = b->m_occs;
             while (curr) {
                 m_prop_queue.push_back(var_pos(curr->m_var, curr->m_idx));
+                enqueue_word(curr->m_var);
                 curr = curr->m_next;
             }
             propagate_bits();
@@ -1202,6 +1767,11 @@ namespace smt {
             }
 #endif
         }
+        else {
+            le_atom * le = static_cast<le_atom*>(a);
+            if (le->m_bound_var != null_theory_var)
+                enqueue_word(le->m_bound_var);
+        }
     }
     
     void theory_bv::propagate_bits() {
@@ -1352,6 +1922,7 @@ namespace smt {
     void theory_bv::push_scope_eh() {
         theory::push_scope_eh();
         m_trail_stack.push_scope();
+        m_bb.push();
         // check_invariant();
 #if WATCH_DISEQ
         m_diseq_watch_lim.push_back(m_diseq_watch_trail.size());
@@ -1360,10 +1931,14 @@ namespace smt {
     
     void theory_bv::pop_scope_eh(unsigned num_scopes) {
         m_trail_stack.pop_scope(num_scopes);
+        m_bb.pop(num_scopes);
         unsigned num_old_vars = get_old_num_vars(num_scopes);
         m_bits.shrink(num_old_vars);
         m_wpos.shrink(num_old_vars);
         m_zero_one_bits.shrink(num_old_vars);
+        m_word_parents.shrink(num_old_vars);
+        m_word_bounds.shrink(num_old_vars);
+        m_word_queue.reset();
 #if WATCH_DISEQ
         unsigned old_trail_sz = m_diseq_watch_lim[m_diseq_watch_lim.size()-num_scopes];
         for (unsigned i = m_diseq_watch_trail.size(); i-- > old_trail_sz;) {
@@ -1381,6 +1956,9 @@ namespace smt {
 
     final_check_status theory_bv::final_check_eh() {
         SASSERT(check_invariant());
+        if (!check_delayed()) {
+            return FC_CONTINUE;
+        }
         if (m_approximates_large_bvs) {
             return FC_GIVEUP;
         }
@@ -1391,6 +1969,12 @@ namespace smt {
         pop_scope_eh(m_trail_stack.get_num_scopes());
         m_bool_var2atom.reset();
         m_fixed_var_table.reset();
+        m_delayed.reset();
+        m_delayed_blasted.reset();
+        m_blast_cache.reset();
+        m_blast_cache_keys.reset();
+        m_blast_bits.reset();
+        m_word_queue.reset();
         theory::reset_eh();
     }
 
@@ -1420,7 +2004,9 @@ namespace smt {
         m_bb(ctx.get_manager(), ctx.get_fparams()),
         m_trail_stack(*this),
         m_find(*this),
-        m_approximates_large_bvs(false) {
+        m_approximates_large_bvs(false),
+        m_blast_cache_keys(ctx.get_manager()),
+        m_blast_bits(ctx.get_manager()) {
         memset(m_eq_activity, 0, sizeof(m_eq_activity));
 #if WATCH_DISEQ
         memset(m_diseq_activity, 0, sizeof(m_diseq_activity));
@@ -1556,6 +2142,9 @@ namespace smt {
             }
             m_replay_diseq.reset();
         }
+        for (unsigned i = 0; i < m_word_queue.size() && !ctx.inconsistent(); ++i) 
+            propagate_word(m_word_queue[i]);
+        m_word_queue.reset();
     }
 
     class bit_eq_justification : public justification {
@@ -1718,6 +2307,10 @@ namespace smt {
         st.update("bv bit2core", m_stats.m_num_bit2core);
         st.update("bv->core eq", m_stats.m_num_th2core_eq);
         st.update("bv dynamic eqs", m_stats.m_num_eq_dynamic);
+        st.update("bv delayed", m_stats.m_num_delayed);
+        st.update("bv delayed blasted", m_stats.m_num_delayed_blasted);
+        st.update("bv word propagations", m_stats.m_num_word_props);
+        st.update("bv word conflicts", m_stats.m_num_word_conflicts);
     }
 
     bool theory_bv::check_assignment(theory_var v) {
@@ -19,18 +19,22 @@ Revision History:
 #pragma once
 
 #include "ast/rewriter/bit_blaster/bit_blaster.h"
+#include "ast/rewriter/th_rewriter.h"
 #include "util/trail.h"
 #include "util/union_find.h"
 #include "ast/arith_decl_plugin.h"
 #include "model/numeral_factory.h"
 #include "smt/smt_theory.h"
 #include "smt/params/theory_bv_params.h"
+#include "smt/bv_word_domain.h"
 
 namespace smt {
     
     struct theory_bv_stats {
         unsigned   m_num_diseq_static, m_num_diseq_dynamic, m_num_bit2core, m_num_th2core_eq, m_num_conflicts;
         unsigned   m_num_eq_dynamic;
+        unsigned   m_num_delayed, m_num_delayed_blasted;
+        unsigned   m_num_word_props, m_num_word_conflicts;
         void reset() { memset(this, 0, sizeof(theory_bv_stats)); }
         theory_bv_stats() { reset(); }
     };
@@ -64,7 +68,8 @@ namespace smt {
         struct le_atom : public atom {
             literal    m_var;
             literal    m_def;
-            le_atom(literal v, literal d):m_var(v), m_def(d) {}
+            theory_var m_bound_var; // variable compared with a numeral, used by word-level propagation
+            le_atom(literal v, literal d):m_var(v), m_def(d), m_bound_var(null_theory_var) {}
             ~le_atom() override {}
             bool is_bit() const override { return false; }
         };
@@ -134,6 +139,26 @@ namespace smt {
         svector<var_pos>         m_prop_queue;
         bool                     m_approximates_large_bvs;
 
+        // delayed bit-blasting of multipliers, dividers and remainders (smt.bv.delay)
+        ptr_vector<app>          m_delayed;           // delayed terms, backtrackable
+        obj_hashtable<app>       m_delayed_blasted;   // delayed terms whose circuit is asserted in the current scope
+        obj_map<app, unsigned>   m_blast_cache;       // term -> offset of its circuit in m_blast_bits, survives pop
+        expr_ref_vector          m_blast_cache_keys;
+        expr_ref_vector          m_blast_bits;
+        scoped_ptr<th_rewriter>  m_delayed_rw;
+
+        // word-level propagation of delayed terms and, with smt.bv.word_prop, of blasted terms
+        struct word_bound {
+            bool_var m_atom;
+            rational m_val;
+            bool     m_upper;             // m_atom is (bvule v m_val), otherwise (bvule m_val v)
+            word_bound(bool_var a, rational const& val, bool upper): m_atom(a), m_val(val), m_upper(upper) {}
+        };
+        vector<vector<app*>>       m_word_parents;    // argument variable -> propagated terms using it
+        vector<vector<word_bound>> m_word_bounds;     // variable -> unsigned comparisons with numerals
+        obj_hashtable<app>         m_word_terms;      // blasted terms propagated at word level
+        ptr_vector<app>            m_word_queue;      // terms with newly assigned argument bits or bounds
+
         theory_var find(theory_var v) const { return m_find.find(v); }
         theory_var next(theory_var v) const { return m_find.next(v); }
         bool is_root(theory_var v) const { return m_find.is_root(v); }
@@ -212,6 +237,26 @@ namespace smt {
 
         bool approximate_term(app* n);
 
+        bool should_delay(app* n) const;
+        void internalize_delayed(app* n);
+        bool check_delayed();
+        bool is_delayed_consistent(app* n);
+        bool propagate_delayed(app* n);
+        bool eval_delayed(app* n, numeral& r);
+        literal get_assigned_bit(theory_var v, unsigned idx) const;
+        void assign_word_bit(theory_var v, unsigned idx, bool is_true, literal_vector const& antecedents);
+        th_rewriter& delayed_rw();
+        void blast_delayed(app* n);
+        void mk_delayed_bits(app* n, expr_ref_vector& bits);
+
+        bool is_word_term(app* n) const;
+        void register_word_term(app* n);
+        void register_word_bound(app* atom, le_atom* a);
+        void enqueue_word(theory_var v);
+        void propagate_word(app* n);
+        bv_word_domain get_word_domain(theory_var v, literal_vector& antecedents) const;
+        bool propagate_domain(app* n);
+
         template<bool Signed>
         void internalize_le(app * atom);
         bool internalize_xor3(app * n, bool gate_ctx);
@@ -239,7 +284,7 @@ namespace smt {
         bool include_func_interp(func_decl* f) override;
         svector<theory_var>   m_merge_aux[2]; //!< auxiliary vector used in merge_zero_one_bits
         bool merge_zero_one_bits(theory_var r1, theory_var r2);
-        bool can_propagate() override { return !m_replay_diseq.empty(); }
+        bool can_propagate() override { return !m_replay_diseq.empty() || !m_word_queue.empty(); }
         void propagate() override;
 
         // -----------------------------------
@@ -264,10 +264,15 @@ namespace smt {
         VERIFY(r == static_cast<theory_var>(m_find.mk_var()));
         SASSERT(r == static_cast<int>(m_var_data.size()));
         m_var_data.push_back(alloc(var_data));
+        // fresh variables precede all existing variables in the topological order
+        m_oc_order.push_back(-r);
+        m_oc_mark.push_back(0);
+        m_oc_pred.push_back(nullptr);
         var_data * d  = m_var_data[r];
         ctx.attach_th_var(n, this, r);
         if (is_constructor(n)) {
             d->m_constructor = n;
+            oc_register(r, n);
             assert_accessor_axioms(n);
         }
         else if (is_update_field(n)) {
@@ -461,6 +466,9 @@ namespace smt {
         unsigned num_old_vars = get_old_num_vars(num_scopes);
         std::for_each(m_var_data.begin() + num_old_vars, m_var_data.end(), delete_proc<var_data>());
         m_var_data.shrink(num_old_vars);
+        m_oc_order.shrink(num_old_vars);
+        m_oc_mark.shrink(num_old_vars);
+        m_oc_pred.shrink(num_old_vars);
         theory::pop_scope_eh(num_scopes);
         SASSERT(m_find.get_num_vars() == m_var_data.size());
         SASSERT(m_find.get_num_vars() == get_num_vars());
@@ -473,7 +481,7 @@ namespace smt {
         for (int v = 0; v < num_vars; v++) {
             if (v == static_cast<int>(m_find.find(v))) {
                 enode * node = get_enode(v);
-                if (!oc_cycle_free(node) && occurs_check(node)) {
+                if (m_oc_full && !oc_cycle_free(node) && occurs_check(node)) {
                     // conflict was detected... 
                     // return...
                     return FC_CONTINUE;
@@ -621,6 +629,201 @@ namespace smt {
         return m_array_args;
     }
 
+    /**
+       \brief Return the equivalence class of a constructor argument if it is an edge of the
+       constructor graph.
+    */
+    theory_var theory_datatype::oc_child(enode * arg) {
+        if (!m_util.is_datatype(m.get_sort(arg->get_owner())))
+            return null_theory_var;
+        theory_var v = arg->get_th_var(get_id());
+        return v == null_theory_var ? v : m_find.find(v);
+    }
+
+    /**
+       \brief Register the fresh constructor variable v for n with the classes of its arguments.
+       The edges of v satisfy the topological order because v precedes all other variables.
+    */
+    void theory_datatype::oc_register(theory_var v, enode * n) {
+        for (enode * arg : enode::args(n)) {
+            sort * s = m.get_sort(arg->get_owner());
+            if (m_autil.is_array(s) && m_util.is_datatype(get_array_range(s))) {
+                oc_set_full();
+                continue;
+            }
+            if (!m_util.is_datatype(s))
+                continue;
+            theory_var w = arg->get_th_var(get_id());
+            if (w == null_theory_var) {
+                oc_set_full();
+                continue;
+            }
+            m_var_data[w]->m_parents.push_back(n);
+            m_trail_stack.push(push_back_trail<theory_datatype, enode *, false>(m_var_data[w]->m_parents));
+        }
+    }
+
+    /**
+       \brief Use the full occurs check while a constructor with an edge that is not indexed
+       is internalized. The flag is restored when the scope of the constructor is popped.
+    */
+    void theory_datatype::oc_set_full() {
+        if (m_oc_full)
+            return;
+        m_trail_stack.push(value_trail<theory_datatype, bool>(m_oc_full));
+        m_oc_full = true;
+    }
+
+    void theory_datatype::oc_inc_ts() {
+        if (++m_oc_ts == 0) {
+            for (unsigned & mark : m_oc_mark)
+                mark = 0;
+            m_oc_ts = 1;
+        }
+    }
+
+    /**
+       \brief Add the edge u -> w for the argument of the constructor c of u.
+       Return true if the edge closes a cycle, in which case a conflict is set.
+    */
+    bool theory_datatype::oc_add_edge(theory_var u, enode * c, theory_var w) {
+        if (u != w && m_oc_order[u] < m_oc_order[w])
+            return false;
+        if (u == w || oc_forward(w, u, m_oc_order[u])) {
+            oc_conflict(u, c, w);
+            return true;
+        }
+        oc_backward(u, m_oc_order[w]);
+        oc_reorder();
+        return false;
+    }
+
+    /**
+       \brief Collect the classes reachable from w whose position is at most ub.
+       Only edges that respect the order are followed, the others are pending
+       edges of the current merge. Return true if u is reachable.
+    */
+    bool theory_datatype::oc_forward(theory_var w, theory_var u, int ub) {
+        oc_inc_ts();
+        m_oc_fwd.reset();
+        m_oc_todo.reset();
+        m_oc_todo.push_back(w);
+        m_oc_mark[w] = m_oc_ts;
+        while (!m_oc_todo.empty()) {
+            theory_var n = m_oc_todo.back();
+            m_oc_todo.pop_back();
+            m_oc_fwd.push_back(n);
+            enode * c = m_var_data[n]->m_constructor;
+            if (c == nullptr)
+                continue;
+            for (enode * arg : enode::args(c)) {
+                theory_var v = oc_child(arg);
+                if (v == null_theory_var || m_oc_mark[v] == m_oc_ts || m_oc_order[v] <= m_oc_order[n] || m_oc_order[v] > ub)
+                    continue;
+                m_oc_pred[v] = c;
+                if (v == u)
+                    return true;
+                m_oc_mark[v] = m_oc_ts;
+                m_oc_todo.push_back(v);
+            }
+        }
+        return false;
+    }
+
+    /**
+       \brief Collect the classes that reach u whose position is at least lb.
+    */
+    void theory_datatype::oc_backward(theory_var u, int lb) {
+        oc_inc_ts();
+        m_oc_bwd.reset();
+        m_oc_todo.reset();
+        m_oc_todo.push_back(u);
+        m_oc_mark[u] = m_oc_ts;
+        while (!m_oc_todo.empty()) {
+            theory_var n = m_oc_todo.back();
+            m_oc_todo.pop_back();
+            m_oc_bwd.push_back(n);
+            theory_var x = n;
+            do {
+                for (enode * c : m_var_data[x]->m_parents) {
+                    theory_var p = m_find.find(c->get_th_var(get_id()));
+                    if (m_oc_mark[p] == m_oc_ts || m_var_data[p]->m_constructor != c ||
+                        m_oc_order[p] >= m_oc_order[n] || m_oc_order[p] < lb)
+                        continue;
+                    m_oc_mark[p] = m_oc_ts;
+                    m_oc_todo.push_back(p);
+                }
+                x = m_find.next(x);
+            }
+            while (x != n);
+        }
+    }
+
+    /**
+       \brief Move the classes that reach u before the classes reachable from w,
+       reusing their positions.
+    */
+    void theory_datatype::oc_reorder() {
+        auto lt = [&](theory_var a, theory_var b) { return m_oc_order[a] < m_oc_order[b]; };
+        std::sort(m_oc_bwd.begin(), m_oc_bwd.end(), lt);
+        std::sort(m_oc_fwd.begin(), m_oc_fwd.end(), lt);
+        m_oc_positions.reset();
+        for (theory_var v : m_oc_bwd)
+            m_oc_positions.push_back(m_oc_order[v]);
+        for (theory_var v : m_oc_fwd)
+            m_oc_positions.push_back(m_oc_order[v]);
+        std::sort(m_oc_positions.begin(), m_oc_positions.end());
+        unsigned i = 0;
+        for (theory_var v : m_oc_bwd) {
+            int pos = m_oc_positions[i++];
+            if (m_oc_order[v] != pos) {
+                m_trail_stack.push(vector_value_trail<theory_datatype, int, false>(m_oc_order, v));
+                m_oc_order[v] = pos;
+            }
+        }
+        for (theory_var v : m_oc_fwd) {
+            int pos = m_oc_positions[i++];
+            if (m_oc_order[v] != pos) {
+                m_trail_stack.push(vector_value_trail<theory_datatype, int, false>(m_oc_order, v));
+                m_oc_order[v] = pos;
+            }
+        }
+        m_stats.m_oc_reorder++;
+    }
+
+    /**
+       \brief Explain the cycle u -> w -> ... -> u, where the edge u -> w is an argument of c
+       and the path from w to u is recorded in m_oc_pred.
+    */
+    void theory_datatype::oc_conflict(theory_var u, enode * c, theory_var w) {
+        m_used_eqs.reset();
+        auto explain_edge = [&](enode * parent, theory_var child) {
+            enode * cstor = m_var_data[child]->m_constructor;
+            for (enode * arg : enode::args(parent)) {
+                if (oc_child(arg) == child) {
+                    if (arg != cstor)
+                        m_used_eqs.push_back(enode_pair(arg, cstor));
+                    return;
+                }
+            }
+            UNREACHABLE();
+        };
+        theory_var n = u;
+        while (n != w) {
+            enode * parent = m_oc_pred[n];
+            explain_edge(parent, n);
+            n = m_find.find(parent->get_th_var(get_id()));
+        }
+        explain_edge(c, w);
+        TRACE("datatype",
+              tout << "occurs_check cycle v" << u << " -> v" << w << "\n";
+              for (enode_pair const& p : m_used_eqs) {
+                  tout << enode_eq_pp(p, ctx);
+              });
+        region & r = ctx.get_region();
+        ctx.set_conflict(ctx.mk_justification(ext_theory_conflict_justification(get_id(), r, 0, nullptr, m_used_eqs.size(), m_used_eqs.c_ptr())));
+    }
+
     /**
        \brief Check if n can be reached starting from n and following equalities and constructors.
        For example, occur_check(a1) returns true in the following set of equalities:
@@ -669,6 +872,11 @@ namespace smt {
         m_trail_stack.reset();
         std::for_each(m_var_data.begin(), m_var_data.end(), delete_proc<var_data>());
         m_var_data.reset();
+        m_oc_order.reset();
+        m_oc_mark.reset();
+        m_oc_pred.reset();
+        m_oc_ts = 0;
+        m_oc_full = false;
         theory::reset_eh();
         m_util.reset();
         m_stats.reset();
@@ -691,7 +899,9 @@ namespace smt {
         m_util(m),
         m_autil(m),
         m_find(*this),
-        m_trail_stack(*this) {
+        m_trail_stack(*this),
+        m_oc_ts(0),
+        m_oc_full(false) {
     }
 
     theory_datatype::~theory_datatype() {
@@ -709,6 +919,7 @@ namespace smt {
 
     void theory_datatype::collect_statistics(::statistics & st) const {
         st.update("datatype occurs check", m_stats.m_occurs_check);
+        st.update("datatype occurs check reorder", m_stats.m_oc_reorder);
         st.update("datatype splits", m_stats.m_splits);
         st.update("datatype constructor ax", m_stats.m_assert_cnstr);
         st.update("datatype accessor ax", m_stats.m_assert_accessor);
@@ -802,6 +1013,33 @@ namespace smt {
                 add_recognizer(v1, e);
     }
 
+    void theory_datatype::after_merge_eh(theory_var r1, theory_var r2, theory_var v1, theory_var v2) {
+        // r1 is the new root
+        if (ctx.inconsistent())
+            return;
+        // constructors with an argument in the class of r2 now have an argument in the class of r1.
+        // The members of the class of r2 follow r1 in the class list, ending with r2.
+        theory_var x = r1;
+        do {
+            x = m_find.next(x);
+            for (enode * c : m_var_data[x]->m_parents) {
+                theory_var p = m_find.find(c->get_th_var(get_id()));
+                if (m_var_data[p]->m_constructor == c && oc_add_edge(p, c, r1))
+                    return;
+            }
+        }
+        while (x != r2);
+        // the class of r1 inherited the constructor of r2
+        enode * c = m_var_data[r1]->m_constructor;
+        if (c != nullptr && c == m_var_data[r2]->m_constructor) {
+            for (enode * arg : enode::args(c)) {
+                theory_var w = oc_child(arg);
+                if (w != null_theory_var && oc_add_edge(r1, c, w))
+                    return;
+            }
+        }
+    }
+
     void theory_datatype::unmerge_eh(theory_var v1, theory_var v2) {
         // do nothing
     }
@@ -34,13 +34,14 @@ namespace smt {
         struct var_data {
             ptr_vector<enode> m_recognizers; //!< recognizers of this equivalence class that are being watched.
             enode *           m_constructor; //!< constructor of this equivalence class, 0 if there is no constructor in the eqc.
+            ptr_vector<enode> m_parents;     //!< constructor applications that have this variable as an argument.
             var_data():
                 m_constructor(nullptr) {
             }
         };
 
         struct stats {
-            unsigned   m_occurs_check, m_splits;
+            unsigned   m_occurs_check, m_splits, m_oc_reorder;
             unsigned   m_assert_cnstr, m_assert_accessor, m_assert_update_field;
             void reset() { memset(this, 0, sizeof(stats)); }
             stats() { reset(); }
@@ -91,6 +92,29 @@ namespace smt {
         bool oc_cycle_free(enode * n) const { return n->get_root()->is_marked2(); }
 
         void oc_push_stack(enode * n);
+
+        // Incremental occurs check.
+        // The graph with an edge from each equivalence class with a constructor to the
+        // classes of the constructor arguments is kept in a topological order that is
+        // updated when classes are merged (Pearce and Kelly, dynamic topological sort).
+        // Order changes are undone on backtracking.
+        svector<int>          m_oc_order;   // position of the equivalence class of a variable
+        svector<unsigned>     m_oc_mark;
+        unsigned              m_oc_ts;
+        ptr_vector<enode>     m_oc_pred;    // constructor through which a class was reached in forward search
+        svector<theory_var>   m_oc_todo, m_oc_fwd, m_oc_bwd;
+        svector<int>          m_oc_positions;
+        bool                  m_oc_full;    // edges through arrays are not indexed, use the full occurs check, backtrackable
+
+        theory_var oc_child(enode * arg);
+        void oc_register(theory_var v, enode * n);
+        void oc_set_full();
+        bool oc_add_edge(theory_var u, enode * c, theory_var w);
+        bool oc_forward(theory_var w, theory_var u, int ub);
+        void oc_backward(theory_var u, int lb);
+        void oc_reorder();
+        void oc_conflict(theory_var u, enode * c, theory_var w);
+        void oc_inc_ts();
         ptr_vector<enode> m_array_args;
         ptr_vector<enode> const& get_array_args(enode* n);
 
@@ -139,7 +163,7 @@ namespace smt {
         model_value_proc * mk_value(enode * n, model_generator & m) override;
         th_trail_stack & get_trail_stack() { return m_trail_stack; }
         virtual void merge_eh(theory_var v1, theory_var v2, theory_var, theory_var);
-        static void after_merge_eh(theory_var r1, theory_var r2, theory_var v1, theory_var v2) {}
+        void after_merge_eh(theory_var r1, theory_var r2, theory_var v1, theory_var v2);
         void unmerge_eh(theory_var v1, theory_var v2);
         char const * get_name() const override { return "datatype"; }
         bool include_func_interp(func_decl* f) override;
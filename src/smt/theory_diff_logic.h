@@ -183,6 +183,7 @@ namespace smt {
         ptr_vector<atom>               m_atoms;
         ptr_vector<atom>               m_asserted_atoms;   // set of asserted atoms
         unsigned                       m_asserted_qhead;   
+        svector<edge_id>               m_edge_batch;       // edges of the pending asserted atoms
         bool_var2atom                  m_bool_var2atom;
         svector<scope>                 m_scopes;
 
@@ -569,6 +569,22 @@ void theory_diff_logic<Ext>::inc_conflicts() {
 
 template<typename Ext>
 void theory_diff_logic<Ext>::propagate_core() {
+    unsigned num_atoms = m_asserted_atoms.size() - m_asserted_qhead;
+    if (num_atoms > 1 && !ctx.inconsistent()) {
+        // enable the pending edges as a batch
+        m_edge_batch.reset();
+        for (unsigned i = m_asserted_qhead; i < m_asserted_atoms.size(); ++i) {
+            m_edge_batch.push_back(m_asserted_atoms[i]->get_asserted_edge());
+        }
+        unsigned num_enabled = 0;
+        bool consistent = m_graph.enable_edges(num_atoms, m_edge_batch.c_ptr(), num_enabled);
+        m_asserted_qhead += num_enabled;
+        if (!consistent) {
+            TRACE("arith", display(tout););
+            set_neg_cycle_conflict();
+        }
+        return;
+    }
     bool consistent = true;
     while (consistent && can_propagate()) {
         atom * a = m_asserted_atoms[m_asserted_qhead];
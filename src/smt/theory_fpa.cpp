@@ -84,6 +84,10 @@ namespace smt {
         }
     }
 
+    expr * theory_fpa::fpa2bv_converter_wrapped::get_abstraction(expr * e) {
+        return m_th.get_abstraction(e);
+    }
+
     theory_fpa::theory_fpa(context& ctx) :
         theory(ctx, ctx.get_manager().mk_family_id("fpa")),
         m_converter(ctx.get_manager(), this),
@@ -93,7 +97,8 @@ namespace smt {
         m_fpa_util(m_converter.fu()),
         m_bv_util(m_converter.bu()),
         m_arith_util(m_converter.au()),
-        m_is_initialized(true)
+        m_is_initialized(true),
+        m_lazy(ctx.get_fparams().m_fp_lazy)
     {
         params_ref p;
         p.set_bool("arith_lhs", true);
@@ -106,6 +111,7 @@ namespace smt {
 
         if (m_is_initialized) {
             dec_ref_map_key_values(m, m_conversions);
+            dec_ref_map_key_values(m, m_abstractions);
             dec_ref_collection_values(m, m_is_added_to_model);
 
             m_converter.reset();
@@ -116,6 +122,7 @@ namespace smt {
 
         SASSERT(m_trail_stack.get_num_scopes() == 0);
         SASSERT(m_conversions.empty());
+        SASSERT(m_abstractions.empty());
         SASSERT(m_is_added_to_model.empty());
     }
 
@@ -461,11 +468,263 @@ namespace smt {
             }
             default: /* ignore */;
             }
+
+            if (m_lazy && is_lazy_op(term)) {
+                m_abstracted.push_back(term);
+                m_trail_stack.push(push_back_vector<theory_fpa, ptr_vector<app>>(m_abstracted));
+                m_stats.m_num_abstractions++;
+                assert_abstraction_axioms(term);
+            }
+        }
+
+        return true;
+    }
+
+    bool theory_fpa::is_lazy_op(expr * e) const {
+        if (!is_app(e) || to_app(e)->get_family_id() != get_family_id())
+            return false;
+        switch (to_app(e)->get_decl_kind()) {
+        case OP_FPA_MUL:
+        case OP_FPA_DIV:
+        case OP_FPA_FMA:
+        case OP_FPA_SQRT:
+        case OP_FPA_REM:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    /**
+       \brief An abstracted term is translated to the bit-vector wrapping it, as constants are.
+    */
+    expr * theory_fpa::get_abstraction(expr * e) {
+        if (!m_lazy || !is_lazy_op(e) || m_refined.contains(e))
+            return nullptr;
+        expr * r = nullptr;
+        if (!m_abstractions.find(e, r)) {
+            app_ref a = unwrap(wrap(e), m.get_sort(e));
+            r = a;
+            m.inc_ref(e);
+            m.inc_ref(r);
+            m_abstractions.insert(e, r);
+        }
+        return r;
+    }
+
+    /**
+       \brief cheap properties of abstracted terms: propagation of NaN, infinities, signs
+       and zeros, and bounds on the magnitude of the result by the magnitudes of the arguments.
+       The bounds hold under every rounding mode: rounding is monotone, and the bounds
+       (1 and the arguments) are representable, so they are preserved by rounding.
+    */
+    void theory_fpa::assert_abstraction_axioms(app * t) {
+        fpa_util & fu = m_fpa_util;
+        expr_ref_vector fmls(m);
+        expr_ref nan_t(fu.mk_is_nan(t), m);
+        expr_ref not_nan_t(m.mk_not(nan_t), m);
+        decl_kind k = t->get_decl_kind();
+        unsigned first = k == OP_FPA_REM ? 0 : 1;
+        for (unsigned i = first; i < t->get_num_args(); ++i)
+            fmls.push_back(m.mk_implies(fu.mk_is_nan(t->get_arg(i)), nan_t));
+        expr * x = t->get_arg(first);
+        expr * y = first + 1 < t->get_num_args() ? t->get_arg(first + 1) : nullptr;
+        scoped_mpf one_v(fu.fm());
+        fu.fm().set(one_v, fu.get_ebits(m.get_sort(t)), fu.get_sbits(m.get_sort(t)), 1);
+        expr_ref one(fu.mk_value(one_v), m);
+        auto is_finite = [&](expr * e) { return m.mk_and(m.mk_not(fu.mk_is_nan(e)), m.mk_not(fu.mk_is_inf(e))); };
+        auto abs_le = [&](expr * a, expr * b) { return fu.mk_le(fu.mk_abs(a), fu.mk_abs(b)); };
+        switch (k) {
+        case OP_FPA_MUL:
+            fmls.push_back(m.mk_implies(not_nan_t, m.mk_eq(fu.mk_is_negative(t), m.mk_xor(fu.mk_is_negative(x), fu.mk_is_negative(y)))));
+            fmls.push_back(m.mk_implies(m.mk_and(fu.mk_is_zero(x), is_finite(y)), fu.mk_is_zero(t)));
+            fmls.push_back(m.mk_implies(m.mk_and(fu.mk_is_zero(y), is_finite(x)), fu.mk_is_zero(t)));
+            fmls.push_back(m.mk_implies(m.mk_or(m.mk_and(fu.mk_is_inf(x), fu.mk_is_zero(y)),
+                                                m.mk_and(fu.mk_is_zero(x), fu.mk_is_inf(y))), nan_t));
+            fmls.push_back(m.mk_implies(m.mk_and(fu.mk_is_inf(x), m.mk_not(fu.mk_is_nan(y)), m.mk_not(fu.mk_is_zero(y))), fu.mk_is_inf(t)));
+            fmls.push_back(m.mk_implies(m.mk_and(fu.mk_is_inf(y), m.mk_not(fu.mk_is_nan(x)), m.mk_not(fu.mk_is_zero(x))), fu.mk_is_inf(t)));
+            // |x| <= 1 implies |x * y| <= |y|, and 1 <= |x| implies |y| <= |x * y|
+            fmls.push_back(m.mk_implies(m.mk_and(abs_le(x, one), is_finite(y)), abs_le(t, y)));
+            fmls.push_back(m.mk_implies(m.mk_and(abs_le(y, one), is_finite(x)), abs_le(t, x)));
+            fmls.push_back(m.mk_implies(m.mk_and(abs_le(one, x), m.mk_not(fu.mk_is_inf(x)), m.mk_not(fu.mk_is_nan(y))), abs_le(y, t)));
+            fmls.push_back(m.mk_implies(m.mk_and(abs_le(one, y), m.mk_not(fu.mk_is_inf(y)), m.mk_not(fu.mk_is_nan(x))), abs_le(x, t)));
+            break;
+        case OP_FPA_DIV:
+            fmls.push_back(m.mk_implies(not_nan_t, m.mk_eq(fu.mk_is_negative(t), m.mk_xor(fu.mk_is_negative(x), fu.mk_is_negative(y)))));
+            fmls.push_back(m.mk_implies(m.mk_and(fu.mk_is_zero(x), m.mk_not(fu.mk_is_nan(y)), m.mk_not(fu.mk_is_zero(y))), fu.mk_is_zero(t)));
+            fmls.push_back(m.mk_implies(m.mk_and(fu.mk_is_inf(y), is_finite(x)), fu.mk_is_zero(t)));
+            fmls.push_back(m.mk_implies(m.mk_or(m.mk_and(fu.mk_is_zero(x), fu.mk_is_zero(y)),
+                                                m.mk_and(fu.mk_is_inf(x), fu.mk_is_inf(y))), nan_t));
+            fmls.push_back(m.mk_implies(m.mk_and(fu.mk_is_inf(x), is_finite(y)), fu.mk_is_inf(t)));
+            fmls.push_back(m.mk_implies(m.mk_and(fu.mk_is_zero(y), m.mk_not(fu.mk_is_nan(x)), m.mk_not(fu.mk_is_zero(x))), fu.mk_is_inf(t)));
+            // 1 <= |y| implies |x / y| <= |x|, and |y| <= 1 implies |x| <= |x / y|
+            fmls.push_back(m.mk_implies(m.mk_and(abs_le(one, y), is_finite(x)), abs_le(t, x)));
+            fmls.push_back(m.mk_implies(m.mk_and(abs_le(y, one), m.mk_not(fu.mk_is_zero(y)), m.mk_not(fu.mk_is_nan(x))), abs_le(x, t)));
+            break;
+        case OP_FPA_FMA:
+            fmls.push_back(m.mk_implies(m.mk_or(m.mk_and(fu.mk_is_inf(x), fu.mk_is_zero(y)),
+                                                m.mk_and(fu.mk_is_zero(x), fu.mk_is_inf(y))), nan_t));
+            break;
+        case OP_FPA_SQRT:
+            fmls.push_back(m.mk_implies(m.mk_and(fu.mk_is_negative(x), m.mk_not(fu.mk_is_zero(x))), nan_t));
+            fmls.push_back(m.mk_implies(m.mk_and(not_nan_t, m.mk_not(fu.mk_is_zero(t))), fu.mk_is_positive(t)));
+            fmls.push_back(m.mk_implies(fu.mk_is_zero(x), m.mk_and(fu.mk_is_zero(t), m.mk_eq(fu.mk_is_negative(t), fu.mk_is_negative(x)))));
+            fmls.push_back(m.mk_implies(m.mk_and(fu.mk_is_inf(x), fu.mk_is_positive(x)), fu.mk_is_inf(t)));
+            // sqrt(x) lies between x and 1
+            fmls.push_back(m.mk_implies(fu.mk_le(one, x), m.mk_and(fu.mk_le(one, t), fu.mk_le(t, x))));
+            fmls.push_back(m.mk_implies(m.mk_and(fu.mk_is_positive(x), fu.mk_le(x, one)), m.mk_and(fu.mk_le(x, t), fu.mk_le(t, one))));
+            break;
+        case OP_FPA_REM:
+            fmls.push_back(m.mk_implies(m.mk_or(fu.mk_is_inf(x), fu.mk_is_zero(y)), nan_t));
+            fmls.push_back(m.mk_implies(m.mk_and(fu.mk_is_inf(y), is_finite(x)), m.mk_eq(t, x)));
+            fmls.push_back(m.mk_implies(not_nan_t, abs_le(t, y)));
+            break;
+        default:
+            break;
+        }
+        for (expr * f : fmls) {
+            expr_ref fml(f, m);
+            m_th_rw(fml);
+            assert_cnstr(fml);
+        }
+    }
+
+    bool theory_fpa::get_bv_value(expr * e, rational & val) {
+        unsigned sz;
+        if (m_bv_util.is_numeral(e, val, sz))
+            return true;
+        if (!ctx.e_internalized(e))
+            return false;
+        theory_var v = ctx.get_enode(e)->get_th_var(m_bv_util.get_family_id());
+        if (v == null_theory_var)
+            return false;
+        theory_bv * th = static_cast<theory_bv*>(ctx.get_theory(m_bv_util.get_family_id()));
+        return th->get_fixed_value(to_app(e), val);
+    }
+
+    /**
+       \brief value of a floating-point term in the current assignment, decoded as in fpa_value_proc.
+    */
+    bool theory_fpa::get_value(expr * e, scoped_mpf & val) {
+        if (m_fpa_util.is_numeral(e, val))
+            return true;
+        mpf_manager & mpfm = m_fpa_util.fm();
+        unsynch_mpz_manager & mpzm = mpfm.mpz_manager();
+        sort * s = m.get_sort(e);
+        unsigned ebits = m_fpa_util.get_ebits(s);
+        unsigned sbits = m_fpa_util.get_sbits(s);
+        rational all(0);
+        if (m_fpa_util.is_fp(e)) {
+            rational sgn, exp, sig;
+            if (!get_bv_value(to_app(e)->get_arg(0), sgn) ||
+                !get_bv_value(to_app(e)->get_arg(1), exp) ||
+                !get_bv_value(to_app(e)->get_arg(2), sig))
+                return false;
+            all = sgn * rational::power_of_two(ebits + sbits - 1) + exp * rational::power_of_two(sbits - 1) + sig;
         }
+        else if (!get_bv_value(wrap(e), all))
+            return false;
+
+        scoped_mpz all_z(mpzm), sgn_z(mpzm), exp_z(mpzm), sig_z(mpzm), bias(mpzm);
+        mpzm.set(all_z, all.to_mpq().numerator());
+        mpzm.machine_div2k(all_z, ebits + sbits - 1, sgn_z);
+        mpzm.mod(all_z, mpfm.m_powers2(ebits + sbits - 1), all_z);
+        mpzm.machine_div2k(all_z, sbits - 1, exp_z);
+        mpzm.mod(all_z, mpfm.m_powers2(sbits - 1), sig_z);
+        mpzm.power(mpz(2), ebits - 1, bias);
+        mpzm.dec(bias);
+        scoped_mpz exp_u = exp_z - bias;
+        mpfm.set(val, ebits, sbits, mpzm.is_one(sgn_z), mpzm.get_int64(exp_u), sig_z);
+        return true;
+    }
 
+    bool theory_fpa::get_rm_value(expr * e, mpf_rounding_mode & rm) {
+        if (m_fpa_util.is_rm_numeral(e, rm))
+            return true;
+        rational val;
+        if (m_fpa_util.is_bv2rm(e)) {
+            if (!get_bv_value(to_app(e)->get_arg(0), val))
+                return false;
+        }
+        else if (!get_bv_value(wrap(e), val))
+            return false;
+        switch (val.get_unsigned()) {
+        case BV_RM_TIES_TO_AWAY: rm = MPF_ROUND_NEAREST_TAWAY; break;
+        case BV_RM_TIES_TO_EVEN: rm = MPF_ROUND_NEAREST_TEVEN; break;
+        case BV_RM_TO_NEGATIVE: rm = MPF_ROUND_TOWARD_NEGATIVE; break;
+        case BV_RM_TO_POSITIVE: rm = MPF_ROUND_TOWARD_POSITIVE; break;
+        case BV_RM_TO_ZERO:
+        default: rm = MPF_ROUND_TOWARD_ZERO;
+        }
         return true;
     }
 
+    /**
+       \brief check the value of an abstracted term against the value computed by mpf_manager.
+       Terms whose values are not available are treated as inconsistent.
+    */
+    bool theory_fpa::is_consistent(app * t) {
+        mpf_manager & mpfm = m_fpa_util.fm();
+        scoped_mpf v(mpfm), r(mpfm), x(mpfm), y(mpfm), z(mpfm);
+        mpf_rounding_mode rm;
+        if (!get_value(t, v))
+            return false;
+        switch (t->get_decl_kind()) {
+        case OP_FPA_MUL:
+            if (!get_rm_value(t->get_arg(0), rm) || !get_value(t->get_arg(1), x) || !get_value(t->get_arg(2), y))
+                return false;
+            mpfm.mul(rm, x, y, r);
+            break;
+        case OP_FPA_DIV:
+            if (!get_rm_value(t->get_arg(0), rm) || !get_value(t->get_arg(1), x) || !get_value(t->get_arg(2), y))
+                return false;
+            mpfm.div(rm, x, y, r);
+            break;
+        case OP_FPA_FMA:
+            if (!get_rm_value(t->get_arg(0), rm) || !get_value(t->get_arg(1), x) ||
+                !get_value(t->get_arg(2), y) || !get_value(t->get_arg(3), z))
+                return false;
+            mpfm.fma(rm, x, y, z, r);
+            break;
+        case OP_FPA_SQRT:
+            if (!get_rm_value(t->get_arg(0), rm) || !get_value(t->get_arg(1), x))
+                return false;
+            mpfm.sqrt(rm, x, r);
+            break;
+        case OP_FPA_REM:
+            if (!get_value(t->get_arg(0), x) || !get_value(t->get_arg(1), y))
+                return false;
+            mpfm.rem(x, y, r);
+            break;
+        default:
+            return true;
+        }
+        TRACE("t_fpa", tout << mk_ismt2_pp(t, m) << " := " << mpfm.to_string(v) << " expected " << mpfm.to_string(r) << "\n";);
+        if (mpfm.is_nan(r) || mpfm.is_nan(v))
+            return mpfm.is_nan(r) && mpfm.is_nan(v);
+        return mpfm.sgn(r) == mpfm.sgn(v) && mpfm.exp(r) == mpfm.exp(v) &&
+            mpfm.mpz_manager().eq(mpfm.sig(r), mpfm.sig(v));
+    }
+
+    /**
+       \brief blast t: assert that its abstraction equals the translation of t.
+    */
+    void theory_fpa::refine(app * t) {
+        TRACE("t_fpa", tout << "refine " << mk_ismt2_pp(t, m) << "\n";);
+        m_refined.insert(t);
+        m_trail_stack.push(insert_obj_trail<theory_fpa, expr>(m_refined, t));
+        m_stats.m_num_refinements++;
+        // the rewriter cache may contain the abstraction of t
+        m_rw.reset();
+        expr_ref abs(unwrap(wrap(t), m.get_sort(t)), m);
+        expr_ref conv(convert_term(t), m);
+        expr_ref c(m);
+        m_converter.mk_eq(abs, conv, c);
+        m_th_rw(c);
+        assert_cnstr(c);
+        assert_cnstr(mk_side_conditions());
+    }
+
     void theory_fpa::apply_sort_cnstr(enode * n, sort * s) {
         TRACE("t_fpa", tout << "apply sort cnstr for: " << mk_ismt2_pp(n->get_owner(), m) << "\n";);
         SASSERT(s->get_family_id() == get_family_id());
@@ -673,14 +932,29 @@ namespace smt {
             m_factory = nullptr;
         }
         dec_ref_map_key_values(m, m_conversions);
+        dec_ref_map_key_values(m, m_abstractions);
         dec_ref_collection_values(m, m_is_added_to_model);
+        m_stats.reset();
         theory::reset_eh();
     }
 
     final_check_status theory_fpa::final_check_eh() {
         TRACE("t_fpa", tout << "final_check_eh\n";);
         SASSERT(m_converter.m_extra_assertions.empty());
-        return FC_DONE;
+        final_check_status r = FC_DONE;
+        for (unsigned i = 0; i < m_abstracted.size(); ++i) {
+            app * t = m_abstracted[i];
+            if (m_refined.contains(t) || !ctx.is_relevant(t) || is_consistent(t))
+                continue;
+            refine(t);
+            r = FC_CONTINUE;
+        }
+        return r;
+    }
+
+    void theory_fpa::collect_statistics(::statistics & st) const {
+        st.update("fpa abstractions", m_stats.m_num_abstractions);
+        st.update("fpa refinements", m_stats.m_num_refinements);
     }
 
     void theory_fpa::init_model(model_generator & mg) {
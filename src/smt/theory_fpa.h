@@ -95,6 +95,14 @@ namespace smt {
             virtual ~fpa2bv_converter_wrapped() {}
             void mk_const(func_decl * f, expr_ref & result) override;
             void mk_rm_const(func_decl * f, expr_ref & result) override;
+            expr * get_abstraction(expr * e) override;
+        };
+
+        struct stats {
+            unsigned m_num_abstractions;
+            unsigned m_num_refinements;
+            void reset() { memset(this, 0, sizeof(*this)); }
+            stats() { reset(); }
         };
 
         class fpa_value_proc : public model_value_proc {
@@ -156,6 +164,13 @@ namespace smt {
         obj_map<expr, expr*>      m_conversions;
         bool                      m_is_initialized;
         obj_hashtable<func_decl>  m_is_added_to_model;
+        // lazy mode: multiplication, division, fma, square root and remainder
+        // are blasted only when the candidate model violates their semantics.
+        bool                      m_lazy;
+        ptr_vector<app>           m_abstracted;    // abstracted terms, in internalization order
+        obj_hashtable<expr>       m_refined;       // abstracted terms that are blasted
+        obj_map<expr, expr*>      m_abstractions;  // term -> bit-vector representation of its value
+        stats                     m_stats;
 
         final_check_status final_check_eh() override;
         bool internalize_atom(app * atom, bool gate_ctx) override;
@@ -181,6 +196,7 @@ namespace smt {
         ~theory_fpa() override;
 
         void display(std::ostream & out) const override;
+        void collect_statistics(::statistics & st) const override;
 
     protected:
         expr_ref mk_side_conditions();
@@ -198,6 +214,15 @@ namespace smt {
         enode* ensure_enode(expr* e);
         enode* get_root(expr* a) { return ensure_enode(a)->get_root(); }
         app* get_ite_value(expr* e);
+
+        bool is_lazy_op(expr * e) const;
+        expr * get_abstraction(expr * e);
+        void assert_abstraction_axioms(app * t);
+        bool get_bv_value(expr * e, rational & val);
+        bool get_value(expr * e, scoped_mpf & val);
+        bool get_rm_value(expr * e, mpf_rounding_mode & rm);
+        bool is_consistent(app * t);
+        void refine(app * t);
     };
 
 };
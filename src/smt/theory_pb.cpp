@@ -165,6 +165,38 @@ namespace smt {
         m_nfixed = 0;
         m_max_sum.reset();
         m_min_sum.reset();
+        m_small = false;
+        m_k64[0] = m_k64[1] = 0;
+        m_coeffs64[0].reset();
+        m_coeffs64[1].reset();
+        m_watch_sum64 = 0;
+        m_max_watch64 = 0;
+    }
+
+    /**
+       \brief use 64-bit arithmetic for watches if the sum of coefficients is below 2^60.
+       Watch sums, bounds and the bound plus two coefficients then fit in 64 bits.
+    */
+    void theory_pb::ineq::init_small() {
+        static const uint64_t small_limit = 1ull << 60;
+        m_small = false;
+        rational sum(0);
+        for (auto const& a : m_args[0]) 
+            sum += a.second;
+        if (sum >= rational(small_limit, rational::ui64()))
+            return;
+        for (unsigned j = 0; j < 2; ++j) {
+            numeral const& k = m_args[j].m_k;
+            if (!k.is_uint64() || k.get_uint64() >= small_limit)
+                return;
+        }
+        for (unsigned j = 0; j < 2; ++j) {
+            m_k64[j] = m_args[j].m_k.get_uint64();
+            m_coeffs64[j].reset();
+            for (auto const& a : m_args[j]) 
+                m_coeffs64[j].push_back(a.second.get_uint64());
+        }
+        m_small = true;
     }
 
 
@@ -581,6 +613,10 @@ namespace smt {
             }
         }
 
+        c->init_small();
+        if (c->is_small()) {
+            m_stats.m_num_small++;
+        }
         init_watch_ineq(*c);
         init_watch(abv);
         m_var_infos[abv].m_ineq = c.detach();
@@ -643,38 +679,55 @@ namespace smt {
         watch.pop_back();
         
         SASSERT(ineq_index < c.watch_size());
-        scoped_mpz coeff(m_mpz_mgr);
-        coeff = c.ncoeff(ineq_index);
+        if (c.is_small()) 
+            del_watch(uint64_coeffs(c), ineq_index);
+        else 
+            del_watch(mpz_coeffs(c), ineq_index);
+        // current index of unwatched literal is c.watch_size().
+    }
+
+    template<typename Coeffs>
+    void theory_pb::del_watch(Coeffs cs, unsigned ineq_index) {
+        ineq& c = cs.c;
+        typename Coeffs::numeral coeff = cs.mk();
+        coeff = cs.coeff(ineq_index);
         if (ineq_index + 1 < c.watch_size()) {
-            std::swap(c.args()[ineq_index], c.args()[c.watch_size()-1]);
+            c.swap_args(ineq_index, c.watch_size()-1);
         }
         --c.m_watch_sz;
-        c.m_watch_sum  -= coeff;
-        if (coeff == c.max_watch()) {
-            coeff = c.ncoeff(0);
-            for (unsigned i = 1; coeff != c.max_watch() && i < c.watch_size(); ++i) {
-                if (coeff < c.ncoeff(i)) coeff = c.ncoeff(i);
+        cs.watch_sum() -= coeff;
+        if (coeff == cs.max_watch()) {
+            coeff = cs.coeff(0);
+            for (unsigned i = 1; coeff != cs.max_watch() && i < c.watch_size(); ++i) {
+                if (coeff < cs.coeff(i)) coeff = cs.coeff(i);
             }
-            c.set_max_watch(coeff);
+            cs.max_watch() = coeff;
         }
-
-        // current index of unwatched literal is c.watch_size().
     }
 
     void theory_pb::add_watch(ineq& c, unsigned i) {
         SASSERT(c.is_ge());
-        literal lit = c.lit(i);
-        scoped_mpz coeff(m_mpz_mgr);
-        coeff = c.ncoeff(i);
-        c.m_watch_sum += coeff;
         SASSERT(i >= c.watch_size());
+        if (c.is_small()) 
+            add_watch(uint64_coeffs(c), i);
+        else 
+            add_watch(mpz_coeffs(c), i);
+    }
+
+    template<typename Coeffs>
+    void theory_pb::add_watch(Coeffs cs, unsigned i) {
+        ineq& c = cs.c;
+        literal lit = c.lit(i);
+        typename Coeffs::numeral coeff = cs.mk();
+        coeff = cs.coeff(i);
+        cs.watch_sum() += coeff;
         
         if (i > c.watch_size()) {
-            std::swap(c.args()[i], c.args()[c.watch_size()]);
+            c.swap_args(i, c.watch_size());
         }
         ++c.m_watch_sz;
-        if (coeff > c.max_watch()) {
-            c.set_max_watch(coeff);
+        if (coeff > cs.max_watch()) {
+            cs.max_watch() = coeff;
         }
         watch_literal(lit, &c);
     }
@@ -964,6 +1017,7 @@ namespace smt {
         st.update("pb conflicts", m_stats.m_num_conflicts);
         st.update("pb propagations", m_stats.m_num_propagations);
         st.update("pb predicates", m_stats.m_num_predicates);        
+        st.update("pb small predicates", m_stats.m_num_small);
     }
     
     void theory_pb::reset_eh() {
@@ -1111,49 +1165,59 @@ namespace smt {
         ctx.push_trail(value_trail<context, unsigned>(c.m_nfixed));
 
         SASSERT(c.is_ge());
-        unsigned sz = c.size();
         if (c.lit().sign() == is_true) {
             c.negate();
             ctx.push_trail(negate_ineq(c));
         }
 
-        scoped_mpz maxsum(m_mpz_mgr), mininc(m_mpz_mgr);
+        if (c.is_small()) 
+            assign_ineq(uint64_coeffs(c));
+        else 
+            assign_ineq(mpz_coeffs(c));
+    }
+
+    template<typename Coeffs>
+    void theory_pb::assign_ineq(Coeffs cs) {
+        ineq& c = cs.c;
+        unsigned sz = c.size();
+        typename Coeffs::numeral maxsum = cs.mk(), mininc = cs.mk(), k = cs.mk();
+        bool has_undef = false;
         for (unsigned i = 0; i < sz; ++i) {
             lbool asgn = ctx.get_assignment(c.lit(i));
             if (asgn != l_false) {
-                maxsum += c.ncoeff(i);
+                maxsum += cs.coeff(i);
             }
-            if (asgn == l_undef && (mininc.is_zero() || mininc > c.ncoeff(i))) {
-                mininc = c.ncoeff(i);
+            if (asgn == l_undef && (!has_undef || mininc > cs.coeff(i))) {
+                mininc = cs.coeff(i);
+                has_undef = true;
             }
         }
+        k = cs.k();
 
         TRACE("pb", 
               tout << "assign: " << c.lit() << "\n";
               display(tout, c); );
 
-        if (maxsum < c.mpz_k()) {
+        if (maxsum < k) {
             literal_vector& lits = get_unhelpful_literals(c, false);
             lits.push_back(~c.lit());
             add_clause(c, lits);
         }
         else {
             init_watch_literal(c);
-            SASSERT(c.m_watch_sum >= c.mpz_k());
+            SASSERT(cs.watch_sum() >= k);
             DEBUG_CODE(validate_watch(c););
         }
 
         // perform unit propagation
-        if (maxsum >= c.mpz_k() && maxsum - mininc < c.mpz_k()) { 
+        if (maxsum >= k && maxsum - mininc < k) { 
             literal_vector& lits = get_unhelpful_literals(c, true);
-            // for (literal lit : lits) SASSERT(ctx.get_assignment(lit) == l_true);
             lits.push_back(c.lit());
-            // SASSERT(ctx.get_assignment(c.lit()) == l_true);
             for (unsigned i = 0; i < sz; ++i) {
                 literal lit = c.lit(i);
                 if (ctx.get_assignment(lit) == l_undef) {
                     DEBUG_CODE(validate_assign(c, lits, lit););
-                    add_assign(c, lits, c.lit(i));               
+                    add_assign(c, lits, lit);
                 }
             }
         }
@@ -1175,8 +1239,17 @@ namespace smt {
        (inequalities are closed under negation).       
      */
     bool theory_pb::assign_watch_ge(bool_var v, bool is_true, ineq_watch& watch, unsigned watch_index) {
-        bool removed = false;
         ineq& c = *watch[watch_index];
+        if (c.is_small()) 
+            return assign_watch_ge(uint64_coeffs(c), v, is_true, watch, watch_index);
+        else 
+            return assign_watch_ge(mpz_coeffs(c), v, is_true, watch, watch_index);
+    }
+
+    template<typename Coeffs>
+    bool theory_pb::assign_watch_ge(Coeffs cs, bool_var v, bool is_true, ineq_watch& watch, unsigned watch_index) {
+        bool removed = false;
+        ineq& c = cs.c;
         unsigned w = c.find_lit(v, 0, c.watch_size());
         SASSERT(ctx.get_assignment(c.lit()) == l_true);
         SASSERT(is_true == c.lit(w).sign());
@@ -1186,19 +1259,19 @@ namespace smt {
         // Adjust set of watched literals.
         //
         
-        scoped_mpz k_coeff(m_mpz_mgr), k(m_mpz_mgr);
-        k = c.mpz_k();
+        typename Coeffs::numeral k_coeff = cs.mk(), k = cs.mk();
+        k = cs.k();
         k_coeff = k;
-        k_coeff += c.ncoeff(w);
-        bool add_more = c.watch_sum() < k_coeff + c.max_watch();
+        k_coeff += cs.coeff(w);
+        bool add_more = cs.watch_sum() < k_coeff + cs.max_watch();
         for (unsigned i = c.watch_size(); add_more && i < c.size(); ++i) {
             if (ctx.get_assignment(c.lit(i)) != l_false) {
-                add_watch(c, i);
-                add_more = c.watch_sum() < k_coeff + c.max_watch();
+                add_watch(cs, i);
+                add_more = cs.watch_sum() < k_coeff + cs.max_watch();
             }
         }        
         
-        if (c.watch_sum() < k_coeff) {
+        if (cs.watch_sum() < k_coeff) {
             //
             // L: 3*x1 + 2*x2 + x4 >= 3, but x1 <- 0, x2 <- 0
             // create clause x1 or x2 or ~L
@@ -1210,8 +1283,8 @@ namespace smt {
         else {
             del_watch(watch, watch_index, c, w);
             removed = true;
-            SASSERT(c.watch_sum() >= k);
-            if (c.watch_sum() < k + c.max_watch()) {
+            SASSERT(cs.watch_sum() >= k);
+            if (cs.watch_sum() < k + cs.max_watch()) {
                 
                 //
                 // opportunities for unit propagation for unassigned 
@@ -1225,10 +1298,10 @@ namespace smt {
 
                 literal_vector& lits = get_unhelpful_literals(c, true);
                 lits.push_back(c.lit());
-                scoped_mpz deficit(m_mpz_mgr);
-                deficit = c.watch_sum() - k;
+                typename Coeffs::numeral deficit = cs.mk();
+                deficit = cs.watch_sum() - k;
                 for (unsigned i = 0; i < c.size(); ++i) {
-                    if (ctx.get_assignment(c.lit(i)) == l_undef && deficit < c.ncoeff(i)) {
+                    if (ctx.get_assignment(c.lit(i)) == l_undef && deficit < cs.coeff(i)) {
                         DEBUG_CODE(validate_assign(c, lits, c.lit(i)););
                         add_assign(c, lits, c.lit(i));                  
                         // break;
@@ -1425,9 +1498,7 @@ namespace smt {
             literal w = c.lit(i);
             unwatch_literal(w, &c);            
         }
-        c.m_watch_sum.reset();
-        c.m_watch_sz = 0;
-        c.m_max_watch.reset();
+        c.reset_watch();
         c.m_nfixed = 0;
         c.m_max_sum.reset();
         c.m_min_sum.reset();
@@ -1443,37 +1514,40 @@ namespace smt {
             for (unsigned i = 0; i < c.watch_size(); ++i) {
                 pb.unwatch_literal(c.lit(i), &c);
             }
-            c.m_watch_sz = 0;
-            c.m_watch_sum.reset();
-            c.m_max_watch.reset();
+            c.reset_watch();
         }        
     };
 
 
     void theory_pb::init_watch_literal(ineq& c) {
-        scoped_mpz max_k(m_mpz_mgr);
-        c.m_watch_sum.reset();
-        c.m_watch_sz = 0;
-        c.m_max_watch.reset();
+        c.reset_watch();
+        if (c.is_small()) 
+            init_watch_literal(uint64_coeffs(c));
+        else 
+            init_watch_literal(mpz_coeffs(c));
+        ctx.push_trail(unwatch_ge(*this, c));
+    }
+
+    template<typename Coeffs>
+    void theory_pb::init_watch_literal(Coeffs cs) {
+        ineq& c = cs.c;
+        typename Coeffs::numeral max_k = cs.mk();
         bool watch_more = true;
         for (unsigned i = 0; watch_more && i < c.size(); ++i) {
             if (ctx.get_assignment(c.lit(i)) != l_false) {
-                add_watch(c, i);
-                max_k = c.mpz_k();
-                max_k += c.max_watch();
-                watch_more = c.m_watch_sum < max_k;
+                add_watch(cs, i);
+                max_k = cs.k();
+                max_k += cs.max_watch();
+                watch_more = cs.watch_sum() < max_k;
             }       
         }        
-        ctx.push_trail(unwatch_ge(*this, c));
     }
 
     void theory_pb::init_watch_ineq(ineq& c) {
         c.m_min_sum.reset();
         c.m_max_sum.reset();
         c.m_nfixed = 0;
-        c.m_watch_sum.reset();
-        c.m_max_watch.reset();
-        c.m_watch_sz = 0;
+        c.reset_watch();
         for (unsigned i = 0; i < c.size(); ++i) {
             c.m_max_sum += c.ncoeff(i);
         }                   
@@ -1488,6 +1562,8 @@ namespace smt {
                       m_ineq(c)
                       {}
         ineq& get_ineq() { return m_ineq; }
+        unsigned num_literals() const { return m_num_literals; }
+        literal lit(unsigned i) const { return m_literals[i]; }
     };
 
     void theory_pb::add_assign(ineq& c, literal_vector const& lits, literal l) {
@@ -1510,6 +1586,10 @@ namespace smt {
         m_stats.m_num_conflicts++;
         TRACE("pb", tout << "#prop:" << c.m_num_propagations << " - " << lits << "\n"; 
               display(tout, c, true);); 
+        if (resolve_conflict(c, lits)) {
+            SASSERT(ctx.inconsistent());
+            return;
+        }
         justification* js = nullptr;
         if (proofs_enabled()) {                                         
             js = alloc(theory_lemma_justification, get_id(), ctx, lits.size(), lits.c_ptr());
@@ -1561,6 +1641,58 @@ namespace smt {
         }
     }
 
+    /**
+       \brief add offset times the inequality c, divided by the coefficient of conseq,
+       to the lemma and set bound to the bound of the divided inequality.
+
+       Literals in m_false_var_set are false before conseq is propagated.
+       The other literals whose coefficients are not multiples of the divisor
+       are removed by weakening, then coefficients and bound are divided,
+       rounding up, and saturated. The result still propagates conseq with
+       coefficient 1. With conseq = null_literal the inequality is added as is.
+       Fails if the result does not fit in the integer coefficients of the lemma.
+    */
+    bool theory_pb::process_ineq(ineq& c, literal conseq, int offset, int& bound) {
+        SASSERT(c.is_small());
+        SASSERT(ctx.get_assignment(c.lit()) == l_true);
+        uint64_t div = 1;
+        if (conseq != null_literal) {
+            unsigned i = 0;
+            for (; c.lit(i) != conseq; ++i) 
+                SASSERT(i + 1 < c.size());
+            div = c.coeff64(i);
+        }
+        uint64_t k = c.k64();
+        for (unsigned i = 0; i < c.size(); ++i) {
+            if (!m_false_var_set.contains(c.lit(i).var()) && c.coeff64(i) % div != 0) {
+                k -= std::min(k, c.coeff64(i));
+            }
+        }
+        k = (k + div - 1) / div;
+        SASSERT(k > 0);
+        if (k * offset + std::abs(m_bound) >= (1ull << 30)) {
+            return false;
+        }
+        for (unsigned i = 0; i < c.size(); ++i) {
+            literal l = c.lit(i);
+            bool is_false = m_false_var_set.contains(l.var());
+            uint64_t coeff = c.coeff64(i);
+            if (!is_false && coeff % div != 0) 
+                continue;
+            coeff = std::min(k, (coeff + div - 1) / div);
+            int inc = static_cast<int>(coeff) * offset;
+            if (is_false) 
+                process_antecedent(l, inc);
+            else 
+                inc_coeff(l, inc);
+        }
+        if (ctx.get_assign_level(c.lit()) > ctx.get_base_level()) {
+            m_antecedents.push_back(c.lit());
+        }
+        bound = static_cast<int>(k);
+        return true;
+    }
+
     bool theory_pb::validate_lemma() {
         int value = -m_bound;
         normalize_active_coeffs();
@@ -1799,59 +1931,114 @@ namespace smt {
     
     void theory_pb::propagate() { }
 
-    bool theory_pb::resolve_conflict(card& c, literal_vector const& confl) {
-       
-        TRACE("pb", display(tout, c, true); );
-
-        bool_var v;
+    /**
+       \brief determine the conflict level and reset the lemma.
+       l is the literal of the conflicting constraint.
+    */
+    bool theory_pb::init_conflict(literal_vector const& confl, literal l) {
         m_conflict_lvl = 0;
         for (literal lit : confl) {
             SASSERT(ctx.get_assignment(lit) == l_false);
             m_conflict_lvl = std::max(m_conflict_lvl, ctx.get_assign_level(lit));            
         }
-        if (m_conflict_lvl < ctx.get_assign_level(c.lit()) || m_conflict_lvl == ctx.get_base_level()) {
+        if (m_conflict_lvl < ctx.get_assign_level(l) || m_conflict_lvl == ctx.get_base_level()) {
             return false;
         }
 
         reset_coeffs();
         m_num_marks = 0;
-        m_bound = c.k();
         m_antecedents.reset();
         m_resolved.reset();
-        literal_vector ante;
+        return true;
+    }
+
+    bool theory_pb::resolve_conflict(card& c, literal_vector const& confl) {
+       
+        TRACE("pb", display(tout, c, true); );
 
+        if (!init_conflict(confl, c.lit())) {
+            return false;
+        }
+        m_bound = c.k();
         process_card(c, 1);
+        return resolve_conflict(~confl[2]);
+    }
 
+    /**
+       \brief cutting plane analysis starting from an inequality whose 
+       literals in the conflict clause are all false.
+    */
+    bool theory_pb::resolve_conflict(ineq& c, literal_vector const& confl) {
+
+        TRACE("pb", display(tout, c, true); );
+
+        if (!c.is_small() || !init_conflict(confl, c.lit())) {
+            return false;
+        }
+        m_false_var_set.reset();
+        for (literal lit : confl) {
+            m_false_var_set.insert(lit.var());
+        }
+        int bound = 0;
+        m_bound = 0;
+        if (!process_ineq(c, null_literal, 1, bound) || m_num_marks == 0) {
+            for (bool_var v : m_active_vars) {
+                if (ctx.is_marked(v)) {
+                    ctx.unset_mark(v);
+                }
+            }
+            return false;
+        }
+        m_bound = bound;
+        return resolve_conflict(null_literal);
+    }
+
+    /**
+       \brief resolve the lemma with the justifications of the marked literals
+       at the conflict level, starting with conseq.
+    */
+    bool theory_pb::resolve_conflict(literal conseq) {
+        bool_var v;
         app_ref A(m), B(m), C(m);
-        DEBUG_CODE(A = c.to_expr(*this););
+        DEBUG_CODE(A = active2expr(););
         
         // point into stack of assigned literals
         literal_vector const& lits = ctx.assigned_literals();        
         SASSERT(!lits.empty());
         unsigned idx = lits.size()-1;
         b_justification js;
-        literal conseq = ~confl[2];
         int bound = 1;
+        int offset = 0;
+
+        auto abort_resolve = [&]() {
+            while (m_num_marks > 0) {
+                v = lits[idx].var();
+                if (ctx.is_marked(v)) {
+                    ctx.unset_mark(v);
+                    --m_num_marks;
+                }
+                if (idx == 0) break;
+                --idx;
+            }
+            return false;
+        };
 
         while (m_num_marks > 0) {
 
+            if (conseq == null_literal) {
+                goto process_next_resolvent;
+            }
+
             v = conseq.var();
 
-            int offset = get_abs_coeff(v);
+            offset = get_abs_coeff(v);
 
             if (offset == 0) {
                 goto process_next_resolvent;            
             }
             SASSERT(validate_lemma());
             if (offset > 1000) {
-                while (m_num_marks > 0 && idx > 0) {
-                    v = lits[idx].var();
-                    if (ctx.is_marked(v)) {
-                        ctx.unset_mark(v);
-                    }
-                    --idx;
-                }
-                return false;
+                return abort_resolve();
             }
 
             SASSERT(offset > 0);
@@ -1910,7 +2097,20 @@ namespace smt {
                 if (j->get_from_theory() == get_id()) {
                     pbj = dynamic_cast<card_justification*>(j);
                 }
-                if (pbj == nullptr) {
+                pb_justification* ineqj = nullptr;
+                if (!pbj && j->get_from_theory() == get_id()) {
+                    ineqj = dynamic_cast<pb_justification*>(j);
+                }
+                if (ineqj && ineqj->get_ineq().is_small()) {
+                    m_false_var_set.reset();
+                    for (unsigned i = 0; i < ineqj->num_literals(); ++i) {
+                        m_false_var_set.insert(ineqj->lit(i).var());
+                    }
+                    if (!process_ineq(ineqj->get_ineq(), conseq, offset, bound)) {
+                        return abort_resolve();
+                    }
+                }
+                else if (pbj == nullptr) {
                     TRACE("pb", tout << "skip justification for " << conseq << "\n";);
                     bound = 0;
                     // this is possible when conseq is an assumption.
@@ -2038,6 +2238,18 @@ namespace smt {
     // debug methods
 
     void theory_pb::validate_watch(ineq const& c) const {
+        if (c.is_small()) {
+            uint64_t sum = 0, max = 0;
+            for (unsigned i = 0; i < c.watch_size(); ++i) {
+                SASSERT(c.coeff(i) == rational(c.coeff64(i), rational::ui64()));
+                sum += c.coeff64(i);
+                max = std::max(max, c.coeff64(i));
+            }
+            SASSERT(c.m_watch_sum64 == sum);
+            SASSERT(sum >= c.k64());
+            SASSERT(max == c.m_max_watch64);
+            return;
+        }
         scoped_mpz sum(m_mpz_mgr), max(m_mpz_mgr);
         for (unsigned i = 0; i < c.watch_size(); ++i) {
             sum += c.ncoeff(i);
@@ -2273,9 +2485,10 @@ namespace smt {
         if (c.m_max_watch.is_pos())  out << "max_watch: "    << c.max_watch() << " ";
         if (c.watch_size())          out << "watch size: "   << c.watch_size() << " ";
         if (c.m_watch_sum.is_pos())  out << "watch-sum: "    << c.watch_sum() << " ";
+        if (c.m_watch_sum64 > 0)     out << "watch-sum: "    << c.m_watch_sum64 << " max_watch: " << c.m_max_watch64 << " ";
         if (!c.m_max_sum.is_zero())  out << "sum: [" << c.min_sum() << ":" << c.max_sum() << "] ";
         if (c.m_num_propagations || c.m_max_watch.is_pos() || c.watch_size() || 
-            c.m_watch_sum.is_pos() || !c.m_max_sum.is_zero()) out << "\n";
+            c.m_watch_sum.is_pos() || c.m_watch_sum64 > 0 || !c.m_max_sum.is_zero()) out << "\n";
         return out;
     }
 
@@ -98,6 +98,7 @@ namespace smt {
             unsigned m_num_propagations;
             unsigned m_num_predicates;
             unsigned m_num_resolves;
+            unsigned m_num_small;
             void reset() { memset(this, 0, sizeof(*this)); }
             stats() { reset(); }
         };
@@ -118,6 +119,13 @@ namespace smt {
             scoped_mpz      m_max_sum;      // maximal possible sum.
             scoped_mpz      m_min_sum;      // minimal possible sum.
             unsigned        m_num_propagations;
+            // 64-bit copies of the coefficients and watch sums, used instead of
+            // the mpz numerals when the sum of the coefficients is small.
+            bool              m_small;
+            uint64_t          m_k64[2];
+            svector<uint64_t> m_coeffs64[2];
+            uint64_t          m_watch_sum64;
+            uint64_t          m_max_watch64;
             
             ineq(unsynch_mpz_manager& m, literal l, bool is_eq) : 
                 m_mpz(m), m_lit(l), m_is_eq(is_eq), 
@@ -151,6 +159,25 @@ namespace smt {
             bool vwatch_initialized() const { return !m_mpz.is_zero(max_sum()); }
             void vwatch_reset() { m_min_sum.reset(); m_max_sum.reset(); m_nfixed = 0; }
 
+            bool is_small() const { return m_small; }
+            uint64_t k64() const { return m_k64[m_lit.sign()]; }
+            uint64_t coeff64(unsigned i) const { return m_coeffs64[m_lit.sign()][i]; }
+
+            void swap_args(unsigned i, unsigned j) {
+                std::swap(args()[i], args()[j]);
+                if (m_small) std::swap(m_coeffs64[m_lit.sign()][i], m_coeffs64[m_lit.sign()][j]);
+            }
+
+            void init_small();
+
+            void reset_watch() {
+                m_watch_sz = 0;
+                m_watch_sum.reset();
+                m_max_watch.reset();
+                m_watch_sum64 = 0;
+                m_max_watch64 = 0;
+            }
+
             unsigned find_lit(bool_var v, unsigned begin, unsigned end) {
                 while (lit(begin).var() != v) {
                     ++begin;
@@ -287,10 +314,40 @@ namespace smt {
         literal compile_arg(expr* arg);
         void init_watch(bool_var v);
         
+        // coefficients, bound and watch sums of a >= inequality in
+        // arbitrary precision and in 64 bits.
+        struct mpz_coeffs {
+            typedef scoped_mpz numeral;
+            ineq& c;
+            mpz_coeffs(ineq& c): c(c) {}
+            scoped_mpz mk() const { return scoped_mpz(c.m_mpz); }
+            mpz const& k() const { return c.mpz_k(); }
+            mpz const& coeff(unsigned i) const { return c.ncoeff(i); }
+            scoped_mpz& watch_sum() const { return c.m_watch_sum; }
+            scoped_mpz& max_watch() const { return c.m_max_watch; }
+        };
+
+        struct uint64_coeffs {
+            typedef uint64_t numeral;
+            ineq& c;
+            uint64_coeffs(ineq& c): c(c) {}
+            uint64_t mk() const { return 0; }
+            uint64_t k() const { return c.k64(); }
+            uint64_t coeff(unsigned i) const { return c.coeff64(i); }
+            uint64_t& watch_sum() const { return c.m_watch_sum64; }
+            uint64_t& max_watch() const { return c.m_max_watch64; }
+        };
+
         // general purpose pb constraints
         void add_watch(ineq& c, unsigned index);
+        template<typename Coeffs>
+        void add_watch(Coeffs cs, unsigned index);
         void del_watch(ineq_watch& watch, unsigned index, ineq& c, unsigned ineq_index);
+        template<typename Coeffs>
+        void del_watch(Coeffs cs, unsigned ineq_index);
         void init_watch_literal(ineq& c);
+        template<typename Coeffs>
+        void init_watch_literal(Coeffs cs);
         void init_watch_ineq(ineq& c);
         void clear_watch(ineq& c);
         void watch_literal(literal lit, ineq* c);
@@ -298,7 +355,11 @@ namespace smt {
         void remove(ptr_vector<ineq>& ineqs, ineq* c);
 
         bool assign_watch_ge(bool_var v, bool is_true, ineq_watch& watch, unsigned index);
+        template<typename Coeffs>
+        bool assign_watch_ge(Coeffs cs, bool_var v, bool is_true, ineq_watch& watch, unsigned index);
         void assign_ineq(ineq& c, bool is_true);
+        template<typename Coeffs>
+        void assign_ineq(Coeffs cs);
         void assign_eq(ineq& c, bool is_true);
 
         // cardinality constraints
@@ -355,6 +416,7 @@ namespace smt {
         int               m_bound;
         literal_vector    m_antecedents;
         tracked_uint_set  m_active_var_set;
+        tracked_uint_set  m_false_var_set;      // false literals of a reason before the propagated literal
         expr_ref_vector   m_antecedent_exprs;
         bool_vector     m_antecedent_signs;
         expr_ref_vector   m_cardinality_exprs;
@@ -376,9 +438,13 @@ namespace smt {
         void reset_coeffs();
         literal get_asserting_literal(literal conseq);
 
+        bool init_conflict(literal_vector const& conflict_clause, literal l);
         bool resolve_conflict(card& c, literal_vector const& conflict_clause);
+        bool resolve_conflict(ineq& c, literal_vector const& conflict_clause);
+        bool resolve_conflict(literal conseq);
         void process_antecedent(literal l, int offset);
         void process_card(card& c, int offset);
+        bool process_ineq(ineq& c, literal conseq, int offset, int& bound);
         void cut();
         bool is_proof_justification(justification const& j) const;
 
@@ -1520,6 +1520,8 @@ bool theory_seq::simplify_and_solve_eqs() {
 }
 
 void theory_seq::internalize_eq_eh(app * atom, bool_var v) {
+    if (get_fparams().m_seq_length_abstraction && m_util.is_seq(atom->get_arg(0)))
+        enque_axiom(atom);
 }
 
 bool theory_seq::internalize_atom(app* a, bool) {
@@ -1534,6 +1536,9 @@ bool theory_seq::internalize_term(app* term) {
         return true;
     }
 
+    if (get_fparams().m_seq_length_abstraction && m_util.str.is_in_re(term))
+        enque_axiom(term);
+
     if (ctx.get_fparams().m_seq_use_derivatives && 
         m.is_bool(term) && 
         (m_util.str.is_in_re(term) || m_sk.is_skolem(term))) {
@@ -1824,7 +1829,10 @@ void theory_seq::collect_statistics(::statistics & st) const {
     st.update("seq extensionality", m_stats.m_extensionality);
     st.update("seq fixed length", m_stats.m_fixed_length);
     st.update("seq int.to.str", m_stats.m_int_string);
+    st.update("seq length abstraction", m_stats.m_length_abstraction);
+    st.update("seq length pruned", m_stats.m_length_pruned);
     st.update("seq automata", m_stats.m_propagate_automata);
+    m_regex.collect_statistics(st);
 }
 
 void theory_seq::init_search_eh() {
@@ -2613,6 +2621,39 @@ void theory_seq::deque_axiom(expr* n) {
     else if (m_util.str.is_to_code(n)) {
         m_ax.add_str_to_code_axiom(n);        
     }
+    else if (m.is_eq(n) || m_util.str.is_in_re(n)) {
+        add_length_abstraction(n);
+        if (!ctx.at_base_level()) {
+            m_trail_stack.push(push_replay(alloc(replay_axiom, m, n)));
+        }
+    }
+}
+
+/**
+   \brief project sequence constraints onto their lengths:
+
+       s = t => len(s) = len(t)
+       s in R => min_length(R) <= len(s) <= max_length(R)
+
+   The projections are solved by the arithmetic solver up front, so
+   length bounds are available when branching on equations.
+*/
+void theory_seq::add_length_abstraction(expr* n) {
+    expr* a = nullptr, *b = nullptr;
+    literal lit = mk_literal(n);
+    ++m_stats.m_length_abstraction;
+    if (m.is_eq(n, a, b)) {
+        add_axiom(~lit, mk_eq(mk_len(a), mk_len(b), false));
+        return;
+    }
+    VERIFY(m_util.str.is_in_re(n, a, b));
+    expr_ref len = mk_len(a);
+    unsigned lo = m_util.re.min_length(b);
+    unsigned hi = m_util.re.max_length(b);
+    if (lo > 0)
+        add_axiom(~lit, mk_literal(m_autil.mk_ge(len, m_autil.mk_int(lo))));
+    if (hi != UINT_MAX)
+        add_axiom(~lit, mk_literal(m_autil.mk_le(len, m_autil.mk_int(hi))));
 }
 
 expr_ref theory_seq::add_elim_string_axiom(expr* n) {
@@ -368,6 +368,8 @@ namespace smt {
             unsigned m_fixed_length;
             unsigned m_propagate_contains;
             unsigned m_int_string;
+            unsigned m_length_abstraction;
+            unsigned m_length_pruned;
         };
         typedef hashtable<rational, rational::hash_proc, rational::eq_proc> rational_set;
 
@@ -594,6 +596,7 @@ namespace smt {
         expr_ref_vector expand_strings(expr_ref_vector const& es);
         bool can_be_equal(unsigned szl, expr* const* ls, unsigned szr, expr* const* rs) const;
         lbool assume_equality(expr* l, expr* r);
+        void add_length_bounds(expr* e, rational& lo, rational& hi, bool& has_hi);
 
         // variable solving utilities
         bool occurs(expr* a, expr* b);
@@ -614,6 +617,7 @@ namespace smt {
         // terms whose meaning are encoded using axioms.
         void enque_axiom(expr* e);
         void deque_axiom(expr* e);
+        void add_length_abstraction(expr* e);
         void add_axiom(literal l1, literal l2 = null_literal, literal l3 = null_literal, literal l4 = null_literal, literal l5 = null_literal);        
         void add_axiom(literal_vector& lits);
         
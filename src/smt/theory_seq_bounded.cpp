@@ -0,0 +1,660 @@
+/*++
+Copyright (c) 2020 Microsoft Corporation
+
+Module Name:
+
+    theory_seq_bounded.cpp
+
+Abstract:
+
+    Bounded solver for strings and sequences.
+
+    Clauses are indexed by the largest element position or length they
+    mention. Encoding a constraint for the range (lo, hi] adds the clauses
+    of that size, so raising the bound from k to 2k only adds the clauses
+    of size k+1 .. 2k. The initial encoding uses lo = -1.
+
+--*/
+
+#include "ast/ast_pp.h"
+#include "ast/ast_ll_pp.h"
+#include "smt/smt_context.h"
+#include "smt/smt_model_generator.h"
+#include "smt/theory_seq_bounded.h"
+#include "model/seq_factory.h"
+
+using namespace smt;
+
+theory_seq_bounded::theory_seq_bounded(context& ctx):
+    theory(ctx, ctx.get_manager().mk_family_id("seq")),
+    m_util(m),
+    m_autil(m),
+    m_rewrite(m),
+    m_sk(m, m_rewrite),
+    m_ax(*this, m_rewrite),
+    m_mk_aut(m),
+    m_res(m),
+    m_bound(std::max(1u, ctx.get_fparams().m_seq_bounded_length)),
+    m_encoded_bound(m_bound),
+    m_bound_expr(m),
+    m_todo(m),
+    m_todo_head(0),
+    m_encoded(m),
+    m_unsupported(false),
+    m_has_seq(m_util.has_seq()) {
+}
+
+void theory_seq_bounded::init() {
+    params_ref p;
+    p.set_bool("coalesce_chars", false);
+    m_rewrite.updt_params(p);
+    std::function<void(literal, literal, literal, literal, literal)> add_ax = [&](literal l1, literal l2, literal l3, literal l4, literal l5) {
+        add_axiom(l1, l2, l3, l4, l5);
+    };
+    std::function<literal(expr*,bool)> mk_eq_emp = [&](expr* e, bool p) {
+        expr_ref emp(m_util.str.mk_empty(m.get_sort(e)), m);
+        return mk_eq(e, emp, false);
+    };
+    m_ax.add_axiom5 = add_ax;
+    m_ax.mk_eq_empty2 = mk_eq_emp;
+}
+
+/**
+   \brief operations with an encoding in this solver.
+*/
+bool theory_seq_bounded::is_supported(app* e) const {
+    if (e->get_family_id() != m_util.get_family_id())
+        return true;
+    return
+        m_util.str.is_string(e) ||
+        m_util.str.is_empty(e) ||
+        m_util.str.is_unit(e) ||
+        m_util.str.is_concat(e) ||
+        m_util.str.is_length(e) ||
+        m_util.str.is_prefix(e) ||
+        m_util.str.is_suffix(e) ||
+        m_util.str.is_contains(e) ||
+        m_util.str.is_in_re(e) ||
+        m_util.str.is_extract(e) ||
+        m_util.str.is_at(e) ||
+        m_util.str.is_nth_i(e) ||
+        m_util.str.is_index(e) ||
+        m_util.str.is_last_index(e) ||
+        m_util.str.is_replace(e) ||
+        m_util.is_skolem(e);
+}
+
+void theory_seq_bounded::set_unsupported(expr* e) {
+    if (!m_unsupported) {
+        TRACE("seq", tout << "unsupported: " << mk_pp(e, m) << "\n";);
+        IF_VERBOSE(2, verbose_stream() << "(smt.seq.bounded :unsupported " << mk_bounded_pp(e, m, 2) << ")\n");
+        ctx.push_trail(value_trail<context, bool>(m_unsupported));
+        m_unsupported = true;
+    }
+}
+
+void theory_seq_bounded::enque(expr* e) {
+    m_todo.push_back(e);
+    ctx.push_trail(push_back_vector<context, expr_ref_vector>(m_todo));
+}
+
+theory_var theory_seq_bounded::mk_var(enode* n) {
+    if (!m_util.is_seq(n->get_owner()))
+        return null_theory_var;
+    if (is_attached_to_var(n))
+        return n->get_th_var(get_id());
+    theory_var v = theory::mk_var(n);
+    ctx.attach_th_var(n, this, v);
+    ctx.mark_as_relevant(n);
+    enque(n->get_owner());
+    return v;
+}
+
+bool theory_seq_bounded::internalize_atom(app* atom, bool) {
+    return internalize_term(atom);
+}
+
+bool theory_seq_bounded::internalize_term(app* term) {
+    m_has_seq = true;
+    if (ctx.e_internalized(term)) {
+        mk_var(ctx.get_enode(term));
+        return true;
+    }
+    if (!is_supported(term))
+        set_unsupported(term);
+
+    expr* a = nullptr, *b = nullptr;
+    bool is_aux = m_util.is_skolem(term) && m.is_bool(term) && !m_sk.is_eq(term, a, b);
+    if (m_util.str.is_in_re(term) || is_aux) {
+        // regular expressions and auxiliary atoms have no enodes for their arguments
+        if (m_util.str.is_in_re(term))
+            ensure_enode(term->get_arg(0));
+        bool_var bv = ctx.mk_bool_var(term);
+        ctx.set_var_theory(bv, get_id());
+        ctx.mark_as_relevant(bv);
+        if (!is_aux)
+            enque(term);
+        return true;
+    }
+
+    for (expr* arg : *term)
+        ensure_enode(arg);
+    if (m.is_bool(term)) {
+        bool_var bv = ctx.mk_bool_var(term);
+        ctx.set_var_theory(bv, get_id());
+        ctx.mark_as_relevant(bv);
+    }
+    enode* e = nullptr;
+    if (ctx.e_internalized(term))
+        e = ctx.get_enode(term);
+    else
+        e = ctx.mk_enode(term, false, m.is_bool(term), true);
+    if (null_theory_var == mk_var(e))
+        enque(term);
+    return true;
+}
+
+void theory_seq_bounded::apply_sort_cnstr(enode* n, sort* s) {
+    m_has_seq = true;
+    mk_var(n);
+}
+
+void theory_seq_bounded::new_eq_eh(theory_var v1, theory_var v2) {
+    expr* a = get_enode(v1)->get_owner();
+    expr* b = get_enode(v2)->get_owner();
+    expr_ref eq(m.mk_eq(a, b), m);
+    encode(eq, -1, m_encoded_bound);
+    m_encoded.push_back(eq);
+    ctx.push_trail(push_back_vector<context, expr_ref_vector>(m_encoded));
+}
+
+void theory_seq_bounded::new_diseq_eh(theory_var v1, theory_var v2) {
+    expr* a = get_enode(v1)->get_owner();
+    expr* b = get_enode(v2)->get_owner();
+    expr_ref ne(m.mk_not(m.mk_eq(a, b)), m);
+    encode(ne, -1, m_encoded_bound);
+    m_encoded.push_back(ne);
+    ctx.push_trail(push_back_vector<context, expr_ref_vector>(m_encoded));
+}
+
+bool theory_seq_bounded::can_propagate() {
+    return m_todo_head < m_todo.size();
+}
+
+void theory_seq_bounded::propagate() {
+    if (m_todo_head == m_todo.size())
+        return;
+    ctx.push_trail(value_trail<context, unsigned>(m_todo_head));
+    while (m_todo_head < m_todo.size() && !ctx.inconsistent()) {
+        expr* e = m_todo.get(m_todo_head++);
+        encode(e, -1, m_encoded_bound);
+        m_encoded.push_back(e);
+        ctx.push_trail(push_back_vector<context, expr_ref_vector>(m_encoded));
+    }
+}
+
+final_check_status theory_seq_bounded::final_check_eh() {
+    if (can_propagate()) {
+        propagate();
+        return FC_CONTINUE;
+    }
+    if (m_unsupported)
+        return FC_GIVEUP;
+    return FC_DONE;
+}
+
+/**
+   \brief raise the encoding to the current bound and assume that
+   all sequences are within the bound.
+*/
+void theory_seq_bounded::add_theory_assumptions(expr_ref_vector& assumptions) {
+    if (!m_has_seq)
+        return;
+    if (m_encoded_bound < m_bound) {
+        for (unsigned i = 0; i < m_encoded.size(); ++i)
+            encode(m_encoded.get(i), m_encoded_bound, m_bound);
+        m_encoded_bound = m_bound;
+    }
+    m_bound_expr = m_sk.mk_max_unfolding_depth(m_encoded_bound);
+    literal bound = mk_literal(m_bound_expr);
+    for (expr* e : m_encoded)
+        if (m_util.is_seq(e))
+            add_axiom(~bound, mk_len_le(e, m_encoded_bound));
+    assumptions.push_back(m_bound_expr);
+}
+
+bool theory_seq_bounded::should_research(expr_ref_vector& unsat_core) {
+    if (!m_has_seq)
+        return false;
+    for (expr* e : unsat_core) {
+        if (m_sk.is_max_unfolding(e)) {
+            m_bound *= 2;
+            ++m_stats.m_num_researches;
+            IF_VERBOSE(1, verbose_stream() << "(smt.seq.bounded :length " << m_bound << ")\n");
+            return true;
+        }
+    }
+    return false;
+}
+
+expr_ref theory_seq_bounded::mk_len(expr* s) {
+    expr_ref result(m_util.str.mk_length(s), m);
+    m_rewrite(result);
+    return result;
+}
+
+expr_ref theory_seq_bounded::mk_elem(expr* s, unsigned i) {
+    sort* elem_sort = nullptr;
+    VERIFY(m_util.is_seq(m.get_sort(s), elem_sort));
+    return m_sk.mk("seq.bounded.elem", s, m_autil.mk_int(i), elem_sort);
+}
+
+literal theory_seq_bounded::mk_literal(expr* _e) {
+    expr_ref e(_e, m);
+    m_rewrite(e);
+    ctx.internalize(e, false);
+    literal lit = ctx.get_literal(e);
+    ctx.mark_as_relevant(lit);
+    return lit;
+}
+
+literal theory_seq_bounded::mk_len_le(expr* s, unsigned k) {
+    return mk_literal(m_autil.mk_le(mk_len(s), m_autil.mk_int(k)));
+}
+
+literal theory_seq_bounded::mk_len_eq(expr* s, unsigned k) {
+    return mk_literal(m.mk_eq(mk_len(s), m_autil.mk_int(k)));
+}
+
+literal theory_seq_bounded::mk_elem_eq(expr* a, unsigned i, expr* b, unsigned j) {
+    return mk_eq(mk_elem(a, i), mk_elem(b, j), false);
+}
+
+void theory_seq_bounded::add_axiom(literal l1, literal l2, literal l3, literal l4, literal l5) {
+    literal_vector lits;
+    if (l1 != null_literal) lits.push_back(l1);
+    if (l2 != null_literal) lits.push_back(l2);
+    if (l3 != null_literal) lits.push_back(l3);
+    if (l4 != null_literal) lits.push_back(l4);
+    if (l5 != null_literal) lits.push_back(l5);
+    add_axiom(lits);
+}
+
+void theory_seq_bounded::add_axiom(literal_vector& lits) {
+    unsigned j = 0;
+    for (literal lit : lits) {
+        if (lit == true_literal)
+            return;
+        if (lit != false_literal)
+            lits[j++] = lit;
+    }
+    lits.shrink(j);
+    for (literal lit : lits)
+        ctx.mark_as_relevant(lit);
+    ++m_stats.m_num_axioms;
+    ctx.mk_th_axiom(get_id(), lits.size(), lits.c_ptr());
+}
+
+/**
+   \brief add the clauses of e with sizes in (lo, hi].
+*/
+void theory_seq_bounded::encode(expr* e, int lo, unsigned hi) {
+    TRACE("seq", tout << mk_bounded_pp(e, m, 2) << " " << lo << " " << hi << "\n";);
+    expr* a = nullptr, *b = nullptr, *c = nullptr;
+    if (m_util.is_seq(e))
+        encode_term(e, lo, hi);
+    else if (m.is_eq(e, a, b) && m_util.is_seq(a))
+        encode_eq(a, b, lo, hi);
+    else if (m.is_not(e, c) && m.is_eq(c, a, b) && m_util.is_seq(a))
+        encode_diseq(a, b, lo, hi);
+    else if (m_util.str.is_prefix(e, a, b))
+        encode_prefix(e, a, b, lo, hi);
+    else if (m_util.str.is_suffix(e, a, b))
+        encode_suffix(e, a, b, lo, hi);
+    else if (m_util.str.is_contains(e, a, b))
+        encode_contains(e, a, b, lo, hi);
+    else if (m_util.str.is_in_re(e, a, b))
+        encode_in_re(e, a, b, lo, hi);
+    else if (lo >= 0)
+        return;
+    else if (m_sk.is_eq(e, a, b)) {
+        literal lit = ctx.get_literal(e);
+        literal eq = mk_eq(a, b, false);
+        add_axiom(~lit, eq);
+        add_axiom(lit, ~eq);
+    }
+    else if (m_util.str.is_length(e))
+        m_ax.add_length_axiom(e);
+    else if (m_util.str.is_extract(e))
+        m_ax.add_extract_axiom(e);
+    else if (m_util.str.is_at(e))
+        m_ax.add_at_axiom(e);
+    else if (m_util.str.is_nth_i(e))
+        m_ax.add_nth_axiom(e);
+    else if (m_util.str.is_index(e))
+        m_ax.add_indexof_axiom(e);
+    else if (m_util.str.is_last_index(e))
+        m_ax.add_last_indexof_axiom(e);
+    else if (m_util.str.is_replace(e))
+        m_ax.add_replace_axiom(e);
+}
+
+/**
+   t = "s"      => elem(t, i) = s[i]
+   t = unit(x)  => elem(t, 0) = x
+   t = a ++ b   => i < len(a) => elem(t, i) = elem(a, i)
+                   len(a) = j & i < len(t) => elem(t, i) = elem(b, i - j)
+*/
+void theory_seq_bounded::encode_term(expr* t, int lo, unsigned hi) {
+    if (lo < 0) {
+        m_ax.add_length_axiom(m_util.str.mk_length(t));
+        if (m_bound_expr)
+            add_axiom(~mk_literal(m_bound_expr), mk_len_le(t, m_encoded_bound));
+    }
+    zstring s;
+    expr* x = nullptr;
+    if (m_util.str.is_string(t, s)) {
+        for (unsigned i = first_index(lo); i < std::min(s.length(), hi); ++i)
+            add_axiom(mk_eq(mk_elem(t, i), m_util.str.mk_char(s, i), false));
+    }
+    else if (m_util.str.is_unit(t, x)) {
+        if (lo < 0)
+            add_axiom(mk_eq(mk_elem(t, 0), x, false));
+    }
+    else if (m_util.str.is_concat(t)) {
+        app* ap = to_app(t);
+        expr* a = ap->get_arg(0);
+        expr_ref b(ap->get_arg(1), m);
+        if (ap->get_num_args() > 2) {
+            b = m_util.str.mk_concat(ap->get_num_args() - 1, ap->get_args() + 1, m.get_sort(t));
+            ensure_enode(b);
+        }
+        for (unsigned i = first_index(lo); i < hi; ++i) {
+            add_axiom(mk_len_le(a, i), mk_elem_eq(t, i, a, i));
+            for (unsigned j = 0; j <= i; ++j)
+                add_axiom(~mk_len_eq(a, j), mk_len_le(t, i), mk_elem_eq(t, i, b, i - j));
+        }
+    }
+}
+
+/**
+   a = b => len(a) = len(b)
+   a = b & i < len(a) => elem(a, i) = elem(b, i)
+*/
+void theory_seq_bounded::encode_eq(expr* a, expr* b, int lo, unsigned hi) {
+    literal eq = mk_eq(a, b, false);
+    if (lo < 0)
+        add_axiom(~eq, mk_literal(m.mk_eq(mk_len(a), mk_len(b))));
+    for (unsigned i = first_index(lo); i < hi; ++i)
+        add_axiom(~eq, mk_len_le(a, i), mk_elem_eq(a, i, b, i));
+}
+
+/**
+   a != b & len(a) = n & len(b) = n => elem(a, i) != elem(b, i) for some i < n
+*/
+void theory_seq_bounded::encode_diseq(expr* a, expr* b, int lo, unsigned hi) {
+    literal eq = mk_eq(a, b, false);
+    for (unsigned n = lo + 1; n <= hi; ++n) {
+        literal_vector lits;
+        lits.push_back(eq);
+        lits.push_back(~mk_len_eq(a, n));
+        lits.push_back(~mk_len_eq(b, n));
+        for (unsigned i = 0; i < n; ++i)
+            lits.push_back(~mk_elem_eq(a, i, b, i));
+        add_axiom(lits);
+    }
+}
+
+/**
+   prefix(a, b) => len(a) <= len(b)
+   prefix(a, b) & i < len(a) => elem(a, i) = elem(b, i)
+   ~prefix(a, b) & len(a) = n & n <= len(b) => elem(a, i) != elem(b, i) for some i < n
+*/
+void theory_seq_bounded::encode_prefix(expr* e, expr* a, expr* b, int lo, unsigned hi) {
+    literal p = ctx.get_literal(e);
+    if (lo < 0)
+        add_axiom(~p, mk_literal(m_autil.mk_le(mk_len(a), mk_len(b))));
+    for (unsigned i = first_index(lo); i < hi; ++i)
+        add_axiom(~p, mk_len_le(a, i), mk_elem_eq(a, i, b, i));
+    for (unsigned n = lo + 1; n <= hi; ++n) {
+        literal_vector lits;
+        lits.push_back(p);
+        lits.push_back(~mk_len_eq(a, n));
+        if (n > 0)
+            lits.push_back(mk_len_le(b, n - 1));
+        for (unsigned i = 0; i < n; ++i)
+            lits.push_back(~mk_elem_eq(a, i, b, i));
+        add_axiom(lits);
+    }
+}
+
+/**
+   suffix(a, b) => len(a) <= len(b)
+   suffix(a, b) & len(b) - len(a) = d & i < len(a) => elem(a, i) = elem(b, i + d)
+   ~suffix(a, b) & len(a) = n & len(b) = n + d => elem(a, i) != elem(b, i + d) for some i < n
+*/
+void theory_seq_bounded::encode_suffix(expr* e, expr* a, expr* b, int lo, unsigned hi) {
+    literal p = ctx.get_literal(e);
+    if (lo < 0)
+        add_axiom(~p, mk_literal(m_autil.mk_le(mk_len(a), mk_len(b))));
+    for (unsigned d = 0; d < hi; ++d) {
+        literal offset = mk_literal(m.mk_eq(m_autil.mk_sub(mk_len(b), mk_len(a)), m_autil.mk_int(d)));
+        for (unsigned i = 0; i + d < hi; ++i)
+            if ((int)(i + d) >= lo)
+                add_axiom(~p, ~offset, mk_len_le(a, i), mk_elem_eq(a, i, b, i + d));
+    }
+    for (unsigned d = 0; d <= hi; ++d) {
+        for (unsigned n = 0; n + d <= hi; ++n) {
+            if ((int)(n + d) <= lo)
+                continue;
+            literal_vector lits;
+            lits.push_back(p);
+            lits.push_back(~mk_len_eq(a, n));
+            lits.push_back(~mk_len_eq(b, n + d));
+            for (unsigned i = 0; i < n; ++i)
+                lits.push_back(~mk_elem_eq(a, i, b, i + d));
+            add_axiom(lits);
+        }
+    }
+}
+
+/**
+   Let match(d) be the atom that b occurs in a at offset d.
+
+   match(d) => contains(a, b) & d + len(b) <= len(a)
+   match(d) & i < len(b) => elem(a, i + d) = elem(b, i)
+   ~match(d) & len(b) = n & n + d <= len(a) => elem(a, i + d) != elem(b, i) for some i < n
+   contains(a, b) & len(a) <= hi => match(0) or .. or match(hi)
+*/
+void theory_seq_bounded::encode_contains(expr* e, expr* a, expr* b, int lo, unsigned hi) {
+    literal p = ctx.get_literal(e);
+    literal_vector matches;
+    matches.push_back(~p);
+    matches.push_back(~mk_len_le(a, hi));
+    for (unsigned d = 0; d <= hi; ++d) {
+        literal md = mk_literal(m_sk.mk("seq.bounded.match", a, b, m_autil.mk_int(d), m.mk_bool_sort()));
+        matches.push_back(md);
+        if ((int)d > lo) {
+            add_axiom(~md, p);
+            add_axiom(~md, mk_literal(m_autil.mk_le(m_autil.mk_add(mk_len(b), m_autil.mk_int(d)), mk_len(a))));
+        }
+        for (unsigned i = 0; i + d < hi; ++i)
+            if ((int)(i + d) >= lo)
+                add_axiom(~md, mk_len_le(b, i), mk_elem_eq(a, i + d, b, i));
+        for (unsigned n = 0; n + d <= hi; ++n) {
+            if ((int)(n + d) <= lo)
+                continue;
+            literal_vector lits;
+            lits.push_back(md);
+            lits.push_back(~mk_len_eq(b, n));
+            lits.push_back(~mk_literal(m_autil.mk_ge(mk_len(a), m_autil.mk_int(n + d))));
+            for (unsigned i = 0; i < n; ++i)
+                lits.push_back(~mk_elem_eq(a, i + d, b, i));
+            add_axiom(lits);
+        }
+    }
+    add_axiom(matches);
+}
+
+eautomaton* theory_seq_bounded::get_automaton(expr* r) {
+    eautomaton* result = nullptr;
+    if (m_re2aut.find(r, result))
+        return result;
+    result = m_mk_aut(r);
+    m_automata.push_back(result);
+    m_re2aut.insert(r, result);
+    m_res.push_back(r);
+    return result;
+}
+
+/**
+   Simulate the automaton of r on the elements of s. Let reach(i, q) be
+   the atom that state q is reached after reading i elements, and
+   step(i, k) the atom that the k'th transition (q, q', phi) is taken
+   on elem(s, i).
+
+   reach(0, q)            <=> q is in the epsilon closure of the initial state
+   step(i, k)             <=> reach(i, q) & phi(elem(s, i))
+   reach(i + 1, q')       <=> step(i, k) for some transition k into q'
+   len(s) = n => (s in r <=> reach(n, q) for some final state q)
+*/
+void theory_seq_bounded::encode_in_re(expr* e, expr* s, expr* r, int lo, unsigned hi) {
+    eautomaton* aut = get_automaton(r);
+    if (!aut) {
+        set_unsupported(e);
+        return;
+    }
+    literal lit = ctx.get_literal(e);
+    unsigned num_states = aut->num_states();
+    expr_ref re(r, m);
+    auto reach = [&](unsigned i, unsigned q) {
+        return mk_literal(m_sk.mk("seq.bounded.reach", s, re, m_autil.mk_int(i), m_autil.mk_int(q), m.mk_bool_sort()));
+    };
+    if (lo < 0) {
+        unsigned_vector init;
+        aut->get_epsilon_closure(aut->init(), init);
+        for (unsigned q = 0; q < num_states; ++q)
+            add_axiom(init.contains(q) ? reach(0, q) : ~reach(0, q));
+    }
+    // moves from a state to the epsilon closures of its successors
+    eautomaton::moves mvs, mvs1;
+    for (unsigned q = 0; q < num_states; ++q) {
+        mvs1.reset();
+        aut->get_moves_from(q, mvs1, true);
+        for (auto const& mv : mvs1)
+            if (mv.src() == q)
+                mvs.push_back(mv);
+    }
+    for (unsigned i = first_index(lo); i < hi; ++i) {
+        expr_ref ch = mk_elem(s, i);
+        vector<literal_vector> into(num_states);
+        for (unsigned k = 0; k < mvs.size(); ++k) {
+            eautomaton::move const& mv = mvs[k];
+            literal step = mk_literal(m_sk.mk("seq.bounded.step", s, re, m_autil.mk_int(i), m_autil.mk_int(k), m.mk_bool_sort()));
+            literal src = reach(i, mv.src());
+            literal phi = mk_literal(mv.t()->accept(ch));
+            add_axiom(~step, src);
+            add_axiom(~step, phi);
+            add_axiom(step, ~src, ~phi);
+            add_axiom(~step, reach(i + 1, mv.dst()));
+            into[mv.dst()].push_back(step);
+        }
+        for (unsigned q = 0; q < num_states; ++q) {
+            into[q].push_back(~reach(i + 1, q));
+            add_axiom(into[q]);
+        }
+    }
+    for (unsigned n = lo + 1; n <= hi; ++n) {
+        literal len_n = mk_len_eq(s, n);
+        literal_vector lits;
+        lits.push_back(~lit);
+        lits.push_back(~len_n);
+        for (unsigned q : aut->final_states()) {
+            literal f = reach(n, q);
+            add_axiom(lit, ~len_n, ~f);
+            lits.push_back(f);
+        }
+        add_axiom(lits);
+    }
+}
+
+class theory_seq_bounded::value_proc : public model_value_proc {
+    theory_seq_bounded&             th;
+    sort*                           m_sort;
+    svector<model_value_dependency> m_dependencies;
+    unsigned_vector                 m_index;     // position of the element in dependency i + 1
+public:
+    value_proc(theory_seq_bounded& th, sort* s, enode* len): th(th), m_sort(s) {
+        m_dependencies.push_back(model_value_dependency(len));
+    }
+
+    void add_elem(enode* n, unsigned idx) {
+        m_dependencies.push_back(model_value_dependency(n));
+        m_index.push_back(idx);
+    }
+
+    void get_dependencies(buffer<model_value_dependency> & result) override {
+        result.append(m_dependencies.size(), m_dependencies.c_ptr());
+    }
+
+    app * mk_value(model_generator & mg, expr_ref_vector const & values) override {
+        ast_manager& m = th.m;
+        seq_util& u = th.m_util;
+        rational r;
+        unsigned len = 0;
+        if (th.m_autil.is_numeral(values.get(0), r) && r.is_unsigned())
+            len = r.get_unsigned();
+        sort* elem_sort = nullptr;
+        VERIFY(u.is_seq(m_sort, elem_sort));
+        expr_ref_vector elems(m);
+        for (unsigned i = 0; i < len; ++i)
+            elems.push_back(mg.get_model().get_some_value(elem_sort));
+        for (unsigned j = 0; j < m_index.size(); ++j)
+            if (m_index[j] < len)
+                elems.set(m_index[j], values.get(j + 1));
+        if (u.is_string(m_sort)) {
+            unsigned_vector chars;
+            unsigned ch = 0;
+            for (expr* e : elems)
+                chars.push_back(u.is_const_char(e, ch) ? ch : 'a');
+            return u.str.mk_string(zstring(chars.size(), chars.c_ptr()));
+        }
+        expr_ref_vector units(m);
+        for (expr* e : elems)
+            units.push_back(u.str.mk_unit(e));
+        expr_ref result(u.str.mk_concat(units, m_sort), m);
+        th.m_rewrite(result);
+        return to_app(result);
+    }
+};
+
+void theory_seq_bounded::init_model(model_generator& mg) {
+    mg.register_factory(alloc(seq_factory, get_manager(), get_family_id(), mg.get_model()));
+}
+
+model_value_proc* theory_seq_bounded::mk_value(enode* n, model_generator& mg) {
+    expr* e = n->get_owner();
+    expr_ref len(m_util.str.mk_length(e), m);
+    if (!ctx.e_internalized(len))
+        return alloc(expr_wrapper_proc, m_util.str.mk_empty(m.get_sort(e)));
+    value_proc* v = alloc(value_proc, *this, m.get_sort(e), ctx.get_enode(len));
+    for (unsigned i = 0; i < m_encoded_bound; ++i) {
+        expr_ref el = mk_elem(e, i);
+        if (ctx.e_internalized(el))
+            v->add_elem(ctx.get_enode(el), i);
+    }
+    return v;
+}
+
+void theory_seq_bounded::collect_statistics(::statistics& st) const {
+    st.update("seq bounded length", m_bound);
+    st.update("seq bounded researches", m_stats.m_num_researches);
+    st.update("seq bounded axioms", m_stats.m_num_axioms);
+}
+
+void theory_seq_bounded::display(std::ostream& out) const {
+    out << "seq-bounded length: " << m_encoded_bound << " encoded: " << m_encoded.size();
+    if (m_unsupported)
+        out << " unsupported";
+    out << "\n";
+}
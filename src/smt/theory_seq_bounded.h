@@ -0,0 +1,112 @@
+/*++
+Copyright (c) 2020 Microsoft Corporation
+
+Module Name:
+
+    theory_seq_bounded.h
+
+Abstract:
+
+    Bounded solver for strings and sequences (smt.string_solver=bounded).
+
+    A sequence s is represented by its length len(s) and the elements
+    elem(s, 0), .., elem(s, k-1) up to a length bound k. Elements of strings
+    are bit-vector characters, so the encoding is solved by the SAT core
+    after bit-blasting. Operations are encoded as clauses over lengths and
+    elements, operations that reduce to concatenation reuse seq_axioms.
+
+    The bound len(s) <= k is a theory assumption. When it occurs in an
+    unsatisfiable core the bound is doubled and search resumes, so
+    satisfiable answers and unsatisfiable answers that do not depend on
+    the bound are exact. The solver gives up on operations it does not
+    encode.
+
+--*/
+#pragma once
+
+#include "ast/seq_decl_plugin.h"
+#include "ast/arith_decl_plugin.h"
+#include "ast/rewriter/th_rewriter.h"
+#include "ast/rewriter/seq_rewriter.h"
+#include "smt/smt_theory.h"
+#include "smt/seq_skolem.h"
+#include "smt/seq_axioms.h"
+
+namespace smt {
+
+    class theory_seq_bounded : public theory {
+        struct stats {
+            stats() { reset(); }
+            void reset() { memset(this, 0, sizeof(stats)); }
+            unsigned m_num_axioms;
+            unsigned m_num_researches;
+        };
+        class value_proc;
+
+        seq_util                      m_util;
+        arith_util                    m_autil;
+        th_rewriter                   m_rewrite;
+        seq_skolem                    m_sk;
+        seq_axioms                    m_ax;
+        re2automaton                  m_mk_aut;
+        scoped_ptr_vector<eautomaton> m_automata;
+        obj_map<expr, eautomaton*>    m_re2aut;
+        expr_ref_vector               m_res;
+        unsigned                      m_bound;         // length bound for the next search
+        unsigned                      m_encoded_bound; // length bound of the encoded constraints
+        expr_ref                      m_bound_expr;    // assumption len(s) <= m_encoded_bound
+        expr_ref_vector               m_todo;          // terms and atoms to encode
+        unsigned                      m_todo_head;
+        expr_ref_vector               m_encoded;       // encoded terms, atoms, equalities and disequalities
+        bool                          m_unsupported;
+        bool                          m_has_seq;
+        stats                         m_stats;
+
+        bool is_supported(app* e) const;
+        void enque(expr* e);
+        void set_unsupported(expr* e);
+
+        static unsigned first_index(int lo) { return lo < 0 ? 0 : lo; }
+        void encode(expr* e, int lo, unsigned hi);
+        void encode_term(expr* t, int lo, unsigned hi);
+        void encode_eq(expr* a, expr* b, int lo, unsigned hi);
+        void encode_diseq(expr* a, expr* b, int lo, unsigned hi);
+        void encode_prefix(expr* e, expr* a, expr* b, int lo, unsigned hi);
+        void encode_suffix(expr* e, expr* a, expr* b, int lo, unsigned hi);
+        void encode_contains(expr* e, expr* a, expr* b, int lo, unsigned hi);
+        void encode_in_re(expr* e, expr* s, expr* r, int lo, unsigned hi);
+        eautomaton* get_automaton(expr* r);
+
+        expr_ref mk_len(expr* s);
+        expr_ref mk_elem(expr* s, unsigned i);
+        literal mk_literal(expr* e);
+        literal mk_len_le(expr* s, unsigned k);
+        literal mk_len_eq(expr* s, unsigned k);
+        literal mk_elem_eq(expr* a, unsigned i, expr* b, unsigned j);
+        void add_axiom(literal l1, literal l2 = null_literal, literal l3 = null_literal, literal l4 = null_literal, literal l5 = null_literal);
+        void add_axiom(literal_vector& lits);
+
+        theory_var mk_var(enode* n) override;
+        bool internalize_atom(app* atom, bool gate_ctx) override;
+        bool internalize_term(app* term) override;
+        void apply_sort_cnstr(enode* n, sort* s) override;
+        void new_eq_eh(theory_var v1, theory_var v2) override;
+        void new_diseq_eh(theory_var v1, theory_var v2) override;
+        bool can_propagate() override;
+        void propagate() override;
+        final_check_status final_check_eh() override;
+        void add_theory_assumptions(expr_ref_vector& assumptions) override;
+        bool should_research(expr_ref_vector& unsat_core) override;
+        void init_model(model_generator& mg) override;
+        model_value_proc* mk_value(enode* n, model_generator& mg) override;
+        theory* mk_fresh(context* new_ctx) override { return alloc(theory_seq_bounded, *new_ctx); }
+        char const* get_name() const override { return "seq-bounded"; }
+        void collect_statistics(::statistics& st) const override;
+        void display(std::ostream& out) const override;
+
+    public:
+        theory_seq_bounded(context& ctx);
+        void init() override;
+    };
+
+};
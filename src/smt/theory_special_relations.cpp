@@ -46,6 +46,8 @@ namespace smt {
         scope& s = m_scopes.back();
         s.m_asserted_atoms_lim = m_asserted_atoms.size();
         s.m_asserted_qhead_old = m_asserted_qhead;
+        s.m_closure_trail_lim = m_closure_trail.size();
+        s.m_closure_qhead_old = m_closure_qhead;
         m_graph.push();        
         m_ufctx.get_trail_stack().push_scope();
     }
@@ -55,6 +57,16 @@ namespace smt {
         scope& s = m_scopes[new_lvl];
         m_asserted_atoms.shrink(s.m_asserted_atoms_lim);
         m_asserted_qhead = s.m_asserted_qhead_old;
+        if (m_use_closure) {
+            for (unsigned i = m_closure_trail.size(); i > s.m_closure_trail_lim; ) {
+                --i;
+                auto const& p = m_closure_trail[i];
+                m_reach[p.first].remove(p.second);
+                m_reached_by[p.second].remove(p.first);
+            }
+            m_closure_trail.shrink(s.m_closure_trail_lim);
+            m_closure_qhead = s.m_closure_qhead_old;
+        }
         m_scopes.shrink(new_lvl);
         m_graph.pop(num_scopes);        
         m_ufctx.get_trail_stack().pop_scope(num_scopes);
@@ -65,6 +77,59 @@ namespace smt {
         if ((unsigned)v >= m_graph.get_num_nodes()) {
             m_graph.init_var(v);
         }
+        if (!m_use_closure || closure_index(v) != UINT_MAX) {
+            return;
+        }
+        if (m_closure2var.size() >= max_closure_size) {
+            // the relation is too large for the closure; it is dropped for good.
+            m_use_closure = false;
+            m_var2closure.reset();
+            m_closure2var.reset();
+            m_reach.reset();
+            m_reached_by.reset();
+            m_closure_trail.reset();
+            m_closure_qhead = 0;
+            m_pair2atom.reset();
+            return;
+        }
+        m_var2closure.reserve(v + 1, UINT_MAX);
+        m_var2closure[v] = m_closure2var.size();
+        m_closure2var.push_back(v);
+        m_reach.push_back(uint_set());
+        m_reached_by.push_back(uint_set());
+    }
+
+    bool theory_special_relations::relation::reaches(theory_var v1, theory_var v2) const {
+        if (v1 == v2) {
+            return true;
+        }
+        unsigned i1 = closure_index(v1), i2 = closure_index(v2);
+        return i1 != UINT_MAX && i2 != UINT_MAX && m_reach[i1].contains(i2);
+    }
+
+    /**
+       \brief add the pairs (x, y) where x reaches v1 and v2 reaches y to the closure.
+     */
+    void theory_special_relations::relation::add_closure_edge(theory_var v1, theory_var v2) {
+        if (!m_use_closure || reaches(v1, v2)) {
+            return;
+        }
+        unsigned i1 = closure_index(v1), i2 = closure_index(v2);
+        SASSERT(i1 != UINT_MAX && i2 != UINT_MAX);
+        unsigned_vector srcs, dsts;
+        srcs.push_back(i1);
+        for (unsigned x : m_reached_by[i1]) srcs.push_back(x);
+        dsts.push_back(i2);
+        for (unsigned y : m_reach[i2]) dsts.push_back(y);
+        for (unsigned x : srcs) {
+            for (unsigned y : dsts) {
+                if (x != y && !m_reach[x].contains(y)) {
+                    m_reach[x].insert(y);
+                    m_reached_by[y].insert(x);
+                    m_closure_trail.push_back(std::make_pair(x, y));
+                }
+            }
+        }
     }
 
     bool theory_special_relations::relation::new_eq_eh(literal l, theory_var v1, theory_var v2) {
@@ -72,7 +137,12 @@ namespace smt {
         ensure_var(v2);
         literal_vector ls;
         ls.push_back(l);
-        return m_graph.add_non_strict_edge(v1, v2, ls) && m_graph.add_non_strict_edge(v2, v1, ls);
+        if (!m_graph.add_non_strict_edge(v1, v2, ls) || !m_graph.add_non_strict_edge(v2, v1, ls)) {
+            return false;
+        }
+        add_closure_edge(v1, v2);
+        add_closure_edge(v2, v1);
+        return true;
     }
 
     std::ostream& theory_special_relations::relation::display(theory_special_relations const& th, std::ostream& out) const {
@@ -91,7 +161,7 @@ namespace smt {
     }
 
     theory_special_relations::theory_special_relations(context& ctx, ast_manager& m):
-        theory(ctx, m.mk_family_id("special_relations")),
+        theory(ctx, m.mk_family_id("specrels")),
         m_util(m),
         m_can_propagate(false) {
     }
@@ -152,6 +222,9 @@ namespace smt {
         m_atoms.push_back(a);
         TRACE("special_relations", tout << mk_pp(atm, m) << " : bv" << v << " v" << a->v1() << " v" << a->v2() << ' ' << gate_ctx << "\n";);
         m_bool_var2atom.insert(v, a);
+        if (r->m_use_closure) {
+            r->m_pair2atom.insert(relation::pair_key(a->v1(), a->v2()), a);
+        }
         return true;
     }
 
@@ -179,6 +252,9 @@ namespace smt {
                 set_neg_cycle_conflict(r);
                 break;
             }
+            if (r.m_closure_qhead < r.m_closure_trail.size()) {
+                m_can_propagate = true;
+            }
         }
     }
 
@@ -564,14 +640,59 @@ namespace smt {
     
     lbool theory_special_relations::propagate_po(atom& a) {
         lbool res = l_true;
+        relation& r = a.get_relation();
         if (a.phase()) {
-            relation& r = a.get_relation();
             r.m_uf.merge(a.v1(), a.v2());
             res = enable(a);
+            if (res == l_true) {
+                r.add_closure_edge(a.v1(), a.v2());
+            }
+        }
+        else if (r.m_use_closure && a.v1() != a.v2() && r.reaches(a.v1(), a.v2())) {
+            // v1 -> v2 is already in the closure
+            r.m_explanation.reset();
+            VERIFY(r.m_graph.find_enabled_path(a.v1(), a.v2(), r));
+            r.m_explanation.push_back(a.explanation());
+            m_stats.m_num_closure_conflicts++;
+            set_conflict(r);
+            res = l_false;
         }
         return res;
     }
 
+    /**
+       \brief propagate the atoms over pairs that were added to the closure.
+     */
+    lbool theory_special_relations::propagate_closure(relation& r) {
+        for (; r.m_closure_qhead < r.m_closure_trail.size() && !ctx.inconsistent(); ++r.m_closure_qhead) {
+            auto const& p = r.m_closure_trail[r.m_closure_qhead];
+            theory_var v1 = r.m_closure2var[p.first], v2 = r.m_closure2var[p.second];
+            atom* a = nullptr;
+            if (!r.m_pair2atom.find(relation::pair_key(v1, v2), a)) {
+                continue;
+            }
+            literal lit(a->var());
+            lbool val = ctx.get_assignment(lit);
+            if (val == l_true) {
+                continue;
+            }
+            r.m_explanation.reset();
+            VERIFY(r.m_graph.find_enabled_path(v1, v2, r));
+            literal_vector const& lits = r.m_explanation;
+            if (val == l_false) {
+                r.m_explanation.push_back(~lit);
+                m_stats.m_num_closure_conflicts++;
+                set_conflict(r);
+                return l_false;
+            }
+            TRACE("special_relations", tout << "closure propagation " << lit << "\n";);
+            m_stats.m_num_closure_propagations++;
+            justification* j = ctx.mk_justification(theory_propagation_justification(get_id(), ctx.get_region(), lits.size(), lits.c_ptr(), lit));
+            ctx.assign(lit, j);
+        }
+        return ctx.inconsistent() ? l_false : l_true;
+    }
+
     lbool theory_special_relations::propagate_tc(atom& a) {
         if (a.phase()) {
             VERIFY(a.enable());
@@ -584,6 +705,9 @@ namespace smt {
     lbool theory_special_relations::final_check_po(relation& r) {
         for (atom* ap : r.m_asserted_atoms) {
             atom& a = *ap;
+            if (r.m_use_closure && !r.reaches(a.v1(), a.v2())) {
+                continue;
+            }
             if (!a.phase() && r.m_uf.find(a.v1()) == r.m_uf.find(a.v2())) {
                 // v1 !-> v2
                 // find v1 -> v3 -> v4 -> v2 path
@@ -635,15 +759,18 @@ namespace smt {
             }
             ++r.m_asserted_qhead;
         }
+        if (res == l_true && r.m_use_closure) {
+            res = propagate_closure(r);
+        }
         return res;
     }
 
     void theory_special_relations::reset_eh() {
+        del_atoms(0);
         for (auto const& kv : m_relations) {
             dealloc(kv.m_value);
         }
         m_relations.reset();
-        del_atoms(0);
     }
 
     void theory_special_relations::assign_eh(bool_var v, bool is_true) {
@@ -679,6 +806,10 @@ namespace smt {
             --it;
             atom* a = *it;
             m_bool_var2atom.erase(a->var());
+            relation& r = a->get_relation();
+            if (r.m_use_closure) {
+                r.m_pair2atom.erase(relation::pair_key(a->v1(), a->v2()));
+            }
             dealloc(a);
         }
         m_atoms.shrink(old_size);
@@ -689,6 +820,8 @@ namespace smt {
         for (auto const& kv : m_relations) {
             kv.m_value->m_graph.collect_statistics(st);
         }
+        st.update("sr closure propagations", m_stats.m_num_closure_propagations);
+        st.update("sr closure conflicts", m_stats.m_num_closure_conflicts);
     }
 
     model_value_proc * theory_special_relations::mk_value(enode * n, model_generator & mg) {
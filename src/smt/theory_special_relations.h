@@ -25,6 +25,7 @@ Notes:
 #include "smt/theory_diff_logic.h"
 #include "util/union_find.h"
 #include "util/rational.h"
+#include "util/uint_set.h"
 
 namespace smt {
     class theory_special_relations : public theory {
@@ -73,6 +74,15 @@ namespace smt {
         struct scope {
             unsigned m_asserted_atoms_lim;
             unsigned m_asserted_qhead_old;
+            unsigned m_closure_trail_lim;
+            unsigned m_closure_qhead_old;
+        };
+
+        struct stats {
+            unsigned m_num_closure_propagations;
+            unsigned m_num_closure_conflicts;
+            void reset() { memset(this, 0, sizeof(*this)); }
+            stats() { reset(); }
         };
 
         struct int_ext : public sidl_ext {
@@ -104,7 +114,23 @@ namespace smt {
             union_find_t           m_uf;
             literal_vector         m_explanation;
 
-            relation(sr_property p, func_decl* d, ast_manager& m): m(m), m_next(m), m_property(p), m_decl(d), m_asserted_qhead(0), m_uf(m_ufctx) {}
+            // Transitive closure of the enabled edges of partial orders with at most
+            // max_closure_size variables. The closure is indexed by the variables of the
+            // relation, numbered in the order they are first seen in its atoms and equalities.
+            // Pairs added to the closure are recorded on a trail, pairs from m_closure_qhead
+            // are checked against atoms in m_pair2atom.
+            static const unsigned  max_closure_size = 1024;
+            bool                   m_use_closure;
+            unsigned_vector        m_var2closure; // theory variable -> closure index, UINT_MAX if none
+            svector<theory_var>    m_closure2var;
+            vector<uint_set>       m_reach;       // i -> closure indices reachable from i
+            vector<uint_set>       m_reached_by;  // i -> closure indices reaching i
+            svector<std::pair<unsigned, unsigned> > m_closure_trail;
+            unsigned               m_closure_qhead;
+            u64_map<atom*>         m_pair2atom;
+
+            relation(sr_property p, func_decl* d, ast_manager& m): m(m), m_next(m), m_property(p), m_decl(d), m_asserted_qhead(0), m_uf(m_ufctx),
+                                                                   m_use_closure(p == sr_po), m_closure_qhead(0) {}
 
             func_decl* decl() { return m_decl; }
 
@@ -123,6 +149,11 @@ namespace smt {
 
             bool add_strict_edge(theory_var v1, theory_var v2, literal_vector const& j);
             bool add_non_strict_edge(theory_var v1, theory_var v2, literal_vector const& j);
+
+            static uint64_t pair_key(theory_var v1, theory_var v2) { return (static_cast<uint64_t>(v1) << 32) | static_cast<unsigned>(v2); }
+            unsigned closure_index(theory_var v) const { return (unsigned)v < m_var2closure.size() ? m_var2closure[v] : UINT_MAX; }
+            bool reaches(theory_var v1, theory_var v2) const;
+            void add_closure_edge(theory_var v1, theory_var v2);
             
             std::ostream& display(theory_special_relations const& sr, std::ostream& out) const;
         };
@@ -135,6 +166,7 @@ namespace smt {
         obj_map<func_decl, relation*>  m_relations;
         bool_var2atom                  m_bool_var2atom;
         bool                           m_can_propagate;
+        stats                          m_stats;
         
 
         void del_atoms(unsigned old_size);
@@ -152,6 +184,7 @@ namespace smt {
         lbool  propagate_plo(atom& a);
         lbool  propagate_po(atom& a); 
         lbool  propagate_tc(atom& a); 
+        lbool  propagate_closure(relation& r);
         theory_var mk_var(expr* e);
         void count_children(graph const& g, unsigned_vector& num_children);
         void ensure_strict(graph& g);
@@ -1499,6 +1499,23 @@ namespace smt {
                             TRACE("str", tout << "warning: non-bitvectors in automaton range predicate" << std::endl;);
                             UNREACHABLE();
                         }
+                    } else if (mv.t()->is_set()) {
+                        // a union of character ranges, such as an intersection of ranges
+                        expr_ref_vector cond_rhs_terms(m);
+                        for (auto const& r : mv.t()->get_set()) {
+                            for (unsigned i = r.m_lo; i <= r.m_hi; ++i) {
+                                zstring str_const(i);
+                                expr_ref str_expr(u.str.mk_string(str_const), m);
+                                cond_rhs_terms.push_back(ctx.mk_eq_atom(ch, str_expr));
+                            }
+                        }
+                        if (cond_rhs_terms.empty()) {
+                            continue;
+                        }
+                        expr_ref cond_rhs = mk_or(cond_rhs_terms);
+                        expr * args[2] = {cond_rhs, acc};
+                        cond = mk_and(m, 2, args);
+                        aut_path_add_next(next, trail, mv.dst(), cond);
                     } else if (mv.t()->is_pred()) {
                         // rewrite this constraint over string terms
                         expr_ref cond_rhs = aut_path_rewrite_constraint(mv.t()->get_pred(), ch);
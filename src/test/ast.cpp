@@ -17,6 +17,11 @@ Revision History:
 
 --*/
 #include "ast/ast.h"
+#include "ast/arith_decl_plugin.h"
+#include "ast/reg_decl_plugins.h"
+#ifndef SINGLE_THREAD
+#include <thread>
+#endif
 
 static void tst1() {
     ast_manager m;
@@ -131,6 +136,113 @@ static void tst5() {
     m.del(arr3);
 }
 
+// nodes of an arena manager are recycled after hash-consing hits and stay
+// in the table when their reference count drops to zero.
+static void tst6() {
+    ast_manager m;
+    m.enable_arena();
+    ENSURE(m.arena_enabled());
+    sort_ref s(m.mk_uninterpreted_sort(symbol("S")), m);
+    sort * dom[2] = { s, s };
+    func_decl_ref f(m.mk_func_decl(symbol("f"), 2, dom, s), m);
+    app_ref a(m.mk_const(symbol("a"), s), m);
+    app_ref b(m.mk_const(symbol("b"), s), m);
+
+    app * t = m.mk_app(f.get(), a.get(), b.get());
+    m.inc_ref(t);
+    unsigned id = t->get_id();
+    unsigned num_asts = m.get_num_asts();
+
+    // duplicates are released to the arena free list and reused.
+    unsigned long long before = memory::get_allocation_size();
+    for (unsigned i = 0; i < 100000; ++i) {
+        app_ref u(m.mk_app(f.get(), a.get(), b.get()), m);
+        ENSURE(u == t);
+    }
+    ENSURE(memory::get_allocation_size() < before + 64 * 1024);
+    ENSURE(m.get_num_asts() == num_asts);
+
+    // the node is kept when its count drops to zero and is found again.
+    m.dec_ref(t);
+    ENSURE(t->get_ref_count() == 0);
+    ENSURE(m.contains(t));
+    app_ref v(m.mk_app(f.get(), a.get(), b.get()), m);
+    ENSURE(v == t);
+    ENSURE(v->get_id() == id);
+    ENSURE(v->get_arg(0) == a && v->get_arg(1) == b);
+    ENSURE(m.get_num_asts() == num_asts);
+
+    // fresh nodes are registered next to the retained ones.
+    app_ref w(m.mk_app(f.get(), b.get(), a.get()), m);
+    ENSURE(w != v);
+    ENSURE(m.get_num_asts() == num_asts + 1);
+}
+
+#ifndef SINGLE_THREAD
+// threads create the same terms in a manager with concurrency enabled.
+static void tst7() {
+    ast_manager m;
+    reg_decl_plugins(m);
+    m.enable_concurrency();
+    ENSURE(m.concurrency_enabled());
+    sort_ref s(m.mk_uninterpreted_sort(symbol("S")), m);
+    sort * dom[2] = { s, s };
+    func_decl_ref f(m.mk_func_decl(symbol("f"), 2, dom, s), m);
+    app_ref_vector xs(m);
+    for (unsigned i = 0; i < 16; ++i)
+        xs.push_back(m.mk_const(symbol(i), s));
+    app_ref pinned(m.mk_app(f.get(), xs.get(0), xs.get(1)), m);
+    unsigned pinned_count = pinned->get_ref_count();
+
+    unsigned const num_threads = 4;
+    vector<expr_ref_vector> results;
+    for (unsigned t = 0; t < num_threads; ++t)
+        results.push_back(expr_ref_vector(m));
+    auto work = [&](unsigned t) {
+        arith_util a(m);
+        expr_ref_vector & r = results[t];
+        for (unsigned i = 0; i < 2000; ++i) {
+            unsigned j = (i + 37 * t) % 2000;
+            app * u = m.mk_app(f.get(), xs.get(j % 16), xs.get((j * 7) % 16));
+            app * v = m.mk_app(f.get(), u, xs.get((j / 16) % 16));
+            r.push_back(m.mk_eq(v, u));
+            r.push_back(a.mk_add(a.mk_int(j % 10), a.mk_int(j)));
+            m.inc_ref(pinned);
+            m.dec_ref(pinned);
+        }
+    };
+    vector<std::thread> threads(num_threads);
+    for (unsigned t = 0; t < num_threads; ++t)
+        threads[t] = std::thread([&, t]() { work(t); });
+    for (auto & th : threads)
+        th.join();
+
+    // every thread found the same nodes, irrespective of the order of creation.
+    unsigned num_asts = m.get_num_asts();
+    obj_map<expr, unsigned> index;
+    for (unsigned i = 0; i < results[0].size(); ++i)
+        index.insert(results[0].get(i), i);
+    for (unsigned t = 1; t < num_threads; ++t) {
+        ENSURE(results[t].size() == results[0].size());
+        for (expr * e : results[t])
+            ENSURE(index.contains(e));
+    }
+    // distinct nodes have distinct identifiers.
+    u_map<expr*> ids;
+    for (expr * e : results[0]) {
+        expr * other = nullptr;
+        ENSURE(!ids.find(e->get_id(), other) || other == e);
+        ids.insert(e->get_id(), e);
+        ENSURE(m.contains(e));
+        ENSURE(e->get_ref_count() >= num_threads);
+    }
+    ENSURE(pinned->get_ref_count() == pinned_count);
+
+    // recreating the terms does not create new nodes.
+    work(0);
+    ENSURE(m.get_num_asts() == num_asts);
+}
+#endif
 
 struct foo {
     unsigned       m_id; 
@@ -153,5 +265,9 @@ void tst_ast() {
     tst3();
     tst4();
     tst5();
+    tst6();
+#ifndef SINGLE_THREAD
+    tst7();
+#endif
 }
 
@@ -0,0 +1,172 @@
+/*++
+Copyright (c) 2020 Microsoft Corporation
+
+Module Name:
+
+    ast_binary.cpp
+
+Abstract:
+
+    Test the binary format for expressions.
+
+--*/
+#include "ast/ast_binary.h"
+#include "ast/ast_translation.h"
+#include "ast/arith_decl_plugin.h"
+#include "ast/bv_decl_plugin.h"
+#include "ast/array_decl_plugin.h"
+#include "ast/datatype_decl_plugin.h"
+#include "ast/reg_decl_plugins.h"
+#include <sstream>
+#include <fstream>
+#include <cstdio>
+
+static void mk_formulas(ast_manager & m, expr_ref_vector & fmls) {
+    arith_util a(m);
+    bv_util bv(m);
+    array_util ar(m);
+    sort_ref U(m.mk_uninterpreted_sort(symbol("U")), m);
+    sort_ref I(a.mk_int(), m), R(a.mk_real(), m), B(bv.mk_sort(8), m);
+    sort_ref A(ar.mk_array_sort(I, B), m);
+    func_decl_ref f(m.mk_func_decl(symbol("f"), U, I), m);
+    func_decl_ref g(m.mk_func_decl(symbol(3), I, R, U), m);
+    sort * int_sort = I.get();
+    func_decl_ref sk(m.mk_fresh_func_decl("sk", "", 1, &int_sort, I), m);
+    expr_ref u(m.mk_const(symbol("u"), U), m);
+    expr_ref x(m.mk_const(symbol("x"), I), m);
+    expr_ref r(m.mk_const(symbol("r"), R), m);
+    expr_ref b(m.mk_const(symbol("b"), B), m);
+    expr_ref arr(m.mk_const(symbol("arr"), A), m);
+
+    // arithmetic with integer and rational numerals.
+    expr_ref fx(m.mk_app(f.get(), u.get()), m);
+    fmls.push_back(a.mk_le(a.mk_add(fx, x, a.mk_int(-7)), a.mk_mul(a.mk_int(3), fx)));
+    fmls.push_back(m.mk_eq(a.mk_mul(a.mk_numeral(rational(5, 3), false), r), a.mk_to_real(x)));
+    fmls.push_back(m.mk_eq(m.mk_app(g.get(), x.get(), r.get()), u));
+    fmls.push_back(a.mk_gt(m.mk_app(sk.get(), x.get()), a.mk_int(0)));
+    // bit-vectors and arrays with parameters.
+    expr * sel_args[2] = { arr, x };
+    expr_ref sel(ar.mk_select(2, sel_args), m);
+    fmls.push_back(m.mk_eq(bv.mk_extract(3, 0, bv.mk_bv_add(b, sel)), bv.mk_numeral(rational(9), 4)));
+    expr * dist_args[3] = { b, sel, bv.mk_numeral(rational(255), 8) };
+    fmls.push_back(m.mk_distinct(3, dist_args));
+    expr * store_args[3] = { arr, x, b };
+    fmls.push_back(m.mk_eq(ar.mk_store(3, store_args), arr));
+    // a quantifier with a pattern.
+    expr_ref v(m.mk_var(0, I), m);
+    expr_ref fv(a.mk_add(v, x), m);
+    expr * sel_v_args[2] = { arr, v };
+    app_ref sel_v(ar.mk_select(2, sel_v_args), m);
+    app_ref pat(m.mk_pattern(sel_v), m);
+    expr * pats[1] = { pat.get() };
+    sort * srts[1] = { I };
+    symbol names[1] = { symbol("i") };
+    fmls.push_back(m.mk_forall(1, srts, names, m.mk_eq(sel_v, b), 2, symbol("q1"), symbol::null, 1, pats));
+    fmls.push_back(m.mk_exists(1, srts, names, a.mk_ge(fv, a.mk_int(1))));
+    // a DAG whose tree is exponentially larger.
+    expr_ref t(x, m);
+    for (unsigned i = 0; i < 64; ++i)
+        t = a.mk_add(t, t);
+    fmls.push_back(m.mk_eq(t, x));
+}
+
+static void write(ast_manager & m, expr_ref_vector const & fmls, std::string & data) {
+    std::ostringstream out;
+    ast_binary_write(m, out, fmls.size(), fmls.c_ptr());
+    data = out.str();
+}
+
+static void tst_same_manager() {
+    ast_manager m;
+    reg_decl_plugins(m);
+    expr_ref_vector fmls(m), result(m);
+    mk_formulas(m, fmls);
+    std::string data;
+    write(m, fmls, data);
+    // the sharing of the DAG is preserved.
+    ENSURE(data.size() < 8192);
+    unsigned num_asts = m.get_num_asts();
+    ast_binary_read(m, data.c_str(), data.size(), result);
+    ENSURE(result.size() == fmls.size());
+    for (unsigned i = 0; i < fmls.size(); ++i)
+        ENSURE(result.get(i) == fmls.get(i));
+    ENSURE(m.get_num_asts() == num_asts);
+}
+
+static void tst_other_manager() {
+    ast_manager m;
+    reg_decl_plugins(m);
+    expr_ref_vector fmls(m);
+    mk_formulas(m, fmls);
+    std::string data;
+    write(m, fmls, data);
+
+    std::string file = "ast_binary_test.bin";
+    {
+        std::ofstream out(file, std::ios::binary);
+        out << data;
+    }
+    ast_manager m2;
+    reg_decl_plugins(m2);
+    expr_ref_vector result(m2);
+    ast_binary_read_file(m2, file.c_str(), result);
+    std::remove(file.c_str());
+    ENSURE(result.size() == fmls.size());
+    ast_translation tr(m2, m);
+    for (unsigned i = 0; i < fmls.size(); ++i) {
+        expr * e = tr(result.get(i));
+        ENSURE(e == fmls.get(i));
+    }
+
+    // the skolem function keeps its flag.
+    expr * sk_app = to_app(to_app(result.get(3))->get_arg(0));
+    ENSURE(to_app(sk_app)->get_decl()->is_skolem());
+}
+
+static void tst_errors() {
+    ast_manager m;
+    reg_decl_plugins(m);
+    expr_ref_vector fmls(m), result(m);
+    mk_formulas(m, fmls);
+    std::string data;
+    write(m, fmls, data);
+
+    auto fails = [&](std::string const & d) {
+        try {
+            result.reset();
+            ast_binary_read(m, d.c_str(), d.size(), result);
+            return false;
+        }
+        catch (default_exception &) {
+            return true;
+        }
+    };
+    ENSURE(fails(data.substr(0, data.size() - 4)));
+    ENSURE(fails(data.substr(0, 12)));
+    ENSURE(fails(data.substr(0, data.size() - 1)));
+    std::string bad = data;
+    bad[0] = 'X';
+    ENSURE(fails(bad));
+    ENSURE(!fails(data));
+
+    // datatypes need their definitions and are rejected.
+    datatype_util dt(m);
+    func_decl_ref fst(m), snd(m), pair(m);
+    sort_ref P = dt.mk_pair_datatype(m.mk_bool_sort(), m.mk_bool_sort(), fst, snd, pair);
+    expr_ref p(m.mk_const(symbol("p"), P), m);
+    expr_ref dt_fml(m.mk_app(fst.get(), p.get()), m);
+    std::ostringstream out;
+    try {
+        expr * e = dt_fml;
+        ast_binary_write(m, out, 1, &e);
+        ENSURE(false);
+    }
+    catch (default_exception &) {
+    }
+}
+
+void tst_ast_binary() {
+    tst_same_manager();
+    tst_other_manager();
+    tst_errors();
+}
@@ -0,0 +1,108 @@
+/*++
+Copyright (c) 2020 Microsoft Corporation
+
+Module Name:
+
+    ast_translation.cpp
+
+Abstract:
+
+    Test translations with persistent caches and read-only sources.
+
+--*/
+#include "ast/ast_translation.h"
+#include "ast/arith_decl_plugin.h"
+#include "ast/reg_decl_plugins.h"
+#include "util/scoped_ptr_vector.h"
+#ifndef SINGLE_THREAD
+#include <thread>
+#endif
+
+static void mk_terms(ast_manager & m, expr_ref_vector & result) {
+    arith_util a(m);
+    expr_ref x(m.mk_const(symbol("x"), a.mk_int()), m);
+    expr_ref y(m.mk_const(symbol("y"), a.mk_int()), m);
+    expr_ref s(a.mk_add(x, y), m);
+    for (unsigned i = 0; i < 50; ++i) {
+        expr_ref t(a.mk_mul(s, a.mk_int(i)), m);
+        result.push_back(a.mk_le(a.mk_add(t, s), a.mk_int(i)));
+    }
+}
+
+// a cache shared by translations in both directions.
+static void tst_cache() {
+    ast_manager m1, m2;
+    reg_decl_plugins(m1);
+    expr_ref_vector src(m1);
+    mk_terms(m1, src);
+    ast_translation_cache c(m1, m2);
+
+    expr_ref_vector dst(m2);
+    {
+        ast_translation tr(c, m1, m2);
+        dst = tr(src);
+        ENSURE(tr.insert_count() > 0);
+    }
+    ENSURE(c.size() > 0);
+    {
+        // the shared subterms are found in the cache.
+        ast_translation tr(c, m1, m2, false);
+        expr_ref_vector dst2(tr(src));
+        ENSURE(tr.hit_count() > 0);
+        for (unsigned i = 0; i < src.size(); ++i)
+            ENSURE(dst.get(i) == dst2.get(i));
+    }
+    {
+        // translating back finds the entries recorded by the forward translation.
+        ast_translation tr(c, m2, m1, false);
+        expr_ref_vector back(tr(dst));
+        ENSURE(tr.hit_count() > 0);
+        for (unsigned i = 0; i < src.size(); ++i)
+            ENSURE(src.get(i) == back.get(i));
+    }
+    c.reset();
+    ENSURE(c.size() == 0);
+}
+
+#ifndef SINGLE_THREAD
+// translations out of the same manager run in parallel.
+static void tst_read_only() {
+    ast_manager m;
+    reg_decl_plugins(m);
+    expr_ref_vector src(m);
+    mk_terms(m, src);
+    unsigned const num_threads = 4;
+    unsigned count = src.get(0)->get_ref_count();
+    scoped_ptr_vector<ast_manager> ms;
+    vector<expr_ref_vector> results;
+    for (unsigned i = 0; i < num_threads; ++i) {
+        ms.push_back(alloc(ast_manager, m, true));
+        results.push_back(expr_ref_vector(*ms[i]));
+    }
+    vector<std::thread> threads(num_threads);
+    for (unsigned i = 0; i < num_threads; ++i) {
+        threads[i] = std::thread([&, i]() {
+            ast_translation tr(m, *ms[i], false);
+            tr.set_read_only_source();
+            results[i] = tr(src);
+        });
+    }
+    for (auto & th : threads)
+        th.join();
+    ENSURE(src.get(0)->get_ref_count() == count);
+    for (unsigned i = 0; i < num_threads; ++i) {
+        ast_translation tr(*ms[i], m, false);
+        expr_ref_vector back(tr(results[i]));
+        for (unsigned j = 0; j < src.size(); ++j)
+            ENSURE(src.get(j) == back.get(j));
+    }
+    results.reset();
+}
+#endif
+
+void tst_ast_translation() {
+    tst_cache();
+#ifndef SINGLE_THREAD
+    tst_read_only();
+#endif
+}
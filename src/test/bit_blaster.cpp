@@ -18,6 +18,7 @@ Revision History:
 --*/
 
 #include "ast/rewriter/bit_blaster/bit_blaster.h"
+#include "ast/reg_decl_plugins.h"
 #include "ast/ast_pp.h"
 #include "ast/ast_ll_pp.h"
 
@@ -113,7 +114,111 @@ void tst_sh(ast_manager & m, unsigned sz) {
 //     TRACE("bit_blaster", tout << "ashr " << c.size() << "\n"; display(tout, c, false););
 }
 
+static bool eval_bit(ast_manager & m, obj_map<expr, bool> const & asgn, expr * e) {
+    bool r = false;
+    if (asgn.find(e, r))
+        return r;
+    if (m.is_true(e))
+        return true;
+    if (m.is_false(e))
+        return false;
+    app * a = to_app(e);
+    unsigned n = a->get_num_args();
+    if (m.is_not(e))
+        return !eval_bit(m, asgn, a->get_arg(0));
+    if (m.is_ite(e))
+        return eval_bit(m, asgn, a->get_arg(0)) ? eval_bit(m, asgn, a->get_arg(1)) : eval_bit(m, asgn, a->get_arg(2));
+    if (m.is_eq(e))
+        return eval_bit(m, asgn, a->get_arg(0)) == eval_bit(m, asgn, a->get_arg(1));
+    if (m.is_xor(e))
+        return eval_bit(m, asgn, a->get_arg(0)) != eval_bit(m, asgn, a->get_arg(1));
+    if (m.is_and(e)) {
+        r = true;
+        for (unsigned i = 0; i < n; ++i)
+            r &= eval_bit(m, asgn, a->get_arg(i));
+        return r;
+    }
+    if (m.is_or(e)) {
+        for (unsigned i = 0; i < n; ++i)
+            r |= eval_bit(m, asgn, a->get_arg(i));
+        return r;
+    }
+    UNREACHABLE();
+    return false;
+}
+
+// the circuits with and without structural hashing agree on all inputs.
+static void check_equiv(ast_manager & m, expr_ref_vector const & a, expr_ref_vector const & b,
+                        expr_ref_vector const & c1, expr_ref_vector const & c2) {
+    ENSURE(c1.size() == c2.size());
+    unsigned sz = a.size();
+    for (unsigned v = 0; v < (1u << (2 * sz)); ++v) {
+        obj_map<expr, bool> asgn;
+        for (unsigned i = 0; i < sz; ++i) {
+            asgn.insert(a.get(i), ((v >> i) & 1) != 0);
+            asgn.insert(b.get(i), ((v >> (i + sz)) & 1) != 0);
+        }
+        for (unsigned i = 0; i < c1.size(); ++i)
+            ENSURE(eval_bit(m, asgn, c1.get(i)) == eval_bit(m, asgn, c2.get(i)));
+    }
+}
+
+static void tst_aig_strash() {
+    ast_manager m;
+    reg_decl_plugins(m);
+    expr_ref_vector a(m), b(m), c1(m), c2(m), d(m);
+    mk_bits(m, "a", 4, a);
+    mk_bits(m, "b", 4, b);
+    bit_blaster_params p;
+    p.m_bb_aig = true;
+    bit_blaster blaster(m, p);
+    bit_blaster plain(m, bit_blaster_params());
+    expr_ref x(m), y(m), na(m), nb(m);
+    // gates are shared modulo commutativity and negation
+    blaster.mk_and(a.get(0), b.get(0), x);
+    blaster.mk_and(b.get(0), a.get(0), y);
+    ENSURE(x == y);
+    blaster.mk_not(a.get(0), na);
+    blaster.mk_not(b.get(0), nb);
+    blaster.mk_or(na, nb, x);
+    blaster.mk_and(a.get(0), b.get(0), y);
+    ENSURE(m.is_not(x) && to_app(x)->get_arg(0) == y);
+    blaster.mk_xor(na, b.get(0), x);
+    blaster.mk_iff(b.get(0), a.get(0), y);
+    ENSURE(x == y);
+    ENSURE(blaster.get_strash().num_gates() == 2);
+
+    // commuted adders share all gates
+    unsigned num_gates = blaster.get_strash().num_gates();
+    blaster.mk_adder(4, a.c_ptr(), b.c_ptr(), c1);
+    unsigned num_gates1 = blaster.get_strash().num_gates();
+    ENSURE(num_gates1 > num_gates);
+    blaster.mk_adder(4, b.c_ptr(), a.c_ptr(), c2);
+    ENSURE(c1 == c2);
+    ENSURE(num_gates1 == blaster.get_strash().num_gates());
+    plain.mk_adder(4, a.c_ptr(), b.c_ptr(), d);
+    check_equiv(m, a, b, c1, d);
+
+    // gates created in a scope are removed on pop
+    blaster.push();
+    c1.reset();
+    d.reset();
+    blaster.mk_multiplier(4, a.c_ptr(), b.c_ptr(), c1);
+    ENSURE(blaster.get_strash().num_gates() > num_gates1);
+    plain.mk_multiplier(4, a.c_ptr(), b.c_ptr(), d);
+    check_equiv(m, a, b, c1, d);
+    blaster.pop(1);
+    ENSURE(blaster.get_strash().num_gates() == num_gates1);
+    ENSURE(blaster.get_strash().num_scopes() == 0);
+    // the gates of the adder survive the pop
+    c1.reset();
+    blaster.mk_adder(4, a.c_ptr(), b.c_ptr(), c1);
+    ENSURE(c1 == c2);
+    ENSURE(blaster.get_strash().num_gates() == num_gates1);
+}
+
 void tst_bit_blaster() {
+    tst_aig_strash();
     ast_manager m;
     tst_adder(m, 4);
     tst_multiplier(m, 4);
@@ -0,0 +1,217 @@
+/*++
+Copyright (c) 2020 Microsoft Corporation
+
+Module Name:
+
+    bv_word_domain.cpp
+
+Abstract:
+
+    Test the abstract bit-vector values against enumeration of their members,
+    and word-level propagation in the bit-vector theory.
+
+--*/
+
+#include "smt/bv_word_domain.h"
+#include "util/util.h"
+#include "api/z3.h"
+#include <iostream>
+#include <string>
+
+static bool contains(bv_word_domain const & d, unsigned v) {
+    if (d.is_empty() || rational(v) < d.lo() || rational(v) > d.hi())
+        return false;
+    for (unsigned i = 0; i < d.size(); ++i)
+        if (d.bit(i) != l_undef && (d.bit(i) == l_true) != (((v >> i) & 1) != 0))
+            return false;
+    return true;
+}
+
+static void mk_random(random_gen & r, unsigned sz, bv_word_domain & d) {
+    d = bv_word_domain(sz);
+    unsigned n = 1u << sz;
+    for (unsigned i = 0; i < sz; ++i)
+        if (r(3) == 0)
+            d.set_bit(i, r(2) == 0);
+    if (r(2) == 0) {
+        unsigned lo = r(n), hi = r(n);
+        if (lo > hi)
+            std::swap(lo, hi);
+        d.intersect(rational(lo), rational(hi));
+    }
+    svector<bool> members;
+    for (unsigned v = 0; v < n; ++v)
+        members.push_back(contains(d, v));
+    d.reduce();
+    // reduction keeps the members and makes the bounds members
+    bool empty = true;
+    for (unsigned v = 0; v < n; ++v) {
+        ENSURE(members[v] == contains(d, v));
+        empty &= !members[v];
+    }
+    ENSURE(empty == d.is_empty());
+    if (!d.is_empty()) {
+        ENSURE(contains(d, d.lo().get_unsigned()));
+        ENSURE(contains(d, d.hi().get_unsigned()));
+    }
+}
+
+static void tst_transfer() {
+    random_gen r(0);
+    unsigned const sz = 4, n = 1u << sz, mask = n - 1;
+    for (unsigned k = 0; k < 3000; ++k) {
+        bv_word_domain a(sz), b(sz);
+        mk_random(r, sz, a);
+        mk_random(r, sz, b);
+        bv_word_domain add  = bv_word_domain::mk_add(a, b);
+        bv_word_domain band = bv_word_domain::mk_and(a, b);
+        bv_word_domain mul  = bv_word_domain::mk_mul(a, b);
+        bv_word_domain udiv = bv_word_domain::mk_udiv(a, b);
+        bv_word_domain urem = bv_word_domain::mk_urem(a, b);
+        bv_word_domain shl  = bv_word_domain::mk_shl(a, b);
+        bv_word_domain lshr = bv_word_domain::mk_lshr(a, b);
+        bv_word_domain cat  = bv_word_domain::mk_concat(a, b);
+        bv_word_domain ext  = bv_word_domain::mk_extract(cat, 5, 2);
+        for (unsigned x = 0; x < n; ++x) {
+            if (!contains(a, x))
+                continue;
+            for (unsigned y = 0; y < n; ++y) {
+                if (!contains(b, y))
+                    continue;
+                ENSURE(contains(add, (x + y) & mask));
+                ENSURE(contains(band, x & y));
+                ENSURE(contains(mul, (x * y) & mask));
+                if (y != 0) {
+                    ENSURE(contains(udiv, x / y));
+                    ENSURE(contains(urem, x % y));
+                }
+                ENSURE(contains(shl, y >= sz ? 0 : (x << y) & mask));
+                ENSURE(contains(lshr, y >= sz ? 0 : x >> y));
+                ENSURE(contains(cat, (x << sz) | y));
+                ENSURE(contains(ext, (((x << sz) | y) >> 2) & mask));
+            }
+        }
+    }
+}
+
+static void tst_precision() {
+    // intervals give bits that bit-level propagation through an adder does not
+    bv_word_domain x(8), y(8);
+    x.intersect(rational(0), rational(10));
+    y.intersect(rational(0), rational(10));
+    x.reduce();
+    y.reduce();
+    bv_word_domain s = bv_word_domain::mk_add(x, y);
+    ENSURE(s.lo().is_zero() && s.hi() == rational(20));
+    for (unsigned i = 5; i < 8; ++i)
+        ENSURE(s.bit(i) == l_false);
+    bv_word_domain v = bv_word_domain::mk_value(8, rational(30));
+    v.intersect(s);
+    v.reduce();
+    ENSURE(v.is_empty());
+
+    // the sum of [250, 255] and [10, 12] wraps around for all members
+    bv_word_domain a(8), b(8);
+    a.intersect(rational(250), rational(255));
+    b.intersect(rational(10), rational(12));
+    s = bv_word_domain::mk_add(a, b);
+    ENSURE(s.lo() == rational(4) && s.hi() == rational(11));
+
+    bv_word_domain sh(8);
+    sh.intersect(rational(2), rational(3));
+    bv_word_domain q = bv_word_domain::mk_lshr(bv_word_domain::mk_value(8, rational(100)), sh);
+    ENSURE(q.lo() == rational(12) && q.hi() == rational(25));
+}
+
+// the formulas are checked after a push, so that the incremental SMT core solves them.
+static std::string eval(char const * script) {
+    Z3_context ctx = Z3_mk_context(nullptr);
+    std::string r = Z3_eval_smtlib2_string(ctx, script);
+    Z3_del_context(ctx);
+    return r;
+}
+
+static void check(char const * options, char const * fml, char const * expected, unsigned rounds = 1) {
+    std::string script = std::string("(set-option :model_validate true)\n") + options;
+    std::string results;
+    for (unsigned i = 0; i < rounds; ++i) {
+        script += std::string("(push)") + fml + "(check-sat)(pop)\n";
+        results += std::string(expected) + "\n";
+    }
+    std::string r = eval(script.c_str());
+    if (r != results)
+        std::cout << script << "expected: " << results << "got: " << r << "\n";
+    ENSURE(r == results);
+}
+
+static void tst_propagation() {
+    char const * fmls[][2] = {
+        // addition of small values
+        { "(declare-const x (_ BitVec 8))(declare-const y (_ BitVec 8))"
+          "(assert (bvule x #x0a))(assert (bvule y #x0a))(assert (= (bvadd x y) #x1e))", "unsat" },
+        { "(declare-const x (_ BitVec 8))(declare-const y (_ BitVec 8))"
+          "(assert (bvule x #x0a))(assert (bvule y #x0a))(assert (= (bvadd x y) #x14))", "sat" },
+        { "(declare-const x (_ BitVec 8))(declare-const y (_ BitVec 8))"
+          "(assert (bvule #xfa x))(assert (bvule #x0a y))(assert (bvule y #x0c))(assert (bvult #x0b (bvadd x y)))", "unsat" },
+        // bitwise and
+        { "(declare-const x (_ BitVec 8))(declare-const y (_ BitVec 8))"
+          "(assert (bvule y #x21))(assert (bvult #x21 (bvand x y)))", "unsat" },
+        // shifts by bounded amounts
+        { "(declare-const x (_ BitVec 8))(declare-const s (_ BitVec 8))"
+          "(assert (bvule x #x64))(assert (bvule #x02 s))(assert (bvult #x19 (bvlshr x s)))", "unsat" },
+        { "(declare-const x (_ BitVec 8))(declare-const s (_ BitVec 8))"
+          "(assert (bvule x #x64))(assert (bvule #x02 s))(assert (= #x19 (bvlshr x s)))", "sat" },
+        { "(declare-const x (_ BitVec 8))(declare-const s (_ BitVec 8))"
+          "(assert (bvule x #x03))(assert (bvule s #x02))(assert (bvult #x0c (bvshl x s)))", "unsat" },
+        // concatenation and extraction
+        { "(declare-const a (_ BitVec 4))(declare-const b (_ BitVec 4))"
+          "(assert (bvule a #x3))(assert (bvult #x2f (concat a b)))(assert (bvule (concat a b) #x30))"
+          "(assert (= ((_ extract 3 0) (concat a b)) #x1))", "unsat" },
+        { "(declare-const a (_ BitVec 4))(declare-const b (_ BitVec 4))"
+          "(assert (bvule a #x3))(assert (bvult #x2f (concat a b)))(assert (bvule (concat a b) #x30))", "sat" },
+    };
+    for (auto const & f : fmls) {
+        check("", f[0], f[1]);
+        check("(set-option :smt.bv.word_prop true)\n", f[0], f[1], 2);
+    }
+
+    // the interval of a sum is used to detect the conflict
+    char const * script =
+        "(set-option :smt.bv.word_prop true)\n"
+        "(push)(declare-const x (_ BitVec 32))(declare-const y (_ BitVec 32))"
+        "(assert (bvule x #x00000100))(assert (bvule y #x00000100))(assert (bvult #x00000200 (bvadd x y)))"
+        "(check-sat)(get-info :all-statistics)";
+    std::string r = eval(script);
+    ENSURE(r.substr(0, r.find('\n')) == "unsat");
+    ENSURE(r.find("bv-word-conflicts") != std::string::npos || r.find("bv-word-propagations") != std::string::npos);
+}
+
+static void tst_delayed() {
+    // multipliers and dividers with bounded arguments
+    char const * options = "(set-option :smt.bv.delay true)(set-option :smt.bv.word_prop true)\n";
+    check(options,
+          "(declare-const x (_ BitVec 16))(declare-const y (_ BitVec 16))"
+          "(assert (bvule x #x000a))(assert (bvule y #x000a))(assert (bvult #x0064 (bvmul x y)))", "unsat");
+    check(options,
+          "(declare-const x (_ BitVec 16))(declare-const y (_ BitVec 16))"
+          "(assert (bvule x #x000a))(assert (bvule y #x000a))(assert (= #x0064 (bvmul x y)))", "sat");
+    check(options,
+          "(declare-const x (_ BitVec 16))(declare-const y (_ BitVec 16))"
+          "(assert (bvule #x0004 y))(assert (bvule x #x0100))(assert (bvult #x0040 (bvudiv x y)))", "unsat");
+    check(options,
+          "(declare-const x (_ BitVec 16))(declare-const y (_ BitVec 16))"
+          "(assert (bvule #x0001 y))(assert (bvule y #x0007))(assert (bvule #x0007 (bvurem x y)))", "unsat");
+    // final check blasts a factorization instead of excluding one candidate at a time
+    check("(set-option :smt.bv.delay true)\n",
+          "(declare-const x (_ BitVec 32))(declare-const y (_ BitVec 32))"
+          "(assert (bvult #x00000001 x))(assert (bvult #x00000001 y))"
+          "(assert (bvult x #x00010000))(assert (bvult y #x00010000))"
+          "(assert (= (bvmul x y) #x3dce1a37))", "sat");
+}
+
+void tst_bv_word_domain() {
+    tst_transfer();
+    tst_precision();
+    tst_propagation();
+    tst_delayed();
+}
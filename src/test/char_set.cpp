@@ -0,0 +1,115 @@
+/*++
+Copyright (c) 2020 Microsoft Corporation
+
+Module Name:
+
+    char_set.cpp
+
+Abstract:
+
+    Test character sets against a reference bit-array.
+
+--*/
+
+#include "util/char_set.h"
+#include "util/vector.h"
+#include "util/util.h"
+#include "api/z3.h"
+#include <iostream>
+#include <string>
+
+static const unsigned max_ch = 700;
+
+static void check(char_set const& s, svector<bool> const& ref) {
+    for (unsigned ch = 0; ch <= max_ch; ++ch) {
+        if (s.contains(ch) != ref[ch]) {
+            std::cout << s << " " << ch << "\n";
+        }
+        ENSURE(s.contains(ch) == ref[ch]);
+    }
+    for (unsigned i = 1; i < s.num_ranges(); ++i)
+        ENSURE(s[i - 1].m_hi + 1 < s[i].m_lo);
+}
+
+static void mk_random(random_gen& r, char_set& s, svector<bool>& ref) {
+    s.reset();
+    ref.reset();
+    ref.resize(max_ch + 1, false);
+    unsigned n = r(4);
+    // bias towards small characters to exercise the bitset
+    unsigned range = r(2) ? 256 : max_ch + 1;
+    for (unsigned i = 0; i < n; ++i) {
+        unsigned lo = r(range);
+        unsigned hi = std::min(max_ch, lo + r(80));
+        s.add(lo, hi);
+        for (unsigned ch = lo; ch <= hi; ++ch)
+            ref[ch] = true;
+    }
+}
+
+static void tst_random() {
+    random_gen r(0);
+    for (unsigned k = 0; k < 2000; ++k) {
+        char_set s1, s2;
+        svector<bool> ref1, ref2;
+        mk_random(r, s1, ref1);
+        mk_random(r, s2, ref2);
+        check(s1, ref1);
+        check(s2, ref2);
+
+        char_set t = s1;
+        t &= s2;
+        svector<bool> ref(ref1);
+        for (unsigned ch = 0; ch <= max_ch; ++ch) ref[ch] = ref1[ch] && ref2[ch];
+        check(t, ref);
+        ENSURE(t.empty() == (t.num_ranges() == 0));
+
+        t = s1;
+        t |= s2;
+        for (unsigned ch = 0; ch <= max_ch; ++ch) ref[ch] = ref1[ch] || ref2[ch];
+        check(t, ref);
+
+        t = s1.complement(max_ch);
+        for (unsigned ch = 0; ch <= max_ch; ++ch) ref[ch] = !ref1[ch];
+        check(t, ref);
+        ENSURE(t.complement(max_ch) == s1);
+
+        unsigned lo = r(max_ch + 1), hi = r(max_ch + 1);
+        t = s1;
+        t.intersect(lo, hi);
+        for (unsigned ch = 0; ch <= max_ch; ++ch) ref[ch] = ref1[ch] && lo <= ch && ch <= hi;
+        check(t, ref);
+
+        unsigned ch = r(max_ch + 1);
+        t = s1;
+        t.remove(ch);
+        ref = ref1;
+        ref[ch] = false;
+        check(t, ref);
+    }
+}
+
+// z3str3 follows automaton moves labeled by sets, such as the
+// intersection of two character ranges.
+static void tst_z3str3_intersection() {
+    char const* decls =
+        "(set-option :smt.string_solver z3str3)\n"
+        "(declare-const x String)\n"
+        "(assert (str.in_re x (re.+ (re.inter (re.range \"a\" \"m\") (re.range \"h\" \"z\")))))\n"
+        "(assert (= (str.len x) 2))\n";
+    auto check_sat = [&](char const* extra) {
+        Z3_context ctx = Z3_mk_context(nullptr);
+        std::string r = Z3_eval_smtlib2_string(ctx, (std::string(decls) + extra + "(check-sat)\n").c_str());
+        Z3_del_context(ctx);
+        return r.substr(0, r.find('\n'));
+    };
+    ENSURE(check_sat("") == "sat");
+    ENSURE(check_sat("(assert (str.prefixof \"k\" x))\n") == "sat");
+    ENSURE(check_sat("(assert (str.prefixof \"b\" x))\n") == "unsat");
+    ENSURE(check_sat("(assert (str.suffixof \"n\" x))\n") == "unsat");
+}
+
+void tst_char_set() {
+    tst_random();
+    tst_z3str3_intersection();
+}
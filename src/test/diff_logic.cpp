@@ -16,22 +16,25 @@ Author:
 Revision History:
 
 --*/
-#ifdef _WINDOWS
 #include "util/rational.h"
+#include "util/stopwatch.h"
 #include "smt/diff_logic.h"
 #include "smt/smt_literal.h"
 #include "util/util.h"
 #include "util/debug.h"
+#include "api/z3.h"
+#include <string>
 
 struct diff_logic_ext {
     typedef rational numeral;
     typedef smt::literal  explanation;
 };
 
-template class dl_graph<diff_logic_ext>;
-
 typedef dl_graph<diff_logic_ext> dlg;
 
+#ifdef _WINDOWS
+template class dl_graph<diff_logic_ext>;
+
 struct tst_dl_functor {
     smt::literal_vector m_literals;
     void operator()(smt::literal l) {
@@ -163,12 +166,181 @@ static void tst3() {
 
 }
 
+#endif
+
+struct sum_weights {
+    vector<rational> const& m_weights;
+    rational m_sum;
+    unsigned m_num_edges;
+    sum_weights(vector<rational> const& w): m_weights(w), m_num_edges(0) {}
+    void operator()(smt::literal l) {
+        m_sum += m_weights[l.var()];
+        ++m_num_edges;
+    }
+};
+
+// Job-shop like graphs: chains of tasks with random durations and random
+// precedences between tasks of different chains, asserted in batches.
+// Compare enabling batches of edges with enabling the edges one by one.
+static void tst_batch(unsigned num_chains, unsigned chain_len, unsigned num_prec, unsigned batch_size, bool add_cycle) {
+    random_gen r(num_chains + num_prec);
+    unsigned num_vars = num_chains * chain_len;
+    vector<rational> weights;
+    svector<std::pair<dl_var, dl_var> > arcs;
+    // start[t] + d <= start[t+1]  <=>  start[t] - start[t+1] <= -d
+    for (unsigned c = 0; c < num_chains; ++c) {
+        for (unsigned i = 0; i + 1 < chain_len; ++i) {
+            dl_var t = c * chain_len + i;
+            arcs.push_back(std::make_pair(t + 1, t));
+            weights.push_back(rational(-static_cast<int>(1 + r(10))));
+        }
+    }
+    // precedences from earlier to later positions keep the graph acyclic.
+    for (unsigned k = 0; k < num_prec; ++k) {
+        unsigned i = r(chain_len - 1);
+        unsigned j = i + 1 + r(chain_len - i - 1);
+        dl_var t1 = r(num_chains) * chain_len + i;
+        dl_var t2 = r(num_chains) * chain_len + j;
+        arcs.push_back(std::make_pair(t2, t1));
+        weights.push_back(rational(-static_cast<int>(r(10))));
+    }
+    if (add_cycle) {
+        // the first task of chain 0 starts after the last task of chain 0.
+        arcs.push_back(std::make_pair(0, chain_len - 1));
+        weights.push_back(rational(0));
+    }
+
+    double times[2];
+    for (unsigned batch = 0; batch < 2; ++batch) {
+        dlg g;
+        for (unsigned v = 0; v < num_vars; ++v) {
+            g.init_var(v);
+        }
+        svector<edge_id> ids;
+        for (unsigned i = 0; i < arcs.size(); ++i) {
+            ids.push_back(g.add_edge(arcs[i].first, arcs[i].second, weights[i], smt::literal(i)));
+        }
+        stopwatch sw;
+        sw.start();
+        bool ok = true;
+        for (unsigned i = 0; ok && i < ids.size(); i += batch_size) {
+            unsigned n = std::min(batch_size, ids.size() - i);
+            if (batch) {
+                unsigned num_enabled = 0;
+                ok = g.enable_edges(n, ids.c_ptr() + i, num_enabled);
+                ENSURE(!ok || num_enabled == n);
+            }
+            else {
+                for (unsigned j = 0; ok && j < n; ++j) {
+                    ok = g.enable_edge(ids[i + j]);
+                }
+            }
+        }
+        sw.stop();
+        times[batch] = sw.get_seconds();
+        ENSURE(ok == !add_cycle);
+        if (ok) {
+            ENSURE(g.is_feasible_dbg());
+        }
+        else {
+            sum_weights proc(weights);
+            g.traverse_neg_cycle(false, proc);
+            ENSURE(proc.m_sum.is_neg());
+            ENSURE(proc.m_num_edges > 0);
+        }
+    }
+    std::cout << "vars: " << num_vars << " edges: " << arcs.size() << " batch: " << batch_size
+              << " one by one: " << times[0] << "s batched: " << times[1] << "s\n";
+}
+
+static std::string mk_int(std::string const& name) {
+    return "(declare-const " + name + " Int)";
+}
+
+// Job-shop scheduling problems with a bound on the makespan, solved with the
+// Bellman-Ford based solver (smt.arith.solver=1), which uses enable_edges, and
+// the Floyd-Warshall based solver theory_dense_diff_logic (smt.arith.solver=3).
+static void tst_job_shop(unsigned num_jobs, unsigned num_machines, unsigned seed) {
+    random_gen r(seed);
+    vector<unsigned_vector> machine(num_jobs), duration(num_jobs);
+    unsigned_vector load(num_machines, 0u);
+    unsigned lower = 0, total = 0;
+    for (unsigned j = 0; j < num_jobs; ++j) {
+        unsigned_vector order;
+        for (unsigned k = 0; k < num_machines; ++k) order.push_back(k);
+        shuffle(order.size(), order.c_ptr(), r);
+        unsigned len = 0;
+        for (unsigned k = 0; k < num_machines; ++k) {
+            unsigned d = 1 + r(9);
+            machine[j].push_back(order[k]);
+            duration[j].push_back(d);
+            load[order[k]] += d;
+            len += d;
+        }
+        lower = std::max(lower, len);
+        total += len;
+    }
+    for (unsigned l : load) lower = std::max(lower, l);
+
+    auto s = [&](unsigned j, unsigned k) { return "s" + std::to_string(j) + "_" + std::to_string(k); };
+    std::string fml = mk_int("end");
+    for (unsigned j = 0; j < num_jobs; ++j) {
+        for (unsigned k = 0; k < num_machines; ++k) {
+            fml += mk_int(s(j, k));
+        }
+    }
+    for (unsigned j = 0; j < num_jobs; ++j) {
+        for (unsigned k = 0; k < num_machines; ++k) {
+            fml += "(assert (<= 0 " + s(j, k) + "))";
+            std::string next = k + 1 < num_machines ? s(j, k + 1) : std::string("end");
+            fml += "(assert (<= (- " + s(j, k) + " " + next + ") (- " + std::to_string(duration[j][k]) + ")))";
+        }
+    }
+    // tasks on the same machine do not overlap
+    for (unsigned j1 = 0; j1 < num_jobs; ++j1) {
+        for (unsigned j2 = j1 + 1; j2 < num_jobs; ++j2) {
+            for (unsigned k1 = 0; k1 < num_machines; ++k1) {
+                for (unsigned k2 = 0; k2 < num_machines; ++k2) {
+                    if (machine[j1][k1] != machine[j2][k2]) continue;
+                    fml += "(assert (or (<= (- " + s(j1, k1) + " " + s(j2, k2) + ") (- " + std::to_string(duration[j1][k1]) + "))"
+                        "(<= (- " + s(j2, k2) + " " + s(j1, k1) + ") (- " + std::to_string(duration[j2][k2]) + "))))";
+                }
+            }
+        }
+    }
+    // the bounds are below the lower bound, between the bounds and at the sum of all durations.
+    unsigned bounds[4] = { lower - 1, lower, (lower + total) / 2, total };
+    for (unsigned bound : bounds) {
+        std::string results[2];
+        double times[2];
+        for (unsigned i = 0; i < 2; ++i) {
+            std::string script = std::string("(set-option :smt.arith.solver ") + (i == 0 ? "1" : "3") + ")(push)" + fml +
+                "(assert (<= end " + std::to_string(bound) + "))(check-sat)";
+            stopwatch sw;
+            sw.start();
+            Z3_context ctx = Z3_mk_context(nullptr);
+            results[i] = Z3_eval_smtlib2_string(ctx, script.c_str());
+            Z3_del_context(ctx);
+            sw.stop();
+            times[i] = sw.get_seconds();
+        }
+        std::cout << "job shop " << num_jobs << "x" << num_machines << " makespan <= " << bound << ": " << results[0].substr(0, results[0].size() - 1)
+                  << " bellman-ford: " << times[0] << "s floyd-warshall: " << times[1] << "s\n";
+        ENSURE(results[0] == results[1]);
+        ENSURE(bound >= lower || results[0] == "unsat\n");
+        ENSURE(bound < total || results[0] == "sat\n");
+    }
+}
+
 void tst_diff_logic() {
     //tst1();
     //tst2();
     //tst3();
+    tst_batch(5, 20, 50, 10, false);
+    tst_batch(5, 20, 50, 10, true);
+    tst_batch(40, 100, 20000, 500, false);
+    tst_batch(40, 100, 20000, 500, true);
+    tst_job_shop(4, 4, 0);
+    tst_job_shop(6, 5, 1);
+    tst_job_shop(10, 8, 2);
 }
-#else
-void tst_diff_logic() {
-}
-#endif
@@ -0,0 +1,116 @@
+/*++
+Copyright (c) 2020 Microsoft Corporation
+
+Module Name:
+
+    fpa2bv_templates.cpp
+
+Abstract:
+
+    Test that circuits for fp.add, fp.mul, fp.div, fp.fma and fp.sqrt
+    instantiated from templates (rewriter.fpa2bv_templates) are equivalent
+    to the circuits of the direct translation.
+
+--*/
+
+#include "ast/reg_decl_plugins.h"
+#include "ast/fpa/fpa2bv_converter.h"
+#include "ast/ast_pp.h"
+#include "smt/smt_context.h"
+#include <iostream>
+
+class fpa2bv_templates_tester {
+    ast_manager &     m;
+    fpa_util          m_util;
+    bv_util           m_bv;
+    sort_ref          m_sort;
+    fpa2bv_converter  m_direct;
+    fpa2bv_converter  m_template;
+    expr_ref_vector   m_vars;
+    unsigned          m_ebits, m_sbits;
+
+    // fp(sgn, exp, sig) over fresh bit-vector constants.
+    expr * mk_var(char const * name) {
+        std::string n(name);
+        expr * sgn = m.mk_const(symbol((n + "_sgn").c_str()), m_bv.mk_sort(1));
+        expr * exp = m.mk_const(symbol((n + "_exp").c_str()), m_bv.mk_sort(m_ebits));
+        expr * sig = m.mk_const(symbol((n + "_sig").c_str()), m_bv.mk_sort(m_sbits - 1));
+        m_vars.push_back(m_util.mk_fp(sgn, exp, sig));
+        return m_vars.back();
+    }
+
+    expr * mk_rm(int rm) {
+        if (rm < 0)
+            m_vars.push_back(m_util.mk_bv2rm(m.mk_const(symbol("rm"), m_bv.mk_sort(3))));
+        else
+            m_vars.push_back(m_util.mk_bv2rm(m_bv.mk_numeral(rm, 3)));
+        return m_vars.back();
+    }
+
+    void mk_circuit(fpa2bv_converter & conv, decl_kind k, func_decl * f, unsigned num, expr * const * args, expr_ref & result) {
+        switch (k) {
+        case OP_FPA_ADD: conv.mk_add(f, num, args, result); break;
+        case OP_FPA_MUL: conv.mk_mul(f, num, args, result); break;
+        case OP_FPA_DIV: conv.mk_div(f, num, args, result); break;
+        case OP_FPA_FMA: conv.mk_fma(f, num, args, result); break;
+        case OP_FPA_SQRT: conv.mk_sqrt(f, num, args, result); break;
+        default: UNREACHABLE();
+        }
+    }
+
+    // the circuits agree on all inputs
+    void check_equiv(expr * r1, expr * r2) {
+        ENSURE(m_util.is_fp(r1) && m_util.is_fp(r2));
+        expr_ref_vector eqs(m);
+        for (unsigned i = 0; i < 3; ++i)
+            eqs.push_back(m.mk_eq(to_app(r1)->get_arg(i), to_app(r2)->get_arg(i)));
+        smt_params params;
+        smt::context ctx(m, params);
+        for (expr * e : m_direct.m_extra_assertions)
+            ctx.assert_expr(e);
+        for (expr * e : m_template.m_extra_assertions)
+            ctx.assert_expr(e);
+        ctx.assert_expr(m.mk_not(m.mk_and(eqs.size(), eqs.c_ptr())));
+        lbool r = ctx.check();
+        if (r != l_false)
+            std::cout << "not equivalent:\n" << mk_pp(r1, m) << "\n" << mk_pp(r2, m) << "\n";
+        ENSURE(r == l_false);
+    }
+
+public:
+    fpa2bv_templates_tester(ast_manager & m, unsigned ebits, unsigned sbits):
+        m(m), m_util(m), m_bv(m), m_sort(m_util.mk_float_sort(ebits, sbits), m),
+        m_direct(m), m_template(m), m_vars(m), m_ebits(ebits), m_sbits(sbits) {
+        m_direct.set_circuit_templates(false);
+    }
+
+    // rm < 0 stands for a symbolic rounding mode. Each template is used for
+    // two argument lists, the second one instantiates the cached circuit.
+    void check(decl_kind k, int rm) {
+        expr * x = mk_var("x"), * y = mk_var("y"), * z = mk_var("z");
+        expr * rm_arg = mk_rm(rm);
+        expr * args1[4] = { rm_arg, x, y, z };
+        expr * args2[4] = { rm_arg, z, x, y };
+        unsigned num = k == OP_FPA_SQRT ? 2 : (k == OP_FPA_FMA ? 4 : 3);
+        sort * domain[4] = { m_util.mk_rm_sort(), m_sort, m_sort, m_sort };
+        func_decl_ref f(m.mk_func_decl(m_util.get_family_id(), k, 0, nullptr, num, domain), m);
+        for (expr * const * args : { args1, args2 }) {
+            expr_ref r1(m), r2(m);
+            mk_circuit(m_direct, k, f, num, args, r1);
+            mk_circuit(m_template, k, f, num, args, r2);
+            check_equiv(r1, r2);
+        }
+    }
+};
+
+void tst_fpa2bv_templates() {
+    ast_manager m;
+    reg_decl_plugins(m);
+    fpa2bv_templates_tester t(m, 2, 4);
+    decl_kind ops[] = { OP_FPA_ADD, OP_FPA_MUL, OP_FPA_DIV, OP_FPA_FMA, OP_FPA_SQRT };
+    for (decl_kind k : ops) {
+        for (int rm = BV_RM_TIES_TO_EVEN; rm <= BV_RM_TO_ZERO; ++rm)
+            t.check(k, rm);
+        t.check(k, -1);
+    }
+}
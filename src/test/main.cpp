@@ -156,8 +156,12 @@ int main(int argc, char ** argv) {
     TST(rational);
     TST(inf_rational);
     TST(ast);
+    TST(ast_translation);
+    TST(ast_binary);
     TST(optional);
     TST(bit_vector);
+    TST(char_set);
+    TST(bv_word_domain);
     TST(fixed_bit_vector);
     TST(tbv);
     TST(doc);
@@ -206,6 +210,8 @@ int main(int argc, char ** argv) {
     TST(model_retrieval);
     TST(model_based_opt);
     TST(factor_rewriter);
+    TST(rewriter_memo);
+    TST(parallel_rewriter);
     TST(smt2print_parse);
     TST(substitution);
     TST(polynomial);
@@ -227,6 +233,7 @@ int main(int argc, char ** argv) {
     TST(mpbq);
     TST(mpfx);
     TST(mpff);
+    TST(numeral_throughput);
     TST(horn_subsume_model_converter);
     TST(model2expr);
     TST(hilbert_basis);
@@ -244,6 +251,12 @@ int main(int argc, char ** argv) {
     TST(expr_substitution);
     TST(sorting_network);
     TST(theory_pb);
+    TST(theory_bv);
+    TST(theory_fpa);
+    TST(fpa2bv_templates);
+    TST(theory_datatype);
+    TST(theory_array);
+    TST(theory_special_relations);
     TST(simplex);
     TST(sat_user_scope);
     TST_ARGV(ddnf);
@@ -254,6 +267,9 @@ int main(int argc, char ** argv) {
     TST_ARGV(sat_lookahead);
     TST_ARGV(sat_local_search);
     TST_ARGV(cnf_backbones);
+    TST(seq_bounded);
+    TST(seq_length);
+    TST_ARGV(seq_regex);
     TST(bdd);
     TST(pdd);
     TST(pdd_solver);
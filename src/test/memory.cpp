@@ -4,6 +4,92 @@ Copyright (c) 2015 Microsoft Corporation
 
 --*/
 
+#include <thread>
+#include "util/memory_manager.h"
+#include "util/vector.h"
+#include "util/util.h"
+#include "util/debug.h"
+
+// blocks of different sizes are written and checked, and a part of them is
+// freed by a different thread than the one that allocated them.
+static void thread_cache_work(unsigned seed, unsigned n, ptr_vector<unsigned>& handoff) {
+    random_gen r(seed);
+    ptr_vector<unsigned> live;
+    for (unsigned i = 0; i < n; ++i) {
+        unsigned sz = 1 + r(r(8) == 0 ? 300 : 40);
+        unsigned * p = static_cast<unsigned*>(memory::allocate(sizeof(unsigned) * (sz + 1)));
+        p[0] = sz;
+        for (unsigned j = 1; j <= sz; ++j)
+            p[j] = seed + j;
+        live.push_back(p);
+        if (r(3) == 0) {
+            // grow or shrink a block across the small and large sizes
+            unsigned k = r(live.size());
+            unsigned * q = live[k];
+            unsigned new_sz = 1 + r(300);
+            q = static_cast<unsigned*>(memory::reallocate(q, sizeof(unsigned) * (new_sz + 1)));
+            for (unsigned j = 1; j <= std::min(q[0], new_sz); ++j)
+                ENSURE(q[j] == seed + j);
+            for (unsigned j = q[0] + 1; j <= new_sz; ++j)
+                q[j] = seed + j;
+            q[0] = new_sz;
+            live[k] = q;
+        }
+        if (r(2) == 0) {
+            unsigned k = r(live.size());
+            unsigned * q = live[k];
+            for (unsigned j = 1; j <= q[0]; ++j)
+                ENSURE(q[j] == seed + j);
+            live[k] = live.back();
+            live.pop_back();
+            memory::deallocate(q);
+        }
+    }
+    for (unsigned i = 0; i < live.size(); ++i) {
+        if (i % 2 == 0)
+            handoff.push_back(live[i]);
+        else
+            memory::deallocate(live[i]);
+    }
+}
+
+static void tst_thread_cache(unsigned num_threads) {
+    vector<ptr_vector<unsigned>> handoff(num_threads);
+    vector<std::thread> threads;
+    for (unsigned t = 0; t < num_threads; ++t)
+        threads.push_back(std::thread([&, t]() { thread_cache_work(t, 100000, handoff[t]); }));
+    for (auto& th : threads)
+        th.join();
+    threads.reset();
+    // free the remaining blocks in other threads
+    for (unsigned t = 0; t < num_threads; ++t)
+        threads.push_back(std::thread([&, t]() {
+            for (unsigned * p : handoff[(t + 1) % num_threads]) memory::deallocate(p);
+        }));
+    for (auto& th : threads)
+        th.join();
+}
+
+// the blocks cached after a thread exits count towards memory.max_size,
+// and they are returned to the system instead of exceeding it.
+static void tst_cache_limit() {
+    std::thread th([]() {
+        ptr_vector<char> blocks;
+        for (unsigned i = 0; i < 500000; ++i)
+            blocks.push_back(static_cast<char*>(memory::allocate(64)));
+        for (char * b : blocks)
+            memory::deallocate(b);
+    });
+    th.join();
+    memory::set_max_size(static_cast<size_t>(memory::get_allocation_size()) + 8 * 1024 * 1024);
+    ptr_vector<char> blocks;
+    for (unsigned i = 0; i < 20000; ++i)
+        blocks.push_back(static_cast<char*>(memory::allocate(200)));
+    for (char * b : blocks)
+        memory::deallocate(b);
+    memory::set_max_size(0);
+}
+
 #ifdef _WINDOWS
 #include "api/z3.h"
 #include "api/z3_private.h"
@@ -51,6 +137,9 @@ static void hit_me(char const* wm) {
 }
 
 void tst_memory() {    
+    tst_thread_cache(1);
+    tst_thread_cache(4);
+    tst_cache_limit();
     hit_me("10");
     Z3_reset_memory();
     hit_me("20");
@@ -62,5 +151,8 @@ void tst_memory() {
 
 #else
 void tst_memory() {    
+    tst_thread_cache(1);
+    tst_thread_cache(4);
+    tst_cache_limit();
 }
 #endif
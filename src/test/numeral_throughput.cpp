@@ -0,0 +1,211 @@
+/*++
+Copyright (c) 2020 Microsoft Corporation
+
+Module Name:
+
+    numeral_throughput.cpp
+
+Abstract:
+
+    Throughput of the basic operations of mpz, mpq, mpbq and mpff on
+    operands of different magnitudes.
+
+    The machine word paths of mpz and mpq are cross-checked against the
+    digit based algorithms by scaling the operands beyond 64 bits.
+
+--*/
+#include "util/mpz.h"
+#include "util/mpq.h"
+#include "util/mpbq.h"
+#include "util/mpff.h"
+#include "util/stopwatch.h"
+#include "util/util.h"
+#include <iostream>
+
+static int64_t rand_int64(random_gen & r, unsigned bits) {
+    uint64_t v = 0;
+    for (unsigned i = 0; i < 5; ++i)
+        v = (v << 15) | static_cast<uint64_t>(r());
+    if (bits < 64)
+        v &= (static_cast<uint64_t>(1) << bits) - 1;
+    return static_cast<int64_t>(v);
+}
+
+static void report(char const * name, unsigned bits, unsigned n, stopwatch const & sw) {
+    double s = sw.get_seconds();
+    std::cout << name << " (" << bits << " bits): " << n << " ops in " << s << "s";
+    if (s > 0)
+        std::cout << ", " << static_cast<unsigned>(n / s / 1000) << " Kops/s";
+    std::cout << "\n";
+}
+
+static void check_mpz(unsigned bits) {
+    unsynch_mpz_manager m;
+    random_gen r(bits);
+    scoped_mpz a(m), b(m), c(m), sa(m), sb(m), ref(m);
+    for (unsigned i = 0; i < 10000; ++i) {
+        m.set(a, rand_int64(r, bits));
+        m.set(b, rand_int64(r, bits));
+        if (r(2)) m.neg(a);
+        if (r(2)) m.neg(b);
+        m.mul2k(a, 64, sa);
+        m.mul2k(b, 64, sb);
+
+        m.add(a, b, c);
+        m.add(sa, sb, ref);
+        m.machine_div2k(ref, 64);
+        ENSURE(m.eq(c, ref));
+
+        m.sub(a, b, c);
+        m.sub(sa, sb, ref);
+        m.machine_div2k(ref, 64);
+        ENSURE(m.eq(c, ref));
+
+        m.mul(a, b, c);
+        m.mul(sa, b, ref);
+        m.machine_div2k(ref, 64);
+        ENSURE(m.eq(c, ref));
+
+        m.gcd(a, b, c);
+        m.gcd(sa, sb, ref);
+        m.machine_div2k(ref, 64);
+        ENSURE(m.eq(c, ref));
+    }
+}
+
+static void check_mpq() {
+    unsynch_mpq_manager m;
+    random_gen r(1);
+    scoped_mpq a(m), b(m), c(m);
+    scoped_mpz n(m), d(m), t(m);
+    scoped_mpq ref(m);
+    for (unsigned i = 0; i < 10000; ++i) {
+        m.set(a, static_cast<int64_t>(r()) - 16000, static_cast<uint64_t>(r() + 1));
+        m.set(b, static_cast<int64_t>(r()) - 16000, static_cast<uint64_t>(r() + 1));
+
+        m.add(a, b, c);
+        m.mul(a.get().numerator(), b.get().denominator(), n);
+        m.mul(b.get().numerator(), a.get().denominator(), t);
+        m.add(n, t, n);
+        m.mul(a.get().denominator(), b.get().denominator(), d);
+        m.set(ref, n, d);
+        ENSURE(m.eq(c, ref));
+
+        m.sub(a, b, c);
+        m.mul(a.get().numerator(), b.get().denominator(), n);
+        m.sub(n, t, n);
+        m.set(ref, n, d);
+        ENSURE(m.eq(c, ref));
+
+        m.mul(a, b, c);
+        m.mul(a.get().numerator(), b.get().numerator(), n);
+        m.set(ref, n, d);
+        ENSURE(m.eq(c, ref));
+    }
+}
+
+static void bench_mpz(unsigned bits, unsigned n) {
+    unsynch_mpz_manager m;
+    random_gen r(0);
+    scoped_mpz_vector xs(m);
+    scoped_mpz x(m), acc(m);
+    for (unsigned i = 0; i < 1024; ++i) {
+        m.set(x, rand_int64(r, bits) | 1);
+        xs.push_back(x);
+    }
+    stopwatch sw;
+    sw.start();
+    for (unsigned i = 0; i < n; ++i) {
+        m.add(xs[i % 1024], xs[(i + 1) % 1024], acc);
+        m.sub(xs[i % 1024], xs[(i + 7) % 1024], acc);
+    }
+    sw.stop();
+    report("mpz add/sub", bits, 2 * n, sw);
+
+    sw.reset();
+    sw.start();
+    for (unsigned i = 0; i < n; ++i)
+        m.mul(xs[i % 1024], xs[(i + 3) % 1024], acc);
+    sw.stop();
+    report("mpz mul", bits, n, sw);
+
+    sw.reset();
+    sw.start();
+    for (unsigned i = 0; i < n; ++i)
+        m.gcd(xs[i % 1024], xs[(i + 5) % 1024], acc);
+    sw.stop();
+    report("mpz gcd", bits, n, sw);
+}
+
+static void bench_mpq(unsigned n) {
+    unsynch_mpq_manager m;
+    random_gen r(0);
+    scoped_mpq_vector xs(m);
+    scoped_mpq x(m), acc(m);
+    for (unsigned i = 0; i < 1024; ++i) {
+        m.set(x, static_cast<int64_t>(r()) - 16000, static_cast<uint64_t>(r() + 1));
+        xs.push_back(x);
+    }
+    stopwatch sw;
+    sw.start();
+    for (unsigned i = 0; i < n; ++i) {
+        m.add(xs[i % 1024], xs[(i + 1) % 1024], acc);
+        m.sub(xs[i % 1024], xs[(i + 7) % 1024], acc);
+    }
+    sw.stop();
+    report("mpq add/sub", 16, 2 * n, sw);
+
+    sw.reset();
+    sw.start();
+    for (unsigned i = 0; i < n; ++i)
+        m.mul(xs[i % 1024], xs[(i + 3) % 1024], acc);
+    sw.stop();
+    report("mpq mul", 16, n, sw);
+}
+
+static void bench_mpbq(unsigned n) {
+    unsynch_mpz_manager zm;
+    mpbq_manager m(zm);
+    random_gen r(0);
+    scoped_mpbq a(m), b(m), acc(m);
+    stopwatch sw;
+    sw.start();
+    for (unsigned i = 0; i < n; ++i) {
+        m.set(a, r() - 16000, r(8));
+        m.set(b, r() - 16000, r(8));
+        m.add(a, b, acc);
+        m.mul(a, b, acc);
+    }
+    sw.stop();
+    report("mpbq add/mul", 16, 2 * n, sw);
+}
+
+static void bench_mpff(unsigned n) {
+    mpff_manager m;
+    random_gen r(0);
+    scoped_mpff a(m), b(m), acc(m);
+    stopwatch sw;
+    sw.start();
+    for (unsigned i = 0; i < n; ++i) {
+        m.set(a, r() - 16000, static_cast<unsigned>(r() + 1));
+        m.set(b, r() - 16000, static_cast<unsigned>(r() + 1));
+        m.add(a, b, acc);
+        m.mul(a, b, acc);
+    }
+    sw.stop();
+    report("mpff add/mul", 16, 2 * n, sw);
+}
+
+void tst_numeral_throughput() {
+    check_mpz(31);
+    check_mpz(48);
+    check_mpz(63);
+    check_mpq();
+    unsigned const n = 1000000;
+    bench_mpz(30, n);
+    bench_mpz(48, n);
+    bench_mpz(62, n);
+    bench_mpq(n);
+    bench_mpbq(n);
+    bench_mpff(n);
+}
@@ -0,0 +1,96 @@
+/*++
+Copyright (c) 2020 Microsoft Corporation
+
+Module Name:
+
+    parallel_rewriter.cpp
+
+Abstract:
+
+    Compare th_rewriter with worker threads against the sequential rewriter.
+
+--*/
+#include "ast/rewriter/th_rewriter.h"
+#include "ast/arith_decl_plugin.h"
+#include "ast/bv_decl_plugin.h"
+#include "ast/reg_decl_plugins.h"
+#include "ast/ast_pp.h"
+
+// a conjunction of bit-vector constraints whose terms are shared between conjuncts.
+static expr_ref mk_bv_formula(ast_manager & m, unsigned n) {
+    bv_util bv(m);
+    sort_ref s(bv.mk_sort(32), m);
+    expr_ref_vector xs(m), conjs(m);
+    for (unsigned i = 0; i < n; ++i) {
+        std::string name = "x" + std::to_string(i);
+        xs.push_back(m.mk_const(symbol(name.c_str()), s));
+    }
+    expr_ref zero(bv.mk_numeral(rational(0), 32), m), one(bv.mk_numeral(rational(1), 32), m);
+    expr_ref acc(xs.get(0), m);
+    for (unsigned i = 1; i < n; ++i) {
+        expr * x = xs.get(i);
+        expr_ref t(bv.mk_bv_add(bv.mk_bv_mul(one, x), zero), m);
+        expr_ref o(m.mk_app(bv.get_fid(), OP_BOR, x, zero), m);
+        acc = bv.mk_bv_add(acc, m.mk_app(bv.get_fid(), OP_BAND, t, o));
+        expr_ref c(m.mk_ite(m.mk_eq(t, zero), m.mk_app(bv.get_fid(), OP_BXOR, acc, t), bv.mk_concat(bv.mk_extract(31, 16, acc), bv.mk_extract(15, 0, t))), m);
+        conjs.push_back(bv.mk_ule(c, bv.mk_bv_add(acc, one)));
+        conjs.push_back(m.mk_not(m.mk_eq(bv.mk_bv_sub(t, x), one)));
+    }
+    return expr_ref(m.mk_and(conjs.size(), conjs.c_ptr()), m);
+}
+
+static expr_ref mk_arith_formula(ast_manager & m, unsigned n) {
+    arith_util a(m);
+    expr_ref_vector conjs(m);
+    expr_ref zero(a.mk_int(0), m), one(a.mk_int(1), m);
+    expr_ref prev(m.mk_const(symbol("y"), a.mk_int()), m);
+    for (unsigned i = 0; i < n; ++i) {
+        std::string name = "y" + std::to_string(i);
+        expr_ref y(m.mk_const(symbol(name.c_str()), a.mk_int()), m);
+        expr_ref s(a.mk_add(a.mk_mul(one, y), zero, a.mk_uminus(a.mk_uminus(prev))), m);
+        conjs.push_back(m.mk_or(a.mk_le(s, a.mk_add(y, one)), m.mk_eq(a.mk_sub(s, zero), prev)));
+        prev = s;
+    }
+    return expr_ref(m.mk_and(conjs.size(), conjs.c_ptr()), m);
+}
+
+static void check(ast_manager & m, expr * f, unsigned threads) {
+    params_ref p;
+    expr_ref expected(m), r(m);
+    p.set_uint("threads", threads);
+    p.set_uint("threads.min_size", 10);
+    th_rewriter par(m, p);
+    par(f, r);
+
+    th_rewriter seq(m);
+    seq(f, expected);
+    if (r != expected)
+        std::cout << mk_pp(f, m) << "\nsequential:\n" << expected << "\nparallel:\n" << r << "\n";
+    ENSURE(r == expected);
+
+    // expressions below the minimal size are rewritten sequentially.
+    p.set_uint("threads.min_size", 1000000);
+    par.updt_params(p);
+    par(f, r);
+    ENSURE(r == expected);
+}
+
+void tst_parallel_rewriter() {
+    ast_manager m;
+    reg_decl_plugins(m);
+    for (unsigned threads : { 2, 3, 8 }) {
+        check(m, mk_bv_formula(m, 40), threads);
+        check(m, mk_arith_formula(m, 40), threads);
+    }
+    // a single rewriter is used for several expressions.
+    params_ref p;
+    p.set_uint("threads", 4);
+    p.set_uint("threads.min_size", 10);
+    th_rewriter par(m, p), seq(m);
+    for (unsigned n = 5; n < 30; n += 5) {
+        expr_ref f = mk_bv_formula(m, n), r1(m), r2(m);
+        par(f, r1);
+        seq(f, r2);
+        ENSURE(r1 == r2);
+    }
+}
@@ -1,3 +1,5 @@
+#include "util/stopwatch.h"
+#include "util/statistics.h"
 #include "math/dd/dd_pdd.h"
 
 namespace dd {
@@ -101,6 +103,50 @@ public :
         std::cout << e << "\n";
     }
 
+    /**
+     * micro-benchmark for node allocation and operation throughput.
+     * The op cache limit is kept small to exercise cache resizing and garbage collection.
+     */
+    static void bench() {
+        std::cout << "\nbench\n";
+        unsigned const num_vars = 12;
+        pdd_manager m(num_vars);
+        m.set_op_cache_limit(1 << 10);
+        vector<pdd> vars;
+        for (unsigned i = 0; i < num_vars; ++i)
+            vars.push_back(m.mk_var(i));
+        unsigned num_ops = 0;
+        stopwatch sw;
+        sw.start();
+        for (unsigned round = 0; round < 20; ++round) {
+            pdd p = m.one();
+            for (unsigned i = 0; i < num_vars; i += 2) {
+                p = p * (vars[i] + vars[(i + round + 1) % num_vars] + round);
+                num_ops += 3;
+            }
+            pdd q = m.one();
+            for (unsigned i = num_vars; i-- > 0; ) {
+                if (i % 2 == 0) {
+                    q = (vars[(i + round + 1) % num_vars] + vars[i] + round) * q;
+                    num_ops += 3;
+                }
+            }
+            VERIFY(p == q);
+            VERIFY((p - q).is_zero());
+            num_ops += 1;
+        }
+        sw.stop();
+        statistics st;
+        m.collect_statistics(st);
+        st.display(std::cout);
+        double secs = sw.get_seconds();
+        std::cout << "ops: " << num_ops << " nodes: " << m.num_nodes() << " op cache: " << m.op_cache_size() 
+                  << " time: " << secs << "s";
+        if (secs > 0) 
+            std::cout << " ops/s: " << (num_ops / secs);
+        std::cout << "\n";
+    }
+
     static void reset() {
         std::cout << "\ntest reset\n";
         pdd_manager m(4);
@@ -292,6 +338,7 @@ void tst_pdd() {
     dd::test::hello_world();
     dd::test::reduce();
     dd::test::large_product();
+    dd::test::bench();
     dd::test::canonize();
     dd::test::reset();
     dd::test::iterator();
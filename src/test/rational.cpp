@@ -22,6 +22,8 @@ Revision History:
 #include "util/trace.h"
 #include "util/ext_gcd.h"
 #include "util/timeit.h"
+#include "util/stopwatch.h"
+#include <thread>
 
 static void tst1() {
     rational r1(1);
@@ -453,6 +455,38 @@ static void tst11(bool use_ints) {
     std::cout << "\n";
 }
 
+// Sum of 1/i for i = start, start + step, ... and products of small rationals,
+// computed by each thread. The results are freed by the main thread.
+static void mt_work(unsigned start, unsigned step, unsigned n, rational & result) {
+    rational sum(0), prod(1);
+    for (unsigned i = start; i <= n; i += step) {
+        sum += rational(1, i);
+        prod *= rational(i % 7 + 1, i % 5 + 1);
+        if (prod.bitsize() > 256)
+            prod = rational(1);
+    }
+    result = sum + prod;
+}
+
+static void tst12(unsigned num_threads) {
+    unsigned const n = 4000;
+    vector<rational> results;
+    results.resize(num_threads);
+    stopwatch sw;
+    sw.start();
+    // every thread performs the same work, so results must agree
+    vector<std::thread> threads;
+    for (unsigned t = 0; t < num_threads; ++t)
+        threads.push_back(std::thread([&, t]() { mt_work(1, 1, n, results[t]); }));
+    for (auto & th : threads)
+        th.join();
+    sw.stop();
+    rational expected;
+    mt_work(1, 1, n, expected);
+    for (rational const& r : results)
+        ENSURE(r == expected);
+    std::cout << "rational arithmetic with " << num_threads << " threads: " << sw.get_seconds() << "s\n";
+}
 
 void tst_rational() {
     TRACE("rational", tout << "starting rational test...\n";);
@@ -475,6 +509,8 @@ void tst_rational() {
     std::cout << "running rational_tester::tst1" << std::endl;
     rational_tester::tst1();
     rational_tester::tst2();
+    tst12(1);
+    tst12(4);
     tst11(true);
     tst10(true);
     tst10(false);
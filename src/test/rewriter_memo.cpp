@@ -0,0 +1,151 @@
+/*++
+Copyright (c) 2020 Microsoft Corporation
+
+Module Name:
+
+    rewriter_memo.cpp
+
+Abstract:
+
+    Test the rewriting results shared by th_rewriter instances.
+
+--*/
+#include "ast/rewriter/th_rewriter.h"
+#include "ast/rewriter/rewriter_memo.h"
+#include "ast/arith_decl_plugin.h"
+#include "ast/reg_decl_plugins.h"
+#include "ast/expr_substitution.h"
+
+// (and (<= (+ x_i 0 (* 1 x_i)) (+ x_i x_i)) ...) with the sums shared by the atoms.
+static expr_ref mk_formula(ast_manager & m, unsigned n, char const * prefix) {
+    arith_util a(m);
+    expr_ref_vector conjs(m);
+    expr_ref zero(a.mk_int(0), m), one(a.mk_int(1), m);
+    for (unsigned i = 0; i < n; ++i) {
+        std::string name = std::string(prefix) + std::to_string(i);
+        expr_ref x(m.mk_const(symbol(name.c_str()), a.mk_int()), m);
+        expr_ref s(a.mk_add(x, zero, a.mk_mul(one, x)), m);
+        conjs.push_back(a.mk_le(s, a.mk_add(x, x)));
+        conjs.push_back(a.mk_ge(s, zero));
+    }
+    return expr_ref(m.mk_and(conjs.size(), conjs.c_ptr()), m);
+}
+
+static params_ref mk_memo_params(unsigned size = 1 << 20) {
+    params_ref p;
+    p.set_bool("memo", true);
+    p.set_uint("memo_size", size);
+    return p;
+}
+
+static expr_ref rewrite(ast_manager & m, params_ref const & p, expr * e) {
+    th_rewriter rw(m, p);
+    expr_ref r(m);
+    rw(e, r);
+    return r;
+}
+
+// results are shared between rewriters with the same parameters.
+static void tst_sharing() {
+    ast_manager m;
+    reg_decl_plugins(m);
+    expr_ref f = mk_formula(m, 10, "x");
+    expr_ref expected = rewrite(m, params_ref(), f);
+    ENSURE(!rewriter_memo::find(m));
+
+    params_ref p = mk_memo_params();
+    ENSURE(rewrite(m, p, f) == expected);
+    rewriter_memo & memo = rewriter_memo::get(m);
+    ENSURE(memo.size() > 0);
+    unsigned hits = memo.hits();
+
+    // the root is found by a fresh rewriter.
+    ENSURE(rewrite(m, p, f) == expected);
+    ENSURE(memo.hits() == hits + 1);
+
+    // shared subterms are found in a different formula.
+    arith_util a(m);
+    expr_ref g(m.mk_not(to_app(f)->get_arg(0)), m);
+    hits = memo.hits();
+    th_rewriter rw(m, p);
+    expr_ref r(m);
+    rw(g, r);
+    ENSURE(memo.hits() > hits);
+    ENSURE(r == rewrite(m, params_ref(), g));
+
+    // rewriters with other parameters do not use the results.
+    params_ref q = mk_memo_params();
+    q.set_bool("flat", false);
+    hits = memo.hits();
+    ENSURE(rewrite(m, q, f) == rewrite(m, params_ref(), f));
+    ENSURE(memo.hits() == hits);
+
+    statistics st;
+    rw.collect_statistics(st);
+    ENSURE(st.size() == 4);
+}
+
+// a small memo evicts the old generation but keeps producing the same results.
+static void tst_eviction() {
+    ast_manager m;
+    reg_decl_plugins(m);
+    params_ref p = mk_memo_params(8);
+    for (unsigned k = 0; k < 3; ++k) {
+        for (unsigned i = 0; i < 20; ++i) {
+            std::string prefix = "y" + std::to_string(i) + "_";
+            expr_ref f = mk_formula(m, 3, prefix.c_str());
+            ENSURE(rewrite(m, p, f) == rewrite(m, params_ref(), f));
+        }
+    }
+    rewriter_memo & memo = rewriter_memo::get(m);
+    ENSURE(memo.evictions() > 0);
+    ENSURE(memo.size() <= 2 * memo.capacity());
+
+    // recently used results survive the eviction of the old generation.
+    expr_ref f = mk_formula(m, 1, "z");
+    ENSURE(rewrite(m, p, f) == rewrite(m, params_ref(), f));
+    unsigned hits = memo.hits();
+    ENSURE(rewrite(m, p, f) == rewrite(m, params_ref(), f));
+    ENSURE(memo.hits() == hits + 1);
+
+    memo.reset();
+    ENSURE(memo.size() == 0);
+}
+
+// results that depend on substitutions or bindings are not shared.
+static void tst_context() {
+    ast_manager m;
+    reg_decl_plugins(m);
+    arith_util a(m);
+    params_ref p = mk_memo_params();
+    expr_ref x(m.mk_const(symbol("x"), a.mk_int()), m);
+    expr_ref y(m.mk_const(symbol("y"), a.mk_int()), m);
+    expr_ref one(a.mk_int(1), m);
+    expr_ref t(a.mk_add(x, a.mk_mul(one, y)), m);
+
+    expr_substitution sub(m);
+    sub.insert(y, a.mk_int(2));
+    th_rewriter rw(m, p);
+    rw.set_substitution(&sub);
+    expr_ref r(m);
+    rw(t, r);
+    ENSURE(r == rewrite(m, params_ref(), a.mk_add(x, a.mk_int(2))));
+    ENSURE(rewriter_memo::get(m).size() == 0);
+    // without the substitution, the result is not the substituted one.
+    ENSURE(rewrite(m, p, t) == rewrite(m, params_ref(), t));
+
+    expr_ref v(m.mk_var(0, a.mk_int()), m);
+    expr_ref s(a.mk_add(v, a.mk_mul(one, y)), m);
+    expr * b = x.get();
+    th_rewriter rw2(m, p);
+    r = rw2(s, 1, &b);
+    ENSURE(r == rewrite(m, params_ref(), t));
+    th_rewriter rw3(m, params_ref());
+    ENSURE(rw2(s, 1, &b) == rw3(s, 1, &b));
+}
+
+void tst_rewriter_memo() {
+    tst_sharing();
+    tst_eviction();
+    tst_context();
+}
@@ -0,0 +1,110 @@
+/*++
+Copyright (c) 2020 Microsoft Corporation
+
+Module Name:
+
+    seq_bounded.cpp
+
+Abstract:
+
+    Test the bounded string solver (smt.string_solver=bounded).
+
+--*/
+
+#include "api/z3.h"
+#include "util/util.h"
+#include <iostream>
+#include <string>
+
+// models are validated against the original assertions, this covers
+// the characters that are filled in by the model construction.
+static std::string eval(char const * fml, char const * cmds) {
+    std::string script = std::string(
+        "(set-option :model_validate true)\n"
+        "(set-option :smt.string_solver bounded)\n"
+        "(push)(declare-const x String)(declare-const y String)\n") + fml + cmds;
+    Z3_context ctx = Z3_mk_context(nullptr);
+    std::string r = Z3_eval_smtlib2_string(ctx, script.c_str());
+    Z3_del_context(ctx);
+    return r;
+}
+
+static void check(char const * fml, char const * expected) {
+    std::string r = eval(fml, "(check-sat)");
+    if (r != std::string(expected) + "\n")
+        std::cout << fml << "\nexpected: " << expected << " got: " << r;
+    ENSURE(r == std::string(expected) + "\n");
+}
+
+static void check_value(char const * fml, char const * term, char const * value) {
+    std::string r = eval(fml, (std::string("(check-sat)(get-value (") + term + "))").c_str());
+    std::string expected = std::string("sat\n((") + term + " " + value + "))\n";
+    if (r != expected)
+        std::cout << fml << "\nexpected: " << expected << "got: " << r;
+    ENSURE(r == expected);
+}
+
+static void tst_concat() {
+    check_value("(assert (= (str.++ x y) \"abc\"))(assert (= (str.len x) 1))", "y", "\"bc\"");
+    check("(assert (= (str.++ x \"b\") (str.++ \"a\" y)))(assert (= (str.len x) 2))", "sat");
+    check("(assert (= (str.++ x y) \"abc\"))(assert (= (str.len y) 4))", "unsat");
+    check("(assert (= (str.++ x \"b\") (str.++ \"a\" x)))(assert (<= (str.len x) 3))", "unsat");
+}
+
+static void tst_prefix_suffix() {
+    check_value("(assert (str.prefixof \"ab\" x))(assert (str.suffixof \"bc\" x))(assert (= (str.len x) 3))", "x", "\"abc\"");
+    check("(assert (str.prefixof \"ab\" x))(assert (str.prefixof \"b\" x))", "unsat");
+    check("(assert (str.suffixof \"ab\" x))(assert (str.suffixof \"a\" x))", "unsat");
+    check("(assert (str.prefixof x \"abc\"))(assert (not (str.prefixof x \"abd\")))(assert (<= 2 (str.len x)))", "sat");
+    check("(assert (not (str.prefixof x (str.++ x y))))", "unsat");
+    check("(assert (not (str.suffixof y (str.++ x y))))", "unsat");
+}
+
+static void tst_contains() {
+    check_value("(assert (str.contains x \"ab\"))(assert (str.prefixof \"b\" x))(assert (str.suffixof \"b\" x))"
+                "(assert (= (str.len x) 3))", "x", "\"bab\"");
+    check("(assert (str.contains x \"abc\"))(assert (<= (str.len x) 2))", "unsat");
+    check("(assert (str.contains x \"abc\"))(assert (not (str.contains x \"b\")))", "unsat");
+    check("(assert (str.contains x y))(assert (not (str.contains x \"\")))", "unsat");
+}
+
+static void tst_in_re() {
+    check_value("(assert (str.in_re x (re.+ (str.to_re \"ab\"))))(assert (= (str.len x) 4))", "x", "\"abab\"");
+    check("(assert (str.in_re x (re.* (str.to_re \"ab\"))))(assert (= (str.len x) 3))", "unsat");
+    check("(assert (str.in_re x (re.* (re.range \"a\" \"c\"))))(assert (str.contains x \"d\"))", "unsat");
+    check("(assert (str.in_re x (re.++ (re.* re.allchar) (str.to_re \"b\"))))(assert (not (str.suffixof \"b\" x)))", "unsat");
+}
+
+// the initial bound of 4 is doubled until the constraints fit
+static void tst_research() {
+    std::string r = eval("(assert (str.in_re x (re.+ (str.to_re \"ab\"))))(assert (= (str.len x) 10))",
+                         "(check-sat)(get-value (x))(get-info :all-statistics)");
+    ENSURE(r.find("sat\n((x \"ababababab\"))\n") == 0);
+    size_t i = r.find(":seq-bounded-researches");
+    ENSURE(i != std::string::npos);
+    ENSURE(r.substr(i, 26) == ":seq-bounded-researches 2 " || r.substr(i, 26) == ":seq-bounded-researches 2\n");
+    r = eval("(assert (= (str.len x) 9))", "(check-sat)(get-info :all-statistics)");
+    ENSURE(r.find("sat\n") == 0);
+    ENSURE(r.find(":seq-bounded-length 16") != std::string::npos);
+    // the answer does not depend on the bound and no research is needed
+    r = eval("(assert (= (str.++ x \"a\") \"b\"))", "(check-sat)(get-info :all-statistics)");
+    ENSURE(r.find("unsat\n") == 0);
+    ENSURE(r.find(":seq-bounded-researches") == std::string::npos);
+}
+
+// elements that are not constrained are filled with 'a'
+static void tst_model_fill() {
+    check_value("(assert (= (str.len x) 3))", "x", "\"aaa\"");
+    check_value("(assert (= (str.len x) 3))(assert (str.suffixof \"b\" x))", "x", "\"aab\"");
+    check("(assert (= (str.len x) 3))(assert (not (str.contains x \"a\")))", "sat");
+    check("(assert (= (str.len x) 3))(assert (distinct x \"aaa\" \"aab\" \"aba\"))(assert (str.prefixof \"a\" x))", "sat");
+}
+
+void tst_seq_bounded() {
+    tst_concat();
+    tst_prefix_suffix();
+    tst_contains();
+    tst_in_re();
+    tst_research();
+    tst_model_fill();
+}
@@ -0,0 +1,88 @@
+/*++
+Copyright (c) 2020 Microsoft Corporation
+
+Module Name:
+
+    seq_length.cpp
+
+Abstract:
+
+    Test pruning of branches on sequence equations by length bounds
+    (smt.seq.length_abstraction).
+
+--*/
+
+#include "api/z3.h"
+#include "util/util.h"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+// the formulas are checked after a push, so that the incremental SMT core solves them.
+static std::string eval(bool abstraction, char const * fml, char const * cmds) {
+    std::string script = std::string("(set-option :model_validate true)(set-option :smt.seq.length_abstraction ") +
+        (abstraction ? "true" : "false") + ")\n"
+        "(push)(declare-const x String)(declare-const y String)(declare-const z String)\n"
+        "(declare-const u String)(declare-const v String)(declare-const w String)\n" + fml + cmds;
+    Z3_context ctx = Z3_mk_context(nullptr);
+    std::string r = Z3_eval_smtlib2_string(ctx, script.c_str());
+    Z3_del_context(ctx);
+    return r;
+}
+
+static unsigned get_stat(std::string const & r, char const * name) {
+    size_t i = r.find(name);
+    if (i == std::string::npos)
+        return 0;
+    return static_cast<unsigned>(atoi(r.c_str() + i + strlen(name)));
+}
+
+// check the result with and without the abstraction, and that branches were pruned.
+static void check(char const * fml, char const * expected) {
+    std::string exp = std::string(expected) + "\n";
+    std::string r = eval(false, fml, "(check-sat)");
+    if (r != exp)
+        std::cout << fml << "\nexpected: " << expected << " got: " << r;
+    ENSURE(r == exp);
+    r = eval(true, fml, "(check-sat)(get-info :all-statistics)");
+    if (r.compare(0, exp.size(), exp) != 0 || get_stat(r, ":seq-length-pruned ") == 0)
+        std::cout << fml << "\nlength abstraction, expected: " << expected << " got: " << r;
+    ENSURE(r.compare(0, exp.size(), exp) == 0);
+    ENSURE(get_stat(r, ":seq-length-abstraction ") > 0);
+    ENSURE(get_stat(r, ":seq-length-pruned ") > 0);
+}
+
+static void tst_prune_empty() {
+    // x cannot be empty, and the prefixes u and u ++ v of the right side are too short for x,
+    // so "ab" lies in w
+    check("(assert (= (str.++ x \"ab\" y) (str.++ u v w)))"
+          "(assert (<= 5 (str.len x)))(assert (<= (str.len u) 2))(assert (<= (str.len v) 1))", "sat");
+    check("(assert (= (str.++ x \"ab\" y) (str.++ u v w)))"
+          "(assert (<= 5 (str.len x)))(assert (<= (str.len u) 2))(assert (<= (str.len v) 1))"
+          "(assert (not (str.contains w \"a\")))", "unsat");
+}
+
+static void tst_prune_prefix() {
+    // the characters at the position |x| = |u| differ
+    check("(assert (= (str.++ x \"a\" y) (str.++ u \"b\" w)))"
+          "(assert (= (str.len x) 3))(assert (= (str.len u) 3))", "unsat");
+    // u ++ "b" is a prefix of x
+    check("(assert (= (str.++ x \"a\" y) (str.++ u \"b\" w)))"
+          "(assert (= (str.len x) 3))(assert (= (str.len u) 1))", "sat");
+    check("(assert (= (str.++ x \"a\" y) (str.++ u \"b\" w)))"
+          "(assert (= (str.len x) 3))(assert (= (str.len u) 1))(assert (not (str.contains x \"b\")))", "unsat");
+    // only the prefix u ++ v has a length between the bounds of x
+    check("(assert (= (str.++ x \"c\" y) (str.++ u v \"c\" w)))"
+          "(assert (<= 2 (str.len x)))(assert (<= (str.len x) 3))(assert (= (str.len u) 1))(assert (= (str.len v) 2))"
+          "(assert (not (str.contains w \"c\")))(assert (not (str.contains u \"c\")))(assert (not (str.contains v \"c\")))", "sat");
+    check("(assert (= (str.++ x \"c\" y) (str.++ u v \"c\" w)))"
+          "(assert (<= 2 (str.len x)))(assert (<= (str.len x) 3))(assert (= (str.len u) 1))(assert (= (str.len v) 2))"
+          "(assert (not (str.contains w \"c\")))(assert (not (str.contains u \"c\")))(assert (not (str.contains v \"c\")))"
+          "(assert (not (= x (str.++ u v))))", "unsat");
+}
+
+void tst_seq_length() {
+    tst_prune_empty();
+    tst_prune_prefix();
+}
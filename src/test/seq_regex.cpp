@@ -0,0 +1,147 @@
+/*++
+Copyright (c) 2020 Microsoft Corporation
+
+Module Name:
+
+    seq_regex.cpp
+
+Abstract:
+
+    Regular expression membership constraints.
+
+    Each sample is asserted once and solved repeatedly under push/pop,
+    so that derivatives computed in one check are reused by the next.
+    The built-in samples are checked against their expected results,
+    with and without the derivative cache. SMT-LIB2 files given on the 
+    command line are benchmarked instead:
+
+    test-z3 seq_regex file1.smt2 file2.smt2 ...
+
+--*/
+
+#include "api/z3.h"
+#include "util/stopwatch.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+struct regex_sample {
+    char const* m_fml;
+    char const* m_expected;
+};
+
+static regex_sample s_samples[] = {
+    // e-mail like addresses
+    { "(declare-const s String)\n"
+    "(define-fun w () RegLan (re.+ (re.union (re.range \"a\" \"z\") (re.range \"0\" \"9\") (str.to_re \"_\"))))\n"
+    "(assert (str.in_re s (re.++ w (re.* (re.++ (str.to_re \".\") w)) (str.to_re \"@\") w (re.+ (re.++ (str.to_re \".\") w)))))\n"
+    "(assert (str.in_re s (re.++ re.all (str.to_re \".org\"))))\n"
+    "(assert (>= (str.len s) 12))\n", "sat" },
+
+    // dates that are not in the range of the first regex
+    { "(declare-const s String)\n"
+    "(define-fun d () RegLan (re.range \"0\" \"9\"))\n"
+    "(assert (str.in_re s (re.++ d d d d (str.to_re \"-\") d d (str.to_re \"-\") d d)))\n"
+    "(assert (not (str.in_re s (re.++ (str.to_re \"20\") d d (str.to_re \"-\") (re.union (str.to_re \"0\") (str.to_re \"1\")) d re.all))))\n"
+    "(assert (str.prefixof \"19\" s))\n", "sat" },
+
+    // intersection of length and character class constraints
+    { "(declare-const s String)\n"
+    "(declare-const t String)\n"
+    "(assert (str.in_re s (re.+ (re.union (re.range \"a\" \"f\") (re.range \"0\" \"9\")))))\n"
+    "(assert (str.in_re s (re.++ ((_ re.loop 4 8) (re.range \"a\" \"c\")) ((_ re.loop 2 4) (re.range \"0\" \"3\")))))\n"
+    "(assert (= t (str.++ s \"x\" s)))\n"
+    "(assert (str.in_re t (re.++ re.all (str.to_re \"c1x\") re.all)))\n", "unsat" },
+
+    // the same with a single digit at the end of the second regex
+    { "(declare-const s String)\n"
+    "(declare-const t String)\n"
+    "(assert (str.in_re s (re.+ (re.union (re.range \"a\" \"f\") (re.range \"0\" \"9\")))))\n"
+    "(assert (str.in_re s (re.++ ((_ re.loop 4 8) (re.range \"a\" \"c\")) ((_ re.loop 1 4) (re.range \"0\" \"3\")))))\n"
+    "(assert (= t (str.++ s \"x\" s)))\n"
+    "(assert (str.in_re t (re.++ re.all (str.to_re \"c1x\") re.all)))\n", "sat" },
+
+    // (ab)+ and (aba)* have no common non-empty word
+    { "(declare-const s String)\n"
+    "(assert (str.in_re s (re.+ (str.to_re \"ab\"))))\n"
+    "(assert (str.in_re s (re.* (str.to_re \"aba\"))))\n", "unsat" },
+
+    // equal and different regular expressions
+    { "(declare-const s String)\n"
+    "(assert (not (= (re.* (str.to_re \"a\")) (re.* (re.* (str.to_re \"a\"))))))\n", "unsat" },
+    { "(declare-const s String)\n"
+    "(assert (not (= (re.* (str.to_re \"a\")) (re.+ (str.to_re \"a\")))))\n", "sat" },
+};
+
+static void bench_sample(char const* name, std::string const& sample, unsigned rounds) {
+    Z3_context ctx = Z3_mk_context(nullptr);
+    Z3_eval_smtlib2_string(ctx, sample.c_str());
+    stopwatch sw;
+    sw.start();
+    std::string result;
+    for (unsigned i = 0; i < rounds; ++i)
+        result = Z3_eval_smtlib2_string(ctx, "(push)(check-sat)(pop)");
+    sw.stop();
+    std::cout << name << " " << result.substr(0, result.find('\n'))
+              << " rounds: " << rounds << " time: " << sw.get_seconds() << "s\n";
+    std::string st = Z3_eval_smtlib2_string(ctx, "(get-info :all-statistics)");
+    std::istringstream in(st);
+    std::string line;
+    while (std::getline(in, line))
+        if (line.find("regex") != std::string::npos)
+            std::cout << line << "\n";
+    Z3_del_context(ctx);
+}
+
+static std::string check_sample(regex_sample const& sample, bool use_derivatives, bool cache) {
+    Z3_context ctx = Z3_mk_context(nullptr);
+    std::string options = std::string("(set-option :model_validate true)")
+        + "(set-option :smt.seq.use_derivatives " + (use_derivatives ? "true" : "false") + ")"
+        + "(set-option :smt.seq.regex_cache " + (cache ? "true" : "false") + ")\n";
+    Z3_eval_smtlib2_string(ctx, (options + sample.m_fml).c_str());
+    std::string expected = std::string(sample.m_expected) + "\n";
+    for (unsigned i = 0; i < 3; ++i) {
+        std::string result = Z3_eval_smtlib2_string(ctx, "(push)(check-sat)(pop)");
+        if (result != expected)
+            std::cout << sample.m_fml << "derivatives: " << use_derivatives << " cache: " << cache
+                      << " expected: " << expected << "got: " << result;
+        ENSURE(result == expected);
+    }
+    std::string st = Z3_eval_smtlib2_string(ctx, "(get-info :all-statistics)");
+    Z3_del_context(ctx);
+    return st;
+}
+
+void tst_seq_regex(char ** argv, int argc, int& i) {
+    unsigned rounds = 5;
+    if (i + 1 < argc) {
+        for (++i; i < argc; ++i) {
+            std::ifstream in(argv[i]);
+            if (in.bad() || in.fail()) {
+                std::cerr << "(error \"failed to open file '" << argv[i] << "'\")" << std::endl;
+                continue;
+            }
+            std::stringstream buffer;
+            buffer << in.rdbuf();
+            // commands after the assertions are issued by the benchmark
+            std::string text = buffer.str();
+            size_t pos = text.find("(check-sat)");
+            if (pos != std::string::npos)
+                text = text.substr(0, pos);
+            bench_sample(argv[i], text, rounds);
+        }
+        return;
+    }
+    bool has_hits = false;
+    for (auto const& sample : s_samples) {
+        for (bool use_derivatives : { false, true }) {
+            check_sample(sample, use_derivatives, false);
+            std::string st = check_sample(sample, use_derivatives, true);
+            has_hits |= st.find(":seq-regex-derivative-hits") != std::string::npos;
+        }
+    }
+    // derivatives are reused across unfoldings and check-sat calls
+    ENSURE(has_hits);
+}
@@ -17,8 +17,12 @@ Revision History:
 
 --*/
 #include<iostream>
+#include<thread>
 #include "util/symbol.h"
 #include "util/debug.h"
+#include "util/hash.h"
+#include "util/vector.h"
+#include "util/util.h"
 
 static void tst1() {
     symbol s1("foo");
@@ -51,8 +55,35 @@ static void tst1() {
     ENSURE(lt(symbol("zzz"), symbol("zzzb")));
 }
 
+// threads intern overlapping sets of names concurrently.
+static void tst2(unsigned num_threads) {
+    unsigned const n = 20000;
+    vector<vector<symbol>> syms(num_threads);
+    vector<std::thread> threads;
+    for (unsigned t = 0; t < num_threads; ++t)
+        threads.push_back(std::thread([&, t]() {
+            for (unsigned i = 0; i < n; ++i) {
+                std::string name = "tst_symbol_" + std::to_string((i * (t + 1)) % n);
+                syms[t].push_back(symbol(name.c_str()));
+            }
+        }));
+    for (auto& th : threads)
+        th.join();
+    for (unsigned t = 0; t < num_threads; ++t) {
+        for (unsigned i = 0; i < n; ++i) {
+            std::string name = "tst_symbol_" + std::to_string((i * (t + 1)) % n);
+            symbol s(name.c_str());
+            ENSURE(syms[t][i] == s);
+            ENSURE(s.str() == name);
+            ENSURE(s.hash() == string_hash(name.c_str(), static_cast<unsigned>(name.size()), 17));
+        }
+    }
+}
+
 void tst_symbol() {
     tst1();
+    tst2(1);
+    tst2(4);
 }
 
 
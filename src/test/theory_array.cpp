@@ -0,0 +1,117 @@
+/*++
+Copyright (c) 2020 Microsoft Corporation
+
+Module Name:
+
+    theory_array.cpp
+
+Abstract:
+
+    Test that parent selects that are skipped because they are congruent
+    to an existing select of the same array give sound results across
+    push and pop.
+
+--*/
+
+#include "api/z3.h"
+#include "util/util.h"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+static char const * s_decls =
+    "(declare-const a (Array Int Int))(declare-const b (Array Int Int))(declare-const c (Array Int Int))\n"
+    "(declare-const i Int)(declare-const j Int)(declare-const k Int)(declare-const p Bool)\n";
+
+// the formulas are checked after a push, so that the incremental SMT core solves them.
+static std::string eval(std::string const & cmds) {
+    std::string script = std::string("(set-option :model_validate true)\n") + s_decls + "(push)" + cmds;
+    Z3_context ctx = Z3_mk_context(nullptr);
+    std::string r = Z3_eval_smtlib2_string(ctx, script.c_str());
+    Z3_del_context(ctx);
+    return r;
+}
+
+static unsigned get_stat(std::string const & r, char const * name) {
+    size_t i = r.find(name);
+    if (i == std::string::npos)
+        return 0;
+    return static_cast<unsigned>(atoi(r.c_str() + i + strlen(name)));
+}
+
+// the selects are internalized outside of the scopes, so they remain
+// parent selects after the scope where their indices are equal is popped.
+static void tst_push_pop() {
+    std::string r = eval(
+        "(assert (or p (= (select a i) 1) (= (select a j) 2) (= (select a k) 3)))\n"
+        "(assert (= a (store b k 0)))\n"
+        "(push)(assert (= i j))(assert (not (= (select a i) (select a j))))(check-sat)(pop)\n"
+        "(push)(assert (= i j))(assert (not (= (select a j) (select b j))))(assert (not (= i k)))(check-sat)(pop)\n"
+        "(push)(assert (not (= i j)))(assert (not (= j k)))(assert (not (= (select a j) (select b j))))(check-sat)(pop)\n"
+        "(push)(assert (= i j))(assert (= j k))(assert (not (= (select a i) 0)))(check-sat)(pop)\n"
+        "(push)(assert (= i j))(assert (not (= j k)))(assert (= (select a i) 5))(assert (not (= (select b j) 5)))(check-sat)(pop)\n"
+        "(push)(assert (not (= i j)))(assert (= (select a i) 1))(assert (= (select a j) 2))(check-sat)(pop)\n"
+        "(get-info :all-statistics)");
+    std::string expected = "unsat\nunsat\nunsat\nunsat\nunsat\nsat\n";
+    if (r.compare(0, expected.size(), expected) != 0)
+        std::cout << "expected: " << expected << "got: " << r << "\n";
+    ENSURE(r.compare(0, expected.size(), expected) == 0);
+    ENSURE(get_stat(r, ":array-select-dups ") > 0);
+}
+
+static std::string mk_index(random_gen & r) {
+    char const * idx[] = { "i", "j", "k", "0", "1" };
+    return idx[r(5)];
+}
+
+static std::string mk_array(random_gen & r, unsigned depth) {
+    char const * arrays[] = { "a", "b", "c" };
+    if (depth == 0 || r(2) == 0)
+        return arrays[r(3)];
+    return "(store " + mk_array(r, depth - 1) + " " + mk_index(r) + " " + std::to_string(r(3)) + ")";
+}
+
+static std::string mk_atom(random_gen & r) {
+    switch (r(4)) {
+    case 0: return "(= " + mk_index(r) + " " + mk_index(r) + ")";
+    case 1: return "(= " + mk_array(r, 2) + " " + mk_array(r, 2) + ")";
+    case 2: return "(= (select " + mk_array(r, 2) + " " + mk_index(r) + ") " + std::to_string(r(3)) + ")";
+    default: return "(= (select " + mk_array(r, 2) + " " + mk_index(r) + ") (select " + mk_array(r, 2) + " " + mk_index(r) + "))";
+    }
+}
+
+static std::string mk_literal(random_gen & r) {
+    std::string a = mk_atom(r);
+    return r(2) == 0 ? "(not " + a + ")" : a;
+}
+
+// each scope is checked in sequence after the previous scopes are popped,
+// and alone in a fresh context.
+static void tst_random() {
+    random_gen r(0);
+    for (unsigned k = 0; k < 60; ++k) {
+        std::string base;
+        for (unsigned i = 0; i < 2; ++i)
+            base += "(assert (or " + mk_literal(r) + " " + mk_literal(r) + " p))";
+        std::string seq = base;
+        std::string expected;
+        for (unsigned s = 0; s < 4; ++s) {
+            std::string scope;
+            for (unsigned i = 0; i < 3; ++i)
+                scope += "(assert " + mk_literal(r) + ")";
+            scope += "(assert (not p))";
+            seq += "(push)" + scope + "(check-sat)(pop)\n";
+            expected += eval(base + scope + "(check-sat)");
+        }
+        std::string res = eval(seq);
+        if (res != expected)
+            std::cout << seq << "\nexpected: " << expected << "got: " << res << "\n";
+        ENSURE(res == expected);
+    }
+}
+
+void tst_theory_array() {
+    tst_push_pop();
+    tst_random();
+}
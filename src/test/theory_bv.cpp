@@ -0,0 +1,139 @@
+/*++
+Copyright (c) 2020 Microsoft Corporation
+
+Module Name:
+
+    theory_bv.cpp
+
+Abstract:
+
+    Test delayed bit-blasting of multipliers, dividers and remainders
+    (smt.bv.delay) against eager bit-blasting.
+
+--*/
+
+#include "api/z3.h"
+#include "util/util.h"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+// the formulas are checked after a push, so that the incremental SMT core solves them.
+static std::string eval(std::string const & script) {
+    Z3_context ctx = Z3_mk_context(nullptr);
+    std::string r = Z3_eval_smtlib2_string(ctx, script.c_str());
+    Z3_del_context(ctx);
+    return r;
+}
+
+static std::string delay_options(bool delay) {
+    return std::string("(set-option :model_validate true)(set-option :smt.bv.delay ") + (delay ? "true" : "false") + ")\n";
+}
+
+static unsigned get_stat(std::string const & r, char const * name) {
+    size_t i = r.find(name);
+    if (i == std::string::npos)
+        return 0;
+    return static_cast<unsigned>(atoi(r.c_str() + i + strlen(name)));
+}
+
+static char const * s_ops[] = { "bvmul", "bvudiv", "bvurem", "bvsdiv", "bvsrem", "bvsmod" };
+
+static std::string mk_term(random_gen & r, unsigned depth) {
+    if (depth == 0 || r(3) == 0) {
+        switch (r(4)) {
+        case 0: return "x";
+        case 1: return "y";
+        case 2: return "z";
+        default: {
+            std::string n = "#x";
+            n += "0123456789abcdef"[r(16)];
+            return n;
+        }
+        }
+    }
+    return std::string("(") + s_ops[r(6)] + " " + mk_term(r, depth - 1) + " " + mk_term(r, depth - 1) + ")";
+}
+
+static std::string mk_atom(random_gen & r) {
+    char const * preds[] = { "=", "bvult", "bvslt" };
+    std::string a = std::string("(") + preds[r(3)] + " " + mk_term(r, 2) + " " + mk_term(r, 2) + ")";
+    return r(2) == 0 ? "(not " + a + ")" : a;
+}
+
+// random formulas over 4-bit variables, with and without delay,
+// in the same push/pop sequence so that cached circuits are reused.
+static void tst_random() {
+    random_gen r(0);
+    for (unsigned k = 0; k < 40; ++k) {
+        std::string body = "(declare-const x (_ BitVec 4))(declare-const y (_ BitVec 4))(declare-const z (_ BitVec 4))\n";
+        std::string checks;
+        for (unsigned i = 0; i < 4; ++i) {
+            checks += "(push)";
+            for (unsigned j = 0; j < 3; ++j)
+                checks += "(assert " + mk_atom(r) + ")";
+            checks += "(check-sat)";
+            if (i % 2 == 1)
+                checks += "(pop)";
+        }
+        std::string script = "(push)" + body + checks;
+        std::string expected = eval(delay_options(false) + script);
+        std::string r_delay = eval(delay_options(true) + script);
+        if (expected != r_delay)
+            std::cout << script << "\nexpected: " << expected << "got: " << r_delay << "\n";
+        ENSURE(expected == r_delay);
+    }
+}
+
+static void check_value(char const * fml, char const * term, char const * value) {
+    std::string r = eval(delay_options(true) + "(push)(declare-const x (_ BitVec 8))(declare-const y (_ BitVec 8))" +
+                         fml + "(check-sat)(get-value (" + term + "))");
+    std::string expected = std::string("sat\n((") + term + " " + value + "))\n";
+    if (r != expected)
+        std::cout << fml << "\nexpected: " << expected << "got: " << r;
+    ENSURE(r == expected);
+}
+
+static void tst_models() {
+    // 3 is invertible modulo 256, so y is determined by x
+    check_value("(assert (= x #x03))(assert (= (bvmul x y) #x0f))", "y", "#x05");
+    check_value("(assert (= x #x64))(assert (= y #x07))", "(bvudiv x y)", "#x0e");
+    check_value("(assert (= x #x64))(assert (= y #x07))", "(bvurem x y)", "#x02");
+    check_value("(assert (= x #x9c))(assert (= y #x07))", "(bvsdiv x y)", "#xf2");
+    check_value("(assert (= x #x9c))(assert (= y #x07))", "(bvsrem x y)", "#xfe");
+    check_value("(assert (= x #x9c))(assert (= y #x07))", "(bvsmod x y)", "#x05");
+    // division by zero
+    check_value("(assert (= x #x64))(assert (= y #x00))", "(bvudiv x y)", "#xff");
+    check_value("(assert (= x #x64))(assert (= y #x00))", "(bvurem x y)", "#x64");
+    // the arguments are found from the value of a delayed term
+    check_value("(assert (= (bvmul x x) #x31))(assert (bvult x #x10))", "x", "#x07");
+    check_value("(assert (= (bvurem #x64 x) #x00))(assert (bvult #x1e x))(assert (bvult x #x40))", "x", "#x32");
+}
+
+// circuits of delayed terms are blasted in final check, and reused after backtracking.
+static void tst_push_pop() {
+    std::string script = delay_options(true) +
+        "(declare-const x (_ BitVec 16))(declare-const y (_ BitVec 16))\n"
+        "(push)(assert (bvult #x0001 x))(assert (bvult #x0001 y))(assert (bvult x #x0100))(assert (bvult y #x0100))\n"
+        "(push)(assert (= (bvmul x y) #x0d3b))(check-sat)(pop)\n"        // 3387 = 3 * 1129 has no such factorization
+        "(push)(assert (= (bvmul x y) #x0d3d))(check-sat)(pop)\n"        // 3389 is prime
+        "(push)(assert (= (bvmul x y) #x0d3c))(check-sat)(pop)\n"        // 3388 = 44 * 77
+        "(push)(assert (= (bvmul x y) #x0d3b))(check-sat)(pop)\n"
+        "(push)(assert (= (bvurem x y) #x00fe))(check-sat)(pop)\n"       // x = 254, y = 255
+        "(push)(assert (= (bvurem x y) #x00ff))(check-sat)(pop)\n"
+        "(get-info :all-statistics)";
+    std::string r = eval(script);
+    std::string expected = "unsat\nunsat\nsat\nunsat\nsat\nunsat\n";
+    if (r.compare(0, expected.size(), expected) != 0)
+        std::cout << script << "\nexpected: " << expected << "got: " << r << "\n";
+    ENSURE(r.compare(0, expected.size(), expected) == 0);
+    ENSURE(get_stat(r, ":bv-delayed ") > 0);
+    ENSURE(get_stat(r, ":bv-delayed-blasted ") > 0);
+}
+
+void tst_theory_bv() {
+    tst_models();
+    tst_push_pop();
+    tst_random();
+}
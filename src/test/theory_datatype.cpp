@@ -0,0 +1,114 @@
+/*++
+Copyright (c) 2020 Microsoft Corporation
+
+Module Name:
+
+    theory_datatype.cpp
+
+Abstract:
+
+    Test the incremental occurs check of the datatype theory on cyclic
+    and acyclic constraints, and the fallback to the full occurs check
+    for constructors with array arguments.
+
+--*/
+
+#include "api/z3.h"
+#include "util/util.h"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+static char const * s_decls =
+    "(declare-datatypes ((L 0)) (((nil) (cons (hd Int) (tl L)))))\n"
+    "(declare-datatypes ((T 0)) (((leaf) (node (left T) (right T)))))\n"
+    "(declare-datatypes ((A 0)) (((base) (mk (f (Array Int A))))))\n"
+    "(declare-const x L)(declare-const y L)(declare-const z L)(declare-const w L)\n"
+    "(declare-const s T)(declare-const t T)(declare-const u T)\n"
+    "(declare-const a A)(declare-const b A)(declare-const arr (Array Int A))\n";
+
+// the formulas are checked after a push, so that the incremental SMT core solves them.
+static std::string eval(std::string const & cmds) {
+    std::string script = std::string("(set-option :model_validate true)\n") + s_decls + cmds;
+    Z3_context ctx = Z3_mk_context(nullptr);
+    std::string r = Z3_eval_smtlib2_string(ctx, script.c_str());
+    Z3_del_context(ctx);
+    return r;
+}
+
+static unsigned get_stat(std::string const & r, char const * name) {
+    size_t i = r.find(name);
+    if (i == std::string::npos)
+        return 0;
+    return static_cast<unsigned>(atoi(r.c_str() + i + strlen(name)));
+}
+
+static char const * s_samples[][2] = {
+    { "(assert (= x (cons 1 y)))(assert (= y (cons 2 x)))", "unsat" },
+    { "(assert (= x (cons 1 y)))(assert (= y (cons 2 z)))", "sat" },
+    { "(assert (= x (cons 1 y)))(assert (= y (cons 2 z)))(assert (= z (cons 3 w)))(assert (= w x))", "unsat" },
+    { "(assert (= x (cons 1 y)))(assert (= y (cons 2 z)))(assert (= z (cons 3 w)))(assert (= w (tl x)))", "unsat" },
+    { "(assert (= x (cons 1 y)))(assert (= y (cons 2 z)))(assert (= z (cons 3 w)))(assert ((_ is cons) w))(assert (= (tl w) y))", "unsat" },
+    // the cycle depends on a case split
+    { "(assert (= x (cons 1 y)))(assert (or (= y x) (= y nil)))", "sat" },
+    { "(assert (= x (cons 1 y)))(assert (or (= y x) (= y nil)))(assert (not ((_ is nil) y)))", "unsat" },
+    { "(assert (= x (cons 1 y)))(assert (or (= y (cons 2 x)) (= y (cons 3 z))))(assert (not (= (hd y) 3)))", "unsat" },
+    // classes are merged in an order that contradicts the current topological order
+    { "(assert (= s (node t u)))(assert (= u (node leaf leaf)))(assert (= t (node u u)))", "sat" },
+    { "(assert (= s (node t u)))(assert (= u (node leaf t)))(assert (= t (node u leaf)))", "unsat" },
+    { "(assert (= s (node t t)))(assert (= t (node u u)))(assert ((_ is node) u))(assert (= (left u) (right s)))", "unsat" },
+    { "(assert (= s (node t t)))(assert (= t (node u u)))(assert (= (left u) (node leaf leaf)))", "sat" },
+    // edges through arrays use the full occurs check
+    { "(assert (= a (mk arr)))(assert (= (select arr 0) a))", "unsat" },
+    { "(assert (= a (mk arr)))(assert (= (select arr 0) b))(assert (= b base))", "sat" },
+    { "(assert (= a (mk arr)))(assert (= (select arr 0) b))(assert (= b (mk (store arr 1 base))))", "unsat" },
+};
+
+static void tst_samples() {
+    for (auto const & s : s_samples) {
+        std::string cmds;
+        std::string expected;
+        // rounds with the same scope check that the order is restored on pop
+        for (unsigned i = 0; i < 3; ++i) {
+            cmds += std::string("(push)") + s[0] + "(check-sat)(pop)\n";
+            expected += std::string(s[1]) + "\n";
+        }
+        std::string r = eval(cmds);
+        if (r != expected)
+            std::cout << s[0] << "\nexpected: " << expected << "got: " << r;
+        ENSURE(r == expected);
+    }
+}
+
+// after the scope of a constructor with an array argument is popped,
+// the incremental occurs check is used again.
+static void tst_full_restore() {
+    std::string r = eval(
+        "(push)(assert (= a (mk arr)))(assert (= (select arr 0) a))(check-sat)(get-info :all-statistics)(pop)\n"
+        "(push)(assert (= a (mk arr)))(assert (= (select arr 0) b))(check-sat)(get-info :all-statistics)(pop)\n");
+    ENSURE(r.find("unsat\n") == 0);
+    size_t i = r.find("\nsat\n");
+    ENSURE(i != std::string::npos);
+    unsigned after_cyclic = get_stat(r.substr(0, i), ":datatype-occurs-check ");
+    unsigned after_acyclic = get_stat(r.substr(i), ":datatype-occurs-check ");
+    ENSURE(after_cyclic > 0);
+    ENSURE(after_acyclic > after_cyclic);
+
+    r = eval(
+        "(push)(assert (= a (mk arr)))(assert (= (select arr 0) a))(check-sat)(get-info :all-statistics)(pop)\n"
+        "(push)(assert (= x (cons 1 y)))(assert (= y (cons 2 z)))(check-sat)(get-info :all-statistics)(pop)\n"
+        "(push)(assert (= x (cons 1 y)))(assert (= y (cons 2 x)))(check-sat)(get-info :all-statistics)(pop)\n");
+    ENSURE(r.find("unsat\n") == 0);
+    i = r.find("\nsat\n");
+    size_t j = r.find("\nunsat\n", i);
+    ENSURE(i != std::string::npos && j != std::string::npos);
+    after_cyclic = get_stat(r.substr(0, i), ":datatype-occurs-check ");
+    ENSURE(get_stat(r.substr(i, j - i), ":datatype-occurs-check ") == after_cyclic);
+    ENSURE(get_stat(r.substr(j), ":datatype-occurs-check ") == after_cyclic);
+}
+
+void tst_theory_datatype() {
+    tst_samples();
+    tst_full_restore();
+}
@@ -0,0 +1,171 @@
+/*++
+Copyright (c) 2020 Microsoft Corporation
+
+Module Name:
+
+    theory_fpa.cpp
+
+Abstract:
+
+    Test the abstraction of floating-point multiplication, division,
+    fused multiply-add, square root and remainder (smt.fp.lazy), and
+    their refinement against eager translation.
+
+--*/
+
+#include "api/z3.h"
+#include "util/util.h"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+// the formulas are checked after a push, so that the incremental SMT core solves them.
+// Equalities with constants are avoided, they are solved before the theory sees them.
+static std::string eval(bool lazy, std::string const & fml, char const * cmds) {
+    std::string script = std::string("(set-option :model_validate true)(set-option :smt.fp.lazy ") + (lazy ? "true" : "false") + ")\n"
+        "(define-sort F () (_ FloatingPoint 5 11))\n"
+        "(push)(declare-const x F)(declare-const y F)(declare-const z F)\n"
+        "(define-fun one () F ((_ to_fp 5 11) RNE 1.0))\n" + fml + cmds;
+    Z3_context ctx = Z3_mk_context(nullptr);
+    std::string r = Z3_eval_smtlib2_string(ctx, script.c_str());
+    Z3_del_context(ctx);
+    return r;
+}
+
+static unsigned get_stat(std::string const & r, char const * name) {
+    size_t i = r.find(name);
+    if (i == std::string::npos)
+        return 0;
+    return static_cast<unsigned>(atoi(r.c_str() + i + strlen(name)));
+}
+
+enum refinement { no_refine, refine, any_refine };
+
+// check the result with and without abstraction, and whether the
+// abstraction needed refinement.
+static void check(char const * fml, char const * expected, refinement ref) {
+    std::string r = eval(false, fml, "(check-sat)");
+    if (r != std::string(expected) + "\n")
+        std::cout << fml << "\nexpected: " << expected << " got: " << r;
+    ENSURE(r == std::string(expected) + "\n");
+    r = eval(true, fml, "(check-sat)(get-info :all-statistics)");
+    if (r.compare(0, strlen(expected) + 1, std::string(expected) + "\n") != 0)
+        std::cout << fml << "\nlazy, expected: " << expected << " got: " << r;
+    ENSURE(r.compare(0, strlen(expected) + 1, std::string(expected) + "\n") == 0);
+    ENSURE(get_stat(r, ":fpa-abstractions ") > 0);
+    unsigned num_refinements = get_stat(r, ":fpa-refinements ");
+    if ((ref == no_refine && num_refinements > 0) || (ref == refine && num_refinements == 0))
+        std::cout << fml << "\nrefinements: " << num_refinements << "\n";
+    ENSURE(ref != no_refine || num_refinements == 0);
+    ENSURE(ref != refine || num_refinements > 0);
+}
+
+#define NEG_ZERO(v) "(assert (fp.isZero " v "))(assert (fp.isNegative " v "))"
+#define POS_ZERO(v) "(assert (fp.isZero " v "))(assert (fp.isPositive " v "))"
+#define POS_INF(v)  "(assert (fp.isInfinite " v "))(assert (fp.isPositive " v "))"
+
+static void tst_mul() {
+    check("(assert (fp.isNaN x))(assert (not (fp.isNaN (fp.mul RNE x y))))", "unsat", no_refine);
+    check("(assert (fp.isInfinite x))(assert (fp.isZero y))(assert (not (fp.isNaN (fp.mul RNE x y))))", "unsat", no_refine);
+    check("(assert (fp.isInfinite x))(assert (fp.isNormal y))(assert (not (fp.isInfinite (fp.mul RTZ x y))))", "unsat", no_refine);
+    check(POS_ZERO("x") "(assert (fp.isNegative y))(assert (fp.isNormal y))(assert (not (fp.isNegative (fp.mul RNE x y))))", "unsat", no_refine);
+    check(POS_ZERO("x") "(assert (fp.isNegative y))(assert (fp.isNormal y))(assert (not (fp.isZero (fp.mul RTP x y))))", "unsat", no_refine);
+    // magnitude bounds
+    check("(assert (fp.leq (fp.abs x) one))(assert (fp.lt (fp.abs y) (fp.abs (fp.mul RTP x y))))", "unsat", no_refine);
+    check("(assert (fp.leq one (fp.abs x)))(assert (fp.isNormal x))(assert (fp.lt (fp.abs (fp.mul RTZ x y)) (fp.abs y)))", "unsat", no_refine);
+    // values
+    check("(assert (fp.eq x ((_ to_fp 5 11) RNE 3.0)))(assert (fp.eq y ((_ to_fp 5 11) RNE 5.0)))"
+          "(assert (not (fp.eq (fp.mul RNE x y) ((_ to_fp 5 11) RNE 15.0))))", "unsat", refine);
+    check("(assert (fp.eq (fp.mul RNE x y) ((_ to_fp 5 11) RNE 15.0)))(assert (fp.lt one x))(assert (fp.lt one y))", "sat", any_refine);
+    // 65504 is the largest value, the product overflows
+    check("(assert (fp.eq x ((_ to_fp 5 11) RNE 256.0)))(assert (fp.eq y ((_ to_fp 5 11) RNE 256.0)))"
+          "(assert (not (fp.isInfinite (fp.mul RNE x y))))", "unsat", refine);
+    check("(assert (fp.eq x ((_ to_fp 5 11) RNE 256.0)))(assert (fp.eq y ((_ to_fp 5 11) RNE 256.0)))"
+          "(assert (not (fp.isInfinite (fp.mul RTZ x y))))", "sat", any_refine);
+}
+
+static void tst_div() {
+    check("(assert (fp.isZero x))(assert (fp.isZero y))(assert (not (fp.isNaN (fp.div RNE x y))))", "unsat", no_refine);
+    check("(assert (fp.isInfinite x))(assert (fp.isInfinite y))(assert (not (fp.isNaN (fp.div RNE x y))))", "unsat", no_refine);
+    check("(assert (fp.isNormal x))(assert (fp.isZero y))(assert (not (fp.isInfinite (fp.div RNE x y))))", "unsat", no_refine);
+    check("(assert (fp.isNegative x))(assert (fp.isNormal x))" POS_INF("y") "(assert (not (fp.isZero (fp.div RNE x y))))", "unsat", no_refine);
+    check("(assert (fp.isNegative x))(assert (fp.isNormal x))" POS_INF("y") "(assert (not (fp.isNegative (fp.div RNE x y))))", "unsat", no_refine);
+    check(NEG_ZERO("y") "(assert (fp.isNormal x))(assert (fp.isPositive x))(assert (not (fp.isNegative (fp.div RNE x y))))", "unsat", no_refine);
+    // magnitude bounds
+    check("(assert (fp.leq one (fp.abs y)))(assert (fp.lt (fp.abs x) (fp.abs (fp.div RTP x y))))", "unsat", no_refine);
+    // values
+    check("(assert (fp.eq y ((_ to_fp 5 11) RNE 4.0)))(assert (fp.eq (fp.div RNE x y) ((_ to_fp 5 11) RNE 0.5)))"
+          "(assert (not (fp.eq x ((_ to_fp 5 11) RNE 2.0))))", "unsat", refine);
+    check("(assert (fp.eq x one))(assert (fp.eq y ((_ to_fp 5 11) RNE 3.0)))"
+          "(assert (fp.eq (fp.div RTP x y) (fp.div RTN x y)))", "unsat", refine);
+}
+
+static void tst_fma() {
+    check("(assert (fp.isInfinite x))(assert (fp.isZero y))(assert (not (fp.isNaN (fp.fma RNE x y z))))", "unsat", no_refine);
+    check("(assert (fp.isNaN z))(assert (not (fp.isNaN (fp.fma RNE x y z))))", "unsat", no_refine);
+    // -0 * +0 + +0 is +0, except when rounding towards negative
+    check(NEG_ZERO("x") POS_ZERO("y") POS_ZERO("z") "(assert (fp.isNegative (fp.fma RNE x y z)))", "unsat", refine);
+    check(NEG_ZERO("x") POS_ZERO("y") POS_ZERO("z") "(assert (fp.isNegative (fp.fma RTN x y z)))", "sat", any_refine);
+    // +oo * 1 + -oo is NaN
+    check(POS_INF("x") "(assert (fp.eq y one))(assert (fp.isInfinite z))(assert (fp.isNegative z))"
+          "(assert (not (fp.isNaN (fp.fma RNE x y z))))", "unsat", refine);
+    // the product is not rounded: 3 * 1365/4096 - 1 = -1/4096, while the rounded product is 1
+    check("(assert (fp.eq x ((_ to_fp 5 11) RNE 3.0)))(assert (fp.eq y ((_ to_fp 5 11) RNE 0.333251953125)))"
+          "(assert (not (fp.eq (fp.fma RNE x y (fp.neg one)) (fp.sub RNE (fp.mul RNE x y) one))))", "sat", any_refine);
+}
+
+static void tst_sqrt() {
+    check("(assert (fp.isNegative x))(assert (fp.isNormal x))(assert (not (fp.isNaN (fp.sqrt RNE x))))", "unsat", no_refine);
+    check(NEG_ZERO("x") "(assert (not (fp.isNegative (fp.sqrt RNE x))))", "unsat", no_refine);
+    check(NEG_ZERO("x") "(assert (not (fp.isZero (fp.sqrt RNE x))))", "unsat", no_refine);
+    check(POS_INF("x") "(assert (not (fp.isInfinite (fp.sqrt RTZ x))))", "unsat", no_refine);
+    check("(assert (fp.isNormal x))(assert (fp.isPositive x))(assert (fp.isNegative (fp.sqrt RNE x)))", "unsat", any_refine);
+    // sqrt(x) lies between x and 1
+    check("(assert (fp.leq one x))(assert (fp.lt x (fp.sqrt RTP x)))", "unsat", no_refine);
+    check("(assert (fp.isPositive x))(assert (fp.leq x one))(assert (fp.lt (fp.sqrt RTN x) x))", "unsat", no_refine);
+    // values
+    check("(assert (fp.eq x ((_ to_fp 5 11) RNE 9.0)))(assert (not (fp.eq (fp.sqrt RNE x) ((_ to_fp 5 11) RNE 3.0))))", "unsat", refine);
+    check("(assert (fp.eq x ((_ to_fp 5 11) RNE 2.0)))(assert (fp.eq (fp.sqrt RTP x) (fp.sqrt RTN x)))", "unsat", refine);
+    check("(assert (fp.eq (fp.sqrt RNE x) ((_ to_fp 5 11) RNE 3.0)))", "sat", any_refine);
+}
+
+static void tst_rem() {
+    check("(assert (fp.isInfinite x))(assert (not (fp.isNaN (fp.rem x y))))", "unsat", no_refine);
+    check("(assert (fp.isZero y))(assert (not (fp.isNaN (fp.rem x y))))", "unsat", no_refine);
+    check("(assert (fp.isNormal x))(assert (fp.isInfinite y))(assert (not (= (fp.rem x y) x)))", "unsat", no_refine);
+    check(NEG_ZERO("x") "(assert (fp.isNormal y))(assert (not (fp.isNegative (fp.rem x y))))", "unsat", refine);
+    // magnitude bound
+    check("(assert (not (fp.isNaN (fp.rem x y))))(assert (fp.lt (fp.abs y) (fp.abs (fp.rem x y))))", "unsat", no_refine);
+    // the remainder rounds the quotient to the nearest integer: 5 - 2 * 3 = -1
+    check("(assert (fp.eq x ((_ to_fp 5 11) RNE 5.0)))(assert (fp.eq y ((_ to_fp 5 11) RNE 3.0)))"
+          "(assert (not (fp.eq (fp.rem x y) (fp.neg one))))", "unsat", refine);
+}
+
+// refinements are undone on pop and redone in the next scope.
+static void tst_push_pop() {
+    std::string fml =
+        "(assert (fp.eq x ((_ to_fp 5 11) RNE 3.0)))(assert (fp.eq y ((_ to_fp 5 11) RNE 5.0)))\n"
+        "(push)(assert (not (fp.eq (fp.mul RNE x y) ((_ to_fp 5 11) RNE 15.0))))(check-sat)(pop)\n"
+        "(push)(assert (fp.eq (fp.mul RNE x y) ((_ to_fp 5 11) RNE 15.0)))(check-sat)(pop)\n"
+        "(push)(assert (not (fp.eq (fp.mul RNE x y) ((_ to_fp 5 11) RNE 15.0))))(check-sat)(pop)\n"
+        "(push)(assert (fp.isNaN (fp.div RNE x (fp.sub RNE y y))))(check-sat)(pop)\n"
+        "(push)(assert (fp.eq (fp.div RNE y (fp.sub RNE y x)) ((_ to_fp 5 11) RNE 2.5)))(check-sat)(pop)\n";
+    std::string expected = "unsat\nsat\nunsat\nunsat\nsat\n";
+    for (bool lazy : { false, true }) {
+        std::string r = eval(lazy, fml, "(get-info :all-statistics)");
+        if (r.compare(0, expected.size(), expected) != 0)
+            std::cout << fml << "\nexpected: " << expected << "got: " << r << "\n";
+        ENSURE(r.compare(0, expected.size(), expected) == 0);
+        ENSURE(!lazy || get_stat(r, ":fpa-refinements ") >= 2);
+    }
+}
+
+void tst_theory_fpa() {
+    tst_mul();
+    tst_div();
+    tst_fma();
+    tst_sqrt();
+    tst_rem();
+    tst_push_pop();
+}
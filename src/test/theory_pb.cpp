@@ -120,8 +120,108 @@ static void fuzz_pb()
     fuzzer.fuzz();
 }
 
+static unsigned get_stat(smt::context& ctx, char const* key) {
+    statistics st;
+    ctx.collect_statistics(st);
+    for (unsigned i = 0; i < st.size(); ++i) 
+        if (st.is_uint(i) && std::string(st.get_key(i)) == key) 
+            return st.get_uint_value(i);
+    return 0;
+}
+
+/**
+   Random inequalities over a few variables are checked against enumeration.
+   Each inequality also occurs scaled by 2^61 with an extra literal of coefficient 1, 
+   which has the same solutions but does not fit the 64-bit propagation.
+*/
+static void tst_ineq64(bool scaled) {
+    ast_manager m;
+    reg_decl_plugins(m);
+    pb_util pb(m);
+    random_gen rand(scaled ? 1 : 0);
+    unsigned const N = 8;
+    rational scale = scaled ? rational::power_of_two(61) : rational::one();
+    expr_ref_vector vars(m);
+    for (unsigned i = 0; i < N; ++i) 
+        vars.push_back(m.mk_const(symbol(i), m.mk_bool_sort()));
+    expr_ref y(m.mk_const(symbol("y"), m.mk_bool_sort()), m);
+    unsigned num_sat = 0, num_unsat = 0, num_resolves = 0;
+    for (unsigned round = 0; round < 100; ++round) {
+        smt_params params;
+        params.m_model = true;
+        smt::context ctx(m, params);
+        expr_ref_vector fmls(m);
+        // each constraint lists the coefficient of the positive literal of each variable
+        vector<svector<int>> coeffs;
+        svector<int> bounds;
+        unsigned num_ineqs = 2 + rand(6);
+        for (unsigned j = 0; j < num_ineqs; ++j) {
+            svector<int> cs;
+            int k = 0, sum = 0;
+            expr_ref_vector args(m);
+            vector<rational> rcoeffs;
+            for (unsigned i = 0; i < N; ++i) {
+                int c = 1 + rand(20);
+                sum += c;
+                if (rand(2) == 0) {
+                    // c * ~x = c - c * x
+                    args.push_back(m.mk_not(vars.get(i)));
+                    cs.push_back(-c);
+                    k -= c;
+                }
+                else {
+                    args.push_back(vars.get(i));
+                    cs.push_back(c);
+                }
+                rcoeffs.push_back(scale * rational(c));
+            }
+            int bound = 1 + rand(sum);
+            if (scaled) {
+                args.push_back(y);
+                rcoeffs.push_back(rational::one());
+            }
+            fmls.push_back(pb.mk_ge(args.size(), rcoeffs.c_ptr(), args.c_ptr(), scale * rational(bound)));
+            ctx.assert_expr(fmls.back());
+            coeffs.push_back(cs);
+            bounds.push_back(bound + k);
+        }
+        bool expected = false;
+        for (unsigned v = 0; !expected && v < (1u << N); ++v) {
+            bool ok = true;
+            for (unsigned j = 0; ok && j < coeffs.size(); ++j) {
+                int sum = 0;
+                for (unsigned i = 0; i < N; ++i) 
+                    if (v & (1u << i)) 
+                        sum += coeffs[j][i];
+                ok = sum >= bounds[j];
+            }
+            expected = ok;
+        }
+        lbool r = ctx.check();
+        ENSURE(r == (expected ? l_true : l_false));
+        if (r == l_true) {
+            ++num_sat;
+            model_ref mdl;
+            ctx.get_model(mdl);
+            ENSURE(mdl->is_true(fmls));
+        }
+        else {
+            ++num_unsat;
+        }
+        unsigned num_small = get_stat(ctx, "pb small predicates");
+        ENSURE(scaled ? num_small == 0 : num_small > 0);
+        num_resolves += get_stat(ctx, "pb resolves");
+    }
+    ENSURE(num_sat > 0 && num_unsat > 0);
+    // cutting planes analysis is only used for the 64-bit inequalities
+    ENSURE(scaled ? num_resolves == 0 : num_resolves > 0);
+}
+
 void tst_theory_pb() {
 
+    tst_ineq64(false);
+    tst_ineq64(true);
+
     fuzz_pb();
 
     ast_manager m;
@@ -0,0 +1,110 @@
+/*++
+Copyright (c) 2020 Microsoft Corporation
+
+Module Name:
+
+    theory_special_relations.cpp
+
+Abstract:
+
+    Test the transitive closure of partial orders: propagation of atoms
+    over the closure, conflicts on negated atoms, restoring the closure
+    on pop, and the fallback for relations with many variables.
+
+--*/
+
+#include "api/z3.h"
+#include "util/util.h"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+static char const * s_decls =
+    "(declare-sort U 0)(define-fun po ((x U) (y U)) Bool ((_ partial-order 0) x y))\n"
+    "(define-fun po1 ((x U) (y U)) Bool ((_ partial-order 1) x y))\n"
+    "(declare-const a U)(declare-const b U)(declare-const c U)(declare-const d U)(declare-const e U)\n"
+    "(declare-const p Bool)\n";
+
+// the formulas are checked after a push, so that the incremental SMT core solves them.
+static std::string eval(std::string const & cmds) {
+    std::string script = std::string("(set-option :model_validate true)\n") + s_decls + "(push)" + cmds;
+    Z3_context ctx = Z3_mk_context(nullptr);
+    std::string r = Z3_eval_smtlib2_string(ctx, script.c_str());
+    Z3_del_context(ctx);
+    return r;
+}
+
+static unsigned get_stat(std::string const & r, char const * name) {
+    size_t i = r.find(name);
+    if (i == std::string::npos)
+        return 0;
+    return static_cast<unsigned>(atoi(r.c_str() + i + strlen(name)));
+}
+
+static unsigned closure_stats(std::string const & r) {
+    return get_stat(r, ":sr-closure-propagations ") + get_stat(r, ":sr-closure-conflicts ");
+}
+
+static void check(std::string const & cmds, char const * expected, bool use_closure) {
+    std::string r = eval(cmds + "(check-sat)(get-info :all-statistics)");
+    std::string exp = std::string(expected) + "\n";
+    if (r.compare(0, exp.size(), exp) != 0 || (use_closure && closure_stats(r) == 0))
+        std::cout << cmds << "\nexpected: " << expected << " got: " << r;
+    ENSURE(r.compare(0, exp.size(), exp) == 0);
+    ENSURE(!use_closure || closure_stats(r) > 0);
+}
+
+static void tst_closure() {
+    // atoms over pairs in the closure are propagated
+    check("(assert (po a b))(assert (po b c))(assert (or p (not (po a c))))(assert (not p))", "unsat", true);
+    check("(assert (po a b))(assert (po b c))(assert (or p (po c a)))(assert (not p))", "sat", false);
+    // conflicts on negated atoms
+    check("(assert (not (po a d)))(assert (po a b))(assert (po b c))(assert (po c d))", "unsat", true);
+    check("(assert (po a b))(assert (po b c))(assert (po c d))(assert (not (po a d)))", "unsat", true);
+    // paths through equalities
+    check("(assert (po a b))(assert (= b c))(assert (po c d))(assert (not (po a d)))", "unsat", true);
+    check("(assert (po a b))(assert (po c d))(assert (not (po a d)))", "sat", false);
+}
+
+// the atoms are internalized outside of the scopes, so the closure
+// of each scope starts from the closure restored by the previous pop.
+static void tst_push_pop() {
+    std::string r = eval(
+        "(assert (or p (po a b) (po b c) (po a c) (po c d) (po a d)))\n"
+        "(push)(assert (po a b))(assert (po b c))(assert (not (po a c)))(check-sat)(pop)\n"
+        "(push)(assert (po a b))(assert (po b c))(assert (po c d))(check-sat)(pop)\n"
+        "(push)(assert (po b c))(assert (not (po a c)))(check-sat)(pop)\n"
+        "(push)(assert (po a b))(assert (not (po a c)))(assert (not (po a d)))(check-sat)(pop)\n"
+        "(push)(assert (po a b))(assert (po c d))(assert (not (po a d)))(check-sat)(pop)\n"
+        "(push)(assert (po a b))(assert (po b c))(assert (po c d))(assert (not (po a d)))(check-sat)(pop)\n");
+    std::string expected = "unsat\nsat\nsat\nsat\nsat\nunsat\n";
+    if (r != expected)
+        std::cout << "expected: " << expected << "got: " << r;
+    ENSURE(r == expected);
+}
+
+// a chain over n fresh constants of the relation rel.
+static std::string mk_chain(char const * rel, unsigned n) {
+    std::string r;
+    for (unsigned i = 0; i < n; ++i)
+        r += "(declare-const x" + std::to_string(i) + " U)";
+    for (unsigned i = 0; i + 1 < n; ++i)
+        r += std::string("(assert (") + rel + " x" + std::to_string(i) + " x" + std::to_string(i + 1) + "))";
+    return r + "\n";
+}
+
+static void tst_large() {
+    // the relation has more variables than the closure is kept for
+    check(mk_chain("po", 1100) + "(assert (not (po x0 x1099)))", "unsat", false);
+    check(mk_chain("po", 1100) + "(assert (not (po x1099 x0)))", "sat", false);
+    // the variables of another relation do not count against the closure of po,
+    // whose variables are numbered after those of the chain
+    check(mk_chain("po1", 1100) + "(assert (po a b))(assert (= b c))(assert (po c d))(assert (not (po a d)))", "unsat", true);
+}
+
+void tst_theory_special_relations() {
+    tst_closure();
+    tst_push_pop();
+    tst_large();
+}
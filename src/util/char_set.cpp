@@ -0,0 +1,217 @@
+/*++
+Copyright (c) 2020 Microsoft Corporation
+
+Module Name:
+
+    char_set.cpp
+
+Abstract:
+
+    Sets of characters represented as sorted ranges with a bitset for
+    the first 256 characters.
+
+--*/
+
+#include "util/char_set.h"
+#include "util/bit_util.h"
+#include "util/hash.h"
+
+void char_set::reset() {
+    m_ranges.reset();
+    for (uint64_t& w : m_small)
+        w = 0;
+}
+
+void char_set::set_small(unsigned lo, unsigned hi) {
+    if (lo >= num_small)
+        return;
+    if (hi >= num_small)
+        hi = num_small - 1;
+    for (unsigned w = lo / 64; w <= hi / 64; ++w) {
+        unsigned l = std::max(lo, 64 * w) - 64 * w;
+        unsigned h = std::min(hi, 64 * w + 63) - 64 * w;
+        uint64_t mask = (h == 63 ? ~0ull : ((1ull << (h + 1)) - 1)) & ~((1ull << l) - 1);
+        m_small[w] |= mask;
+    }
+}
+
+void char_set::init_small() {
+    for (uint64_t& w : m_small)
+        w = 0;
+    for (range const& r : m_ranges) {
+        if (r.m_lo >= num_small)
+            break;
+        set_small(r.m_lo, r.m_hi);
+    }
+}
+
+/**
+   \brief rebuild the ranges from the bitset, for sets whose characters are all small.
+*/
+void char_set::ranges_of_small() {
+    m_ranges.reset();
+    unsigned ch = 0;
+    while (ch < num_small) {
+        uint64_t w = m_small[ch / 64] >> (ch % 64);
+        if (w == 0) {
+            ch = 64 * (ch / 64 + 1);
+            continue;
+        }
+        unsigned lo_bits = static_cast<unsigned>(w);
+        ch += lo_bits != 0 ? ntz_core(lo_bits) : 32 + ntz_core(static_cast<unsigned>(w >> 32));
+        unsigned lo = ch;
+        while (ch < num_small && contains(ch))
+            ++ch;
+        m_ranges.push_back(range(lo, ch - 1));
+    }
+}
+
+bool char_set::contains_large(unsigned ch) const {
+    unsigned lo = 0, hi = m_ranges.size();
+    while (lo < hi) {
+        unsigned mid = lo + (hi - lo) / 2;
+        range const& r = m_ranges[mid];
+        if (ch < r.m_lo)
+            hi = mid;
+        else if (ch > r.m_hi)
+            lo = mid + 1;
+        else
+            return true;
+    }
+    return false;
+}
+
+void char_set::add(unsigned lo, unsigned hi) {
+    if (lo > hi)
+        return;
+    set_small(lo, hi);
+    svector<range> result;
+    unsigned i = 0, sz = m_ranges.size();
+    for (; i < sz && m_ranges[i].m_hi + 1 < lo; ++i)
+        result.push_back(m_ranges[i]);
+    for (; i < sz && m_ranges[i].m_lo <= hi + 1; ++i) {
+        lo = std::min(lo, m_ranges[i].m_lo);
+        hi = std::max(hi, m_ranges[i].m_hi);
+    }
+    result.push_back(range(lo, hi));
+    for (; i < sz; ++i)
+        result.push_back(m_ranges[i]);
+    m_ranges.swap(result);
+}
+
+void char_set::intersect(unsigned lo, unsigned hi) {
+    unsigned j = 0;
+    for (unsigned i = 0; i < m_ranges.size(); ++i) {
+        range const r = m_ranges[i];
+        if (hi < r.m_lo)
+            break;
+        if (r.m_hi >= lo)
+            m_ranges[j++] = range(std::max(r.m_lo, lo), std::min(r.m_hi, hi));
+    }
+    m_ranges.shrink(j);
+    init_small();
+}
+
+void char_set::remove(unsigned ch) {
+    if (!contains(ch))
+        return;
+    svector<range> result;
+    for (range const& r : m_ranges) {
+        if (ch < r.m_lo || ch > r.m_hi)
+            result.push_back(r);
+        else {
+            if (r.m_lo < ch)
+                result.push_back(range(r.m_lo, ch - 1));
+            if (ch < r.m_hi)
+                result.push_back(range(ch + 1, r.m_hi));
+        }
+    }
+    m_ranges.swap(result);
+    if (ch < num_small)
+        m_small[ch / 64] &= ~(1ull << (ch % 64));
+}
+
+char_set& char_set::operator&=(char_set const& other) {
+    if (is_small() || other.is_small()) {
+        for (unsigned i = 0; i < num_small / 64; ++i)
+            m_small[i] &= other.m_small[i];
+        ranges_of_small();
+        return *this;
+    }
+    svector<range> result;
+    unsigned i = 0, j = 0;
+    while (i < m_ranges.size() && j < other.m_ranges.size()) {
+        range const& a = m_ranges[i];
+        range const& b = other.m_ranges[j];
+        unsigned lo = std::max(a.m_lo, b.m_lo);
+        unsigned hi = std::min(a.m_hi, b.m_hi);
+        if (lo <= hi)
+            result.push_back(range(lo, hi));
+        if (a.m_hi < b.m_hi)
+            ++i;
+        else
+            ++j;
+    }
+    m_ranges.swap(result);
+    for (unsigned k = 0; k < num_small / 64; ++k)
+        m_small[k] &= other.m_small[k];
+    return *this;
+}
+
+char_set& char_set::operator|=(char_set const& other) {
+    if (is_small() && other.is_small()) {
+        for (unsigned i = 0; i < num_small / 64; ++i)
+            m_small[i] |= other.m_small[i];
+        ranges_of_small();
+        return *this;
+    }
+    for (range const& r : other.m_ranges)
+        add(r.m_lo, r.m_hi);
+    return *this;
+}
+
+char_set char_set::complement(unsigned max_char) const {
+    char_set result;
+    unsigned lo = 0;
+    for (range const& r : m_ranges) {
+        if (r.m_lo > max_char)
+            break;
+        if (lo < r.m_lo)
+            result.m_ranges.push_back(range(lo, r.m_lo - 1));
+        if (r.m_hi >= max_char) {
+            result.init_small();
+            return result;
+        }
+        lo = r.m_hi + 1;
+    }
+    result.m_ranges.push_back(range(lo, max_char));
+    result.init_small();
+    return result;
+}
+
+bool char_set::operator==(char_set const& other) const {
+    if (m_ranges.size() != other.m_ranges.size())
+        return false;
+    for (unsigned i = 0; i < m_ranges.size(); ++i)
+        if (m_ranges[i].m_lo != other.m_ranges[i].m_lo || m_ranges[i].m_hi != other.m_ranges[i].m_hi)
+            return false;
+    return true;
+}
+
+unsigned char_set::hash() const {
+    unsigned h = m_ranges.size();
+    for (range const& r : m_ranges)
+        h = combine_hash(h, combine_hash(r.m_lo, r.m_hi));
+    return h;
+}
+
+std::ostream& char_set::display(std::ostream& out) const {
+    out << "[";
+    for (range const& r : m_ranges) {
+        if (r.m_lo == r.m_hi)
+            out << " " << r.m_lo;
+        else
+            out << " " << r.m_lo << "-" << r.m_hi;
+    }
+    return out << " ]";
+}
@@ -0,0 +1,98 @@
+/*++
+Copyright (c) 2020 Microsoft Corporation
+
+Module Name:
+
+    char_set.h
+
+Abstract:
+
+    Sets of characters represented as sorted, disjoint and non-adjacent
+    ranges of code points.
+
+    Characters below 256 are mirrored in a 256-bit bitset. Membership
+    tests for these characters are a single bit test, and intersection
+    and union of sets that only contain such characters are word-wise
+    operations on the bitset.
+
+--*/
+#pragma once
+
+#include "util/vector.h"
+#include <ostream>
+
+class char_set {
+public:
+    struct range {
+        unsigned m_lo;
+        unsigned m_hi;
+        range(unsigned lo, unsigned hi): m_lo(lo), m_hi(hi) {}
+        range(): m_lo(0), m_hi(0) {}
+    };
+
+    static const unsigned num_small = 256;
+
+private:
+    svector<range> m_ranges;
+    uint64_t       m_small[num_small / 64];
+
+    bool is_small() const { return m_ranges.empty() || m_ranges.back().m_hi < num_small; }
+    void set_small(unsigned lo, unsigned hi);
+    void init_small();
+    void ranges_of_small();
+
+public:
+    char_set() { reset(); }
+    char_set(unsigned lo, unsigned hi) { reset(); add(lo, hi); }
+
+    static char_set full(unsigned max_char) { return char_set(0, max_char); }
+
+    void reset();
+
+    bool empty() const { return m_ranges.empty(); }
+
+    bool contains(unsigned ch) const {
+        if (ch < num_small)
+            return 0 != ((m_small[ch / 64] >> (ch % 64)) & 1);
+        return contains_large(ch);
+    }
+
+    bool contains_large(unsigned ch) const;
+
+    /**
+       \brief add the characters lo..hi to the set.
+    */
+    void add(unsigned lo, unsigned hi);
+
+    /**
+       \brief restrict the set to characters in lo..hi.
+    */
+    void intersect(unsigned lo, unsigned hi);
+
+    /**
+       \brief remove character ch from the set.
+    */
+    void remove(unsigned ch);
+
+    char_set& operator&=(char_set const& other);
+    char_set& operator|=(char_set const& other);
+
+    /**
+       \brief complement with respect to the characters 0..max_char.
+    */
+    char_set complement(unsigned max_char) const;
+
+    bool operator==(char_set const& other) const;
+    bool operator!=(char_set const& other) const { return !(*this == other); }
+
+    unsigned num_ranges() const { return m_ranges.size(); }
+    range const& operator[](unsigned i) const { return m_ranges[i]; }
+    range const* begin() const { return m_ranges.begin(); }
+    range const* end() const { return m_ranges.end(); }
+
+    unsigned hash() const;
+
+    std::ostream& display(std::ostream& out) const;
+};
+
+inline std::ostream& operator<<(std::ostream& out, char_set const& s) { return s.display(out); }
@@ -7,6 +7,7 @@ Copyright (c) 2015 Microsoft Corporation
 #include<iostream>
 #include<stdlib.h>
 #include<climits>
+#include<cstring>
 #include "util/mutex.h"
 #include "util/trace.h"
 #include "util/memory_manager.h"
@@ -130,10 +131,13 @@ void memory::set_max_alloc_count(size_t max_count) {
 
 static bool g_finalizing = false;
 
+static void finalize_thread_cache();
+
 void memory::finalize() {
     if (g_memory_initialized) {
         g_finalizing = true;
         mem_finalize();
+        finalize_thread_cache();
         // we leak the mutex since we need it to be always live since memory may
         // be reinitialized again
         //delete g_memory_mux;
@@ -225,6 +229,9 @@ void * memory::allocate(char const* file, int line, char const* obj, size_t s) {
 thread_local long long g_memory_thread_alloc_size    = 0;
 thread_local long long g_memory_thread_alloc_count   = 0;
 
+static long long cached_bytes();
+static void trim_central_pool();
+
 static void synchronize_counters(bool allocating) {
 #ifdef PROFILE_MEMORY
     g_synch_counter++;
@@ -238,12 +245,19 @@ static void synchronize_counters(bool allocating) {
         g_memory_alloc_count += g_memory_thread_alloc_count;
         if (g_memory_alloc_size > g_memory_max_used_size)
             g_memory_max_used_size = g_memory_alloc_size;
-        if (g_memory_max_size != 0 && g_memory_alloc_size > g_memory_max_size)
+        if (g_memory_max_size != 0 && g_memory_alloc_size + cached_bytes() > g_memory_max_size)
             out_of_mem = true;
         if (g_memory_max_alloc_count != 0 && g_memory_alloc_count > g_memory_max_alloc_count)
             counts_exceeded = true;
     }
     g_memory_thread_alloc_size = 0;
+    if (out_of_mem && allocating && cached_bytes() > 0) {
+        // blocks cached in the central pool count towards the limit,
+        // return them to the system before giving up.
+        trim_central_pool();
+        lock_guard lock(*g_memory_mux);
+        out_of_mem = g_memory_alloc_size > g_memory_max_size;
+    }
     if (out_of_mem && allocating) {
         throw_out_of_memory();
     }
@@ -252,12 +266,303 @@ static void synchronize_counters(bool allocating) {
     }
 }
 
+// memory checkers must see every block
+#if defined(__SANITIZE_ADDRESS__) || defined(__SANITIZE_THREAD__)
+#define _NO_THREAD_CACHE
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer) || __has_feature(memory_sanitizer) || __has_feature(thread_sanitizer)
+#define _NO_THREAD_CACHE
+#endif
+#endif
+
+#ifndef _NO_THREAD_CACHE
+// ==================================
+// Thread caching of small blocks
+// ==================================
+//
+// Blocks of at most MAX_SMALL_BLOCK bytes (including the size field) are
+// rounded up to a multiple of SMALL_BLOCK_GRANULARITY and recycled through
+// per thread free lists, one for each size class.  A thread refills an empty
+// list with a batch of blocks from the central pool, and returns a batch to
+// the central pool when its list grows beyond two batches.  Only the batch
+// transfers take g_cache_mux.
+//
+// Every block is obtained from malloc, so any block can be returned to the
+// system.  The central pool keeps at most MAX_CACHED_BYTES; blocks returned
+// to a full pool are freed.  The pool is emptied by memory::finalize, and
+// before reporting that memory.max_size is exceeded, since the bytes it
+// holds count towards the limit.  The free lists of a thread hold at most
+// two batches per size class.
+//
+// The size field of a small block stores its rounded size, so the size
+// class is recovered on deallocation and the accounting in
+// g_memory_thread_alloc_size reflects the memory handed out.
+//
+// Memory checkers do not see blocks that are recycled through the free
+// lists.  The cache is disabled when compiling with a sanitizer, and it
+// can be disabled by defining _NO_THREAD_CACHE (Z3_THREAD_CACHE=OFF in
+// the CMake build).
+
+#define SMALL_BLOCK_GRANULARITY 16
+#define MAX_SMALL_BLOCK         512
+#define NUM_SIZE_CLASSES        (MAX_SMALL_BLOCK / SMALL_BLOCK_GRANULARITY)
+#define BATCH_BYTES             4096
+#define MAX_CACHED_BYTES        (16 * 1024 * 1024)
+
+struct free_block {
+    free_block * m_next;
+    free_block * m_next_batch; // used for batches in the central pool
+};
+
+struct thread_cache {
+    free_block * m_free[NUM_SIZE_CLASSES];
+    unsigned     m_count[NUM_SIZE_CLASSES];
+    bool         m_registered;
+    bool         m_finalized;
+};
+
+struct central_pool {
+    free_block * m_batches[NUM_SIZE_CLASSES]; // batches of batch_size() blocks
+    free_block * m_loose[NUM_SIZE_CLASSES];   // blocks returned outside of batches
+    unsigned     m_loose_count[NUM_SIZE_CLASSES];
+};
+
+static DECLARE_INIT_MUTEX(g_cache_mux);
+static central_pool g_central_pool;
+static atomic<long long> g_cached_bytes(0); // bytes held by the central pool
+static thread_local thread_cache t_cache;
+
+static unsigned block_size(unsigned c) { return (c + 1) * SMALL_BLOCK_GRANULARITY; }
+
+static unsigned batch_size(unsigned c) {
+    unsigned n = BATCH_BYTES / block_size(c);
+    return n < 8 ? 8 : n;
+}
+
+static void free_blocks(free_block * b) {
+    while (b) {
+        free_block * next = b->m_next;
+        free(b);
+        b = next;
+    }
+}
+
+static long long cached_bytes() {
+    return g_cached_bytes;
+}
+
+// return the blocks of the central pool to the system.
+static void trim_central_pool() {
+    free_block * batches[NUM_SIZE_CLASSES];
+    free_block * loose[NUM_SIZE_CLASSES];
+    {
+        lock_guard lock(*g_cache_mux);
+        central_pool & cp = g_central_pool;
+        for (unsigned c = 0; c < NUM_SIZE_CLASSES; ++c) {
+            batches[c] = cp.m_batches[c];
+            loose[c] = cp.m_loose[c];
+            cp.m_batches[c] = nullptr;
+            cp.m_loose[c] = nullptr;
+            cp.m_loose_count[c] = 0;
+        }
+        g_cached_bytes = 0;
+    }
+    for (unsigned c = 0; c < NUM_SIZE_CLASSES; ++c) {
+        for (free_block * b = batches[c]; b; ) {
+            free_block * next = b->m_next_batch;
+            free_blocks(b);
+            b = next;
+        }
+        free_blocks(loose[c]);
+    }
+}
+
+static void flush_thread_cache();
+
+// flush the free lists of a thread when it exits.
+struct thread_cache_flusher {
+    bool m_active = false;
+    ~thread_cache_flusher() {
+        if (m_active)
+            flush_thread_cache();
+    }
+};
+
+static thread_local thread_cache_flusher t_cache_flusher;
+
+// move the free lists of the current thread to the central pool, or
+// free them if the pool is full.
+static void flush_thread_cache() {
+    thread_cache & tc = t_cache;
+    for (unsigned c = 0; c < NUM_SIZE_CLASSES; ++c) {
+        free_block * b = tc.m_free[c];
+        long long bytes = static_cast<long long>(block_size(c)) * tc.m_count[c];
+        tc.m_free[c] = nullptr;
+        tc.m_count[c] = 0;
+        if (!b)
+            continue;
+        {
+            lock_guard lock(*g_cache_mux);
+            if (g_cached_bytes + bytes <= MAX_CACHED_BYTES) {
+                central_pool & cp = g_central_pool;
+                while (b) {
+                    free_block * next = b->m_next;
+                    b->m_next = cp.m_loose[c];
+                    cp.m_loose[c] = b;
+                    cp.m_loose_count[c]++;
+                    b = next;
+                }
+                g_cached_bytes += bytes;
+            }
+        }
+        free_blocks(b);
+    }
+}
+
+static void register_thread_cache() {
+    t_cache.m_registered = true;
+    t_cache_flusher.m_active = true;
+}
+
+// allocate a batch of n blocks of class c.
+static free_block * alloc_batch(unsigned c, unsigned n) {
+    free_block * head = nullptr;
+    for (unsigned i = 0; i < n; ++i) {
+        free_block * b = static_cast<free_block*>(malloc(block_size(c)));
+        if (b == nullptr) {
+            free_blocks(head);
+            throw_out_of_memory();
+        }
+        b->m_next = head;
+        head = b;
+    }
+    return head;
+}
+
+static void refill_thread_cache(unsigned c) {
+    thread_cache & tc = t_cache;
+    if (!tc.m_registered)
+        register_thread_cache();
+    central_pool & cp = g_central_pool;
+    {
+        lock_guard lock(*g_cache_mux);
+        if (cp.m_batches[c]) {
+            free_block * b = cp.m_batches[c];
+            cp.m_batches[c] = b->m_next_batch;
+            tc.m_free[c] = b;
+            tc.m_count[c] = batch_size(c);
+            g_cached_bytes -= static_cast<long long>(block_size(c)) * batch_size(c);
+            return;
+        }
+        if (cp.m_loose[c]) {
+            tc.m_free[c] = cp.m_loose[c];
+            tc.m_count[c] = cp.m_loose_count[c];
+            g_cached_bytes -= static_cast<long long>(block_size(c)) * cp.m_loose_count[c];
+            cp.m_loose[c] = nullptr;
+            cp.m_loose_count[c] = 0;
+            return;
+        }
+    }
+    tc.m_free[c] = alloc_batch(c, batch_size(c));
+    tc.m_count[c] = batch_size(c);
+}
+
+// move the first batch of the free list of class c to the central pool,
+// or free it if the pool is full.
+static void release_batch(unsigned c) {
+    thread_cache & tc = t_cache;
+    unsigned n = batch_size(c);
+    long long bytes = static_cast<long long>(block_size(c)) * n;
+    free_block * first = tc.m_free[c];
+    free_block * last = first;
+    for (unsigned i = 1; i < n; ++i)
+        last = last->m_next;
+    tc.m_free[c] = last->m_next;
+    tc.m_count[c] -= n;
+    last->m_next = nullptr;
+    {
+        lock_guard lock(*g_cache_mux);
+        if (g_cached_bytes + bytes <= MAX_CACHED_BYTES) {
+            first->m_next_batch = g_central_pool.m_batches[c];
+            g_central_pool.m_batches[c] = first;
+            g_cached_bytes += bytes;
+            return;
+        }
+    }
+    free_blocks(first);
+}
+
+static void * allocate_small(unsigned c) {
+    thread_cache & tc = t_cache;
+    if (tc.m_finalized)
+        // the thread is exiting and its cache is gone.
+        return malloc(block_size(c));
+    if (tc.m_free[c] == nullptr)
+        refill_thread_cache(c);
+    free_block * b = tc.m_free[c];
+    tc.m_free[c] = b->m_next;
+    tc.m_count[c]--;
+    return b;
+}
+
+static void deallocate_small(void * p, unsigned c) {
+    thread_cache & tc = t_cache;
+    free_block * b = static_cast<free_block*>(p);
+    if (tc.m_finalized) {
+        free(b);
+        return;
+    }
+    if (!tc.m_registered)
+        register_thread_cache();
+    b->m_next = tc.m_free[c];
+    tc.m_free[c] = b;
+    if (++tc.m_count[c] >= 2 * batch_size(c))
+        release_batch(c);
+}
+
+// called by memory::finalize.
+static void finalize_thread_cache() {
+    if (t_cache.m_registered && !t_cache.m_finalized)
+        flush_thread_cache();
+    trim_central_pool();
+}
+
+static void * raw_allocate(size_t & s) {
+    if (s <= MAX_SMALL_BLOCK) {
+        unsigned c = static_cast<unsigned>((s - 1) / SMALL_BLOCK_GRANULARITY);
+        s = block_size(c);
+        return allocate_small(c);
+    }
+    return malloc(s);
+}
+
+static void raw_deallocate(void * p, size_t s) {
+    if (s <= MAX_SMALL_BLOCK)
+        deallocate_small(p, static_cast<unsigned>(s / SMALL_BLOCK_GRANULARITY - 1));
+    else
+        free(p);
+}
+
+#else
+
+static long long cached_bytes() { return 0; }
+
+static void trim_central_pool() {}
+
+static void finalize_thread_cache() {}
+
+static void * raw_allocate(size_t & s) { return malloc(s); }
+
+static void raw_deallocate(void * p, size_t s) { free(p); }
+
+#endif
+
 void memory::deallocate(void * p) {
     size_t * sz_p  = reinterpret_cast<size_t*>(p) - 1;
     size_t sz      = *sz_p;
     void * real_p  = reinterpret_cast<void*>(sz_p);
     g_memory_thread_alloc_size -= sz;
-    free(real_p);
+    raw_deallocate(real_p, sz);
     if (g_memory_thread_alloc_size < -SYNCH_THRESHOLD) {
         synchronize_counters(false);
     }
@@ -265,7 +570,7 @@ void memory::deallocate(void * p) {
 
 void * memory::allocate(size_t s) {
     s = s + sizeof(size_t); // we allocate an extra field!
-    void * r = malloc(s);
+    void * r = raw_allocate(s);
     if (r == 0) {
         throw_out_of_memory();
         return nullptr;
@@ -286,6 +591,16 @@ void* memory::reallocate(void *p, size_t s) {
     void *real_p = reinterpret_cast<void*>(sz_p);
     s = s + sizeof(size_t); // we allocate an extra field!
 
+#ifndef _NO_THREAD_CACHE
+    if (sz <= MAX_SMALL_BLOCK || s <= MAX_SMALL_BLOCK) {
+        // small blocks are not allocated by malloc
+        void * r = allocate(s - sizeof(size_t));
+        memcpy(r, p, (sz < s ? sz : s) - sizeof(size_t));
+        deallocate(p);
+        return r;
+    }
+#endif
+
     g_memory_thread_alloc_size += s - sz;
     g_memory_thread_alloc_count += 1;
     if (g_memory_thread_alloc_size > SYNCH_THRESHOLD) {
@@ -309,6 +624,8 @@ void* memory::reallocate(void *p, size_t s) {
 // ==================================
 // allocate & deallocate without using thread local storage
 
+static void finalize_thread_cache() {}
+
 void memory::deallocate(void * p) {
     size_t * sz_p  = reinterpret_cast<size_t*>(p) - 1;
     size_t sz      = *sz_p;
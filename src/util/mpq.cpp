@@ -348,6 +348,43 @@ void mpq_manager<SYNCH>::lin_arith_op(mpq const& a, mpq const& b, mpq& c, mpz& g
     }                                           
 }
 
+static unsigned abs_small(int v) {
+    return v < 0 ? 0u - static_cast<unsigned>(v) : static_cast<unsigned>(v);
+}
+
+template<bool SYNCH>
+template<bool SUB>
+void mpq_manager<SYNCH>::small_lin_arith_op(mpq const& a, mpq const& b, mpq& c) {
+    int64_t an = a.m_num.m_val, bn = b.m_num.m_val;
+    uint64_t ad = static_cast<unsigned>(a.m_den.m_val), bd = static_cast<unsigned>(b.m_den.m_val);
+    unsigned g = u_gcd(static_cast<unsigned>(ad), static_cast<unsigned>(bd));
+    if (g == 1) {
+        set(c.m_num, SUB ? an * static_cast<int64_t>(bd) - bn * static_cast<int64_t>(ad) : an * static_cast<int64_t>(bd) + bn * static_cast<int64_t>(ad));
+        set(c.m_den, ad * bd);
+        return;
+    }
+    ad /= g;
+    bd /= g;
+    uint64_t d = ad * bd * g;
+    int64_t n = SUB ? an * static_cast<int64_t>(bd) - bn * static_cast<int64_t>(ad) : an * static_cast<int64_t>(bd) + bn * static_cast<int64_t>(ad);
+    uint64_t abs_n = n < 0 ? 0 - static_cast<uint64_t>(n) : static_cast<uint64_t>(n);
+    unsigned g2 = u_gcd(static_cast<unsigned>(abs_n % g), g);
+    set(c.m_num, n / static_cast<int64_t>(g2));
+    set(c.m_den, d / g2);
+}
+
+template<bool SYNCH>
+void mpq_manager<SYNCH>::small_rat_mul(mpq const& a, mpq const& b, mpq& c) {
+    int an = a.m_num.m_val, bn = b.m_num.m_val;
+    unsigned ad = a.m_den.m_val, bd = b.m_den.m_val;
+    unsigned g1 = u_gcd(ad, abs_small(bn));
+    unsigned g2 = u_gcd(abs_small(an), bd);
+    int64_t n = (static_cast<int64_t>(an) / g2) * (static_cast<int64_t>(bn) / g1);
+    uint64_t d = static_cast<uint64_t>(ad / g1) * (bd / g2);
+    set(c.m_num, n);
+    set(c.m_den, d);
+}
+
 template<bool SYNCH>
 void mpq_manager<SYNCH>::rat_mul(mpq const & a, mpq const & b, mpq & c, mpz& g1, mpz& g2, mpz& tmp1, mpz& tmp2) {
 #if 1
@@ -379,7 +416,10 @@ void mpq_manager<SYNCH>::rat_mul(mpz const & a, mpq const & b, mpq & c) {
 template<bool SYNCH>
 void mpq_manager<SYNCH>::rat_mul(mpq const & a, mpq const & b, mpq & c) {
     STRACE("rat_mpq", tout << "[mpq] " << to_string(a) << " * " << to_string(b) << " == ";); 
-    if (SYNCH) {
+    if (is_small(a) && is_small(b)) {
+        small_rat_mul(a, b, c);
+    }
+    else if (SYNCH) {
         mpz g1, g2, tmp1, tmp2;
         rat_mul(a, b, c, g1, g2, tmp1, tmp2);
         del(g1);
@@ -396,7 +436,10 @@ void mpq_manager<SYNCH>::rat_mul(mpq const & a, mpq const & b, mpq & c) {
 template<bool SYNCH>
 void mpq_manager<SYNCH>::rat_add(mpq const & a, mpq const & b, mpq & c) {
     STRACE("rat_mpq", tout << "[mpq] " << to_string(a) << " + " << to_string(b) << " == ";); 
-    if (SYNCH) {
+    if (is_small(a) && is_small(b)) {
+        small_lin_arith_op<false>(a, b, c);
+    }
+    else if (SYNCH) {
         mpz_stack tmp1, tmp2, tmp3, g;
         lin_arith_op<false>(a, b, c, g, tmp1, tmp2, tmp3);
         del(tmp1);
@@ -413,7 +456,10 @@ void mpq_manager<SYNCH>::rat_add(mpq const & a, mpq const & b, mpq & c) {
 template<bool SYNCH>
 void mpq_manager<SYNCH>::rat_sub(mpq const & a, mpq const & b, mpq & c) {
     STRACE("rat_mpq", tout << "[mpq] " << to_string(a) << " - " << to_string(b) << " == ";); 
-    if (SYNCH) {
+    if (is_small(a) && is_small(b)) {
+        small_lin_arith_op<true>(a, b, c);
+    }
+    else if (SYNCH) {
         mpz tmp1, tmp2, tmp3, g;
         lin_arith_op<true>(a, b, c, g, tmp1, tmp2, tmp3);
         del(tmp1);
@@ -107,6 +107,14 @@ class mpq_manager : public mpz_manager<SYNCH> {
 
     void rat_mul(mpq const & a, mpq const & b, mpq & c, mpz& g1, mpz& g2, mpz& tmp1, mpz& tmp2);
 
+    // Numerators and denominators of small rationals fit in 32 bits, so
+    // add, sub and mul follow lin_arith_op and rat_mul in machine integers
+    // without using mpz temporaries.
+    template<bool SUB>
+    void small_lin_arith_op(mpq const & a, mpq const & b, mpq & c);
+
+    void small_rat_mul(mpq const & a, mpq const & b, mpq & c);
+
 public:
     typedef mpq numeral;
     typedef mpq rational;
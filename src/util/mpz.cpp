@@ -249,6 +249,11 @@ void mpz_manager<SYNCH>::add(mpz const & a, mpz const & b, mpz & c) {
     if (is_small(a) && is_small(b)) {
         set_i64(c, i64(a) + i64(b));
     }
+#ifdef _MP_INT128
+    else if (is_int64(a) && is_int64(b)) {
+        set_i128(c, static_cast<mpz_int128>(get_int64(a)) + get_int64(b));
+    }
+#endif
     else {
         big_add(a, b, c);
     }
@@ -261,6 +266,11 @@ void mpz_manager<SYNCH>::sub(mpz const & a, mpz const & b, mpz & c) {
     if (is_small(a) && is_small(b)) {
         set_i64(c, i64(a) - i64(b));
     }
+#ifdef _MP_INT128
+    else if (is_int64(a) && is_int64(b)) {
+        set_i128(c, static_cast<mpz_int128>(get_int64(a)) - get_int64(b));
+    }
+#endif
     else {
         big_sub(a, b, c);
     }
@@ -368,6 +378,21 @@ void mpz_manager<SYNCH>::set_big_ui64(mpz & c, uint64_t v) {
 #endif
 }
 
+#ifdef _MP_INT128
+template<bool SYNCH>
+void mpz_manager<SYNCH>::set_big_i128(mpz & c, mpz_int128 v) {
+    bool sign = v < 0;
+    mpz_uint128 _v = sign ? 0 - static_cast<mpz_uint128>(v) : static_cast<mpz_uint128>(v);
+    digit_t ds[sizeof(mpz_uint128) / sizeof(digit_t)] = {};
+    unsigned sz = 0;
+    for (; _v != 0; _v >>= 8 * sizeof(digit_t))
+        ds[sz++] = static_cast<digit_t>(_v);
+    set_digits(c, sz, ds);
+    if (sign)
+        neg(c);
+}
+#endif
+
 #ifdef _MP_GMP
 
 template<bool SYNCH>
@@ -505,6 +530,11 @@ void mpz_manager<SYNCH>::mul(mpz const & a, mpz const & b, mpz & c) {
     if (is_small(a) && is_small(b)) {
         set_i64(c, i64(a) * i64(b));
     }
+#ifdef _MP_INT128
+    else if (is_int64(a) && is_int64(b)) {
+        set_i128(c, static_cast<mpz_int128>(get_int64(a)) * get_int64(b));
+    }
+#endif
     else {
         big_mul(a, b, c);
     }
@@ -885,6 +915,11 @@ void mpz_manager<SYNCH>::gcd(mpz const & a, mpz const & b, mpz & c) {
         unsigned r = u_gcd(_a, _b);
         set(c, r);
     }
+#ifndef _MP_GMP
+    else if (is_abs_uint64(a) && is_abs_uint64(b)) {
+        set(c, u64_gcd(abs_to_uint64(a), abs_to_uint64(b)));
+    }
+#endif
     else {
 #ifdef _MP_GMP
         ensure_mpz_t a1(a), b1(b);
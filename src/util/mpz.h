@@ -55,6 +55,14 @@ typedef size_t digit_t;
 typedef unsigned int digit_t;
 #endif
 
+// Operands that fit in 64 bits are combined in 128-bit machine arithmetic
+// before falling back to the digit based algorithms.
+#if !defined(_MP_GMP) && defined(__SIZEOF_INT128__)
+#define _MP_INT128
+__extension__ typedef __int128 mpz_int128;
+__extension__ typedef unsigned __int128 mpz_uint128;
+#endif
+
 #ifndef _MP_GMP
 class mpz_cell {
     unsigned  m_size;
@@ -256,6 +264,17 @@ class mpz_manager {
 
     void set_big_ui64(mpz & c, uint64_t v);
 
+#ifdef _MP_INT128
+    void set_big_i128(mpz & c, mpz_int128 v);
+
+    void set_i128(mpz & c, mpz_int128 v) {
+        if (v >= INT64_MIN && v <= INT64_MAX)
+            set_i64(c, static_cast<int64_t>(v));
+        else
+            set_big_i128(c, v);
+    }
+#endif
+
 
 #ifndef _MP_GMP
 
@@ -289,6 +308,13 @@ class mpz_manager {
             return ((static_cast<uint64_t>(digits(a)[1]) << 32) | (static_cast<uint64_t>(digits(a)[0])));
     }
 
+    // absolute value of a number that satisfies is_abs_uint64
+    static uint64_t abs_to_uint64(mpz const & a) {
+        if (is_small(a))
+            return a.m_val < 0 ? 0 - static_cast<uint64_t>(i64(a)) : static_cast<uint64_t>(i64(a));
+        return big_abs_to_uint64(a);
+    }
+
     class sign_cell {
         static const unsigned capacity = 2;
         unsigned char m_bytes[sizeof(mpz_cell) + sizeof(digit_t) * capacity];
@@ -22,6 +22,27 @@ Revision History:
 #include "util/rational.h"
 
 synch_mpq_manager *  rational::g_mpq_manager = nullptr;
+#ifdef RATIONAL_THREAD_LOCAL
+thread_local synch_mpq_manager * rational::t_mpq_manager = nullptr;
+
+namespace {
+    // releases the manager of a thread other than the main thread when the thread exits.
+    struct thread_mpq_manager {
+        synch_mpq_manager * m_manager = nullptr;
+        ~thread_mpq_manager() { dealloc(m_manager); }
+    };
+    thread_local thread_mpq_manager t_thread_mpq_manager;
+}
+
+synch_mpq_manager & rational::mk_thread_manager() {
+    SASSERT(!t_mpq_manager);
+    SASSERT(g_mpq_manager);
+    synch_mpq_manager * r = alloc(synch_mpq_manager);
+    t_thread_mpq_manager.m_manager = r;
+    t_mpq_manager = r;
+    return *r;
+}
+#endif
 rational             rational::m_zero;
 rational             rational::m_one;
 rational             rational::m_minus_one;
@@ -65,6 +86,9 @@ void rational::initialize() {
     if (!g_mpq_manager) {
         ALLOC_MUTEX(g_powers_of_two);
         g_mpq_manager = alloc(synch_mpq_manager);
+#ifdef RATIONAL_THREAD_LOCAL
+        t_mpq_manager = g_mpq_manager;
+#endif
         m().set(m_zero.m_val, 0);
         m().set(m_one.m_val, 1);
         m().set(m_minus_one.m_val, -1);
@@ -82,6 +106,9 @@ void rational::finalize() {
     m_minus_one.~rational();
     dealloc(g_mpq_manager);
     g_mpq_manager = nullptr;
+#ifdef RATIONAL_THREAD_LOCAL
+    t_mpq_manager = nullptr;
+#endif
     DEALLOC_MUTEX(g_powers_of_two);
 }
 
@@ -20,6 +20,10 @@ Revision History:
 
 #include "util/mpq.h"
 
+#if !defined(SINGLE_THREAD) && (defined(_WINDOWS) || defined(_USE_THREAD_LOCAL))
+#define RATIONAL_THREAD_LOCAL
+#endif
+
 class rational {
     mpq   m_val;
     static rational                  m_zero;
@@ -27,8 +31,20 @@ class rational {
     static rational                  m_minus_one;
     static vector<rational>          m_powers_of_two;
     static synch_mpq_manager *       g_mpq_manager;
-    
+#ifdef RATIONAL_THREAD_LOCAL
+    // Each thread uses its own manager, so that threads do not share the scratch
+    // state of the manager. Cells of numerals are allocated with memory::allocate,
+    // so numerals can be freed by any thread.
+    static thread_local synch_mpq_manager * t_mpq_manager;
+    static synch_mpq_manager & mk_thread_manager();
+
+    static synch_mpq_manager & m() {
+        synch_mpq_manager * r = t_mpq_manager;
+        return r ? *r : mk_thread_manager();
+    }
+#else
     static synch_mpq_manager & m() { return *g_mpq_manager; }
+#endif
 
 public:
     static void initialize();
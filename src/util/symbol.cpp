@@ -19,7 +19,7 @@ Revision History:
 
 #include "util/symbol.h"
 #include "util/mutex.h"
-#include "util/str_hashtable.h"
+#include "util/hash.h"
 #include "util/region.h"
 #include "util/string_buffer.h"
 #include <cstring>
@@ -32,44 +32,121 @@ Revision History:
 symbol symbol::m_dummy(TAG(void*, nullptr, 2));
 const symbol symbol::null;
 
+#ifdef SINGLE_THREAD
+template<typename T> static T load_acquire(T const & x) { return x; }
+template<typename T> static void store_release(T & x, T v) { x = v; }
+#else
+template<typename T> static T load_acquire(std::atomic<T> const & x) { return x.load(std::memory_order_acquire); }
+template<typename T> static void store_release(std::atomic<T> & x, T v) { x.store(v, std::memory_order_release); }
+#endif
+
 /**
    \brief Symbol table manager. It stores the symbol strings created at runtime.
+
+   Strings are stored in a region, preceded by their hash code, and
+   interned in an insert-only open addressing table. Lookups of existing
+   strings probe the table without taking the lock. Insertions take the
+   lock and publish the string with a release store. When the table is
+   grown, the strings are rehashed into a fresh array and the old array
+   is kept until the table is destroyed, so concurrent readers of the old
+   array remain valid; a reader that misses a string falls back to the
+   locked path.
 */
 class internal_symbol_table {
-    region        m_region; //!< Region used to store symbol strings.
-    str_hashtable m_table;  //!< Table of created symbol strings.
+    typedef atomic<char const *> slot;
+
+    struct cells {
+        unsigned m_capacity;
+        slot *   m_slots;
+        cells *  m_prev;   //!< Retired arrays that may still be read.
+    };
+
+    region         m_region; //!< Region used to store symbol strings.
+    atomic<cells*> m_cells;  //!< Table of created symbol strings.
+    unsigned       m_size;
     DECLARE_MUTEX(lock);
+
+    static unsigned get_hash(char const * s) {
+        return static_cast<unsigned>(reinterpret_cast<size_t const *>(s)[-1]);
+    }
+
+    static cells * mk_cells(unsigned capacity, cells * prev) {
+        cells * c = alloc(cells);
+        c->m_capacity = capacity;
+        c->m_slots = alloc_vect<slot>(capacity);
+        for (unsigned i = 0; i < capacity; ++i)
+            store_release(c->m_slots[i], static_cast<char const*>(nullptr));
+        c->m_prev = prev;
+        return c;
+    }
+
+    static char const * find(cells * c, char const * d, unsigned h) {
+        unsigned mask = c->m_capacity - 1;
+        for (unsigned i = h & mask; ; i = (i + 1) & mask) {
+            char const * s = load_acquire(c->m_slots[i]);
+            if (s == nullptr)
+                return nullptr;
+            if (get_hash(s) == h && strcmp(s, d) == 0)
+                return s;
+        }
+    }
+
+    static void insert(cells * c, char const * s) {
+        unsigned mask = c->m_capacity - 1;
+        unsigned i = get_hash(s) & mask;
+        while (load_acquire(c->m_slots[i]) != nullptr)
+            i = (i + 1) & mask;
+        store_release(c->m_slots[i], s);
+    }
+
+    void grow() {
+        cells * old_c = load_acquire(m_cells);
+        cells * new_c = mk_cells(2 * old_c->m_capacity, old_c);
+        for (unsigned i = 0; i < old_c->m_capacity; ++i) {
+            char const * s = load_acquire(old_c->m_slots[i]);
+            if (s)
+                insert(new_c, s);
+        }
+        store_release(m_cells, new_c);
+    }
     
 public:
 
-    internal_symbol_table() {
+    internal_symbol_table():
+        m_cells(mk_cells(64, nullptr)),
+        m_size(0) {
         ALLOC_MUTEX(lock);
     }
 
     ~internal_symbol_table() {
+        cells * c = load_acquire(m_cells);
+        while (c) {
+            cells * prev = c->m_prev;
+            dealloc_vect(c->m_slots, c->m_capacity);
+            dealloc(c);
+            c = prev;
+        }
         DEALLOC_MUTEX(lock);
     }
 
-    char const * get_str(char const * d) {
-        const char * result;
+    char const * get_str(char const * d, size_t l, unsigned h) {
+        char const * result = find(load_acquire(m_cells), d, h);
+        if (result)
+            return result;
         lock_guard _lock(*lock);
-        str_hashtable::entry * e;
-        if (m_table.insert_if_not_there_core(d, e)) {
-            // new entry
-            size_t l   = strlen(d);
-            // store the hash-code before the string
-            size_t * mem = static_cast<size_t*>(m_region.allocate(l + 1 + sizeof(size_t)));
-            *mem = e->get_hash();
-            mem++;
-            result = reinterpret_cast<const char*>(mem);
-            memcpy(mem, d, l+1);
-            // update the entry with the new ptr.
-            e->set_data(result);
-        }
-        else {
-            result = e->get_data();
-        }
-        SASSERT(m_table.contains(result));
+        result = find(load_acquire(m_cells), d, h);
+        if (result)
+            return result;
+        if (2 * (m_size + 1) > load_acquire(m_cells)->m_capacity)
+            grow();
+        // store the hash-code before the string
+        size_t * mem = static_cast<size_t*>(m_region.allocate(l + 1 + sizeof(size_t)));
+        *mem = h;
+        mem++;
+        memcpy(mem, d, l+1);
+        result = reinterpret_cast<const char*>(mem);
+        insert(load_acquire(m_cells), result);
+        m_size++;
         return result;
     }
 };
@@ -91,8 +168,12 @@ struct internal_symbol_tables {
     }
 
     char const * get_str(char const * d) {
-        auto* table = tables[string_hash(d, static_cast<unsigned>(strlen(d)), 251) % sz];
-        return table->get_str(d);
+        size_t l = strlen(d);
+        // the same hash code as str_hash_proc; the table is selected by the
+        // high bits and the slot by the low bits.
+        unsigned h = string_hash(d, static_cast<unsigned>(l), 17);
+        auto* table = tables[((h >> 16) | (h << 16)) % sz];
+        return table->get_str(d, l, h);
     }
 };
 